@@ -0,0 +1,42 @@
+#pragma once
+
+// Benchmarks register themselves by name, EngineBenchmarks runs the ones whose name contains its first argument.
+struct Benchmark
+{
+    std::string_view name;
+    void (*function)();
+};
+
+std::vector<Benchmark>& GetBenchmarks();
+
+struct BenchmarkRegistrar
+{
+    explicit BenchmarkRegistrar(const Benchmark& benchmark) { GetBenchmarks().push_back(benchmark); }
+};
+
+#define BENCHMARK(name)                                                                                                \
+    static void name##Benchmark();                                                                                     \
+    static const BenchmarkRegistrar name##Registrar({ #name, &name##Benchmark });                                      \
+    static void name##Benchmark()
+
+// Where the project's assets are, so benchmarks run the same from any working directory.
+inline std::filesystem::path GetAssetRoot() { return ENGINE_ASSET_ROOT; }
+
+// Makes the compiler keep whatever data points at. It is defined in main.cpp so no call can see that it does nothing.
+void DoNotOptimize(const void* data);
+
+// Average milliseconds per call, called at least min_runs times and for at least 200 ms.
+template <typename Function>
+double MeasureMs(Function&& function, const uint32_t min_runs = 3)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed{};
+    uint32_t runs = 0;
+    while (runs < min_runs || elapsed.count() < 200.0)
+    {
+        function();
+        ++runs;
+        elapsed = std::chrono::high_resolution_clock::now() - start;
+    }
+    return elapsed.count() / runs;
+}
@@ -0,0 +1,112 @@
+#include "benchmark.hpp"
+#include "bvh.hpp"
+
+namespace
+{
+    std::vector<Bounds> RandomBounds(std::mt19937& rng, const uint32_t count)
+    {
+        std::uniform_real_distribution<float> position(-1000.f, 1000.f);
+        std::uniform_real_distribution<float> size(0.5f, 5.f);
+        std::vector<Bounds> bounds(count);
+        for (auto& object : bounds)
+        {
+            const glm::vec3 center(position(rng), position(rng) * 0.1f, position(rng));
+            const glm::vec3 extents(size(rng));
+            object = Bounds::FromPoints(std::array{ center - extents, center + extents });
+        }
+        return bounds;
+    }
+} // namespace
+
+// Build, incremental insert, refit and query throughput over a flat city sized world of random boxes.
+BENCHMARK(Bvh)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    for (const uint32_t count : { 100'000u, 1'000'000u })
+    {
+        const auto bounds = RandomBounds(rng, count);
+        Bvh bvh;
+        const double build_ms = MeasureMs([&] { bvh.Build(bounds); });
+
+        // Adding one more model's worth of objects to the full tree, against building everything again.
+        const auto added = RandomBounds(rng, count / 100);
+        std::vector<Bounds> all = bounds;
+        all.insert(all.end(), added.begin(), added.end());
+        double insert_ms = 0.0;
+        constexpr uint32_t insert_runs = 3;
+        for (uint32_t run = 0; run < insert_runs; ++run)
+        {
+            bvh.Build(bounds);
+            const auto start = std::chrono::high_resolution_clock::now();
+            bvh.Insert(added);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+            insert_ms += elapsed.count() / insert_runs;
+        }
+        const double rebuild_ms = MeasureMs([&] { bvh.Build(all); });
+
+        // A tenth of the objects nudged every frame, small enough that no background rebuild is triggered.
+        bvh.Build(bounds);
+        std::vector<Bounds> moved = bounds;
+        uint32_t frame = 0;
+        const double refit_ms = MeasureMs(
+            [&]
+            {
+                const glm::vec3 offset(0.01f * static_cast<float>(frame++ % 2 ? 1 : -1), 0.f, 0.f);
+                for (uint32_t i = frame % 10; i < count; i += 10)
+                {
+                    moved[i].box.min += offset;
+                    moved[i].box.max += offset;
+                    moved[i].sphere.center += offset;
+                    bvh.Update(i, moved[i]);
+                }
+                bvh.Refit();
+            });
+
+        std::vector<Frustum> frustums(64);
+        for (auto& frustum : frustums)
+        {
+            const glm::vec3 eye(unit(rng) * 900.f, 20.f, unit(rng) * 900.f);
+            const glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(unit(rng), -0.1f, unit(rng)), glm::vec3(0.f, 1.f, 0.f));
+            frustum = Camera::CreateFrustum(glm::perspective(glm::radians(70.f), 16.f / 9.f, 0.1f, 300.f) * view);
+        }
+        std::vector<uint32_t> visible;
+        size_t visible_count = 0;
+        const double frustum_ms = MeasureMs(
+            [&]
+            {
+                visible_count = 0;
+                for (const auto& frustum : frustums)
+                {
+                    visible.clear();
+                    bvh.QueryFrustum(frustum, visible);
+                    visible_count += visible.size();
+                }
+            });
+
+        std::vector<Ray> rays(4096);
+        for (auto& ray : rays)
+        {
+            ray = { .origin = glm::vec3(unit(rng) * 1000.f, 150.f, unit(rng) * 1000.f),
+                    .direction = glm::vec3(unit(rng), -0.3f, unit(rng)) };
+        }
+        std::vector<std::optional<RayHit>> hits(rays.size());
+        const double ray_ms = MeasureMs([&] { bvh.Raycast(rays, hits); });
+        const auto hit_count = std::ranges::count_if(hits, [](const auto& hit) { return hit.has_value(); });
+
+        std::println("{:>9} objects: build {:.2f} ms, insert {} {:.2f} ms (rebuild {:.2f} ms), refit {} moved {:.3f} ms",
+                     count,
+                     build_ms,
+                     added.size(),
+                     insert_ms,
+                     rebuild_ms,
+                     count / 10,
+                     refit_ms);
+        std::println("{:>9}          frustum {:.0f} queries/s ({} visible each), raycast {:.0f} rays/s ({} hit)",
+                     "",
+                     frustums.size() * 1000.0 / frustum_ms,
+                     visible_count / frustums.size(),
+                     rays.size() * 1000.0 / ray_ms,
+                     hit_count);
+    }
+}
@@ -0,0 +1,46 @@
+#include "benchmark.hpp"
+#include "culling.hpp"
+
+// SIMD and scalar frustum culling of random boxes around a camera, roughly a third of them end up visible.
+BENCHMARK(FrustumCulling)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-500.f, 500.f);
+    std::uniform_real_distribution<float> size(0.5f, 5.f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    const Frustum frustum = Camera::CreateFrustum(glm::perspective(glm::radians(90.f), 16.f / 9.f, 0.1f, 1000.f) * view);
+
+    for (const uint32_t count : { 10'000u, 100'000u, 1'000'000u })
+    {
+        FrustumCuller culler;
+        culler.Resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const glm::vec3 center(position(rng), position(rng), position(rng));
+            const glm::vec3 extents(size(rng));
+            culler.SetBounds(i, Bounds::FromPoints(std::array{ center - extents, center + extents }));
+        }
+
+        std::vector<uint32_t> visible;
+        visible.reserve(count);
+        const double simd_ms = MeasureMs(
+            [&]
+            {
+                visible.clear();
+                culler.Cull(frustum, visible);
+            });
+        const size_t visible_count = visible.size();
+        const double scalar_ms = MeasureMs(
+            [&]
+            {
+                visible.clear();
+                culler.CullScalar(frustum, visible);
+            });
+        std::println("{:>9} objects: {:>8.3f} ms SIMD, {:>8.3f} ms scalar ({:.1f}x), {} visible",
+                     count,
+                     simd_ms,
+                     scalar_ms,
+                     scalar_ms / simd_ms,
+                     visible_count);
+    }
+}
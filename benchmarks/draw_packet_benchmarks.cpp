@@ -0,0 +1,176 @@
+#include "benchmark.hpp"
+#include "renderer.hpp"
+
+namespace
+{
+    // The descriptor indices of a geometry page's buffers, what the packets copy out of GeometryPage.
+    struct PageDescriptors
+    {
+        uint32_t positions;
+        uint32_t attributes;
+        uint32_t meshlets;
+        uint32_t meshlet_vertices;
+        uint32_t meshlet_triangles;
+    };
+
+    uint32_t GetAmplificationGroupCount(const uint32_t meshlet_count) { return (meshlet_count + 31) / 32; }
+
+    // The null recorder only counts bytes, a command list copies them. Without this the rebuilt packets would never be
+    // written and only their meshlet count read.
+    template <typename Packet>
+    void Record(const NullCommandRecorder& recorder, const Packet& packet)
+    {
+        DoNotOptimize(&packet);
+        recorder.PushConstants(&packet, sizeof(packet));
+        recorder.DispatchMesh(GetAmplificationGroupCount(packet.meshlet_count), 1, 1);
+    }
+
+    // The renderer's record loop over a packed stream.
+    template <typename Packet>
+    void RecordPackets(const NullCommandRecorder& recorder, const std::span<const Packet> packets)
+    {
+        for (const auto& packet : packets)
+        {
+            Record(recorder, packet);
+        }
+    }
+
+    DepthDrawPacket CreateDepthPacket(const MeshRenderer& renderable, const PageDescriptors& page)
+    {
+        const auto& geometry = renderable.m_geometry;
+        return {
+            .position_buffer = page.positions,
+            .meshlet_buffer = page.meshlets,
+            .mesh_vertex_buffer = page.meshlet_vertices,
+            .mesh_triangle_buffer = page.meshlet_triangles,
+            .transform_index = renderable.m_transform_index,
+            .meshlet_count = renderable.m_meshlet_count,
+            .bounding_offset = renderable.m_bounding_offset,
+            .vertex_offset = geometry.vertices.offset,
+            .meshlet_offset = geometry.meshlets.offset,
+            .meshlet_vertex_offset = geometry.meshlet_vertices.offset,
+            .meshlet_triangle_offset = geometry.meshlet_triangles.offset,
+        };
+    }
+
+    GeometryDrawPacket CreateGeometryPacket(const MeshRenderer& renderable, const PageDescriptors& page)
+    {
+        const auto& geometry = renderable.m_geometry;
+        return {
+            .shadow_sampler_index = 1,
+            .sampler_index = 2,
+            .position_buffer = page.positions,
+            .vertex_buffer = page.attributes,
+            .meshlet_buffer = page.meshlets,
+            .mesh_vertex_buffer = page.meshlet_vertices,
+            .mesh_triangle_buffer = page.meshlet_triangles,
+            .material_index = renderable.m_material_index,
+            .transform_index = renderable.m_transform_index,
+            .meshlet_count = renderable.m_meshlet_count,
+            .bounding_offset = renderable.m_bounding_offset,
+            .vertex_offset = geometry.vertices.offset,
+            .meshlet_offset = geometry.meshlets.offset,
+            .meshlet_vertex_offset = geometry.meshlet_vertices.offset,
+            .meshlet_triangle_offset = geometry.meshlet_triangles.offset,
+        };
+    }
+
+    // Per pass: recording the packed stream the renderer records now, gathering the cached packets of the visible
+    // renderables into that stream first, and rebuilding every visible renderable's push constants while recording the
+    // way the passes did before the packets were cached.
+    template <typename Packet, typename CreatePacket>
+    void MeasurePass(const std::string_view name,
+                     const std::vector<MeshRenderer>& renderables,
+                     const std::vector<PageDescriptors>& pages,
+                     const std::vector<uint32_t>& visible,
+                     CreatePacket&& create_packet)
+    {
+        std::vector<Packet> cache(renderables.size());
+        for (uint32_t i = 0; i < renderables.size(); ++i)
+        {
+            cache[i] = create_packet(renderables[i], pages[renderables[i].m_geometry.page]);
+        }
+        std::vector<Packet> stream(visible.size());
+        auto Gather = [&]
+        {
+            for (uint32_t i = 0; i < visible.size(); ++i)
+            {
+                stream[i] = cache[visible[i]];
+            }
+        };
+        Gather();
+        NullFrameStats stats;
+        const NullCommandRecorder recorder(stats);
+
+        const double packed_ms = MeasureMs([&] { RecordPackets<Packet>(recorder, stream); }, 20);
+        const double gathered_ms = MeasureMs(
+            [&]
+            {
+                Gather();
+                RecordPackets<Packet>(recorder, stream);
+            },
+            20);
+        const double rebuilt_ms = MeasureMs(
+            [&]
+            {
+                for (const uint32_t index : visible)
+                {
+                    const auto& renderable = renderables[index];
+                    Record(recorder, create_packet(renderable, pages[renderable.m_geometry.page]));
+                }
+            },
+            20);
+        std::println("{:<8} {:>3} B packets: {:>6.3f} ms packed stream, {:>6.3f} ms gathered from the cache, "
+                     "{:>6.3f} ms rebuilt per renderable ({:.1f}x)",
+                     name,
+                     sizeof(Packet),
+                     packed_ms,
+                     gathered_ms,
+                     rebuilt_ms,
+                     rebuilt_ms / gathered_ms);
+    }
+} // namespace
+
+// Recording 50k visible renderables into the null recorder, from the cached DepthDrawPacket and GeometryDrawPacket
+// arrays against building each push constant struct from its MeshRenderer and geometry page every frame. The visible
+// list is in a random order, as it is once the draw keys are sorted.
+BENCHMARK(DrawPacketRecording)
+{
+    constexpr uint32_t count = 50'000;
+    constexpr uint32_t page_count = 8;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> meshlets(1, 256);
+    std::uniform_int_distribution<uint32_t> page(0, page_count - 1);
+    std::uniform_int_distribution<int> material(0, 400);
+
+    std::vector<PageDescriptors> pages(page_count);
+    for (uint32_t i = 0; i < page_count; ++i)
+    {
+        const uint32_t base = 100 + i * 5;
+        pages[i] = { base, base + 1, base + 2, base + 3, base + 4 };
+    }
+    std::vector<MeshRenderer> renderables(count);
+    uint32_t bounding_offset = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t meshlet_count = meshlets(rng);
+        renderables[i] = {
+            .m_geometry = { .page = page(rng),
+                            .vertices = { .offset = i * 64 },
+                            .meshlets = { .offset = bounding_offset },
+                            .meshlet_vertices = { .offset = bounding_offset * 64 },
+                            .meshlet_triangles = { .offset = bounding_offset * 124 } },
+            .m_meshlet_count = meshlet_count,
+            .m_material_index = material(rng),
+            .m_transform_index = i,
+            .m_bounding_offset = bounding_offset,
+        };
+        bounding_offset += meshlet_count;
+    }
+    std::vector<uint32_t> visible(count);
+    std::iota(visible.begin(), visible.end(), 0u);
+    std::ranges::shuffle(visible, rng);
+
+    MeasurePass<DepthDrawPacket>("depth", renderables, pages, visible, CreateDepthPacket);
+    MeasurePass<GeometryDrawPacket>("geometry", renderables, pages, visible, CreateGeometryPacket);
+}
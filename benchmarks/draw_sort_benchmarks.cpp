@@ -0,0 +1,122 @@
+#include "benchmark.hpp"
+#include "draw_sort.hpp"
+
+// Sorting a frame's worth of draw keys with the radix sort against std::sort and std::stable_sort, for both orders.
+// Keys come from a few pipelines, a few hundred materials and spread out depths, like a large scene's geometry pass.
+BENCHMARK(DrawSort)
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> pipeline(0, 3);
+    std::uniform_int_distribution<uint32_t> material(0, 400);
+    std::uniform_real_distribution<float> depth(0.1f, 1000.f);
+    for (const uint32_t count : { 10'000u, 100'000u, 1'000'000u })
+    {
+        for (const DrawOrder order : { DrawOrder::eFrontToBack, DrawOrder::eMaterial })
+        {
+            std::vector<DrawSortItem> keys(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                keys[i] = { .key = DrawSorter::CreateKey(order,
+                                                         DrawPass::eGeometry,
+                                                         static_cast<uint8_t>(pipeline(rng)),
+                                                         static_cast<uint16_t>(material(rng)),
+                                                         depth(rng)),
+                            .index = i };
+            }
+
+            DrawSorter sorter;
+            std::vector<DrawSortItem> items;
+            auto Measure = [&](auto&& sort)
+            {
+                return MeasureMs(
+                    [&]
+                    {
+                        items = keys;
+                        sort(items);
+                    });
+            };
+            const double copy_ms = Measure([](auto&) {});
+            const double radix_ms = Measure([&](auto& values) { sorter.Sort(values); });
+            const double sort_ms = Measure([](auto& values) { std::ranges::sort(values, {}, &DrawSortItem::key); });
+            const double stable_ms =
+                Measure([](auto& values) { std::ranges::stable_sort(values, {}, &DrawSortItem::key); });
+            std::println("{:>8} draws, {:<13}: radix {:>7.3f} ms, std::sort {:>7.3f} ms ({:.1f}x), std::stable_sort "
+                         "{:>7.3f} ms ({:.1f}x)",
+                         count,
+                         order == DrawOrder::eFrontToBack ? "front to back" : "material",
+                         radix_ms - copy_ms,
+                         sort_ms - copy_ms,
+                         (sort_ms - copy_ms) / (radix_ms - copy_ms),
+                         stable_ms - copy_ms,
+                         (stable_ms - copy_ms) / (radix_ms - copy_ms));
+        }
+    }
+}
+
+// Building one pass's draw stream for a fixed scene of 200k renderables with 120k visible, on the caller alone and on
+// pools of every size up to the machine's thread count. Sorting front to back creates the keys and radix sorts them,
+// submission order only packs the packets. A tenth of the renderables have no meshlets and are filtered out.
+BENCHMARK(DrawStreamScaling)
+{
+    // Same size as the depth packets the renderer streams.
+    struct Packet
+    {
+        std::array<uint32_t, 5> descriptors;
+        uint32_t meshlet_count;
+        std::array<uint32_t, 6> offsets;
+    };
+
+    constexpr uint32_t count = 200'000;
+    constexpr uint32_t visible_count = 120'000;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> meshlets(0, 9);
+    std::uniform_int_distribution<uint16_t> material(0, 400);
+    std::uniform_real_distribution<float> position(-500.f, 500.f);
+    std::vector<Packet> packets(count);
+    std::vector<uint16_t> materials(count);
+    std::vector<glm::vec3> centers(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        packets[i] = { .descriptors = { 1, 2, 3, 4, 5 }, .meshlet_count = meshlets(rng), .offsets = { i } };
+        materials[i] = material(rng);
+        centers[i] = { position(rng), position(rng), position(rng) };
+    }
+    std::vector<uint32_t> visible(count);
+    std::iota(visible.begin(), visible.end(), 0u);
+    std::ranges::shuffle(visible, rng);
+    visible.resize(visible_count);
+    std::ranges::sort(visible);
+
+    // Pushed back so every depth is positive, as view depths are.
+    const glm::vec4 depth_plane(0.f, 0.f, -1.f, 1000.f);
+    auto CreateKey = [&](const uint32_t index)
+    {
+        return DrawSorter::CreateKey(DrawOrder::eFrontToBack,
+                                     DrawPass::eDepthPrepass,
+                                     0,
+                                     materials[index],
+                                     glm::dot(depth_plane, glm::vec4(centers[index], 1.f)));
+    };
+
+    DrawStream<Packet> stream;
+    for (const bool sort : { true, false })
+    {
+        JobSystem caller_only(0);
+        const double serial_ms =
+            MeasureMs([&] { stream.Build(caller_only, sort, visible, std::span<const Packet>(packets), CreateKey); });
+        std::println("{}: {:.3f} ms on the caller alone, {} packets",
+                     sort ? "front to back" : "submission",
+                     serial_ms,
+                     stream.packets.size());
+
+        const uint32_t max_threads = std::max(std::thread::hardware_concurrency(), 2u);
+        for (uint32_t threads = 1; threads <= max_threads; threads *= 2)
+        {
+            // The caller helps while it waits, so a pool of threads - 1 workers keeps threads busy.
+            JobSystem jobs(threads - 1);
+            const double parallel_ms =
+                MeasureMs([&] { stream.Build(jobs, sort, visible, std::span<const Packet>(packets), CreateKey); });
+            std::println("{:>3} threads: {:>7.3f} ms, {:.2f}x", threads, parallel_ms, serial_ms / parallel_ms);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include "benchmark.hpp"
+#include "frame_graph.hpp"
+#include "shadow_tile_cache.hpp"
+
+namespace
+{
+    struct FrameOptions
+    {
+        uint32_t shadow_renders = 0;
+        bool ssao = true;
+        bool bloom = true;
+        bool grass = false;
+        uint32_t blur_count = 10;
+    };
+
+    // The textures and passes Renderer::DeclareFrameGraph declares, in the same order. The record functions capture
+    // what the renderer's do and do nothing, so building them costs the same but Execute isn't measured.
+    void DeclareRendererFrame(FrameGraph& graph, const glm::uvec2 size, const FrameOptions& options)
+    {
+        graph.Reset();
+        const uint64_t pixels = static_cast<uint64_t>(size.x) * size.y;
+        constexpr uint64_t shadow_texels =
+            static_cast<uint64_t>(ShadowTileCache::ATLAS_WIDTH) * ShadowTileCache::ATLAS_HEIGHT;
+        const uint32_t shadow = graph.AddTexture("Shadow Atlas", shadow_texels * 4);
+        const uint32_t scene = graph.AddTexture("Scene", pixels * 8);
+        const uint32_t depth = graph.AddTexture("Depth", pixels * 4);
+        const uint32_t ssao_gen = graph.AddTexture("SSAO Gen", pixels);
+        const uint32_t ssao_blur = graph.AddTexture("SSAO Blur", pixels);
+        const std::array hdr = { graph.AddTexture("HDR Ping", pixels * 8), graph.AddTexture("HDR Pong", pixels * 8) };
+        graph.AddTexture("LDR Source", pixels * 4);
+        const uint32_t ldr_dst = graph.AddTexture("LDR Target", pixels * 4);
+        uint32_t hdr_dst = 0;
+        const auto swap_hdr = [&] { hdr_dst ^= 1; };
+        const void* renderer = &graph;
+
+        graph.AddPass("Clear Textures", [renderer] {}).Write(scene).Write(depth);
+        for (uint32_t i = 0; i < options.shadow_renders; ++i)
+        {
+            graph.AddPass("Shadow Pass", [renderer, i] {}).Modify(shadow);
+        }
+        graph.AddPass("Depth Prepass", [renderer] {}).Write(depth);
+        graph.AddPass("SSAO Gen Pass", [renderer] {}).Read(depth).Write(ssao_gen);
+        graph.AddPass("SSAO BlurPass", [renderer] {}).Read(ssao_gen).Write(ssao_blur);
+        graph.AddPass("GeometryPass", [renderer] {}).Read(shadow).Modify(scene).Modify(depth);
+        if (options.ssao)
+        {
+            graph.Read(ssao_blur);
+        }
+        if (options.grass)
+        {
+            graph.AddPass("Grass Pass", [renderer] {}).Modify(scene).Modify(depth);
+        }
+        graph.AddPass("Skybox Pass", [renderer] {}).Modify(scene).Modify(depth);
+        graph.AddPass("Bloom Extract Pass", [renderer] {}).Read(scene).Write(hdr[hdr_dst]);
+        for (uint32_t i = 0; i < options.blur_count; ++i)
+        {
+            swap_hdr();
+            graph.AddPass("Bloom Blur Pass", [renderer, i] {}).Read(hdr[hdr_dst ^ 1]).Write(hdr[hdr_dst]);
+        }
+        swap_hdr();
+        graph.AddPass("Bloom Combine Pass", [renderer] {}).Read(scene).Read(hdr[hdr_dst ^ 1]).Write(hdr[hdr_dst]);
+        if (options.bloom)
+        {
+            swap_hdr();
+        }
+        graph.AddPass("Fog Pass", [renderer] {})
+            .Read(options.bloom ? hdr[hdr_dst ^ 1] : scene)
+            .Read(depth)
+            .Read(shadow)
+            .Write(hdr[hdr_dst]);
+        swap_hdr();
+        graph.AddPass("Tonemap Pass", [renderer] {}).Read(hdr[hdr_dst ^ 1]).Write(ldr_dst);
+        graph.AddPass("Editor Viewport").Read(ldr_dst).SetOutput();
+    }
+} // namespace
+
+// Declaring and compiling the renderer's frame at 1080p, when nothing changed since the last frame and the cached
+// schedule is reused, and when the topology changes every frame and it is culled and planned again. The shadow tiles
+// redrawn each frame are what changes most often in practice, toggling SSAO and bloom changes what is culled.
+BENCHMARK(FrameGraph)
+{
+    const glm::uvec2 size(1920, 1080);
+    FrameGraph graph;
+    for (const uint32_t shadow_renders : { 0u, ShadowTileCache::MAX_RENDERS })
+    {
+        const FrameOptions options{ .shadow_renders = shadow_renders };
+        DeclareRendererFrame(graph, size, options);
+        graph.Compile();
+        const double hit_ms = MeasureMs(
+            [&]
+            {
+                DeclareRendererFrame(graph, size, options);
+                graph.Compile();
+            },
+            1000);
+        const uint32_t compiles = graph.GetStats().compiles;
+
+        // Alternates between two declarations, so the hash never matches the last compile.
+        uint32_t frame = 0;
+        const double shadows_ms = MeasureMs(
+            [&]
+            {
+                const uint32_t renders = shadow_renders + (++frame & 1);
+                DeclareRendererFrame(graph, size, { .shadow_renders = renders });
+                graph.Compile();
+            },
+            1000);
+        const double effects_ms = MeasureMs(
+            [&]
+            {
+                const bool enabled = ++frame & 1;
+                const FrameOptions toggled{ .shadow_renders = shadow_renders, .ssao = enabled, .bloom = enabled };
+                DeclareRendererFrame(graph, size, toggled);
+                graph.Compile();
+            },
+            1000);
+        std::println("{:>2} shadow tiles, {:>2} passes: {:>6.2f} us cache hit, {:>6.2f} us recompiling for shadow "
+                     "tiles, {:>6.2f} us recompiling for effects, {} compiles",
+                     shadow_renders,
+                     graph.GetStats().declared_passes,
+                     hit_ms * 1000.0,
+                     shadows_ms * 1000.0,
+                     effects_ms * 1000.0,
+                     graph.GetStats().compiles - compiles);
+    }
+}
@@ -0,0 +1,72 @@
+#include "benchmark.hpp"
+#include "grass_scatter.hpp"
+#include "resources.hpp"
+
+namespace
+{
+    // Clumps from a few crossing waves, so the density map thins the grass out the way a painted one would.
+    GrassDensityMap CreateWaveDensity(const GrassSurface& surface)
+    {
+        constexpr uint32_t size = 64;
+        GrassDensityMap density{ .min = surface.GetMin(), .max = surface.GetMax(), .width = size, .height = size };
+        density.values.resize(size * size);
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                const float wave = std::sin(x * 0.37f) * std::cos(y * 0.29f) + 0.5f * std::sin((x + y) * 0.11f);
+                density.values[y * size + x] = glm::smoothstep(-0.3f, 0.6f, wave);
+            }
+        }
+        return density;
+    }
+} // namespace
+
+// Grass scattered over the cathedral at a few spacings, on every thread and on the caller alone, with the wave
+// density map and with none. Patches per second is what the grass pass streams from, so it is reported next to the
+// time.
+BENCHMARK(GrassScatter)
+{
+    GrassSurface surface;
+    for (const auto& mesh : Resources::LoadGeometry(GetAssetRoot() / "cathedral" / "cathedral.gltf"))
+    {
+        for (const auto& transform : mesh.instances)
+        {
+            surface.AddMesh(mesh.positions, mesh.indices, transform);
+        }
+    }
+    const double surface_ms = MeasureMs([&] { surface.Build(0.25f); });
+    std::println("surface: {} triangles, {:.2f} ms to build", surface.GetTriangleCount(), surface_ms);
+
+    const uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+    JobSystem jobs(threads - 1);
+    JobSystem caller_only(0);
+    GrassScatter scatter;
+    std::vector<GrassPatch> patches;
+    const GrassDensityMap waves = CreateWaveDensity(surface);
+    const GrassDensityMap full;
+    for (const auto& [name, density] : { std::pair{ "waves", &waves }, std::pair{ "full", &full } })
+    {
+        for (const float spacing : { 0.8f, 0.4f, 0.2f })
+        {
+            const GrassScatterSettings settings{ .seed = 1, .spacing = spacing };
+            const double parallel_ms = MeasureMs([&] { scatter.Generate(jobs, surface, *density, settings, patches); });
+            const double serial_ms =
+                MeasureMs([&] { scatter.Generate(caller_only, surface, *density, settings, patches); });
+            const auto& stats = scatter.GetStats();
+            const double patches_per_second = static_cast<double>(stats.patches) / (parallel_ms / 1000.0);
+            std::println("{:>5} spacing {:.1f}: {:>8} patches of {:>8} candidates in {:>4} tiles, {:>8.2f} ms on {} "
+                         "threads ({:>9.0f} patches/s), {:>8.2f} ms on one ({:.1f}x)",
+                         name,
+                         spacing,
+                         stats.patches,
+                         stats.candidates,
+                         stats.tiles,
+                         parallel_ms,
+                         threads,
+                         patches_per_second,
+                         serial_ms,
+                         serial_ms / parallel_ms);
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#include "benchmark.hpp"
+#include "job_system.hpp"
+
+namespace
+{
+    // A fixed amount of arithmetic per item that the optimizer can't drop, a few dozen nanoseconds per item.
+    float Work(const uint32_t begin, const uint32_t end)
+    {
+        float sum = 0.f;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            float x = static_cast<float>(i);
+            for (uint32_t j = 0; j < 16; ++j)
+            {
+                x = std::sqrt(x * 1.0001f + 1.f);
+            }
+            sum += x;
+        }
+        return sum;
+    }
+} // namespace
+
+// ParallelFor speedup over running on the caller alone for each pool size up to the machine's thread count, and the
+// cost of scheduling empty jobs from outside the pool and from inside it.
+BENCHMARK(JobSystemScaling)
+{
+    constexpr uint32_t count = 1 << 20;
+    std::atomic<float> sink = 0.f;
+    const double serial_ms = MeasureMs([&] { sink = Work(0, count); });
+    std::println("serial: {:.2f} ms for {} items", serial_ms, count);
+
+    const uint32_t max_threads = std::max(std::thread::hardware_concurrency(), 2u);
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        // The caller helps while it waits, so a pool of threads - 1 workers keeps threads busy.
+        JobSystem jobs(threads - 1);
+        for (const uint32_t batch_size : { 256u, 4096u })
+        {
+            const double parallel_ms = MeasureMs(
+                [&]
+                {
+                    jobs.ParallelFor(count,
+                                     batch_size,
+                                     [&](const uint32_t begin, const uint32_t end)
+                                     {
+                                         const float sum = Work(begin, end);
+                                         sink.fetch_add(sum, std::memory_order_relaxed);
+                                     });
+                });
+            std::println("{:>3} threads, batches of {:>4}: {:>8.2f} ms, {:.2f}x",
+                         threads,
+                         batch_size,
+                         parallel_ms,
+                         serial_ms / parallel_ms);
+        }
+
+        constexpr uint32_t empty_jobs = 100'000;
+        const double external_ms = MeasureMs(
+            [&]
+            {
+                JobCounter counter;
+                for (uint32_t i = 0; i < empty_jobs; ++i)
+                {
+                    jobs.Schedule([] {}, &counter);
+                }
+                jobs.Wait(counter);
+            });
+        // Fanned out from a job, so the pushes land on a worker's own deque and the others steal from it.
+        const double nested_ms = MeasureMs(
+            [&]
+            {
+                JobCounter outer;
+                jobs.Schedule(
+                    [&]
+                    {
+                        JobCounter counter;
+                        for (uint32_t i = 0; i < empty_jobs; ++i)
+                        {
+                            jobs.Schedule([] {}, &counter);
+                        }
+                        jobs.Wait(counter);
+                    },
+                    &outer);
+                jobs.Wait(outer);
+            });
+        std::println("{:>3} threads, empty jobs: {:.0f} ns each from outside, {:.0f} ns each from a worker",
+                     threads,
+                     external_ms * 1e6 / empty_jobs,
+                     nested_ms * 1e6 / empty_jobs);
+    }
+}
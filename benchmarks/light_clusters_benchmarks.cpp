@@ -0,0 +1,55 @@
+#include "benchmark.hpp"
+#include "light_clusters.hpp"
+
+namespace
+{
+    // Point lights of 8 m range scattered through the cathedral, the way the game scattered them to profile culling.
+    std::vector<BoundingSphere> ScatterLights(const uint32_t count)
+    {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> ground(-40.f, 40.f);
+        std::uniform_real_distribution<float> height(0.5f, 15.f);
+        std::vector<BoundingSphere> lights(count);
+        for (auto& light : lights)
+        {
+            light = { .center = { ground(rng), height(rng), ground(rng) }, .radius = 8.f };
+        }
+        return lights;
+    }
+} // namespace
+
+// Binning 1k to 10k lights into the cluster grid from inside the cathedral, on every thread, on the caller alone, and
+// the one light and one cluster at a time reference.
+BENCHMARK(LightClusters)
+{
+    Camera camera(nullptr);
+    camera.m_near_plane = 0.1f;
+    camera.m_far_plane = 1000.f;
+    camera.m_view_matrix = glm::lookAt(glm::vec3(0.f, 2.f, 35.f), glm::vec3(0.f, 5.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+    camera.m_proj_matrix =
+        glm::perspective(camera.m_fov, camera.m_aspect_ratio, camera.m_near_plane, camera.m_far_plane);
+
+    const uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+    JobSystem jobs(threads - 1);
+    JobSystem caller_only(0);
+    LightClusterGrid grid;
+    for (const uint32_t count : { 1'000u, 2'500u, 5'000u, 10'000u })
+    {
+        const auto lights = ScatterLights(count);
+        const double parallel_ms = MeasureMs([&] { grid.Build(jobs, camera, lights); });
+        const double serial_ms = MeasureMs([&] { grid.Build(caller_only, camera, lights); });
+        const auto stats = grid.GetStats();
+        const double reference_ms = MeasureMs([&] { grid.BuildReference(camera, lights); });
+        std::println("{:>6} lights: {:>7.3f} ms on {} threads, {:>7.3f} ms on one ({:.1f}x), reference {:>8.2f} ms "
+                     "({:.0f}x), {} indices, {} in the fullest cluster",
+                     count,
+                     parallel_ms,
+                     threads,
+                     serial_ms,
+                     serial_ms / parallel_ms,
+                     reference_ms,
+                     reference_ms / parallel_ms,
+                     stats.indices,
+                     stats.max_cluster_lights);
+    }
+}
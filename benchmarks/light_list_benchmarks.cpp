@@ -0,0 +1,62 @@
+#include "benchmark.hpp"
+#include "light_list.hpp"
+
+// Thousands of point lights bobbing around where they were placed, every one updated every frame the way the game
+// animated its scattered lights. Per frame: the updates, taking the changes under the renderer's default budget and
+// with no budget, and applying them to the upload copy, plus how many lights went out and how many are left waiting.
+BENCHMARK(LightListAnimation)
+{
+    for (const uint32_t count : { 1'000u, 5'000u, 10'000u, 50'000u })
+    {
+        for (const uint32_t budget : { 1024u, std::numeric_limits<uint32_t>::max() })
+        {
+            std::mt19937 rng(1);
+            std::uniform_real_distribution<float> ground(-40.f, 40.f);
+            std::uniform_real_distribution<float> height(0.5f, 15.f);
+            LightList<PointLight> list;
+            std::vector<PointLightHandle> handles;
+            std::vector<glm::vec3> origins;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                origins.push_back({ ground(rng), height(rng), ground(rng) });
+                handles.push_back(list.Add({ .position = origins.back(), .intensity = 20.f, .range = 8.f }));
+            }
+            LightChanges<PointLight> changes;
+            std::vector<PointLight> copy;
+            DirtyRanges dirty;
+            list.TakeChanges(budget, changes);
+            changes.Apply(copy, dirty);
+
+            float time = 0.f;
+            uint64_t sent = 0;
+            uint32_t frames = 0;
+            const double frame_ms = MeasureMs(
+                [&]
+                {
+                    time += 1.f / 60.f;
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        auto light = *list.Get(handles[i]);
+                        const float phase = time + static_cast<float>(i) * 0.37f;
+                        light.position =
+                            origins[i] + glm::vec3(std::sin(phase), 0.5f * std::sin(phase * 1.7f), std::cos(phase));
+                        list.Update(handles[i], light);
+                    }
+                    list.TakeChanges(budget, changes);
+                    changes.Apply(copy, dirty);
+                    dirty.Flush([](uint32_t, uint32_t) {});
+                    sent += changes.values.size();
+                    ++frames;
+                },
+                60);
+            const bool unlimited = budget == std::numeric_limits<uint32_t>::max();
+            std::println("{:>6} lights, budget {:>5}: {:>7.3f} ms per frame, {:>6} lights sent per frame, "
+                         "{:>6} waiting",
+                         count,
+                         unlimited ? "none" : std::to_string(budget),
+                         frame_ms,
+                         sent / frames,
+                         list.GetPendingCount());
+        }
+    }
+}
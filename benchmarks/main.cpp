@@ -0,0 +1,22 @@
+#include "benchmark.hpp"
+
+std::vector<Benchmark>& GetBenchmarks()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+void DoNotOptimize(const void*) {}
+
+// Pass part of a benchmark's name to run only the benchmarks matching it, e.g. EngineBenchmarks Meshlet.
+int main(const int argc, char** argv)
+{
+    const std::string_view filter = argc > 1 ? argv[1] : "";
+    for (const auto& benchmark : GetBenchmarks())
+    {
+        if (!benchmark.name.contains(filter)) continue;
+
+        std::println("== {}", benchmark.name);
+        benchmark.function();
+    }
+}
@@ -0,0 +1,14 @@
+#include "benchmark.hpp"
+#include "meshlet_tuner.hpp"
+
+// Sweeps the default meshlet budgets over every asset, the numbers the budgets in resources.hpp are picked from.
+BENCHMARK(MeshletSweep)
+{
+    JobSystem job_system;
+    const auto configs = MeshletTuner::DefaultConfigs();
+    const auto start = std::chrono::high_resolution_clock::now();
+    const auto stats = MeshletTuner::Sweep(job_system, GetAssetRoot(), configs);
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    MeshletTuner::Print(stats);
+    std::println("{} configs in {:.1f} ms on {} workers", configs.size(), elapsed.count(), job_system.GetWorkerCount());
+}
@@ -0,0 +1,121 @@
+#include "benchmark.hpp"
+#include "culling.hpp"
+#include "occlusion.hpp"
+
+namespace
+{
+    struct CameraPath
+    {
+        std::string_view name;
+        std::function<std::pair<glm::vec3, glm::vec3>(float)> eye_and_target;
+    };
+} // namespace
+
+// Frustum then occlusion culls the cathedral from cameras moving along a few fixed paths, the same steps and camera
+// projection the renderer uses, and reports how much of what survives the frustum the occluders hide.
+BENCHMARK(OcclusionCameraPaths)
+{
+    JobSystem job_system;
+    const auto geometry = Resources::LoadGeometry(GetAssetRoot() / "cathedral" / "cathedral.gltf");
+
+    std::vector<Occluder> occluders;
+    std::vector<std::pair<uint32_t, glm::mat4>> occluder_placements;
+    std::vector<Bounds> bounds;
+    for (const auto& mesh : geometry)
+    {
+        const Bounds local = Bounds::FromPoints(mesh.positions);
+        auto occluder = mesh.opaque ? Resources::BuildOccluder(mesh.positions, mesh.indices, local) : std::nullopt;
+        if (occluder)
+        {
+            occluders.push_back(std::move(*occluder));
+        }
+        for (const auto& transform : mesh.instances)
+        {
+            bounds.push_back(local.Transform(transform));
+            if (occluder)
+            {
+                occluder_placements.emplace_back(static_cast<uint32_t>(occluders.size()) - 1, transform);
+            }
+        }
+    }
+    std::vector<OccluderInstance> instances;
+    for (const auto& [index, transform] : occluder_placements)
+    {
+        instances.push_back({ .occluder = &occluders[index], .transform = transform });
+    }
+
+    FrustumCuller frustum_culler;
+    frustum_culler.Resize(static_cast<uint32_t>(bounds.size()));
+    BoundingBox scene;
+    for (uint32_t i = 0; i < bounds.size(); ++i)
+    {
+        frustum_culler.SetBounds(i, bounds[i]);
+        scene.Expand(bounds[i].box);
+    }
+    std::println("{} renderables, {} occluder instances", bounds.size(), instances.size());
+    if (!scene.IsValid()) return;
+
+    const glm::vec3 center = scene.GetCenter();
+    const glm::vec3 extents = scene.GetExtents();
+    const bool long_x = extents.x >= extents.z;
+    const glm::vec3 long_axis = long_x ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 0.f, 1.f);
+    const float length = long_x ? extents.x : extents.z;
+    const float eye_height = scene.min.y + 1.7f;
+    const std::array paths{
+        CameraPath{ "Nave walk",
+                    [&](const float t)
+                    {
+                        const glm::vec3 eye = center + long_axis * glm::mix(-0.8f, 0.8f, t) * length;
+                        return std::pair{ glm::vec3(eye.x, eye_height, eye.z), glm::vec3(eye.x, eye_height, eye.z) + long_axis };
+                    } },
+        CameraPath{ "Inside turn",
+                    [&](const float t)
+                    {
+                        const float angle = t * glm::two_pi<float>();
+                        const glm::vec3 eye(center.x, eye_height, center.z);
+                        return std::pair{ eye, eye + glm::vec3(std::cos(angle), 0.f, std::sin(angle)) };
+                    } },
+        CameraPath{ "Outside orbit",
+                    [&](const float t)
+                    {
+                        const float angle = t * glm::two_pi<float>();
+                        const float radius = glm::length(extents) * 1.5f;
+                        return std::pair{ center + glm::vec3(std::cos(angle), 0.3f, std::sin(angle)) * radius, center };
+                    } },
+    };
+
+    constexpr uint32_t frames = 120;
+    const glm::mat4 proj = glm::perspective(glm::radians(90.f), 16.f / 9.f, 0.01f, 1000.f);
+    OcclusionCuller occlusion_culler;
+    std::vector<uint32_t> visible;
+    for (const auto& [name, eye_and_target] : paths)
+    {
+        uint64_t frustum_visible = 0;
+        uint64_t occluded = 0;
+        std::chrono::duration<double, std::milli> raster_time{};
+        std::chrono::duration<double, std::milli> test_time{};
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            const auto [eye, target] = eye_and_target(static_cast<float>(frame) / frames);
+            const glm::mat4 view_proj = proj * glm::lookAt(eye, target, glm::vec3(0.f, 1.f, 0.f));
+            visible.clear();
+            frustum_culler.Cull(Camera::CreateFrustum(view_proj), visible);
+            frustum_visible += visible.size();
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            occlusion_culler.Render(job_system, view_proj, instances);
+            const auto rasterized = std::chrono::high_resolution_clock::now();
+            occlusion_culler.Cull(bounds, visible);
+            raster_time += rasterized - start;
+            test_time += std::chrono::high_resolution_clock::now() - rasterized;
+            occluded += occlusion_culler.GetStats().occluded;
+        }
+        std::println("{:<14} {:>7.1f} in frustum, {:>7.1f} occluded ({:>5.1f}%), {:.3f} ms raster, {:.3f} ms test per frame",
+                     name,
+                     static_cast<double>(frustum_visible) / frames,
+                     static_cast<double>(occluded) / frames,
+                     frustum_visible ? 100.0 * static_cast<double>(occluded) / static_cast<double>(frustum_visible) : 0.0,
+                     raster_time.count() / frames,
+                     test_time.count() / frames);
+    }
+}
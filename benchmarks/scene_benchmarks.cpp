@@ -0,0 +1,158 @@
+#include "benchmark.hpp"
+#include "scene.hpp"
+
+namespace
+{
+    // The actor the scene used to store, one heap allocation each behind a shared_ptr. Update builds its world matrix
+    // from its own transform and its parent's, the same work Scene::Update does per actor.
+    class LegacyActor
+    {
+    public:
+        void Update(float)
+        {
+            m_world = m_parent ? m_parent->m_world * m_transform.ToMatrix() : m_transform.ToMatrix();
+        }
+
+        Transform m_transform;
+        glm::mat4 m_world = glm::mat4(1.f);
+        LegacyActor* m_parent = nullptr;
+        std::string m_name;
+        uint32_t m_instance_offset = 0;
+        uint32_t m_instance_size = 0;
+    };
+
+    // The old Scene::Update: every actor every tick, copying each shared_ptr out of the vector.
+    void UpdateLegacy(const std::vector<std::shared_ptr<LegacyActor>>& actors, const float dt)
+    {
+        for (const auto actor : actors)
+        {
+            actor->Update(dt);
+        }
+    }
+} // namespace
+
+// Scene::Update over groups of a root and nine children, with every root moving and with one in a hundred moving,
+// against the std::vector<std::shared_ptr<Actor>> layout it replaced. The actors have no renderables, so this is the
+// hierarchy walk and matrix work alone.
+BENCHMARK(SceneUpdate)
+{
+    for (const uint32_t count : { 10'000u, 100'000u, 1'000'000u })
+    {
+        Scene scene(nullptr);
+        std::vector<ActorHandle> roots;
+        roots.reserve(count / 10);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto actor = scene.CreateActor();
+            const float offset = static_cast<float>(i % 10);
+            scene.SetTransform(actor, { .position = glm::vec3(offset, 0.f, 0.f), .rotation = glm::vec3(0.f, offset, 0.f) });
+            if (i % 10 == 0)
+            {
+                roots.push_back(actor);
+            }
+            else
+            {
+                scene.SetParent(actor, roots.back());
+            }
+        }
+        scene.Update();
+
+        uint32_t tick = 0;
+        auto MoveRoots = [&](const uint32_t stride)
+        {
+            const float time = static_cast<float>(++tick) / 60.f;
+            for (uint32_t i = tick % stride; i < roots.size(); i += stride)
+            {
+                scene.SetTransform(roots[i], { .position = glm::vec3(static_cast<float>(i), std::sin(time), 0.f) });
+            }
+            scene.Update();
+        };
+        const double all_ms = MeasureMs([&] { MoveRoots(1); });
+        const double some_ms = MeasureMs([&] { MoveRoots(100); });
+        const double idle_ms = MeasureMs([&] { scene.Update(); });
+
+        // The old layout has no dirty tracking, so moving all or some of the roots costs the same full pass.
+        std::vector<std::shared_ptr<LegacyActor>> legacy;
+        legacy.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            auto& actor = legacy.emplace_back(std::make_shared<LegacyActor>());
+            const float offset = static_cast<float>(i % 10);
+            actor->m_transform = { .position = glm::vec3(offset, 0.f, 0.f), .rotation = glm::vec3(0.f, offset, 0.f) };
+            if (i % 10 != 0)
+            {
+                actor->m_parent = legacy[i - i % 10].get();
+            }
+        }
+        const double legacy_ms = MeasureMs(
+            [&]
+            {
+                const float time = static_cast<float>(++tick) / 60.f;
+                for (uint32_t i = 0; i < count; i += 10)
+                {
+                    legacy[i]->m_transform.position = glm::vec3(static_cast<float>(i), std::sin(time), 0.f);
+                }
+                UpdateLegacy(legacy, 1.f / 60.f);
+            });
+        std::println("{:>9} actors: {:>8.3f} ms all moving, {:>8.3f} ms 1% moving, {:>8.3f} ms idle, "
+                     "{:>8.3f} ms shared_ptr actors ({:.1f}x)",
+                     count,
+                     all_ms,
+                     some_ms,
+                     idle_ms,
+                     legacy_ms,
+                     legacy_ms / all_ms);
+    }
+}
+
+// 100k flat actors all moving every tick, against the one ToMatrix and one product per actor the scene used to run.
+BENCHMARK(SceneMovingTransforms)
+{
+    constexpr uint32_t count = 100'000;
+    Scene scene(nullptr);
+    std::vector<ActorHandle> actors(count);
+    for (auto& actor : actors)
+    {
+        actor = scene.CreateActor();
+    }
+
+    uint32_t tick = 0;
+    auto Move = [&](const uint32_t i)
+    {
+        const float time = static_cast<float>(tick) / 60.f + static_cast<float>(i);
+        return Transform{ .position = glm::vec3(static_cast<float>(i), std::sin(time), 0.f),
+                          .rotation = glm::vec3(0.f, time, time * 0.5f) };
+    };
+    const double batched_ms = MeasureMs(
+        [&]
+        {
+            ++tick;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                scene.SetTransform(actors[i], Move(i));
+            }
+            scene.Update();
+        });
+
+    std::vector<Transform> transforms(count);
+    std::vector<glm::mat4> matrices(count);
+    const glm::mat4 parent(1.f);
+    const double scalar_ms = MeasureMs(
+        [&]
+        {
+            ++tick;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                transforms[i] = Move(i);
+            }
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                matrices[i] = parent * transforms[i].ToMatrix();
+            }
+        });
+    std::println("{} moving transforms: {:.3f} ms per tick batched, {:.3f} ms one at a time, {:.1f}M transforms/s",
+                 count,
+                 batched_ms,
+                 scalar_ms,
+                 count / batched_ms / 1000.0);
+}
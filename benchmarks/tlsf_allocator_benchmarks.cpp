@@ -0,0 +1,138 @@
+#include "benchmark.hpp"
+#include "tlsf_allocator.hpp"
+
+namespace
+{
+    // First fit over a list of free blocks sorted by offset, merged on free. What a geometry page would use without
+    // the bins.
+    class FirstFitAllocator
+    {
+    public:
+        explicit FirstFitAllocator(const uint32_t size) : m_free{ { .offset = 0, .size = size } } {}
+
+        std::optional<TlsfAllocation> Allocate(const uint32_t size)
+        {
+            const auto it = std::ranges::find_if(m_free, [&](const FreeBlock& block) { return block.size >= size; });
+            if (it == m_free.end()) return std::nullopt;
+
+            const uint32_t offset = it->offset;
+            if (it->size > size)
+            {
+                it->offset += size;
+                it->size -= size;
+            }
+            else
+            {
+                m_free.erase(it);
+            }
+            return TlsfAllocation{ .offset = offset, .size = size, .block = 0 };
+        }
+
+        void Free(const TlsfAllocation& allocation)
+        {
+            auto it = std::ranges::lower_bound(m_free, allocation.offset, {}, &FreeBlock::offset);
+            it = m_free.insert(it, { .offset = allocation.offset, .size = allocation.size });
+            if (const auto next = std::next(it); next != m_free.end() && it->offset + it->size == next->offset)
+            {
+                it->size += next->size;
+                m_free.erase(next);
+            }
+            if (it != m_free.begin())
+            {
+                if (const auto prev = std::prev(it); prev->offset + prev->size == it->offset)
+                {
+                    prev->size += it->size;
+                    m_free.erase(it);
+                }
+            }
+        }
+
+    private:
+        struct FreeBlock
+        {
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        std::vector<FreeBlock> m_free;
+    };
+
+    struct ChurnResult
+    {
+        double ns_per_pair;
+        uint32_t failures;
+    };
+
+    // Fills the allocator to about three quarters and then frees a random allocation and makes a new one, over and
+    // over, so the free space is cut up the way streaming meshes in and out of a page cuts it up.
+    template <typename Allocator>
+    ChurnResult Churn(Allocator& allocator, const uint32_t size, const uint32_t pairs)
+    {
+        std::mt19937 rng(9);
+        // Log uniform from 16 to 16k elements, many small meshes and a few large ones.
+        std::uniform_real_distribution<float> log_size(4.f, 14.f);
+        auto RandomSize = [&] { return static_cast<uint32_t>(std::exp2(log_size(rng))); };
+
+        std::vector<TlsfAllocation> live;
+        uint64_t live_size = 0;
+        while (live_size < size / 4 * 3)
+        {
+            const auto allocation = allocator.Allocate(RandomSize());
+            if (!allocation) break;
+            live.push_back(*allocation);
+            live_size += allocation->size;
+        }
+
+        std::vector<uint32_t> frees(pairs);
+        std::vector<uint32_t> sizes(pairs);
+        for (uint32_t i = 0; i < pairs; ++i)
+        {
+            frees[i] = rng();
+            sizes[i] = RandomSize();
+        }
+        uint32_t failures = 0;
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < pairs; ++i)
+        {
+            const uint32_t index = frees[i] % static_cast<uint32_t>(live.size());
+            allocator.Free(live[index]);
+            if (const auto allocation = allocator.Allocate(sizes[i]))
+            {
+                live[index] = *allocation;
+            }
+            else
+            {
+                ++failures;
+                live[index] = live.back();
+                live.pop_back();
+            }
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return { .ns_per_pair = elapsed.count() / pairs, .failures = failures };
+    }
+} // namespace
+
+// A free and an allocation at a time against a three quarters full allocator, TLSF against a first fit free list, and
+// how cut up TLSF leaves the free space: the share of it outside the largest free block.
+BENCHMARK(TlsfFragmentation)
+{
+    constexpr uint32_t pairs = 200'000;
+    for (const uint32_t size : { 1u << 20, 1u << 22, 1u << 24 })
+    {
+        TlsfAllocator tlsf(size);
+        const auto tlsf_result = Churn(tlsf, size, pairs);
+        FirstFitAllocator first_fit(size);
+        const auto first_fit_result = Churn(first_fit, size, pairs);
+        const double fragmentation =
+            1.0 - static_cast<double>(tlsf.GetLargestFreeBlock()) / std::max(tlsf.GetFreeSize(), 1u);
+        std::println("{:>9} elements: tlsf {:>7.1f} ns per free and allocate ({} failed), first fit {:>8.1f} ns ({} "
+                     "failed), {:.1f}% of {} free elements outside the largest block",
+                     size,
+                     tlsf_result.ns_per_pair,
+                     tlsf_result.failures,
+                     first_fit_result.ns_per_pair,
+                     first_fit_result.failures,
+                     fragmentation * 100.0,
+                     tlsf.GetFreeSize());
+    }
+}
@@ -1,32 +1,58 @@
 #pragma once
-#include "resources.hpp"
+#include "bounds.hpp"
+
+struct Model;
+class Engine;
 
 struct Transform
 {
     glm::vec3 position = glm::vec3(0.0f);
     glm::vec3 rotation = glm::vec3(0.0f);
     glm::vec3 scale = glm::vec3(1.0f);
-    glm::mat4 transform = glm::mat4(1.0f);
+
+    [[nodiscard]] glm::mat4 ToMatrix() const;
 };
 
-class Engine;
+// Refers to a slot in the Scene, the generation changes when the slot is reused so stale handles stop resolving.
+struct ActorHandle
+{
+    uint32_t index = std::numeric_limits<uint32_t>::max();
+    uint32_t generation = 0;
+
+    bool operator==(const ActorHandle&) const = default;
+};
+
+struct RenderableRange
+{
+    uint32_t offset = 0;
+    uint32_t size = 0;
+
+    [[nodiscard]] bool Contains(const uint32_t index) const { return index >= offset && index < offset + size; }
+};
 
+// Lightweight view of an actor's components in the Scene, cheap to copy and safe to hold across frames.
 class Actor
 {
 public:
-    Actor(Engine* engine) : m_engine(engine) {}
-    ~Actor() {}
-    void Update(float dt) {}
-    void AddModel(Model& model);
-    [[nodiscard]] Transform GetTransform() const { return m_transform; }
-    [[nodiscard]] glm::vec3 GetPosition() const { return m_transform.position; }
-    [[nodiscard]] glm::vec3 GetRotation() const { return m_transform.rotation; }
-    [[nodiscard]] glm::vec3 GetScale() const { return m_transform.scale; }
+    Actor(Engine* engine, const ActorHandle handle) : m_engine(engine), m_handle(handle) {}
+    void AddModel(Model& model) const;
+    [[nodiscard]] ActorHandle GetHandle() const { return m_handle; }
+    [[nodiscard]] bool IsValid() const;
+    [[nodiscard]] const std::string& GetName() const;
+    [[nodiscard]] Transform GetTransform() const;
+    [[nodiscard]] glm::vec3 GetPosition() const { return GetTransform().position; }
+    [[nodiscard]] glm::vec3 GetRotation() const { return GetTransform().rotation; }
+    [[nodiscard]] glm::vec3 GetScale() const { return GetTransform().scale; }
+    [[nodiscard]] glm::mat4 GetWorldMatrix() const;
+    void SetTransform(const Transform& transform) const;
+    void SetPosition(glm::vec3 position) const;
+    void SetRotation(glm::vec3 rotation) const;
+    void SetScale(glm::vec3 scale) const;
+    void SetParent(ActorHandle parent) const;
+    [[nodiscard]] Bounds GetBounds() const;
+    [[nodiscard]] bool OwnsRenderable(uint32_t index) const;
 
 private:
-    Transform m_transform;
-    std::string m_name;
-    uint32_t m_instance_offset;
-    uint32_t m_instance_size;
     Engine* m_engine;
+    ActorHandle m_handle;
 };
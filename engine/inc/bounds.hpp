@@ -0,0 +1,50 @@
+#pragma once
+
+struct Ray
+{
+    glm::vec3 origin{};
+    glm::vec3 direction = glm::vec3(0.f, 0.f, -1.f);
+
+    // Distance along the ray to a two sided triangle, in units of direction.
+    [[nodiscard]] std::optional<float> Intersect(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) const;
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center{};
+    float radius = 0.f;
+};
+
+struct BoundingBox
+{
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    [[nodiscard]] bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    [[nodiscard]] glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+    [[nodiscard]] glm::vec3 GetExtents() const { return (max - min) * 0.5f; }
+
+    void Expand(const glm::vec3& point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void Expand(const BoundingBox& box)
+    {
+        min = glm::min(min, box.min);
+        max = glm::max(max, box.max);
+    }
+
+    [[nodiscard]] BoundingBox Transform(const glm::mat4& transform) const;
+};
+
+struct Bounds
+{
+    BoundingBox box;
+    BoundingSphere sphere;
+
+    static Bounds FromPoints(std::span<const glm::vec3> points);
+    static Bounds Merge(const Bounds& a, const Bounds& b);
+    [[nodiscard]] Bounds Transform(const glm::mat4& transform) const;
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include "culling.hpp"
+
+struct RayHit
+{
+    uint32_t index;
+    float distance;
+};
+
+// Exact test of one object against the ray, returns the hit distance if it is closer than max_distance.
+using RayIntersector = std::function<std::optional<float>(uint32_t index, const Ray& ray, float max_distance)>;
+
+// Binned SAH tree over object bounds. Moving objects are refit in place, and once refitting has let the tree degrade
+// past REBUILD_THRESHOLD a fresh tree is built on a background thread and swapped in when ready.
+class Bvh
+{
+public:
+    static constexpr uint32_t MAX_LEAF_SIZE = 8;
+    static constexpr uint32_t BIN_COUNT = 16;
+    static constexpr float REBUILD_THRESHOLD = 1.5f;
+
+    ~Bvh();
+
+    void Build(std::span<const Bounds> bounds);
+    // Adds objects after the existing ones without re-partitioning them, they get their own subtree under a new root.
+    void Insert(std::span<const Bounds> bounds);
+    void Update(uint32_t index, const Bounds& bounds);
+    // Applies pending updates and swaps in a finished background rebuild, call once before querying each frame.
+    void Refit();
+
+    [[nodiscard]] uint32_t GetCount() const { return static_cast<uint32_t>(m_bounds.size()); }
+    [[nodiscard]] uint32_t GetNodeCount() const { return static_cast<uint32_t>(m_tree.nodes.size()); }
+    [[nodiscard]] float GetCost() const { return m_cost; }
+    [[nodiscard]] float GetBuildCost() const { return m_tree.cost; }
+    [[nodiscard]] bool IsRebuilding() const { return m_rebuild.valid(); }
+    // Box around every object as of the last Refit.
+    [[nodiscard]] BoundingBox GetBounds() const { return m_tree.nodes.empty() ? BoundingBox{} : m_tree.nodes[0].box; }
+
+    // Batched queries walk the tree once for every query in the batch, results are in tree order.
+    void QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& results) const;
+    void QueryFrustums(std::span<const Frustum> frustums, std::span<std::vector<uint32_t>> results) const;
+    void QuerySphere(const BoundingSphere& sphere, std::vector<uint32_t>& results) const;
+    void QuerySpheres(std::span<const BoundingSphere> spheres, std::span<std::vector<uint32_t>> results) const;
+    void QueryBox(const BoundingBox& box, std::vector<uint32_t>& results) const;
+    void QueryBoxes(std::span<const BoundingBox> boxes, std::span<std::vector<uint32_t>> results) const;
+    // Objects whose box is hit are handed to intersect when given. Without it a hit is decided on the box alone,
+    // and boxes around the ray origin are skipped since the ray starts inside them.
+    [[nodiscard]] std::optional<RayHit> Raycast(const Ray& ray,
+                                                float max_distance = std::numeric_limits<float>::max(),
+                                                const RayIntersector& intersect = {}) const;
+    void Raycast(std::span<const Ray> rays, std::span<std::optional<RayHit>> hits) const;
+
+private:
+    // Every node covers a contiguous range of m_tree.items, leaves have no children (left == 0, the root's index).
+    struct Node
+    {
+        BoundingBox box;
+        uint32_t first = 0;
+        uint32_t count = 0;
+        uint32_t left = 0;
+
+        [[nodiscard]] bool IsLeaf() const { return left == 0; }
+    };
+
+    struct Tree
+    {
+        std::vector<Node> nodes;
+        std::vector<uint32_t> items;
+        std::vector<uint32_t> parents;
+        float cost = 0.f;
+    };
+
+    static Tree BuildTree(std::vector<BoundingBox> boxes);
+    static float ComputeCost(std::span<const Node> nodes);
+    void SetTree(Tree tree);
+    void RebuildIfDegraded();
+    void AppendItems(const Node& node, std::vector<uint32_t>& results) const;
+
+    Tree m_tree;
+    std::vector<Bounds> m_bounds;
+    std::vector<uint32_t> m_item_leaves;
+    std::vector<uint32_t> m_item_positions;
+    std::vector<uint8_t> m_dirty_nodes;
+    // Objects with empty bounds, e.g. removed ones, which nodes fully inside a query must not report either.
+    uint32_t m_empty_count = 0;
+    bool m_refit_pending = false;
+    float m_cost = 0.f;
+    // Leaf contents in item order so partially visible leaves are tested 4 or 8 at a time.
+    FrustumCuller m_leaf_culler;
+    std::future<Tree> m_rebuild;
+};
@@ -1,11 +1,16 @@
 #pragma once
 #include "input.hpp"
+#include "bounds.hpp"
 
 class Engine;
 
 struct Frustum
 {
     std::array<glm::vec4, 6> planes;
+
+    [[nodiscard]] bool Intersects(const BoundingSphere& sphere) const;
+    [[nodiscard]] bool Intersects(const BoundingBox& box) const;
+    [[nodiscard]] bool Intersects(const Bounds& bounds) const { return Intersects(bounds.sphere) && Intersects(bounds.box); }
 };
 
 class Camera
@@ -14,6 +19,8 @@ public:
     Camera(Engine* engine) : m_engine(engine) {}
     Frustum CreateFrustum() const;
     static Frustum CreateFrustum(const glm::mat4& view_proj);
+    // Takes a point in normalized device coordinates, y up.
+    [[nodiscard]] Ray ScreenPointToRay(glm::vec2 ndc) const;
     void Update(float delta_time);
 
     float m_aspect_ratio = 16.f / 9.f;
@@ -0,0 +1,62 @@
+#pragma once
+
+// What the null backend would have sent to the GPU during a frame.
+struct NullFrameStats
+{
+    std::vector<std::string_view> passes;
+    uint32_t dispatches = 0;
+    uint64_t dispatch_groups = 0;
+    uint64_t push_constant_bytes = 0;
+    uint32_t uploads = 0;
+    uint64_t upload_bytes = 0;
+
+    // Adds the counters of a chunk recorded on another thread, passes are declared by the main thread only.
+    void Merge(const NullFrameStats& other)
+    {
+        dispatches += other.dispatches;
+        dispatch_groups += other.dispatch_groups;
+        push_constant_bytes += other.push_constant_bytes;
+        uploads += other.uploads;
+        upload_bytes += other.upload_bytes;
+    }
+
+    void Reset()
+    {
+        passes.clear();
+        dispatches = 0;
+        dispatch_groups = 0;
+        push_constant_bytes = 0;
+        uploads = 0;
+        upload_bytes = 0;
+    }
+};
+
+// Renderable passes record through one of these. The Swift one forwards to a command list and the null one only
+// counts, so headless frames run the exact same loops as the GPU path.
+class SwiftCommandRecorder
+{
+public:
+    explicit SwiftCommandRecorder(Swift::ICommand* command) : m_command(command) {}
+
+    void PushConstants(const void* data, const uint32_t size) const { m_command->PushConstants(data, size); }
+    void DispatchMesh(const uint32_t x, const uint32_t y, const uint32_t z) const { m_command->DispatchMesh(x, y, z); }
+
+private:
+    Swift::ICommand* m_command;
+};
+
+class NullCommandRecorder
+{
+public:
+    explicit NullCommandRecorder(NullFrameStats& stats) : m_stats(stats) {}
+
+    void PushConstants(const void*, const uint32_t size) const { m_stats.push_constant_bytes += size; }
+    void DispatchMesh(const uint32_t x, const uint32_t y, const uint32_t z) const
+    {
+        ++m_stats.dispatches;
+        m_stats.dispatch_groups += static_cast<uint64_t>(x) * y * z;
+    }
+
+private:
+    NullFrameStats& m_stats;
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include "camera.hpp"
+
+// Renderable bounds in structure-of-arrays form so a frustum can be tested against 4 or 8 objects per instruction.
+class FrustumCuller
+{
+public:
+    [[nodiscard]] uint32_t GetCount() const { return m_count; }
+    void Resize(uint32_t count);
+    void SetBounds(uint32_t index, const Bounds& bounds);
+
+    // Appends the indices of every object whose sphere and box both intersect the frustum, in ascending order.
+    void Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const { Cull(frustum, 0, m_count, visible); }
+    void Cull(const Frustum& frustum, uint32_t first, uint32_t count, std::vector<uint32_t>& visible) const;
+    void CullScalar(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+private:
+    [[nodiscard]] bool IsVisible(const Frustum& frustum, uint32_t index) const;
+
+    uint32_t m_count = 0;
+    std::vector<float> m_sphere_x;
+    std::vector<float> m_sphere_y;
+    std::vector<float> m_sphere_z;
+    std::vector<float> m_sphere_radius;
+    std::vector<float> m_box_x;
+    std::vector<float> m_box_y;
+    std::vector<float> m_box_z;
+    std::vector<float> m_extent_x;
+    std::vector<float> m_extent_y;
+    std::vector<float> m_extent_z;
+};
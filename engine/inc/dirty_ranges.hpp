@@ -0,0 +1,49 @@
+#pragma once
+
+// Half open [begin, end) element ranges of a CPU array that changed since its last upload. Flushing merges them so
+// each contiguous run of changes is written once and untouched elements are never sent again.
+class DirtyRanges
+{
+public:
+    void Mark(const uint32_t begin, const uint32_t end)
+    {
+        if (begin >= end) return;
+        if (!m_ranges.empty() && m_ranges.back().second == begin)
+        {
+            m_ranges.back().second = end;
+            return;
+        }
+        m_ranges.emplace_back(begin, end);
+    }
+    void Mark(const uint32_t index) { Mark(index, index + 1); }
+
+    [[nodiscard]] bool IsEmpty() const { return m_ranges.empty(); }
+
+    // Calls function(begin, end) once per merged range and clears them.
+    template <typename Function>
+    void Flush(Function&& function);
+
+private:
+    std::vector<std::pair<uint32_t, uint32_t>> m_ranges;
+};
+
+template <typename Function>
+void DirtyRanges::Flush(Function&& function)
+{
+    if (m_ranges.empty()) return;
+
+    std::ranges::sort(m_ranges);
+    auto range = m_ranges.front();
+    for (const auto& next : m_ranges | std::views::drop(1))
+    {
+        if (next.first <= range.second)
+        {
+            range.second = std::max(range.second, next.second);
+            continue;
+        }
+        function(range.first, range.second);
+        range = next;
+    }
+    function(range.first, range.second);
+    m_ranges.clear();
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "job_system.hpp"
+
+// How a pass orders its draws. Front to back lets early depth reject more, material order keeps state changes and
+// descriptor fetches coherent, submission order skips sorting entirely.
+enum class DrawOrder : uint8_t
+{
+    eSubmission,
+    eFrontToBack,
+    eMaterial,
+};
+
+enum class DrawPass : uint8_t
+{
+    eDepthPrepass,
+    eGeometry,
+    eShadow,
+};
+
+struct DrawSortItem
+{
+    uint64_t key;
+    uint32_t index;
+};
+
+class DrawSorter
+{
+public:
+    // Most significant first: pass (8 bits), pipeline (8), then material (16) and depth (32) in the order asked for.
+    // Depth is stored as its float bits, which sort like the value as long as it is not negative.
+    [[nodiscard]] static uint64_t CreateKey(DrawOrder order, DrawPass pass, uint8_t pipeline, uint16_t material,
+                                            float depth);
+
+    // Stable LSD radix sort on 8 bit digits, digits that every key shares are skipped.
+    void Sort(std::span<DrawSortItem> items);
+
+private:
+    std::vector<DrawSortItem> m_scratch;
+};
+
+// Renderables per job when building and recording draw streams.
+constexpr uint32_t DRAW_CHUNK_SIZE = 256;
+
+// Packets of one pass in record order. The visible list is radix sorted by the pass's DrawOrder, then each chunk of it
+// is filtered and packed on its own job and the chunks are appended in index order, so the stream never depends on
+// which worker ran what.
+template <typename Packet>
+struct DrawStream
+{
+    // visible indexes renderable_packets, which has one packet per renderable. create_key(index) gives a visible
+    // renderable's sort key and is not called when sort is false. Packets without meshlets are left out.
+    template <typename CreateKey>
+    void Build(JobSystem& job_system,
+               bool sort,
+               std::span<const uint32_t> visible,
+               std::span<const Packet> renderable_packets,
+               CreateKey&& create_key);
+
+    std::vector<DrawSortItem> sort_items;
+    std::vector<uint32_t> sorted;
+    DrawSorter sorter;
+    std::vector<std::vector<Packet>> chunks;
+    std::vector<Packet> packets;
+};
+
+template <typename Packet>
+template <typename CreateKey>
+void DrawStream<Packet>::Build(JobSystem& job_system,
+                               const bool sort,
+                               std::span<const uint32_t> visible,
+                               const std::span<const Packet> renderable_packets,
+                               CreateKey&& create_key)
+{
+    const auto count = static_cast<uint32_t>(visible.size());
+    if (sort)
+    {
+        sort_items.resize(count);
+        job_system.ParallelFor(count,
+                               DRAW_CHUNK_SIZE,
+                               [&](const uint32_t begin, const uint32_t end)
+                               {
+                                   for (uint32_t i = begin; i < end; ++i)
+                                   {
+                                       sort_items[i] = { .key = create_key(visible[i]), .index = visible[i] };
+                                   }
+                               });
+        sorter.Sort(sort_items);
+        sorted.resize(count);
+        std::ranges::transform(sort_items, sorted.begin(), &DrawSortItem::index);
+        visible = sorted;
+    }
+
+    chunks.resize((count + DRAW_CHUNK_SIZE - 1) / DRAW_CHUNK_SIZE);
+    job_system.ParallelFor(count,
+                           DRAW_CHUNK_SIZE,
+                           [&](const uint32_t begin, const uint32_t end)
+                           {
+                               auto& chunk = chunks[begin / DRAW_CHUNK_SIZE];
+                               chunk.clear();
+                               for (uint32_t i = begin; i < end; ++i)
+                               {
+                                   const auto& packet = renderable_packets[visible[i]];
+                                   if (packet.meshlet_count == 0) continue;
+                                   chunk.push_back(packet);
+                               }
+                           });
+    packets.clear();
+    for (const auto& chunk : chunks)
+    {
+        packets.insert_range(packets.end(), chunk);
+    }
+}
@@ -1,4 +1,6 @@
 #pragma once
+#include "bvh.hpp"
+#include "meshlet_tuner.hpp"
 
 class Engine;
 
@@ -17,11 +19,20 @@ class Editor
 {
 public:
     explicit Editor(Engine* engine) : m_engine(engine) {}
+    ~Editor();
     void Render(const uint64_t* image_handle);
 
 private:
     void UpdateRenderSettings();
+    void UpdateMeshletTuner();
+    void PickActor(glm::vec2 ndc);
     Engine* m_engine;
-    bool m_rebuild_lights = false;
+    std::vector<MeshletStats> m_meshlet_stats;
+    // Written by the sweep job, moved into m_meshlet_stats once the counter is done.
+    std::vector<MeshletStats> m_pending_meshlet_stats;
+    JobCounter m_meshlet_sweep;
+    bool m_meshlet_sweep_running = false;
+    ActorHandle m_selected_actor;
+    std::optional<RayHit> m_selected_hit;
     ContentBrowser m_content_browser;
 };
\ No newline at end of file
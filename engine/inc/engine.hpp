@@ -1,6 +1,8 @@
 #pragma once
 #include "camera.hpp"
 #include "editor.hpp"
+#include "fixed_timestep.hpp"
+#include "job_system.hpp"
 #include "renderer.hpp"
 #include "resources.hpp"
 #include "scene.hpp"
@@ -8,6 +10,18 @@
 
 class Engine;
 
+struct EngineCreateInfo
+{
+    // Runs without a window or GPU, see Renderer for what still happens each frame. The engine still links the D3D12
+    // backend, so headless runs are Windows only for now.
+    bool headless = false;
+    glm::uvec2 size = { 1280, 720 };
+    // Closes the engine after this many frames, 0 runs until the window is closed.
+    uint32_t max_frames = 0;
+    // Job system threads besides the main one, 0 leaves one hardware thread for the main thread.
+    uint32_t worker_count = 0;
+};
+
 template <typename T>
 concept GameConcept =
     requires(Engine* engine, T obj, float dt) {
@@ -19,12 +33,13 @@ concept GameConcept =
 class Engine
 {
 public:
-    Engine();
+    explicit Engine(const EngineCreateInfo& create_info = {});
     ~Engine();
 
     template<GameConcept game>
     void Run();
 
+    auto& GetJobSystem() const { return *m_job_system; }
     auto& GetWindow() const { return *m_window; }
     auto& GetInput() const { return *m_input; }
     auto& GetEditor() const { return *m_editor; }
@@ -33,8 +48,28 @@ public:
     auto& GetResources() const { return *m_resources; }
     auto& GetScene() const { return *m_scene; }
     float GetTime() const { return m_time; }
+    uint64_t GetFrameCount() const { return m_frame_count; }
+    // Game and scene updates run on fixed ticks from here, the camera still follows input every frame.
+    auto& GetTimestep() { return m_timestep; }
+
+    // Pipelined mode renders frame N on a render thread while frame N + 1 is simulated. Besides lights, actor transforms
+    // and grass, which go through the snapshot, game code must then leave the renderer alone during Update and queue
+    // that work with JobSystem::RunOnMainThread, which runs at the sync point. Debug builds assert on violations.
+    void SetPipelined(const bool pipelined) { m_pipelined = pipelined; }
+    bool IsPipelined() const { return m_pipelined; }
+    // True on the main thread while no frame is rendering, the only time renderer state outside the snapshot may change.
+    [[nodiscard]] bool IsRenderIdle() const
+    {
+        return std::this_thread::get_id() == m_main_thread_id && !m_render_in_flight;
+    }
 
 private:
+    void SubmitFrame(std::chrono::high_resolution_clock::time_point frame_start, float delta_time);
+    void WaitForRenderThread();
+    void RenderThreadLoop();
+    void ReportHeadlessRun() const;
+
+    std::unique_ptr<JobSystem> m_job_system;
     std::unique_ptr<Window> m_window;
     std::unique_ptr<Input> m_input;
     std::unique_ptr<Editor> m_editor;
@@ -43,6 +78,17 @@ private:
     std::unique_ptr<Resources> m_resources;
     std::unique_ptr<Scene> m_scene;
     float m_time = 0.f;
+    uint64_t m_frame_count = 0;
+    uint32_t m_max_frames = 0;
+    FixedTimestep m_timestep;
+
+    std::thread::id m_main_thread_id = std::this_thread::get_id();
+    bool m_pipelined = false;
+    bool m_render_in_flight = false;
+    std::atomic<bool> m_render_thread_running = false;
+    std::thread m_render_thread;
+    std::binary_semaphore m_render_start{ 0 };
+    std::binary_semaphore m_render_done{ 0 };
 };
 
 template<GameConcept Game>
@@ -59,13 +105,25 @@ void Engine::Run()
         m_input->Update();
         m_window->PollEvents();
         m_camera->Update(delta_time);
-        m_renderer->Update();
-        m_scene->Update(delta_time);
-        game->Update(delta_time);
 
-        if (m_input->IsKeyPressed(KeyboardKey::eF1))
+        const uint32_t steps = m_timestep.Advance(delta_time);
+        for (uint32_t i = 0; i < steps; ++i)
+        {
+            game->Update(m_timestep.GetStep());
+            m_scene->Update();
+        }
+        m_scene->Interpolate(m_timestep.GetAlpha());
+        SubmitFrame(current_time, delta_time);
+
+        ++m_frame_count;
+        if (m_max_frames && m_frame_count >= m_max_frames)
         {
-            m_renderer->GenerateStaticShadowMap();
+            m_window->Close();
         }
     }
+    WaitForRenderThread();
+    if (m_renderer->IsHeadless())
+    {
+        ReportHeadlessRun();
+    }
 }
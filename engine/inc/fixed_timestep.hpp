@@ -0,0 +1,37 @@
+#pragma once
+
+// Turns variable frame times into a whole number of fixed simulation ticks. Leftover time carries over to the next
+// frame and GetAlpha says how far the frame sits between the last two ticks, for interpolating what gets drawn.
+class FixedTimestep
+{
+public:
+    static constexpr float DEFAULT_TICK_RATE = 60.f;
+    static constexpr uint32_t DEFAULT_MAX_STEPS = 5;
+
+    explicit FixedTimestep(float tick_rate = DEFAULT_TICK_RATE, uint32_t max_steps = DEFAULT_MAX_STEPS);
+
+    // Returns how many ticks to run this frame. Time past max_steps ticks is dropped so a slow frame can't snowball
+    // into even slower ones.
+    uint32_t Advance(float delta_time);
+    void Reset();
+
+    void SetTickRate(float tick_rate);
+    void SetMaxSteps(uint32_t max_steps) { m_max_steps = std::max(max_steps, 1u); }
+
+    [[nodiscard]] float GetTickRate() const { return m_tick_rate; }
+    [[nodiscard]] float GetStep() const { return static_cast<float>(m_step); }
+    [[nodiscard]] uint32_t GetMaxSteps() const { return m_max_steps; }
+    [[nodiscard]] float GetAlpha() const { return static_cast<float>(m_accumulator / m_step); }
+    [[nodiscard]] uint32_t GetLastSteps() const { return m_last_steps; }
+    [[nodiscard]] uint64_t GetTickCount() const { return m_tick_count; }
+    [[nodiscard]] double GetDroppedTime() const { return m_dropped_time; }
+
+private:
+    float m_tick_rate;
+    double m_step;
+    uint32_t m_max_steps;
+    double m_accumulator = 0.0;
+    uint32_t m_last_steps = 0;
+    uint64_t m_tick_count = 0;
+    double m_dropped_time = 0.0;
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include "transient_planner.hpp"
+
+enum class FrameGraphState : uint8_t
+{
+    eRead,
+    eWrite,
+};
+
+struct FrameGraphStats
+{
+    uint64_t hash = 0;
+    uint32_t declared_passes = 0;
+    uint32_t culled_passes = 0;
+    uint32_t compiles = 0;
+    uint32_t cache_hits = 0;
+    // CPU time from Reset to the end of Compile, so declaring the frame is counted along with compiling it.
+    float build_ms = 0.f;
+    float total_build_ms = 0.f;
+
+    [[nodiscard]] float GetAverageBuildMs() const
+    {
+        const uint32_t builds = compiles + cache_hits;
+        return builds ? total_build_ms / static_cast<float>(builds) : 0.f;
+    }
+};
+
+// The passes of a frame and the per frame textures they read and write, declared again every frame. Compile hashes
+// the declaration and only culls and plans aliasing when the hash differs from the last compile, an unchanged frame
+// reuses the previous schedule. Passes that nothing marked with SetOutput depends on are culled, and Execute records
+// the rest in order. Barriers are left to the render graph the passes record into.
+class FrameGraph
+{
+public:
+    using RecordFunction = std::function<void()>;
+
+    void Reset();
+    uint32_t AddTexture(std::string_view name, uint64_t size);
+    // A pass without a record function only declares what it touches, like a consumer outside the frame.
+    FrameGraph& AddPass(std::string_view name, RecordFunction record = {});
+    FrameGraph& Read(uint32_t texture);
+    // Write replaces the whole texture, Modify draws over what earlier passes left in it.
+    FrameGraph& Write(uint32_t texture);
+    FrameGraph& Modify(uint32_t texture);
+    // Keeps the last declared pass alive along with every pass it depends on.
+    FrameGraph& SetOutput();
+    // Returns true when the declaration changed and had to be compiled again.
+    bool Compile();
+    // Calls the record function of every pass that survived culling, in the order they were declared.
+    void Execute() const;
+
+    [[nodiscard]] bool IsAlive(const uint32_t pass) const { return m_alive[pass]; }
+    // True when a pass with this name was declared and every pass with it was culled.
+    [[nodiscard]] bool IsCulled(std::string_view name) const;
+    [[nodiscard]] const TransientPlanner& GetPlanner() const { return m_planner; }
+    [[nodiscard]] const FrameGraphStats& GetStats() const { return m_stats; }
+
+private:
+    struct Texture
+    {
+        std::string_view name;
+        uint64_t size;
+    };
+
+    struct Access
+    {
+        uint32_t texture;
+        FrameGraphState state;
+        bool load;
+    };
+
+    struct Pass
+    {
+        std::string_view name;
+        uint32_t first_access = 0;
+        uint32_t access_count = 0;
+        bool output = false;
+        RecordFunction record;
+    };
+
+    [[nodiscard]] uint64_t ComputeHash() const;
+    [[nodiscard]] std::span<const Access> GetAccesses(const Pass& pass) const;
+    FrameGraph& AddAccess(uint32_t texture, FrameGraphState state, bool load);
+    void Cull();
+    void PlanAliasing();
+
+    std::vector<Texture> m_textures;
+    std::vector<Pass> m_passes;
+    std::vector<Access> m_accesses;
+    std::vector<uint8_t> m_alive;
+    std::vector<uint8_t> m_needed;
+    TransientPlanner m_planner;
+    FrameGraphStats m_stats;
+    bool m_compiled = false;
+    std::chrono::high_resolution_clock::time_point m_build_start;
+};
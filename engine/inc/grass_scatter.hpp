@@ -0,0 +1,132 @@
+#pragma once
+#include "bounds.hpp"
+#include "job_system.hpp"
+
+struct GrassPatch
+{
+    glm::vec3 position;
+    float height = 2.f;
+    glm::vec2 padding;
+    float width = 0.2f;
+    float radius = 0.5;
+};
+
+// How much grass grows over a world space XZ rectangle, from 0 to 1 and sampled bilinearly. Row 0 is at min.y.
+struct GrassDensityMap
+{
+    glm::vec2 min{};
+    glm::vec2 max{};
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> values;
+
+    // 1 everywhere when there are no values, 0 outside the rectangle otherwise.
+    [[nodiscard]] float Sample(glm::vec2 position) const;
+    // Red channel of an image stretched over [min, max], empty when the file cannot be read.
+    static GrassDensityMap Load(const std::filesystem::path& path, glm::vec2 min, glm::vec2 max);
+};
+
+struct GrassSurfacePoint
+{
+    float height;
+    glm::vec3 normal;
+};
+
+// The ground grass grows on as seen from above. Triangles of terrain and meshes are rasterized into a grid of cells
+// over their XZ extent, each keeping the highest triangle over its center, so grass never grows under a roof.
+// Triangles smaller than a cell can be missed.
+class GrassSurface
+{
+public:
+    void AddMesh(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, const glm::mat4& transform);
+    void Build(float cell_size);
+
+    // The highest triangle over position, nothing outside the grid or where no triangle covers the cell.
+    [[nodiscard]] std::optional<GrassSurfacePoint> Sample(glm::vec2 position) const;
+    [[nodiscard]] glm::vec2 GetMin() const { return m_min; }
+    [[nodiscard]] glm::vec2 GetMax() const { return m_max; }
+    [[nodiscard]] uint32_t GetTriangleCount() const { return static_cast<uint32_t>(m_planes.size()); }
+
+private:
+    static constexpr uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+
+    void Rasterize(uint32_t triangle);
+
+    // Three corners per triangle, and each triangle's plane with the normal facing up.
+    std::vector<glm::vec3> m_corners;
+    std::vector<glm::vec4> m_planes;
+    glm::vec2 m_min{};
+    glm::vec2 m_max{};
+    float m_cell_size = 1.f;
+    glm::uvec2 m_size{};
+    std::vector<uint32_t> m_cells;
+    std::vector<float> m_cell_heights;
+};
+
+struct GrassScatterSettings
+{
+    uint32_t seed = 1;
+    // No two patches are closer than this.
+    float spacing = 0.75f;
+    float max_slope_degrees = 35.f;
+    // Patches are shortened by up to this fraction at random.
+    float height_variation = 0.3f;
+    GrassPatch patch{};
+};
+
+struct GrassScatterStats
+{
+    uint32_t tiles = 0;
+    uint32_t candidates = 0;
+    uint32_t patches = 0;
+    float build_ms = 0.f;
+    float patches_per_second = 0.f;
+};
+
+// Poisson disk samples over a surface, thinned by a density map and a slope limit into grass patches. The disk is
+// filled tile by tile with Bridson's algorithm, tiles with the same parity in x and y never touch, so the four parity
+// classes run one after another and the tiles of each run in parallel. Every tile seeds its own generator from the
+// seed and its coordinates and the patches are joined in tile order, so a seed always gives the same patches
+// however the jobs ran.
+class GrassScatter
+{
+public:
+    static constexpr uint32_t TILE_CELLS = 32;
+    // Candidates tried around a sample before it stops spawning new ones.
+    static constexpr uint32_t ATTEMPTS = 12;
+
+    void Generate(JobSystem& job_system,
+                  const GrassSurface& surface,
+                  const GrassDensityMap& density,
+                  const GrassScatterSettings& settings,
+                  std::vector<GrassPatch>& patches);
+
+    [[nodiscard]] const GrassScatterStats& GetStats() const { return m_stats; }
+
+private:
+    struct Tile
+    {
+        std::vector<glm::vec2> samples;
+        std::vector<glm::vec2> active;
+        std::vector<GrassPatch> patches;
+    };
+
+    void FillTile(uint32_t tile);
+    void PlantTile(uint32_t tile,
+                   const GrassSurface& surface,
+                   const GrassDensityMap& density,
+                   const GrassScatterSettings& settings);
+    [[nodiscard]] bool IsFree(glm::vec2 sample) const;
+    [[nodiscard]] std::mt19937 CreateGenerator(uint32_t tile, uint32_t stream) const;
+
+    uint32_t m_seed = 0;
+    glm::vec2 m_min{};
+    float m_spacing = 1.f;
+    float m_cell_size = 1.f;
+    glm::uvec2 m_size{};
+    glm::uvec2 m_tile_count{};
+    // The sample in each grid cell, cells are small enough to hold at most one.
+    std::vector<glm::vec2> m_cells;
+    std::vector<Tile> m_tiles;
+    GrassScatterStats m_stats;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+class JobCounter;
+
+struct Job
+{
+    std::function<void()> function;
+    JobCounter* counter = nullptr;
+};
+
+// Tracks a group of jobs. Waiting on it runs other jobs instead of blocking, and jobs scheduled after it are held
+// back until it reaches zero.
+class JobCounter
+{
+public:
+    [[nodiscard]] bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> m_pending = 0;
+    std::mutex m_mutex;
+    std::vector<Job> m_continuations;
+};
+
+// Work stealing scheduler. Each worker pops the newest job from its own deque and steals the oldest from the others
+// when it runs dry, threads outside the pool push round robin.
+class JobSystem
+{
+public:
+    explicit JobSystem(uint32_t worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    ~JobSystem();
+
+    void Schedule(std::function<void()> function, JobCounter* counter = nullptr);
+    void ScheduleAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter = nullptr);
+    void Wait(JobCounter& counter);
+
+    // Splits [0, count) into batches of batch_size and calls function(begin, end) for each of them.
+    template <typename Function>
+    void ParallelFor(uint32_t count, uint32_t batch_size, Function&& function);
+    template <typename T, typename Function>
+    void ParallelFor(std::span<T> items, uint32_t batch_size, Function&& function);
+
+    // GPU work has to stay on the thread that owns the context, so it is queued here and drained by the engine loop.
+    void RunOnMainThread(std::function<void()> function);
+    void RunMainThreadJobs();
+
+    [[nodiscard]] uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void Push(Job job);
+    bool TryRunJob();
+    void Execute(Job& job);
+    void WorkerLoop(uint32_t index);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<uint32_t> m_queued = 0;
+    std::atomic<uint32_t> m_next_queue = 0;
+    std::atomic<bool> m_running = true;
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake;
+
+    std::mutex m_main_thread_mutex;
+    std::vector<std::function<void()>> m_main_thread_jobs;
+};
+
+template <typename Function>
+void JobSystem::ParallelFor(const uint32_t count, const uint32_t batch_size, Function&& function)
+{
+    JobCounter counter;
+    const uint32_t batch = std::max(batch_size, 1u);
+    for (uint32_t begin = 0; begin < count; begin += batch)
+    {
+        const uint32_t end = std::min(begin + batch, count);
+        Schedule([&function, begin, end] { function(begin, end); }, &counter);
+    }
+    Wait(counter);
+}
+
+template <typename T, typename Function>
+void JobSystem::ParallelFor(const std::span<T> items, const uint32_t batch_size, Function&& function)
+{
+    ParallelFor(static_cast<uint32_t>(items.size()),
+                batch_size,
+                [items, &function](const uint32_t begin, const uint32_t end)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        function(items[i]);
+                    }
+                });
+}
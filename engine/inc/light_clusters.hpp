@@ -0,0 +1,99 @@
+#pragma once
+#include "camera.hpp"
+#include "job_system.hpp"
+
+// Where a cluster's lights start in the index list and how many there are.
+struct LightClusterRange
+{
+    uint32_t offset;
+    uint32_t count;
+};
+
+struct LightClusterStats
+{
+    uint32_t lights = 0;
+    uint32_t indices = 0;
+    uint32_t occupied_clusters = 0;
+    uint32_t max_cluster_lights = 0;
+    float build_ms = 0.f;
+};
+
+// Splits the view frustum into GRID_X by GRID_Y screen tiles and DEPTH_SLICES exponential depth slices, and lists the
+// point lights whose range reaches each of these clusters. Lights are spheres in view space tested against the boxes
+// around the clusters 8 or 4 at a time, first against a whole slice, then against a row of tiles and last against each
+// cluster, so every step only tests what survived the one before. Slices are binned in parallel into lists of their
+// own that are joined in slice order, the lists come out the same however the jobs ran.
+class LightClusterGrid
+{
+public:
+    static constexpr uint32_t GRID_X = 16;
+    static constexpr uint32_t GRID_Y = 9;
+    static constexpr uint32_t DEPTH_SLICES = 24;
+    static constexpr uint32_t CLUSTER_COUNT = GRID_X * GRID_Y * DEPTH_SLICES;
+    // Depth the exponential slices start at, everything nearer shares the first slice.
+    static constexpr float NEAR_SLICE_DEPTH = 0.5f;
+
+    void Build(JobSystem& job_system, const Camera& camera, std::span<const BoundingSphere> lights);
+    // Tests every light against every cluster one at a time, the reference for checking Build.
+    void BuildReference(const Camera& camera, std::span<const BoundingSphere> lights);
+
+    // Indexed by (slice * GRID_Y + row) * GRID_X + column, row 0 is the top of the screen.
+    [[nodiscard]] std::span<const LightClusterRange> GetClusters() const { return m_clusters; }
+    // Light indices of each cluster in ascending order, cluster after cluster.
+    [[nodiscard]] std::span<const uint32_t> GetLightIndices() const { return m_indices; }
+    // The slice of a view depth is floor(log(depth) * x + y), clamped to the grid.
+    [[nodiscard]] glm::vec2 GetSliceScaleBias() const { return m_slice_scale_bias; }
+    [[nodiscard]] const LightClusterStats& GetStats() const { return m_stats; }
+
+private:
+    struct Box
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // View space spheres in structure-of-arrays form, padded so the SIMD loops can read a whole batch past the end.
+    struct LightSet
+    {
+        uint32_t count = 0;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<float> radius;
+        // Index of each sphere in the lights passed to Build.
+        std::vector<uint32_t> index;
+
+        void Resize(uint32_t size);
+        // Keeps the spheres of source at the given positions.
+        void Gather(const LightSet& source, std::span<const uint32_t> positions);
+    };
+
+    struct Slice
+    {
+        LightSet lights;
+        LightSet row_lights;
+        std::vector<uint32_t> positions;
+        std::vector<uint32_t> indices;
+        std::array<uint32_t, GRID_X * GRID_Y> counts{};
+    };
+
+    void UpdateBoxes(const Camera& camera);
+    void TransformLights(const Camera& camera, std::span<const BoundingSphere> lights);
+    void BinSlice(uint32_t slice);
+    // Writes the positions in lights of the spheres touching box and returns how many there are.
+    static uint32_t Overlap(const LightSet& lights, const Box& box, uint32_t* positions);
+    static bool Overlaps(const BoundingSphere& sphere, const Box& box);
+    void Join();
+    void UpdateStats(std::chrono::high_resolution_clock::time_point start);
+
+    glm::vec4 m_projection{};
+    glm::vec2 m_slice_scale_bias{};
+    std::vector<Box> m_cluster_boxes;
+    std::array<Box, DEPTH_SLICES> m_slice_boxes{};
+    std::array<Box, DEPTH_SLICES * GRID_Y> m_row_boxes{};
+    LightSet m_lights;
+    std::array<Slice, DEPTH_SLICES> m_slices;
+    std::vector<LightClusterRange> m_clusters;
+    std::vector<uint32_t> m_indices;
+    LightClusterStats m_stats;
+};
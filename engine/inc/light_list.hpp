@@ -0,0 +1,276 @@
+#pragma once
+#include "dirty_ranges.hpp"
+
+struct DirectionalLight
+{
+    glm::vec3 direction;
+    float intensity = 1.0f;
+    glm::vec3 color = glm::vec3(1.0f);
+    int cast_shadows = false;
+    void SetDirectionEuler(const glm::vec3& euler)
+    {
+        const glm::mat4 rot = glm::yawPitchRoll(glm::radians(euler.y), glm::radians(euler.x), glm::radians(euler.z));
+        constexpr auto forward = glm::vec3(0.0f, 0.0f, -1.0f);
+        direction = glm::normalize(glm::vec3(rot * glm::vec4(forward, 0.0f)));
+    }
+    // Pitch and yaw in degrees that SetDirectionEuler turns back into the direction, roll does not change it.
+    [[nodiscard]] glm::vec3 GetDirectionEuler() const
+    {
+        const glm::vec3 d = glm::normalize(direction);
+        return { glm::degrees(std::asin(d.y)), glm::degrees(std::atan2(-d.x, -d.z)), 0.f };
+    }
+};
+
+struct PointLight
+{
+    glm::vec3 position;
+    float intensity = 1.0f;
+    glm::vec3 color = glm::vec3(1.0f);
+    float range = 100.0f;
+};
+
+[[nodiscard]] inline bool CastsShadows(const DirectionalLight& light) { return light.cast_shadows; }
+[[nodiscard]] inline bool CastsShadows(const PointLight&) { return false; }
+
+// Refers to a slot in a LightList, the generation changes when the slot is reused so stale handles stop resolving.
+template <typename Light>
+struct LightHandle
+{
+    uint32_t index = std::numeric_limits<uint32_t>::max();
+    uint32_t generation = 0;
+
+    bool operator==(const LightHandle&) const = default;
+};
+using PointLightHandle = LightHandle<PointLight>;
+using DirectionalLightHandle = LightHandle<DirectionalLight>;
+
+// What a LightList wrote since the changes were last taken, the packed ranges with their new values back to back.
+template <typename Light>
+struct LightChanges
+{
+    uint32_t count = 0;
+    uint32_t shadow_caster_count = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    std::vector<Light> values;
+
+    // Brings a copy of the packed lights up to date and marks the ranges that were written.
+    void Apply(std::vector<Light>& lights, DirtyRanges& dirty) const;
+};
+
+// Lights of one type packed behind generational handles, so the GPU buffer is the packed array as is. Shadow casters
+// are kept at the front, which makes them and the other lights two contiguous arrays. Removing a light moves another
+// one into the hole, two when the caster at the end of its partition has to fill it first. Adds, removes and moves
+// are always handed out with the next changes, plain updates queue up and only budget of them are handed out per
+// frame, oldest first, so thousands of animated lights cannot flood a frame with uploads.
+template <typename Light>
+class LightList
+{
+public:
+    LightHandle<Light> Add(const Light& light);
+    // Returns false when the handle is stale.
+    bool Update(LightHandle<Light> handle, const Light& light);
+    void Remove(LightHandle<Light> handle);
+    void Clear();
+    // Hands out every structural change and up to budget updates.
+    void TakeChanges(uint32_t budget, LightChanges<Light>& changes);
+
+    [[nodiscard]] bool IsValid(LightHandle<Light> handle) const;
+    // Returns nullptr when the handle is stale. The pointer is only good until the next add or remove moves lights.
+    [[nodiscard]] const Light* Get(LightHandle<Light> handle) const;
+    [[nodiscard]] LightHandle<Light> GetHandle(uint32_t dense_index) const;
+    [[nodiscard]] uint32_t GetCount() const { return static_cast<uint32_t>(m_lights.size()); }
+    [[nodiscard]] std::span<const Light> GetLights() const { return m_lights; }
+    [[nodiscard]] std::span<const Light> GetShadowCasters() const { return std::span(m_lights).first(m_shadow_caster_count); }
+    [[nodiscard]] std::span<const Light> GetNonCasters() const { return std::span(m_lights).subspan(m_shadow_caster_count); }
+    // Updates waiting for budget.
+    [[nodiscard]] uint32_t GetPendingCount() const { return m_pending_count; }
+
+private:
+    [[nodiscard]] uint32_t GetDenseIndex(const LightHandle<Light> handle) const { return m_slot_dense_indices[handle.index]; }
+    void Swap(uint32_t a, uint32_t b);
+
+    std::vector<uint32_t> m_slot_dense_indices;
+    std::vector<uint32_t> m_slot_generations;
+    std::vector<uint8_t> m_slot_pending;
+    std::vector<uint32_t> m_free_slots;
+    std::vector<uint32_t> m_dense_slots;
+    std::vector<Light> m_lights;
+    uint32_t m_shadow_caster_count = 0;
+    DirtyRanges m_written;
+    // Slots updated since their last upload in the order they were first updated, may hold slots removed since.
+    std::deque<uint32_t> m_pending_slots;
+    uint32_t m_pending_count = 0;
+};
+
+template <typename Light>
+void LightChanges<Light>::Apply(std::vector<Light>& lights, DirtyRanges& dirty) const
+{
+    lights.resize(count);
+    auto value = values.begin();
+    for (const auto& [begin, end] : ranges)
+    {
+        std::copy_n(value, end - begin, lights.begin() + begin);
+        value += end - begin;
+        dirty.Mark(begin, end);
+    }
+}
+
+template <typename Light>
+LightHandle<Light> LightList<Light>::Add(const Light& light)
+{
+    uint32_t slot;
+    if (!m_free_slots.empty())
+    {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(m_slot_generations.size());
+        m_slot_dense_indices.push_back(0);
+        m_slot_generations.push_back(0);
+        m_slot_pending.push_back(false);
+    }
+
+    const auto index = static_cast<uint32_t>(m_lights.size());
+    m_slot_dense_indices[slot] = index;
+    m_dense_slots.push_back(slot);
+    m_lights.push_back(light);
+    m_written.Mark(index);
+    if (CastsShadows(light))
+    {
+        // The first light after the casters goes to the end to make room.
+        Swap(index, m_shadow_caster_count);
+        ++m_shadow_caster_count;
+    }
+    return { .index = slot, .generation = m_slot_generations[slot] };
+}
+
+template <typename Light>
+bool LightList<Light>::Update(const LightHandle<Light> handle, const Light& light)
+{
+    if (!IsValid(handle)) return false;
+
+    const uint32_t index = GetDenseIndex(handle);
+    const bool was_caster = index < m_shadow_caster_count;
+    m_lights[index] = light;
+    if (CastsShadows(light) != was_caster)
+    {
+        // Crossing the partition swaps with its last caster or first other light, a move that is never held back.
+        if (was_caster)
+        {
+            --m_shadow_caster_count;
+            Swap(index, m_shadow_caster_count);
+        }
+        else
+        {
+            Swap(index, m_shadow_caster_count);
+            ++m_shadow_caster_count;
+        }
+        return true;
+    }
+    if (!m_slot_pending[handle.index])
+    {
+        m_slot_pending[handle.index] = true;
+        m_pending_slots.push_back(handle.index);
+        ++m_pending_count;
+    }
+    return true;
+}
+
+template <typename Light>
+void LightList<Light>::Remove(const LightHandle<Light> handle)
+{
+    if (!IsValid(handle)) return;
+
+    uint32_t index = GetDenseIndex(handle);
+    if (index < m_shadow_caster_count)
+    {
+        // The last caster fills the hole, which leaves the light right after the casters.
+        --m_shadow_caster_count;
+        Swap(index, m_shadow_caster_count);
+        index = m_shadow_caster_count;
+    }
+    Swap(index, static_cast<uint32_t>(m_lights.size()) - 1);
+    m_lights.pop_back();
+    m_dense_slots.pop_back();
+
+    if (m_slot_pending[handle.index])
+    {
+        m_slot_pending[handle.index] = false;
+        --m_pending_count;
+    }
+    ++m_slot_generations[handle.index];
+    m_free_slots.push_back(handle.index);
+}
+
+template <typename Light>
+void LightList<Light>::Clear()
+{
+    while (!m_lights.empty())
+    {
+        Remove(GetHandle(GetCount() - 1));
+    }
+}
+
+template <typename Light>
+void LightList<Light>::TakeChanges(const uint32_t budget, LightChanges<Light>& changes)
+{
+    uint32_t taken = 0;
+    while (taken < budget && !m_pending_slots.empty())
+    {
+        const uint32_t slot = m_pending_slots.front();
+        m_pending_slots.pop_front();
+        if (!m_slot_pending[slot]) continue;
+
+        m_slot_pending[slot] = false;
+        --m_pending_count;
+        m_written.Mark(m_slot_dense_indices[slot]);
+        ++taken;
+    }
+
+    changes.count = GetCount();
+    changes.shadow_caster_count = m_shadow_caster_count;
+    changes.ranges.clear();
+    changes.values.clear();
+    m_written.Flush(
+        [&](const uint32_t begin, uint32_t end)
+        {
+            // Lights removed since they were written are past the end now.
+            end = std::min(end, changes.count);
+            if (begin >= end) return;
+            changes.ranges.emplace_back(begin, end);
+            changes.values.insert(changes.values.end(), m_lights.begin() + begin, m_lights.begin() + end);
+        });
+}
+
+template <typename Light>
+bool LightList<Light>::IsValid(const LightHandle<Light> handle) const
+{
+    return handle.index < m_slot_generations.size() && m_slot_generations[handle.index] == handle.generation;
+}
+
+template <typename Light>
+const Light* LightList<Light>::Get(const LightHandle<Light> handle) const
+{
+    if (!IsValid(handle)) return nullptr;
+    return &m_lights[GetDenseIndex(handle)];
+}
+
+template <typename Light>
+LightHandle<Light> LightList<Light>::GetHandle(const uint32_t dense_index) const
+{
+    const uint32_t slot = m_dense_slots[dense_index];
+    return { .index = slot, .generation = m_slot_generations[slot] };
+}
+
+template <typename Light>
+void LightList<Light>::Swap(const uint32_t a, const uint32_t b)
+{
+    std::swap(m_lights[a], m_lights[b]);
+    std::swap(m_dense_slots[a], m_dense_slots[b]);
+    m_slot_dense_indices[m_dense_slots[a]] = a;
+    m_slot_dense_indices[m_dense_slots[b]] = b;
+    m_written.Mark(a);
+    m_written.Mark(b);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "job_system.hpp"
+#include "resources.hpp"
+
+struct MeshletStats
+{
+    MeshletConfig config;
+    uint32_t mesh_count = 0;
+    uint32_t meshlet_count = 0;
+    uint64_t triangle_count = 0;
+    // Average vertex_count / max_vertices and triangle_count / max_triangles over all meshlets.
+    float vertex_fill = 0.f;
+    float triangle_fill = 0.f;
+    // Average triangle area over the area of the bounding sphere's great disc, 1 is a perfectly tight flat patch.
+    float bounds_tightness = 0.f;
+    // Fraction of meshlet/camera pairs rejected by the same cone test the amplification shaders run.
+    float cone_cull_rate = 0.f;
+    float build_ms = 0.f;
+};
+
+class MeshletTuner
+{
+public:
+    static std::vector<MeshletConfig> DefaultConfigs();
+
+    // Camera positions are in asset space. When none are given every mesh is orbited by a ring of sample cameras.
+    static MeshletStats Evaluate(std::span<const MeshGeometry> geometry,
+                                 const MeshletConfig& config,
+                                 std::span<const glm::vec3> camera_positions = {});
+    // Loads every glTF under asset_root and evaluates the configs in parallel, one job per file and per config.
+    static std::vector<MeshletStats> Sweep(JobSystem& job_system,
+                                           const std::filesystem::path& asset_root,
+                                           std::span<const MeshletConfig> configs,
+                                           std::span<const glm::vec3> camera_positions = {});
+    static void Print(std::span<const MeshletStats> stats);
+
+private:
+    static std::vector<glm::vec3> GetOrbitCameras(std::span<const glm::vec3> positions, uint32_t count);
+    static bool IsConeCulled(const CullData& cull_data, const glm::vec3& camera_position);
+};
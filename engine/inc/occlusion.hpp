@@ -0,0 +1,67 @@
+#pragma once
+#include "job_system.hpp"
+#include "resources.hpp"
+
+struct OccluderInstance
+{
+    const Occluder* occluder;
+    glm::mat4 transform;
+};
+
+struct OcclusionStats
+{
+    uint32_t occluder_triangles = 0;
+    uint32_t tested = 0;
+    uint32_t occluded = 0;
+};
+
+// Rasterizes simplified occluders into a small CPU depth buffer and rejects bounds hidden behind them.
+class OcclusionCuller
+{
+public:
+    static constexpr uint32_t WIDTH = 256;
+    static constexpr uint32_t HEIGHT = 128;
+    static constexpr uint32_t TILE_SIZE = 32;
+    static constexpr uint32_t TILES_X = WIDTH / TILE_SIZE;
+    static constexpr uint32_t TILES_Y = HEIGHT / TILE_SIZE;
+    static constexpr uint32_t HIZ_BLOCK = 8;
+    static constexpr uint32_t HIZ_WIDTH = WIDTH / HIZ_BLOCK;
+    static constexpr uint32_t HIZ_HEIGHT = HEIGHT / HIZ_BLOCK;
+
+    OcclusionCuller();
+
+    void Render(JobSystem& job_system, const glm::mat4& view_proj, std::span<const OccluderInstance> occluders);
+    [[nodiscard]] bool IsOccluded(const BoundingBox& box) const;
+    // Removes the indices whose bounds are hidden, keeping the order of the survivors.
+    void Cull(std::span<const Bounds> bounds, std::vector<uint32_t>& visible);
+
+    [[nodiscard]] std::span<const float> GetDepth() const { return m_depth; }
+    [[nodiscard]] const OcclusionStats& GetStats() const { return m_stats; }
+    // Writes the depth buffer as a 16 bit PGM so it can be diffed against a golden image.
+    void SaveDepth(const std::filesystem::path& path) const;
+
+private:
+    // Edge functions and depth are stored as a * x + b * y + c planes so pixels can be stepped with adds.
+    struct ScreenTriangle
+    {
+        std::array<glm::vec3, 3> edges;
+        glm::vec3 depth;
+        int min_x;
+        int min_y;
+        int max_x;
+        int max_y;
+    };
+
+    void AddTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2);
+    void SetupTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2);
+    void RasterizeTile(uint32_t tile_index);
+    void BuildHiZ(uint32_t tile_index);
+
+    glm::mat4 m_view_proj{};
+    std::vector<float> m_depth;
+    std::vector<float> m_hiz;
+    std::vector<glm::vec4> m_clip_positions;
+    std::vector<ScreenTriangle> m_triangles;
+    std::array<std::vector<uint32_t>, TILES_X * TILES_Y> m_bins;
+    OcclusionStats m_stats;
+};
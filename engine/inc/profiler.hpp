@@ -1,5 +1,9 @@
 #pragma once
 #define TRACY_CALLSTACK 8
+#include "tracy/Tracy.hpp"
+
+// CPU zones work everywhere, GPU zones need the D3D12 backend.
+#ifdef _WIN32
 #include "directx/d3d12.h"
 #include "tracy/TracyD3D12.hpp"
 
@@ -19,5 +23,8 @@ private:
 
 #define GPU_ZONE(profiler, cmd_list, name) \
     TracyD3D12Zone((profiler)->GetTracyContext(), static_cast<ID3D12GraphicsCommandList*>(cmd_list->GetCommandList()), name)
+#endif
 
-#define CPU_ZONE(name) ZoneScopedN(name)
\ No newline at end of file
+#define CPU_ZONE(name) ZoneScopedN(name)
+#define CPU_PLOT(name, value) TracyPlot(name, value)
+#define CPU_THREAD_NAME(name) tracy::SetThreadName(name)
\ No newline at end of file
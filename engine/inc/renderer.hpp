@@ -1,20 +1,35 @@
 #pragma once
 #include "camera.hpp"
+#include "bvh.hpp"
+#include "command_recorder.hpp"
+#include "dirty_ranges.hpp"
+#include "draw_sort.hpp"
+#include "grass_scatter.hpp"
+#include "light_clusters.hpp"
+#include "light_list.hpp"
+#include "occlusion.hpp"
+#include "resolution_controller.hpp"
 #include "resources.hpp"
+#include "shadow_tile_cache.hpp"
+#include "tlsf_allocator.hpp"
+#include "upload_ring.hpp"
+#include "frame_graph.hpp"
 #include "render_graph/swift_render_graph.hpp"
 
 class GPUProfiler;
 class Engine;
+struct ID3D12Fence;
 
 struct TextureView
 {
-    Swift::ITexture* texture;
-    Swift::ITextureView* srv;
-    Swift::ITextureView* uav;
-    Swift::ITextureView* render_target;
-    Swift::ITextureView* depth_stencil;
+    Swift::ITexture* texture = nullptr;
+    Swift::ITextureView* srv = nullptr;
+    Swift::ITextureView* uav = nullptr;
+    Swift::ITextureView* render_target = nullptr;
+    Swift::ITextureView* depth_stencil = nullptr;
 
-    uint32_t GetSRVDescriptorIndex() const { return srv->GetDescriptorIndex(); }
+    // Views are left empty by the headless renderer, which packs 0 wherever a descriptor would go.
+    uint32_t GetSRVDescriptorIndex() const { return srv ? srv->GetDescriptorIndex() : 0; }
 
     void Destroy(Swift::IContext* context) const
     {
@@ -139,12 +154,12 @@ private:
 
 struct BufferView
 {
-    Swift::IBuffer* buffer;
-    Swift::IBufferView* srv;
-    Swift::IBufferView* uav;
+    Swift::IBuffer* buffer = nullptr;
+    Swift::IBufferView* srv = nullptr;
+    Swift::IBufferView* uav = nullptr;
 
-    uint32_t GetDescriptorIndex() const { return srv->GetDescriptorIndex(); }
-    uint32_t GetUAVDescriptorIndex() const { return uav->GetDescriptorIndex(); }
+    uint32_t GetDescriptorIndex() const { return srv ? srv->GetDescriptorIndex() : 0; }
+    uint32_t GetUAVDescriptorIndex() const { return uav ? uav->GetDescriptorIndex() : 0; }
 
     void Write(const void* data, const uint32_t offset, const uint32_t size, const bool one_time = false) const
     {
@@ -231,55 +246,236 @@ private:
     uint32_t m_num_elements = 0;
 };
 
-struct MeshRenderer
+// Structured buffer sized to what it holds rather than a worst case. Reserve grows it geometrically into a new buffer
+// and keeps the old one alive until the frames that may still read it are done. Growing changes the descriptor index
+// and leaves the contents behind, so constants read the index every frame and callers upload everything again.
+class GrowableBuffer
 {
-    BufferView m_position_buffer;
-    BufferView m_attrib_buffer;
-    BufferView m_mesh_buffer;
-    BufferView m_mesh_vertex_buffer;
-    BufferView m_mesh_triangle_buffer;
-    uint32_t m_meshlet_count;
-    int m_material_index;
-    uint32_t m_transform_index;
-    uint32_t m_bounding_offset;
+public:
+    static constexpr uint32_t MIN_CAPACITY = 64;
+    static constexpr uint64_t RETIRE_FRAMES = 3;
+
+    GrowableBuffer() = default;
+    // A null context only tracks capacity, which is what the headless renderer uses.
+    GrowableBuffer(Swift::IContext* context, uint32_t element_size, std::string_view name);
+
+    // Returns true when the buffer was reallocated to fit count elements.
+    bool Reserve(uint32_t count, uint64_t frame);
+    // Destroys the buffers replaced at least RETIRE_FRAMES frames ago.
+    void CollectRetired(uint64_t frame);
+
+    [[nodiscard]] const BufferView& GetView() const { return m_view; }
+    [[nodiscard]] uint32_t GetDescriptorIndex() const { return m_view.GetDescriptorIndex(); }
+    [[nodiscard]] std::string_view GetName() const { return m_name; }
+    [[nodiscard]] uint32_t GetCount() const { return m_count; }
+    [[nodiscard]] uint32_t GetCapacity() const { return m_capacity; }
+    [[nodiscard]] uint64_t GetSizeBytes() const { return static_cast<uint64_t>(m_capacity) * m_element_size; }
+    [[nodiscard]] uint32_t GetGrowCount() const { return m_grow_count; }
+
+private:
+    struct RetiredBuffer
+    {
+        BufferView view;
+        uint64_t frame;
+    };
+
+    Swift::IContext* m_context = nullptr;
+    std::string m_name;
+    uint32_t m_element_size = 0;
+    uint32_t m_count = 0;
+    uint32_t m_capacity = 0;
+    uint32_t m_grow_count = 0;
+    BufferView m_view;
+    std::vector<RetiredBuffer> m_retired;
+};
+
+// One buffer for data rewritten every frame, with each frame's space handed out by an UploadRing. A fence signalled
+// after every frame tells how far the GPU is, so space comes back as soon as the frames reading it are done. When the
+// frames in flight leave no room, the ring moves to a buffer twice the size and the old one is destroyed once the
+// frames that used it have completed. Allocations made earlier in that frame stay behind in the old buffer, so a frame's
+// data is best allocated in one piece.
+class FrameUploadBuffer
+{
+public:
+    static constexpr uint32_t MIN_CAPACITY = 64 * 1024;
+    // Ring size as a multiple of one frame's allocation when growing, enough for the frames the swapchain keeps queued.
+    static constexpr uint32_t GROW_FRAMES = 4;
+
+    FrameUploadBuffer() = default;
+    // A null context only tracks the ring, every frame completes at once, which is what the headless renderer uses.
+    FrameUploadBuffer(Swift::IContext* context, std::string_view name);
+
+    // Releases the space of the frames the GPU has finished and destroys the buffers only they used.
+    void BeginFrame();
+    // Byte offset into the current buffer of size bytes aligned to alignment.
+    [[nodiscard]] uint32_t Allocate(uint32_t size, uint32_t alignment);
+    // Signals the fence behind the frame's commands and closes the frame's allocations under it.
+    void EndFrame();
+    void Destroy();
+
+    [[nodiscard]] const BufferView& GetView() const { return m_view; }
+    [[nodiscard]] uint32_t GetDescriptorIndex() const { return m_view.GetDescriptorIndex(); }
+    [[nodiscard]] std::string_view GetName() const { return m_name; }
+    [[nodiscard]] const UploadRing& GetRing() const { return m_ring; }
+    [[nodiscard]] uint32_t GetGrowCount() const { return m_grow_count; }
+
+private:
+    struct RetiredBuffer
+    {
+        BufferView view;
+        uint64_t fence_value;
+    };
 
-    void Draw(Swift::ICommand* command, bool dispatch_amp) const;
+    void Grow(uint32_t size);
+    [[nodiscard]] uint64_t GetCompletedValue() const;
+
+    Swift::IContext* m_context = nullptr;
+    ID3D12Fence* m_fence = nullptr;
+    std::string m_name;
+    // Value the fence is signalled with at the end of the current frame.
+    uint64_t m_fence_value = 1;
+    uint32_t m_grow_count = 0;
+    UploadRing m_ring;
+    BufferView m_view;
+    std::vector<RetiredBuffer> m_retired;
 };
 
-struct GrassPatch
+// Buffers shared by every mesh placed in them, one per vertex stream. Positions and attributes share the vertex
+// allocator since every vertex has both.
+struct GeometryPage
 {
-    glm::vec3 position;
-    float height = 2.f;
-    glm::vec2 padding;
-    float width = 0.2f;
-    float radius = 0.5;
+    BufferView positions;
+    BufferView attributes;
+    BufferView meshlets;
+    BufferView meshlet_vertices;
+    BufferView meshlet_triangles;
+    TlsfAllocator vertex_allocator;
+    TlsfAllocator meshlet_allocator;
+    TlsfAllocator meshlet_vertex_allocator;
+    TlsfAllocator meshlet_triangle_allocator;
 };
 
-struct DirectionalLight
+// Where a mesh lives, offsets are in elements of each stream.
+struct GeometryAllocation
 {
-    glm::vec3 direction;
-    float intensity = 1.0f;
-    glm::vec3 color = glm::vec3(1.0f);
-    int cast_shadows = false;
-    void SetDirectionEuler(const glm::vec3& euler)
+    uint32_t page = 0;
+    TlsfAllocation vertices{};
+    TlsfAllocation meshlets{};
+    TlsfAllocation meshlet_vertices{};
+    TlsfAllocation meshlet_triangles{};
+};
+
+// Suballocates mesh streams out of a few large pages instead of five buffers and descriptors per mesh. Shaders reach a
+// mesh through its page's descriptors plus the offsets in its push constants. A page is added when no existing one has
+// room, meshes bigger than a page get one sized to them.
+class GeometryPool
+{
+public:
+    static constexpr uint32_t PAGE_VERTICES = 256 * 1024;
+    static constexpr uint32_t PAGE_MESHLETS = 16 * 1024;
+    static constexpr uint32_t PAGE_MESHLET_VERTICES = 512 * 1024;
+    static constexpr uint32_t PAGE_MESHLET_TRIANGLES = 512 * 1024;
+    static constexpr uint64_t RETIRE_FRAMES = GrowableBuffer::RETIRE_FRAMES;
+
+    GeometryPool() = default;
+    // A null context only runs the allocators, which is what the headless renderer uses.
+    explicit GeometryPool(Swift::IContext* context) : m_context(context) {}
+
+    GeometryAllocation Allocate(const Mesh& mesh);
+    // Freed ranges merge with free neighbours right away, so a page emptied by unloading is whole again.
+    void Free(const GeometryAllocation& allocation);
+    // Frees the allocation once the frames that may still draw it have completed, see CollectRetired.
+    void Retire(const GeometryAllocation& allocation, uint64_t frame);
+    // Frees the allocations retired at least RETIRE_FRAMES frames ago.
+    void CollectRetired(uint64_t frame);
+
+    [[nodiscard]] const GeometryPage& GetPage(const uint32_t index) const { return m_pages[index]; }
+    [[nodiscard]] uint32_t GetPageCount() const { return static_cast<uint32_t>(m_pages.size()); }
+    [[nodiscard]] uint32_t GetRetiredCount() const { return static_cast<uint32_t>(m_retired.size()); }
+
+private:
+    struct RetiredAllocation
     {
-        const glm::mat4 rot = glm::yawPitchRoll(glm::radians(euler.y), glm::radians(euler.x), glm::radians(euler.z));
-        constexpr auto forward = glm::vec3(0.0f, 0.0f, -1.0f);
-        direction = glm::normalize(glm::vec3(rot * glm::vec4(forward, 0.0f)));
-    }
+        GeometryAllocation allocation;
+        uint64_t frame;
+    };
+
+    static bool TryAllocate(GeometryPage& page, const Mesh& mesh, GeometryAllocation& allocation);
+    void AddPage(const Mesh& mesh);
+
+    Swift::IContext* m_context = nullptr;
+    std::vector<GeometryPage> m_pages;
+    std::vector<RetiredAllocation> m_retired;
+};
+
+// Full resolution triangles of a mesh, kept on the CPU so picking hits the surface instead of its box.
+struct PickMesh
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
 };
 
-struct PointLight
+struct MeshRenderer
 {
-    glm::vec3 position;
-    float intensity = 1.0f;
-    glm::vec3 color = glm::vec3(1.0f);
-    float range = 100.0f;
+    GeometryAllocation m_geometry;
+    uint32_t m_meshlet_count;
+    int m_material_index;
+    uint32_t m_transform_index;
+    uint32_t m_bounding_offset;
+    Bounds m_local_bounds;
+    int m_occluder_index = -1;
+    uint32_t m_pick_mesh_index = 0;
+    bool m_removed = false;
+    // Node transform relative to the owning actor.
+    glm::mat4 m_local_transform = glm::mat4(1.f);
+};
+
+// Push constants of the depth only passes, the prepass and shadows share the same layout.
+struct DepthDrawPacket
+{
+    uint32_t position_buffer;
+    uint32_t meshlet_buffer;
+    uint32_t mesh_vertex_buffer;
+    uint32_t mesh_triangle_buffer;
+
+    uint32_t transform_index;
+    uint32_t meshlet_count;
+    uint32_t bounding_offset;
+    uint32_t vertex_offset;
+
+    uint32_t meshlet_offset;
+    uint32_t meshlet_vertex_offset;
+    uint32_t meshlet_triangle_offset;
+    // Tile render a shadow packet is drawn into, the prepass ignores it.
+    uint32_t shadow_tile_index;
+};
+
+struct GeometryDrawPacket
+{
+    uint32_t shadow_sampler_index;
+    uint32_t sampler_index;
+    uint32_t position_buffer;
+    uint32_t vertex_buffer;
+
+    uint32_t meshlet_buffer;
+    uint32_t mesh_vertex_buffer;
+    uint32_t mesh_triangle_buffer;
+    int material_index;
+
+    uint32_t transform_index;
+    uint32_t meshlet_count;
+    uint32_t bounding_offset;
+    uint32_t vertex_offset;
+
+    uint32_t meshlet_offset;
+    uint32_t meshlet_vertex_offset;
+    uint32_t meshlet_triangle_offset;
 };
 
 struct DepthPrePass
 {
     Swift::IShader* shader = nullptr;
+    DrawOrder order = DrawOrder::eFrontToBack;
 };
 
 struct SkyboxPass
@@ -290,6 +486,7 @@ struct SkyboxPass
 
 struct SSAOPass
 {
+    bool enabled = true;
     Swift::IShader* gen_shader = nullptr;
     Swift::IShader* blur_shader = nullptr;
     TextureView gen_texture;
@@ -319,6 +516,7 @@ struct FogPass
 
 struct BloomPass
 {
+    bool enabled = true;
     Swift::IShader* extract_shader;
     Swift::IShader* blur_shader;
     Swift::IShader* combine_shader;
@@ -340,30 +538,87 @@ struct GrassPass
     float lod_distance = 50.f;
     bool apply_view_space_thicken = false;
     Swift::IShader* shader = nullptr;
-    BufferView buffer;
+    GrowableBuffer buffer;
     std::vector<GrassPatch> patches;
+    // Patches edited since the last upload, the renderer writes them at the start of the next frame.
+    DirtyRanges dirty_patches;
+    // Only the first uploaded_count patches are drawn. Patches past them are uploaded at most upload_budget a frame,
+    // so scattering millions streams them in over a few frames instead of stalling one.
+    uint32_t upload_budget = 1 << 16;
+    uint32_t uploaded_count = 0;
+    // Patches written by the last frame, rewrites of drawn ones included.
+    uint32_t sent_patches = 0;
+    // Only used by ScatterGrass on the simulation side, its patches reach the render thread through the snapshot.
+    GrassScatter scatter;
+};
+
+struct OcclusionPass
+{
+    bool enabled = true;
+    OcclusionCuller culler;
+    std::vector<Occluder> occluders;
+    std::vector<OccluderInstance> instances;
 };
 
 struct ShadowPass
 {
     Swift::IShader* shader = nullptr;
-    TextureView texture;
+    // Every tile page is a square of one atlas, each shadow pass clears and draws only its page's rect.
+    TextureView atlas;
+    ShadowCascades cascades;
+    ShadowTileCache cache;
+    // Tiles drawn per frame at most, the rest wait while coarser cascades stand in for them.
+    uint32_t tile_budget = 8;
+    DrawOrder order = DrawOrder::eFrontToBack;
+};
+
+struct TransformUpdate
+{
+    uint32_t offset;
+    uint32_t size;
+    glm::mat4 transform;
+};
+
+// Everything the render side reads from the simulation. Two are kept so the simulation can fill one while the render
+// thread builds a frame from the other, they are only swapped at the sync point in Extract.
+struct FrameSnapshot
+{
+    Camera camera{ nullptr };
+    std::vector<TransformUpdate> transforms;
+    std::vector<RenderableRange> removed;
+    LightChanges<PointLight> point_lights;
+    LightChanges<DirectionalLight> dir_lights;
+    // Set when grass was scattered since the last snapshot, the render thread swaps it in for the drawn patches.
+    std::optional<std::vector<GrassPatch>> grass_patches;
+    glm::uvec2 screen_size{};
+    float time = 0.f;
+    std::chrono::high_resolution_clock::time_point frame_start;
 };
 
 class Renderer
 {
 public:
-    explicit Renderer(Engine* engine);
+    // A headless renderer never creates a context. Every CPU stage of the frame still runs, and passes, dispatches
+    // and uploads are only counted into GetNullFrame.
+    Renderer(Engine* engine, bool headless);
     ~Renderer();
-    void UpdateGlobalConstantBuffer(const Camera& camera) const;
+    void UpdateGlobalConstantBuffer(const FrameSnapshot& snapshot);
     void RenderImGUI(Swift::ICommand* command) const;
     void ClearTextures(Swift::ICommand* command) const;
     static void ImGUINewFrame();
 
-    void Update();
+    // Sync point, the render thread must be idle. Builds the editor UI, applies pending resizes and hands the
+    // simulation's snapshot over to Render.
+    void Extract(std::chrono::high_resolution_clock::time_point frame_start);
+    // Records and presents a frame from the last extracted snapshot, safe to run on the render thread.
+    void Render();
     auto* GetContext() const { return m_context; }
+    [[nodiscard]] bool IsHeadless() const { return m_headless; }
+    [[nodiscard]] const NullFrameStats& GetNullFrame() const { return m_null_frame; }
     void SetSkybox(Swift::ITexture* texture, Swift::ITexture* ibl_texture)
     {
+        AssertRenderIdle();
+        if (m_headless) return;
         if (m_skybox_pass.texture.texture)
         {
             m_context->GetGraphicsQueue()->WaitIdle();
@@ -386,35 +641,64 @@ public:
 
     std::tuple<uint32_t, uint32_t> AddRenderables(Model& model, const glm::mat4& transform)
     {
+        AssertRenderIdle();
         auto result = CreateMeshRenderers(model, transform);
-        m_transform_buffer.buffer->Write(m_transforms.data(), 0, sizeof(glm::mat4) * m_transforms.size());
-        m_material_buffer.buffer->Write(m_materials.data(), 0, sizeof(Material) * m_materials.size());
-        m_cull_data_buffer.buffer->Write(m_cull_data.data(), 0, sizeof(CullData) * m_cull_data.size());
+        UploadDirtyRanges();
         return result;
     }
 
-    void AddPointLight(const PointLight& point_light)
+    // Lights reach the render thread only through the snapshot, so these are safe from Update even when pipelined.
+    // Updates past the light update budget wait for later frames.
+    PointLightHandle AddPointLight(const PointLight& point_light) { return m_point_lights.Add(point_light); }
+    DirectionalLightHandle AddDirectionalLight(const DirectionalLight& light) { return m_dir_lights.Add(light); }
+    bool UpdatePointLight(const PointLightHandle handle, const PointLight& light)
     {
-        m_point_lights.push_back(point_light);
-        m_point_light_buffer.buffer->Write(&m_point_lights.back(), 0, sizeof(PointLight) * m_point_lights.size());
+        return m_point_lights.Update(handle, light);
     }
-    void AddDirectionalLight(const DirectionalLight& directional_light)
+    bool UpdateDirectionalLight(const DirectionalLightHandle handle, const DirectionalLight& light)
     {
-        m_dir_lights.push_back(directional_light);
-
-        const glm::vec3 d = glm::normalize(directional_light.direction);
-        glm::vec3 euler;
-        euler.x = glm::degrees(asin(d.y));
-        euler.y = glm::degrees(atan2(d.z, d.x));
-        m_dir_light_eulers.push_back(euler);
-
-        m_dir_light_buffer.buffer->Write(&m_dir_lights.back(), 0, sizeof(DirectionalLight) * m_dir_lights.size());
+        return m_dir_lights.Update(handle, light);
     }
+    void RemovePointLight(const PointLightHandle handle) { m_point_lights.Remove(handle); }
+    void RemoveDirectionalLight(const DirectionalLightHandle handle) { m_dir_lights.Remove(handle); }
+    void SetLightUpdateBudget(const uint32_t budget) { m_light_update_budget = budget; }
+    // Replaces every grass patch with ones scattered over surface. They reach the render thread through the snapshot, so
+    // this is safe from Update, and are uploaded over the next frames.
+    void ScatterGrass(const GrassSurface& surface, const GrassDensityMap& density, const GrassScatterSettings& settings);
+
+    // Queued into the snapshot being filled, the renderer's own transforms and bounds change when it is rendered.
+    void SetActorTransform(uint32_t offset, uint32_t size, const glm::mat4& transform);
+    // Queued the same way. Removed renderables are never drawn, shadowed or picked again. A mesh's geometry and pick
+    // triangles are freed with the last renderable using it, the transform, material and cull data slots aren't reused.
+    void RemoveRenderables(uint32_t offset, uint32_t size);
+    // World bounds of the renderables in [offset, offset + size) when placed at transform.
+    [[nodiscard]] Bounds GetBounds(uint32_t offset, uint32_t size, const glm::mat4& transform) const;
+    [[nodiscard]] std::span<const Bounds> GetWorldBounds() const { return m_world_bounds; }
+    [[nodiscard]] const Bvh& GetBvh() const { return m_bvh; }
+    // Nearest renderable whose triangles the ray passes through.
+    [[nodiscard]] std::optional<RayHit> Raycast(const Ray& ray) const;
+
+    [[nodiscard]] float GetFrameLatency() const { return m_frame_latency; }
+    // Fraction of the window the scene was last rendered at, tonemapping upscales it back to the full window.
+    [[nodiscard]] float GetRenderScale() const { return m_render_scale; }
+    [[nodiscard]] const ResolutionController& GetResolutionController() const { return m_resolution_controller; }
+    // Bytes written to GPU buffers by the last rendered frame, including anything added since the frame before it.
+    [[nodiscard]] uint64_t GetUploadBytes() const { return m_last_upload_bytes; }
+    [[nodiscard]] const GeometryPool& GetGeometryPool() const { return m_geometry_pool; }
+    // Passes of the last frame with what was culled and how the full screen targets could share memory, the targets
+    // themselves are still separate.
+    [[nodiscard]] const FrameGraph& GetFrameGraph() const { return m_frame_graph; }
+    [[nodiscard]] std::array<const GrowableBuffer*, 6> GetGrowableBuffers() const
+    {
+        return { &m_transform_buffer, &m_material_buffer,  &m_cull_data_buffer,
+                 &m_point_light_buffer, &m_dir_light_buffer, &m_grass_pass.buffer };
+    }
+    [[nodiscard]] const FrameUploadBuffer& GetFrameUploadBuffer() const { return m_frame_upload_buffer; }
+    [[nodiscard]] const LightClusterGrid& GetLightClusters() const { return m_light_clusters; }
 
-    void GenerateStaticShadowMap();
-
-    std::span<PointLight> GetPointLights() { return m_point_lights; }
-    std::span<DirectionalLight> GetDirectionalLights() { return m_dir_lights; }
+    [[nodiscard]] const LightList<PointLight>& GetPointLights() const { return m_point_lights; }
+    [[nodiscard]] const LightList<DirectionalLight>& GetDirectionalLights() const { return m_dir_lights; }
+    [[nodiscard]] uint32_t GetLightUpdateBudget() const { return m_light_update_budget; }
 
     DepthPrePass& GetDepthPrepass() { return m_depth_prepass; }
     TonemapPass& GetTonemapPass() { return m_tonemap_pass; }
@@ -424,11 +708,16 @@ public:
     FogPass& GetFogPass() { return m_fog_pass; }
     GrassPass& GetGrassPass() { return m_grass_pass; }
     ShadowPass& GetShadowPass() { return m_shadow_pass; }
+    OcclusionPass& GetOcclusionPass() { return m_occlusion_pass; }
 
 private:
     friend class Editor;
+    // Renderer state outside the snapshot belongs to the render thread while a frame is in flight. Anything touching it
+    // directly must run on the main thread at the sync point, from Update that means JobSystem::RunOnMainThread.
+    void AssertRenderIdle() const;
     void InitContext();
     void InitBuffers();
+    void InitGrowableBuffers();
     void InitDepthPrepass();
     void InitShadowPass();
     void InitSSAOPass();
@@ -440,16 +729,60 @@ private:
     void InitTonemapPass();
     void DrawDepthPrePass();
     void DrawGeometry();
-    void DrawSSAOPass();
+    void DrawSSAOGenPass();
+    void DrawSSAOBlurPass();
     void DrawSkybox();
-    void DrawShadowPass(Swift::ICommand* shadow_command = nullptr);
+    // Draws the render'th shadow tile the cache asked for this frame.
+    void DrawShadowPass(uint32_t render);
     void DrawGrassPass();
-    void DrawBloomPass();
+    void DrawBloomExtractPass();
+    void DrawBloomBlurPass(uint32_t blur);
+    void DrawBloomCombinePass();
     void DrawVolumetricFog();
     void DrawTonemapPass();
     void InitImgui() const;
+    // depth_plane dotted with a renderable's world center gives the depth it is sorted by.
+    template <typename Packet>
+    void BuildDrawStream(DrawPass pass,
+                         DrawOrder order,
+                         const glm::vec4& depth_plane,
+                         std::span<const uint32_t> visible,
+                         std::span<const Packet> packets,
+                         DrawStream<Packet>& stream);
+    // Stands in for secondary command lists, each chunk counts into its own stats and they are summed in order.
+    template <typename Packet>
+    void RecordNullStream(const DrawStream<Packet>& stream, bool dispatch_amp);
+    void DeclareNullPass(std::string_view name, uint32_t fullscreen_dispatches = 1);
+    // Declares the frame's passes with the targets they touch and the Draw function recording each of them, and
+    // compiles them. Render executes the graph, so culled passes are never recorded.
+    void DeclareFrameGraph(glm::uvec2 size);
+    // Feeds the time since the previous frame started to the resolution controller.
+    void UpdateRenderScale(const FrameSnapshot& snapshot);
+    // Part of the full screen targets the scene is drawn into, they stay allocated at window size.
+    [[nodiscard]] glm::uvec2 GetRenderExtent(glm::uvec2 screen_size) const;
+    // White when SSAO is culled so the lit pass samples no occlusion.
+    [[nodiscard]] const TextureView& GetAmbientOcclusionTexture() const;
+    void Upload(const BufferView& buffer, const void* data, uint32_t offset, size_t size);
+    [[nodiscard]] uint32_t GetFrameIndex() const { return m_headless ? 0 : m_context->GetFrameIndex(); }
 
     std::tuple<uint32_t, uint32_t> CreateMeshRenderers(Model& model, const glm::mat4& transform);
+    void BuildDrawLists(const FrameSnapshot& snapshot);
+    // Bins the point lights into the camera's clusters and uploads the lists the lit pass walks.
+    void BuildLightClusters(const FrameSnapshot& snapshot);
+    void Resize(glm::uvec2 size);
+    void FillSnapshot(FrameSnapshot& snapshot);
+    void ApplySnapshot(FrameSnapshot& snapshot);
+    void SetRenderableTransform(uint32_t renderable_index, const glm::mat4& transform);
+    void RemoveRenderable(uint32_t renderable_index);
+    // Rebuilds the cached push constants of [first, first + count), call whenever those renderables change.
+    void UpdateDrawPackets(uint32_t first, uint32_t count);
+    void UploadDirtyRanges();
+    // Rewrites edited patches that are drawn already and appends the next chunk of the rest.
+    void UploadGrassPatches();
+    template <typename T>
+    void UploadDirty(GrowableBuffer& buffer, std::span<const T> data, DirtyRanges& ranges);
+    [[nodiscard]] const FrameSnapshot& GetRenderSnapshot() const { return m_snapshots[m_snapshot_index ^ 1]; }
+    [[nodiscard]] FrameSnapshot& GetRenderSnapshot() { return m_snapshots[m_snapshot_index ^ 1]; }
 
     std::unique_ptr<GPUProfiler> m_profiler;
 
@@ -464,13 +797,13 @@ private:
     BloomPass m_bloom_pass;
     GrassPass m_grass_pass;
     ShadowPass m_shadow_pass;
+    OcclusionPass m_occlusion_pass;
 
     struct GlobalConstantInfo
     {
         glm::mat4 view_proj;
         glm::mat4 view;
         glm::mat4 proj;
-        glm::mat4 sun_view_proj;
         glm::mat4 inv_view_proj;
         glm::mat4 inv_proj;
 
@@ -498,16 +831,41 @@ private:
         uint32_t point_light_count;
         uint32_t dir_light_count;
 
-        uint32_t shadow_texture_index;
+        uint32_t cascade_count;
         uint32_t grass_buffer_index;
         uint32_t ibl_texture_index;
         uint32_t ssao_texture_index;
 
         glm::vec2 screen_size;
         glm::vec2 inv_screen_size;
+
+        glm::vec2 render_scale;
+        glm::vec2 shadow_depth_range;
+
+        uint32_t frame_upload_buffer_index;
+        // In uints, the light indices follow the cluster ranges.
+        uint32_t light_cluster_offset;
+        glm::vec2 light_slice_scale_bias;
+
+        uint32_t shadow_atlas_index;
+        glm::uvec3 padding;
+
+        glm::mat4 shadow_light_view;
+        struct Cascade
+        {
+            float split_depth;
+            float tile_size;
+            glm::ivec2 tile_origin;
+        };
+        std::array<Cascade, ShadowCascades::MAX_CASCADES> cascades;
+        std::array<glm::mat4, ShadowTileCache::MAX_RENDERS> shadow_tile_view_projs;
+        // Atlas page of every window slot, the tile cache's page table as is.
+        std::array<uint32_t, ShadowCascades::MAX_CASCADES * ShadowTileCache::WINDOW_TILES> shadow_pages;
     };
 
     Engine* m_engine;
+    bool m_headless = false;
+    NullFrameStats m_null_frame;
     Swift::IContext* m_context = nullptr;
 
     TextureView m_dummy_white_texture;
@@ -517,25 +875,74 @@ private:
 
     TextureView m_render_texture;
     TextureView m_depth_texture;
+    FrameGraph m_frame_graph;
 
+    // Constant buffer views have to be 256 byte aligned.
+    static constexpr uint32_t GLOBAL_CONSTANT_SIZE = (sizeof(GlobalConstantInfo) + 255) & ~255u;
     std::array<BufferView, 3> m_global_constant_buffers;
-    BufferView m_transform_buffer;
-    BufferView m_material_buffer;
-    BufferView m_cull_data_buffer;
+    GrowableBuffer m_transform_buffer;
+    GrowableBuffer m_material_buffer;
+    GrowableBuffer m_cull_data_buffer;
     BufferView m_frustum_buffer;
-    BufferView m_point_light_buffer;
-    BufferView m_dir_light_buffer;
-    Swift::ISampler* m_bilinear_sampler;
-    Swift::ISampler* m_shadow_comparison_sampler;
-    Swift::ISampler* m_nearest_sampler;
+    GrowableBuffer m_point_light_buffer;
+    GrowableBuffer m_dir_light_buffer;
+    FrameUploadBuffer m_frame_upload_buffer;
+    // Byte offset of this frame's light clusters in the frame upload buffer.
+    uint32_t m_light_cluster_offset = 0;
+    Swift::ISampler* m_bilinear_sampler = nullptr;
+    Swift::ISampler* m_shadow_comparison_sampler = nullptr;
+    Swift::ISampler* m_nearest_sampler = nullptr;
 
     Swift::IShader* m_pbr_shader = nullptr;
-    std::vector<PointLight> m_point_lights;
-    std::vector<DirectionalLight> m_dir_lights;
-    std::vector<glm::vec3> m_dir_light_eulers;
+    // Depth already matches exactly after the prepass, so the lit pass is grouped by material instead.
+    DrawOrder m_geometry_order = DrawOrder::eMaterial;
+    // Owned by the simulation side, the render thread only sees the changes taken into each snapshot.
+    LightList<PointLight> m_point_lights;
+    LightList<DirectionalLight> m_dir_lights;
+    uint32_t m_light_update_budget = 1024;
+    std::optional<std::vector<GrassPatch>> m_scattered_grass;
+    // What the light buffers hold, the shadow casting directional lights come first.
+    std::vector<PointLight> m_uploaded_point_lights;
+    std::vector<DirectionalLight> m_uploaded_dir_lights;
+    uint32_t m_dir_shadow_caster_count = 0;
+    DirtyRanges m_dirty_point_lights;
+    DirtyRanges m_dirty_dir_lights;
+    LightClusterGrid m_light_clusters;
+    std::vector<BoundingSphere> m_light_spheres;
+    GeometryPool m_geometry_pool;
     std::vector<MeshRenderer> m_renderables;
+    // Indexed like m_renderables, so recording a pass is a copy and a dispatch per visible renderable.
+    std::vector<DepthDrawPacket> m_depth_packets;
+    std::vector<GeometryDrawPacket> m_geometry_packets;
+    std::vector<Bounds> m_world_bounds;
+    std::vector<PickMesh> m_pick_meshes;
+    // Renderables still using each mesh, indexed like m_pick_meshes since every loaded mesh has one.
+    std::vector<uint32_t> m_mesh_users;
+    Bvh m_bvh;
+    std::vector<uint32_t> m_visible_renderables;
+    std::array<std::vector<uint32_t>, ShadowTileCache::MAX_RENDERS> m_visible_shadow_renderables;
+    DrawStream<DepthDrawPacket> m_depth_stream;
+    DrawStream<GeometryDrawPacket> m_geometry_stream;
+    std::array<DrawStream<DepthDrawPacket>, ShadowTileCache::MAX_RENDERS> m_shadow_streams;
     std::vector<glm::mat4> m_transforms;
+    DirtyRanges m_dirty_transforms;
     std::vector<Material> m_materials;
+    DirtyRanges m_dirty_materials;
     std::vector<CullData> m_cull_data;
+    DirtyRanges m_dirty_cull_data;
     std::vector<TextureView> m_textures;
+
+    // m_snapshot_index is the one the simulation is filling, the other belongs to the frame being rendered.
+    std::array<FrameSnapshot, 2> m_snapshots;
+    uint32_t m_snapshot_index = 0;
+    std::optional<glm::uvec2> m_pending_resize;
+    float m_frame_latency = 0.f;
+    bool m_dynamic_resolution = true;
+    float m_render_scale = 1.f;
+    ResolutionController m_resolution_controller;
+    std::chrono::high_resolution_clock::time_point m_last_frame_start;
+    uint64_t m_upload_bytes = 0;
+    uint64_t m_last_upload_bytes = 0;
+    // Rendered frames, used to tell when a replaced buffer can no longer be in flight.
+    uint64_t m_frame_number = 0;
 };
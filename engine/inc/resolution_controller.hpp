@@ -0,0 +1,41 @@
+#pragma once
+
+struct ResolutionGains
+{
+    float proportional = 0.3f;
+    float integral = 0.08f;
+    float derivative = 0.05f;
+};
+
+// Picks the fraction of the window the scene renders at from measured frame times. Frame cost grows with pixel count,
+// so the PID loop drives the rendered area (the scale squared) where the response is close to linear, in velocity form
+// so clamping to the scale range never winds anything up. Frame times are smoothed and errors inside a small dead band
+// are ignored, which keeps the scale still once it settles instead of chasing noise. Only the inputs decide the output.
+class ResolutionController
+{
+public:
+    static constexpr float MIN_SCALE = 0.5f;
+    static constexpr float MAX_SCALE = 1.f;
+    static constexpr float SMOOTHING = 0.25f;
+    static constexpr float DEAD_BAND = 0.03f;
+
+    explicit ResolutionController(float target_ms = 1000.f / 60.f, ResolutionGains gains = {});
+
+    // Feeds the time of the last frame and returns the scale for the next one.
+    float Update(float frame_ms);
+    void Reset();
+
+    void SetTargetMs(const float target_ms) { m_target_ms = std::max(target_ms, 1.f); }
+    [[nodiscard]] float GetTargetMs() const { return m_target_ms; }
+    [[nodiscard]] float GetScale() const { return std::sqrt(m_area); }
+    [[nodiscard]] float GetFilteredMs() const { return m_filtered_ms; }
+
+private:
+    float m_target_ms;
+    ResolutionGains m_gains;
+    float m_area = 1.f;
+    float m_filtered_ms = 0.f;
+    float m_error = 0.f;
+    float m_previous_error = 0.f;
+    bool m_primed = false;
+};
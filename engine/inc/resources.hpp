@@ -1,7 +1,32 @@
 #pragma once
+#include "actor.hpp"
 
 class Renderer;
 
+// Also the OutputVertices/OutputIndices sizes of the mesh shaders, gen_shaders.py passes them on as defines.
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+// The mesh shaders run one thread per vertex and per triangle in groups of 128, the most D3D12 allows.
+static_assert(MESHLET_MAX_VERTICES <= 128 && MESHLET_MAX_TRIANGLES <= 128);
+
+struct MeshletConfig
+{
+    uint32_t max_vertices = MESHLET_MAX_VERTICES;
+    uint32_t max_triangles = MESHLET_MAX_TRIANGLES;
+    float cone_weight = 0.f;
+};
+
+// Meshes smaller than this are never picked as occluders, they hide too little to pay for rasterizing.
+constexpr float OCCLUDER_MIN_RADIUS = 2.f;
+constexpr uint32_t OCCLUDER_MAX_TRIANGLES = 256;
+
+// Simplified copy of a mesh rasterized by the CPU occlusion culler.
+struct Occluder
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+};
+
 struct Vertex
 {
     float uv_x;
@@ -19,6 +44,8 @@ struct Mesh
     std::vector<uint32_t> meshlet_vertices;
     std::vector<uint32_t> meshlet_triangles;
     int material_index;
+    Bounds bounds;
+    std::optional<Occluder> occluder;
 };
 
 struct Material
@@ -84,10 +111,21 @@ struct Model
     std::vector<glm::mat4> transforms;
     std::vector<Node> nodes;
     std::vector<CullData> cull_datas;
+    MeshletConfig meshlet_config;
+};
+
+struct MeshGeometry
+{
+    std::string name;
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    // False for alpha tested and blended materials, which can't occlude.
+    bool opaque = true;
+    // World transforms of the nodes placing this mesh in the default scene.
+    std::vector<glm::mat4> instances;
 };
 
 class Engine;
-class Actor;
 
 class Resources
 {
@@ -95,35 +133,45 @@ public:
     Resources(Engine* engine);
     ~Resources();
 
-    std::shared_ptr<Actor> LoadModel(const std::filesystem::path& path, glm::vec3 position, glm::vec3 scale);
+    ActorHandle LoadModel(const std::filesystem::path& path,
+                          glm::vec3 position,
+                          glm::vec3 scale,
+                          const MeshletConfig& meshlet_config = {});
     Swift::ITexture* LoadTexture(const std::filesystem::path& path) const;
 
-private:
+    static std::vector<MeshGeometry> LoadGeometry(const std::filesystem::path& path);
     static std::tuple<std::vector<meshopt_Meshlet>, std::vector<uint32_t>, std::vector<uint8_t>> BuildMeshlets(
         std::span<const glm::vec3> positions,
-        std::span<const uint32_t> indices);
+        std::span<const uint32_t> indices,
+        const MeshletConfig& config);
+    static MeshletConfig ClampMeshletConfig(const MeshletConfig& config);
+    static uint32_t PackCone(const meshopt_Bounds& bounds);
+    static std::optional<Occluder> BuildOccluder(std::span<const glm::vec3> positions,
+                                                 std::span<const uint32_t> indices,
+                                                 const Bounds& bounds);
+
+private:
+    static std::optional<fastgltf::Asset> ParseGltf(const std::filesystem::path& path);
+    static bool IsOpaque(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive);
 
     static std::vector<uint32_t> RepackMeshlets(std::span<meshopt_Meshlet> meshlets,
                                                 std::span<const uint8_t> meshlet_triangles);
 
     static void LoadTangents(std::vector<glm::vec3>& positions, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
     static Texture LoadTexture(const std::string& base_path, const fastgltf::Asset& asset, const fastgltf::Texture& texture);
-    static uint32_t PackCone(const meshopt_Bounds& bounds);
 
     static Swift::Filter ToFilter(std::optional<fastgltf::Filter> filter);
     static Swift::Wrap ToWrap(fastgltf::Wrap wrap);
 
-    void LoadNode(const fastgltf::Asset& asset,
-                  size_t node_index,
-                  const glm::mat4& parent_transform,
-                  std::vector<Node>& nodes,
-                  std::vector<glm::mat4>& transforms,
-                  const std::vector<std::pair<uint32_t, uint32_t>>& mesh_ranges);
-    std::tuple<std::vector<Node>, std::vector<glm::mat4>> LoadNodes(
+    static void LoadNode(const fastgltf::Asset& asset,
+                         size_t node_index,
+                         const glm::mat4& parent_transform,
+                         std::vector<Node>& nodes,
+                         std::vector<glm::mat4>& transforms,
+                         const std::vector<std::pair<uint32_t, uint32_t>>& mesh_ranges);
+    static std::tuple<std::vector<Node>, std::vector<glm::mat4>> LoadNodes(
         const fastgltf::Asset& asset,
-        const std::vector<std::pair<uint32_t, uint32_t>>& mesh_ranges,
-        glm::vec3 position,
-        glm::vec3 scale);
+        const std::vector<std::pair<uint32_t, uint32_t>>& mesh_ranges);
     static std::vector<uint32_t> LoadIndices(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive);
     static std::tuple<std::vector<glm::vec3>, std::vector<Vertex>> LoadVertices(const fastgltf::Asset& asset,
                                             const fastgltf::Primitive& primitive,
@@ -1,26 +1,108 @@
 #pragma once
 #include "actor.hpp"
 
-template<typename T>
-concept IsActor = std::derived_from<T, Actor> || std::is_base_of_v<Actor, T>;
+// A world matrix split into translation, rotation and scale, which blend on their own. Lerping the matrices directly
+// would shrink rotating actors.
+struct Pose
+{
+    glm::vec3 position{};
+    glm::quat rotation{};
+    glm::vec3 scale{ 1.f };
+
+    static Pose FromMatrix(const glm::mat4& matrix);
+    [[nodiscard]] static glm::mat4 Blend(const Pose& a, const Pose& b, float alpha);
+};
 
+// Actor components live in parallel dense arrays so per-frame passes walk contiguous memory. Handles map to dense
+// indices through a slot table, and removing an actor moves the last one into its place.
+// Transforms are local to the parent, only actors marked dirty and their descendants get new world matrices each tick.
+// Actors that moved during the last tick are drawn blended between their previous and current world matrix.
 class Scene
 {
 public:
     Scene(Engine* engine) : m_engine(engine) {};
-    template<IsActor T>
-    std::shared_ptr<Actor> AddActor();
-    void Update(float dt) const;
-    [[nodiscard]] std::vector<std::shared_ptr<Actor>>& GetActors() { return m_actors; }
+    ActorHandle CreateActor(std::string_view name = {});
+    // Releases the actor's components and handle, and removes its renderables from the Renderer.
+    void DestroyActor(ActorHandle handle);
+    // Runs once per simulation tick. Nothing in the scene integrates over time, actors only move when the game sets their
+    // transforms, so the tick length is not needed here.
+    void Update();
+    // Recomputes dirty world matrices and pushes them to the actors' renderables.
+    void UpdateTransforms();
+    // Runs once per rendered frame, alpha is how far the frame sits between the last two ticks.
+    void Interpolate(float alpha);
+
+    [[nodiscard]] bool IsValid(ActorHandle handle) const;
+    [[nodiscard]] Actor GetActor(const ActorHandle handle) const { return { m_engine, handle }; }
+    [[nodiscard]] uint32_t GetActorCount() const { return static_cast<uint32_t>(m_dense_slots.size()); }
+    [[nodiscard]] ActorHandle GetHandle(uint32_t dense_index) const;
+    [[nodiscard]] std::optional<ActorHandle> FindRenderableOwner(uint32_t renderable_index) const;
+
+    [[nodiscard]] const Transform& GetTransform(const ActorHandle handle) const { return m_transforms[GetDenseIndex(handle)]; }
+    void SetTransform(ActorHandle handle, const Transform& transform);
+    [[nodiscard]] const glm::mat4& GetWorldMatrix(const ActorHandle handle) const
+    {
+        return m_world_matrices[GetDenseIndex(handle)];
+    }
+    [[nodiscard]] ActorHandle GetParent(const ActorHandle handle) const { return m_parents[GetDenseIndex(handle)]; }
+    [[nodiscard]] std::span<const ActorHandle> GetChildren(const ActorHandle handle) const
+    {
+        return m_children[GetDenseIndex(handle)];
+    }
+    // Pass a default handle to detach. Returns false if the parent is the actor itself or one of its descendants.
+    bool SetParent(ActorHandle child, ActorHandle parent);
+    [[nodiscard]] Bounds& GetBounds(const ActorHandle handle) { return m_bounds[GetDenseIndex(handle)]; }
+    [[nodiscard]] const Bounds& GetBounds(const ActorHandle handle) const { return m_bounds[GetDenseIndex(handle)]; }
+    [[nodiscard]] RenderableRange& GetRenderables(const ActorHandle handle) { return m_renderables[GetDenseIndex(handle)]; }
+    [[nodiscard]] const RenderableRange& GetRenderables(const ActorHandle handle) const
+    {
+        return m_renderables[GetDenseIndex(handle)];
+    }
+    [[nodiscard]] const std::string& GetName(const ActorHandle handle) const { return m_names[GetDenseIndex(handle)]; }
+
+    [[nodiscard]] std::span<const Transform> GetTransforms() const { return m_transforms; }
+    [[nodiscard]] std::span<const glm::mat4> GetWorldMatrices() const { return m_world_matrices; }
+    [[nodiscard]] std::span<const Bounds> GetBounds() const { return m_bounds; }
+    [[nodiscard]] std::span<const RenderableRange> GetRenderables() const { return m_renderables; }
+    [[nodiscard]] std::span<const std::string> GetNames() const { return m_names; }
 
 private:
+    // Component getters hand out references, so a stale handle is a bug in the caller rather than something to skip.
+    [[nodiscard]] uint32_t GetDenseIndex(const ActorHandle handle) const
+    {
+        assert(IsValid(handle) && "Stale or default actor handle");
+        return m_slot_dense_indices[handle.index];
+    }
+
     Engine* m_engine;
-    std::vector<std::shared_ptr<Actor>> m_actors;
-};
 
-template <IsActor T>
-std::shared_ptr<Actor> Scene::AddActor()
-{
-    m_actors.emplace_back(std::make_shared<T>(m_engine));
-    return m_actors.back();
-}
+    std::vector<uint32_t> m_slot_dense_indices;
+    std::vector<uint32_t> m_slot_generations;
+    std::vector<uint32_t> m_free_slots;
+    std::vector<uint32_t> m_dense_slots;
+
+    std::vector<Transform> m_transforms;
+    std::vector<glm::mat4> m_world_matrices;
+    std::vector<ActorHandle> m_parents;
+    std::vector<std::vector<ActorHandle>> m_children;
+    std::vector<uint8_t> m_dirty;
+    std::vector<Bounds> m_bounds;
+    std::vector<RenderableRange> m_renderables;
+    std::vector<std::string> m_names;
+
+    static constexpr uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+    // Dense indices of the actors updated this tick in hierarchy order, their parents' dense indices and their local
+    // matrices, all parallel.
+    std::vector<uint32_t> m_update_order;
+    std::vector<uint32_t> m_update_parents;
+    std::vector<glm::mat4> m_local_matrices;
+
+    // Both poses are split once per tick, so every frame in between only blends them.
+    struct InterpolatedActor
+    {
+        ActorHandle handle;
+        Pose previous;
+        Pose current;
+    };
+    std::vector<InterpolatedActor> m_interpolated;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include "camera.hpp"
+
+struct ShadowCascade
+{
+    glm::mat4 view_proj;
+    // View depth range of the camera slice the cascade covers.
+    float near_depth = 0.f;
+    float split_depth = 0.f;
+    // Sphere around the slice in world space, its radius sets the world size of a texel.
+    BoundingSphere bounds;
+};
+
+struct ShadowCascadeSettings
+{
+    uint32_t count = 4;
+    // Blend between uniform (0) and logarithmic (1) splits.
+    float lambda = 0.8f;
+    // Shadows end here even when the camera sees further.
+    float max_distance = 300.f;
+    uint32_t resolution = 2048;
+};
+
+// Fits orthographic sun projections to slices of the camera frustum. Splits follow the practical scheme, a blend of
+// logarithmic and uniform partitions. Each slice is bounded by the smallest sphere around it, which only depends on
+// the projection, so rotating the camera never resizes a cascade, and the sphere's center is snapped to whole texels in
+// light space so moving it only shifts the map by whole texels. Together they keep shadow edges from crawling.
+class ShadowCascades
+{
+public:
+    static constexpr uint32_t MAX_CASCADES = 4;
+
+    // Split distances for count slices of [near_plane, far_plane], the last one is always far_plane.
+    static void ComputeSplits(float near_plane, float far_plane, float lambda, std::span<float> splits);
+
+    // casters is everything that can throw a shadow, each projection reaches back toward the sun far enough to keep it.
+    void Fit(const Camera& camera, glm::vec3 light_direction, const BoundingBox& casters);
+    // Drops every cascade, for frames without a sun.
+    void Reset() { m_count = 0; }
+
+    void SetSettings(const ShadowCascadeSettings& settings);
+    [[nodiscard]] const ShadowCascadeSettings& GetSettings() const { return m_settings; }
+    [[nodiscard]] std::span<const ShadowCascade> GetCascades() const { return std::span(m_cascades).first(m_count); }
+    // Rotation into the sun's space, it only changes with the light.
+    [[nodiscard]] const glm::mat4& GetLightView() const { return m_light_view; }
+
+private:
+    ShadowCascadeSettings m_settings;
+    std::array<ShadowCascade, MAX_CASCADES> m_cascades{};
+    glm::mat4 m_light_view{ 1.f };
+    uint32_t m_count = 0;
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include "shadow_cascades.hpp"
+
+// Tile of a cascade queued to be drawn into a page this frame.
+struct ShadowTileRender
+{
+    uint32_t page;
+    uint32_t level;
+    glm::ivec2 coord;
+    glm::mat4 view_proj;
+};
+
+// Placement of a cascade's tiles, the tile at coord covers [coord, coord + 1) * tile_size of light space.
+struct ShadowTileLevel
+{
+    float tile_size = 0.f;
+    // First tile of the window the page table holds and the tiles the cascade needs inside it.
+    glm::ivec2 origin{};
+    glm::ivec2 count{};
+};
+
+struct ShadowTileStats
+{
+    uint32_t resident = 0;
+    // Tiles the cascades needed that were missing or dirty before scheduling.
+    uint32_t requested = 0;
+    uint32_t redrawn = 0;
+    uint32_t invalidated = 0;
+    uint32_t evicted = 0;
+    // Tiles the cascades needed that are still not resident once the budget ran out.
+    uint32_t missing = 0;
+};
+
+// Keeps the sun's shadow maps as fixed size tiles anchored in light space, so a tile stays valid while the camera moves
+// and only the tiles entering a cascade have to be drawn. Tiles live in a fixed pool of pages, and a page is only drawn
+// again when a caster moving over it marks it dirty, when the light or the caster depth range changes, or when it is
+// evicted for a tile that is needed more. Missing and dirty tiles are drawn nearest cascade first, a few per frame.
+class ShadowTileCache
+{
+public:
+    static constexpr uint32_t TILE_RESOLUTION = 512;
+    // Tiles per side of a cascade's window, a cascade up to (WINDOW - 1) * TILE_RESOLUTION texels wide always fits.
+    static constexpr uint32_t WINDOW = 5;
+    static constexpr uint32_t WINDOW_TILES = WINDOW * WINDOW;
+    // Every window can be resident at once with a few pages left to keep tiles that just left one.
+    static constexpr uint32_t PAGE_COUNT = ShadowCascades::MAX_CASCADES * WINDOW_TILES + 12;
+    // Pages are laid out row after row in one atlas texture, ATLAS_COLUMNS to a row.
+    static constexpr uint32_t ATLAS_COLUMNS = 16;
+    static constexpr uint32_t ATLAS_ROWS = (PAGE_COUNT + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    static constexpr uint32_t ATLAS_WIDTH = ATLAS_COLUMNS * TILE_RESOLUTION;
+    static constexpr uint32_t ATLAS_HEIGHT = ATLAS_ROWS * TILE_RESOLUTION;
+    static constexpr uint32_t MAX_RENDERS = 16;
+    static constexpr uint32_t NO_PAGE = std::numeric_limits<uint32_t>::max();
+    // The caster depth range is rounded out to this, so casters moving inside the scene rarely change it.
+    static constexpr float DEPTH_SNAP = 16.f;
+
+    ShadowTileCache();
+
+    // Places every cascade's window, a changed light or depth range drops every tile, a changed tile size its level's.
+    void BeginFrame(const glm::mat4& light_view,
+                    std::span<const ShadowCascade> cascades,
+                    uint32_t resolution,
+                    const BoundingBox& casters);
+    // Marks the resident tiles a world box projects onto dirty, call with the old and new bounds of a moved caster.
+    void Invalidate(const BoundingBox& box);
+    // Drops every tile, for when nothing in the cache can be trusted.
+    void Clear();
+    // Assigns pages to up to budget missing or dirty tiles and queues them in GetRenders.
+    void Schedule(uint32_t budget);
+
+    // Top left texel of a page in the atlas.
+    [[nodiscard]] static glm::uvec2 GetPageOrigin(const uint32_t page)
+    {
+        return glm::uvec2(page % ATLAS_COLUMNS, page / ATLAS_COLUMNS) * TILE_RESOLUTION;
+    }
+
+    [[nodiscard]] std::span<const ShadowTileRender> GetRenders() const { return m_renders; }
+    // Page of every window slot, level after level and row after row, NO_PAGE where no tile is resident.
+    [[nodiscard]] std::span<const uint32_t> GetPageTable() const { return m_page_table; }
+    [[nodiscard]] std::span<const ShadowTileLevel> GetLevels() const { return std::span(m_levels).first(m_level_count); }
+    [[nodiscard]] const glm::mat4& GetLightView() const { return m_light_view; }
+    // Light space depth mapped to 0 and 1 by every tile.
+    [[nodiscard]] glm::vec2 GetDepthRange() const { return m_depth_range; }
+    [[nodiscard]] const ShadowTileStats& GetStats() const { return m_stats; }
+
+private:
+    struct Page
+    {
+        uint32_t level = NO_PAGE;
+        glm::ivec2 coord{};
+        uint64_t last_used = 0;
+        bool dirty = false;
+    };
+
+    [[nodiscard]] uint32_t GetSlot(uint32_t level, glm::ivec2 coord) const;
+    [[nodiscard]] uint32_t AllocatePage();
+    void DropLevel(uint32_t level);
+    void BuildPageTable();
+
+    std::array<Page, PAGE_COUNT> m_pages{};
+    std::array<uint32_t, ShadowCascades::MAX_CASCADES * WINDOW_TILES> m_page_table{};
+    std::array<ShadowTileLevel, ShadowCascades::MAX_CASCADES> m_levels{};
+    uint32_t m_level_count = 0;
+    glm::mat4 m_light_view{ 1.f };
+    glm::vec2 m_depth_range{};
+    std::vector<ShadowTileRender> m_renders;
+    ShadowTileStats m_stats;
+    // Tiles marked dirty since the last BeginFrame, invalidation runs before the frame it is reported in starts.
+    uint32_t m_pending_invalidated = 0;
+    uint64_t m_frame = 0;
+};
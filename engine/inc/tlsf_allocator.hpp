@@ -0,0 +1,58 @@
+#pragma once
+
+struct TlsfAllocation
+{
+    uint32_t offset;
+    uint32_t size;
+    uint32_t block;
+};
+
+// Two level segregated fit allocator over a range of elements. Free blocks are binned by the power of two of their size
+// and 16 linear steps within it, so allocating and freeing are a couple of bit scans and neighbours are merged on free.
+class TlsfAllocator
+{
+public:
+    static constexpr uint32_t SL_BITS = 4;
+    static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+    static constexpr uint32_t FL_COUNT = 32 - SL_BITS + 1;
+
+    explicit TlsfAllocator(uint32_t size = 0);
+
+    [[nodiscard]] std::optional<TlsfAllocation> Allocate(uint32_t size);
+    void Free(const TlsfAllocation& allocation);
+
+    [[nodiscard]] uint32_t GetSize() const { return m_size; }
+    [[nodiscard]] uint32_t GetFreeSize() const { return m_free_size; }
+    [[nodiscard]] uint32_t GetAllocationCount() const { return m_allocation_count; }
+    [[nodiscard]] uint32_t GetLargestFreeBlock() const;
+
+private:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    struct Block
+    {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        uint32_t prev_physical = NONE;
+        uint32_t next_physical = NONE;
+        uint32_t prev_free = NONE;
+        uint32_t next_free = NONE;
+        bool free = false;
+    };
+
+    static std::pair<uint32_t, uint32_t> GetBin(uint32_t size);
+    [[nodiscard]] uint32_t FindBlock(uint32_t size) const;
+    uint32_t CreateBlock(uint32_t offset, uint32_t size);
+    void InsertFree(uint32_t block);
+    void RemoveFree(uint32_t block);
+    void Merge(uint32_t block, uint32_t next);
+
+    uint32_t m_size;
+    uint32_t m_free_size = 0;
+    uint32_t m_allocation_count = 0;
+    std::vector<Block> m_blocks;
+    std::vector<uint32_t> m_unused_blocks;
+    uint32_t m_fl_bitmap = 0;
+    std::array<uint32_t, FL_COUNT> m_sl_bitmaps{};
+    std::array<std::array<uint32_t, SL_COUNT>, FL_COUNT> m_free_heads;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+struct TransientTexture
+{
+    std::string_view name;
+    uint64_t size = 0;
+    // Inclusive range of passes touching the texture, first_pass is NONE when no pass does.
+    uint32_t first_pass = 0;
+    uint32_t last_pass = 0;
+    uint32_t block = 0;
+    // Read before being written, so it carries data between frames and lives through the whole frame.
+    bool persistent = false;
+};
+
+struct TransientReport
+{
+    uint64_t unaliased_bytes = 0;
+    uint64_t aliased_bytes = 0;
+    uint32_t block_count = 0;
+    uint32_t unused_textures = 0;
+
+    [[nodiscard]] uint64_t GetSavedBytes() const { return unaliased_bytes - aliased_bytes; }
+};
+
+// Finds which per frame textures can share memory. Passes are declared in execution order with the textures they read
+// and write, every texture lives from the first pass touching it to the last, and Plan colours the resulting interval
+// graph so textures with disjoint lifetimes land in the same block. A block is as big as its largest texture.
+class TransientPlanner
+{
+public:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    // Placement alignment of textures in a D3D12 heap.
+    static constexpr uint64_t ALIGNMENT = 64 * 1024;
+
+    // Drops every texture and pass but keeps the storage, so a frame can be redeclared without allocating.
+    void Reset();
+    uint32_t AddTexture(std::string_view name, uint64_t size);
+    TransientPlanner& AddPass(std::string_view name);
+    TransientPlanner& Read(uint32_t texture);
+    TransientPlanner& Write(uint32_t texture);
+    void Plan();
+
+    [[nodiscard]] std::span<const TransientTexture> GetTextures() const { return m_textures; }
+    [[nodiscard]] std::span<const std::string_view> GetPasses() const { return m_passes; }
+    [[nodiscard]] std::span<const uint64_t> GetBlockSizes() const { return m_block_sizes; }
+    [[nodiscard]] const TransientReport& GetReport() const { return m_report; }
+
+private:
+    void Touch(uint32_t texture);
+
+    std::vector<TransientTexture> m_textures;
+    std::vector<std::string_view> m_passes;
+    std::vector<uint64_t> m_block_sizes;
+    std::vector<uint32_t> m_block_ends;
+    std::vector<uint32_t> m_order;
+    TransientReport m_report;
+};
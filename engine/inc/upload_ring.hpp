@@ -0,0 +1,38 @@
+#pragma once
+
+// Linear suballocation out of a ring of bytes for data rewritten every frame. Each frame's allocations are closed
+// together under the fence value its commands were submitted with, and their space is handed out again only once the
+// GPU has passed that value, so nothing still being read is overwritten.
+class UploadRing
+{
+public:
+    static constexpr uint64_t NONE = std::numeric_limits<uint64_t>::max();
+
+    explicit UploadRing(uint64_t capacity = 0) : m_capacity(capacity) {}
+
+    // Byte offset of size bytes aligned to alignment, a power of two. Allocations never straddle the end of the ring,
+    // the tail is skipped instead. NONE when the frames still in flight leave no room.
+    [[nodiscard]] uint64_t Allocate(uint64_t size, uint64_t alignment);
+    // Closes the current frame's allocations under fence_value, which has to increase from frame to frame.
+    void EndFrame(uint64_t fence_value);
+    // Releases every closed frame whose fence value is at most completed_value.
+    void Recycle(uint64_t completed_value);
+
+    [[nodiscard]] uint64_t GetCapacity() const { return m_capacity; }
+    // Bytes held by frames in flight and the open frame, alignment and skipped tails included.
+    [[nodiscard]] uint64_t GetUsedBytes() const { return m_head - m_tail; }
+    [[nodiscard]] uint32_t GetFramesInFlight() const { return static_cast<uint32_t>(m_frames.size()); }
+
+private:
+    struct Frame
+    {
+        uint64_t end;
+        uint64_t fence_value;
+    };
+
+    uint64_t m_capacity;
+    // Running totals of bytes handed out and released, their difference is what is in use.
+    uint64_t m_head = 0;
+    uint64_t m_tail = 0;
+    std::deque<Frame> m_frames;
+};
@@ -1,12 +1,15 @@
 #pragma once
 
+// A headless window never touches GLFW, it reports a fixed size and runs until Close is called.
 class Window
 {
 public:
-    Window();
+    Window(glm::uvec2 size, bool headless);
     ~Window();
 
     [[nodiscard]] bool IsRunning() const;
+    [[nodiscard]] bool IsHeadless() const { return m_window == nullptr; }
+    void Close();
 
     void PollEvents() const;
     [[nodiscard]] void* GetNativeWindow() const;
@@ -20,6 +23,8 @@ public:
 private:
     friend class Input;
     std::vector<std::function<void(glm::uvec2)>> m_resize_callbacks;
-    GLFWwindow* m_window;
+    GLFWwindow* m_window = nullptr;
+    glm::uvec2 m_headless_size{};
+    bool m_close_requested = false;
     bool m_is_locked = false;
 };
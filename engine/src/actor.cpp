@@ -1,9 +1,65 @@
 #include "actor.hpp"
 #include "engine.hpp"
 
-void Actor::AddModel(Model& model)
+glm::mat4 Transform::ToMatrix() const
 {
-    auto [offset, size] = m_engine->GetRenderer().AddRenderables(model, m_transform.transform);
-    m_instance_size = size;
-    m_instance_offset = offset;
-}
\ No newline at end of file
+    // Rotation columns scaled in place, same result as translate * rotate * scale without the two extra products.
+    glm::mat4 matrix = glm::toMat4(glm::quat(rotation));
+    matrix[0] *= scale.x;
+    matrix[1] *= scale.y;
+    matrix[2] *= scale.z;
+    matrix[3] = glm::vec4(position, 1.f);
+    return matrix;
+}
+
+void Actor::AddModel(Model& model) const
+{
+    auto& scene = m_engine->GetScene();
+    const auto& world_matrix = scene.GetWorldMatrix(m_handle);
+    auto [offset, size] = m_engine->GetRenderer().AddRenderables(model, world_matrix);
+    scene.GetRenderables(m_handle) = { .offset = offset, .size = size };
+    scene.GetBounds(m_handle) = m_engine->GetRenderer().GetBounds(offset, size, world_matrix);
+}
+
+bool Actor::IsValid() const { return m_engine->GetScene().IsValid(m_handle); }
+
+const std::string& Actor::GetName() const { return m_engine->GetScene().GetName(m_handle); }
+
+Transform Actor::GetTransform() const { return m_engine->GetScene().GetTransform(m_handle); }
+
+glm::mat4 Actor::GetWorldMatrix() const { return m_engine->GetScene().GetWorldMatrix(m_handle); }
+
+void Actor::SetTransform(const Transform& transform) const { m_engine->GetScene().SetTransform(m_handle, transform); }
+
+void Actor::SetPosition(const glm::vec3 position) const
+{
+    if (!IsValid()) return;
+    auto transform = GetTransform();
+    transform.position = position;
+    SetTransform(transform);
+}
+
+void Actor::SetRotation(const glm::vec3 rotation) const
+{
+    if (!IsValid()) return;
+    auto transform = GetTransform();
+    transform.rotation = rotation;
+    SetTransform(transform);
+}
+
+void Actor::SetScale(const glm::vec3 scale) const
+{
+    if (!IsValid()) return;
+    auto transform = GetTransform();
+    transform.scale = scale;
+    SetTransform(transform);
+}
+
+void Actor::SetParent(const ActorHandle parent) const { m_engine->GetScene().SetParent(m_handle, parent); }
+
+Bounds Actor::GetBounds() const { return m_engine->GetScene().GetBounds(m_handle); }
+
+bool Actor::OwnsRenderable(const uint32_t index) const
+{
+    return IsValid() && m_engine->GetScene().GetRenderables(m_handle).Contains(index);
+}
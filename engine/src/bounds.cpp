@@ -0,0 +1,98 @@
+#include "bounds.hpp"
+
+std::optional<float> Ray::Intersect(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) const
+{
+    const glm::vec3 ab = b - a;
+    const glm::vec3 ac = c - a;
+    const glm::vec3 p = glm::cross(direction, ac);
+    const float determinant = glm::dot(ab, p);
+    // The ray runs parallel to the triangle.
+    if (std::abs(determinant) < 1e-12f) return std::nullopt;
+
+    const float inv_determinant = 1.f / determinant;
+    const glm::vec3 s = origin - a;
+    const float u = glm::dot(s, p) * inv_determinant;
+    if (u < 0.f || u > 1.f) return std::nullopt;
+    const glm::vec3 q = glm::cross(s, ab);
+    const float v = glm::dot(direction, q) * inv_determinant;
+    if (v < 0.f || u + v > 1.f) return std::nullopt;
+    const float distance = glm::dot(ac, q) * inv_determinant;
+    if (distance < 0.f) return std::nullopt;
+    return distance;
+}
+
+BoundingBox BoundingBox::Transform(const glm::mat4& transform) const
+{
+    if (!IsValid()) return *this;
+
+    // Arvo's method, transform the center and accumulate the absolute rotated extents.
+    const glm::vec3 center = glm::vec3(transform * glm::vec4(GetCenter(), 1.f));
+    const glm::vec3 extents = GetExtents();
+    glm::vec3 world_extents{};
+    for (int i = 0; i < 3; ++i)
+    {
+        world_extents += glm::abs(glm::vec3(transform[i])) * extents[i];
+    }
+    return { .min = center - world_extents, .max = center + world_extents };
+}
+
+Bounds Bounds::FromPoints(const std::span<const glm::vec3> points)
+{
+    Bounds bounds{};
+    for (const auto& point : points)
+    {
+        bounds.box.Expand(point);
+    }
+    if (!bounds.box.IsValid()) return bounds;
+
+    // Centering on the box and taking the furthest point is tighter than the box's half diagonal.
+    bounds.sphere.center = bounds.box.GetCenter();
+    float radius_squared = 0.f;
+    for (const auto& point : points)
+    {
+        const glm::vec3 offset = point - bounds.sphere.center;
+        radius_squared = glm::max(radius_squared, glm::dot(offset, offset));
+    }
+    bounds.sphere.radius = std::sqrt(radius_squared);
+    return bounds;
+}
+
+Bounds Bounds::Merge(const Bounds& a, const Bounds& b)
+{
+    if (!a.box.IsValid()) return b;
+    if (!b.box.IsValid()) return a;
+
+    Bounds bounds{ .box = a.box };
+    bounds.box.Expand(b.box);
+
+    const glm::vec3 offset = b.sphere.center - a.sphere.center;
+    const float distance = glm::length(offset);
+    if (distance + b.sphere.radius <= a.sphere.radius)
+    {
+        bounds.sphere = a.sphere;
+    }
+    else if (distance + a.sphere.radius <= b.sphere.radius)
+    {
+        bounds.sphere = b.sphere;
+    }
+    else
+    {
+        const float radius = (distance + a.sphere.radius + b.sphere.radius) * 0.5f;
+        bounds.sphere.center = a.sphere.center + offset * ((radius - a.sphere.radius) / distance);
+        bounds.sphere.radius = radius;
+    }
+    return bounds;
+}
+
+Bounds Bounds::Transform(const glm::mat4& transform) const
+{
+    if (!box.IsValid()) return *this;
+
+    // Same conservative scale the amplification shaders apply to meshlet spheres.
+    const float max_scale = glm::max(glm::length(glm::vec3(transform[0])),
+                                     glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+    return {
+        .box = box.Transform(transform),
+        .sphere = { .center = glm::vec3(transform * glm::vec4(sphere.center, 1.f)), .radius = sphere.radius * max_scale },
+    };
+}
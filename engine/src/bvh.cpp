@@ -0,0 +1,655 @@
+#include "bvh.hpp"
+#include "profiler.hpp"
+
+namespace
+{
+    float SurfaceArea(const BoundingBox& box)
+    {
+        if (!box.IsValid()) return 0.f;
+        const glm::vec3 size = box.max - box.min;
+        return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    enum class Overlap
+    {
+        eOutside,
+        eIntersects,
+        eInside,
+    };
+
+    Overlap Classify(const Frustum& frustum, const BoundingBox& box)
+    {
+        const glm::vec3 center = box.GetCenter();
+        const glm::vec3 extents = box.GetExtents();
+        Overlap overlap = Overlap::eInside;
+        for (const auto& plane : frustum.planes)
+        {
+            const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+            const float radius = glm::dot(extents, glm::abs(glm::vec3(plane)));
+            if (distance < -radius) return Overlap::eOutside;
+            if (distance < radius)
+            {
+                overlap = Overlap::eIntersects;
+            }
+        }
+        return overlap;
+    }
+
+    bool Overlaps(const BoundingBox& a, const BoundingBox& b)
+    {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y &&
+               a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+
+    bool Overlaps(const BoundingSphere& sphere, const BoundingBox& box)
+    {
+        const glm::vec3 offset = sphere.center - glm::clamp(sphere.center, box.min, box.max);
+        return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+    }
+
+    bool Contains(const BoundingBox& box, const glm::vec3& point)
+    {
+        return point.x >= box.min.x && point.x <= box.max.x && point.y >= box.min.y && point.y <= box.max.y &&
+               point.z >= box.min.z && point.z <= box.max.z;
+    }
+
+    // A zero component would make the slab distances inf, and inf * 0 is NaN when the origin lies on a slab plane.
+    glm::vec3 InverseDirection(const glm::vec3& direction)
+    {
+        constexpr float min_component = 1e-20f;
+        glm::vec3 inverse;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float component = direction[axis];
+            inverse[axis] = 1.f / (std::abs(component) < min_component ? std::copysign(min_component, component)
+                                                                         : component);
+        }
+        return inverse;
+    }
+
+    std::optional<float> Intersect(const BoundingBox& box,
+                                   const glm::vec3& origin,
+                                   const glm::vec3& inv_direction,
+                                   const float max_distance)
+    {
+        if (!box.IsValid()) return std::nullopt;
+        const glm::vec3 t0 = (box.min - origin) * inv_direction;
+        const glm::vec3 t1 = (box.max - origin) * inv_direction;
+        const glm::vec3 near = glm::min(t0, t1);
+        const glm::vec3 far = glm::max(t0, t1);
+        const float enter = std::max({ near.x, near.y, near.z, 0.f });
+        const float exit = std::min({ far.x, far.y, far.z, max_distance });
+        if (enter > exit) return std::nullopt;
+        return enter;
+    }
+} // namespace
+
+Bvh::~Bvh()
+{
+    if (m_rebuild.valid())
+    {
+        m_rebuild.wait();
+    }
+}
+
+void Bvh::Build(const std::span<const Bounds> bounds)
+{
+    CPU_ZONE("BVH Build");
+    // A rebuild started for the old object set can't be swapped in anymore.
+    if (m_rebuild.valid())
+    {
+        m_rebuild.get();
+    }
+
+    m_bounds.assign(bounds.begin(), bounds.end());
+    m_empty_count = static_cast<uint32_t>(std::ranges::count_if(bounds, [](const Bounds& b) { return !b.box.IsValid(); }));
+    std::vector<BoundingBox> boxes(m_bounds.size());
+    std::ranges::transform(m_bounds, boxes.begin(), &Bounds::box);
+    SetTree(BuildTree(std::move(boxes)));
+    m_refit_pending = false;
+}
+
+void Bvh::Insert(const std::span<const Bounds> bounds)
+{
+    CPU_ZONE("BVH Insert");
+    if (bounds.empty()) return;
+    if (m_tree.nodes.empty())
+    {
+        Build(bounds);
+        return;
+    }
+    // A rebuild started for the old object set can't be swapped in anymore.
+    if (m_rebuild.valid())
+    {
+        m_rebuild.get();
+    }
+
+    const auto first_item = static_cast<uint32_t>(m_bounds.size());
+    m_bounds.insert(m_bounds.end(), bounds.begin(), bounds.end());
+    m_empty_count += static_cast<uint32_t>(std::ranges::count_if(bounds, [](const Bounds& b) { return !b.box.IsValid(); }));
+    std::vector<BoundingBox> boxes(bounds.size());
+    std::ranges::transform(bounds, boxes.begin(), &Bounds::box);
+    Tree added = BuildTree(std::move(boxes));
+
+    // New root at 0, the old and added roots as its children at 1 and 2, then the rest of each tree in order. Both
+    // trees keep their relative layout, so children still follow their parents and siblings stay adjacent.
+    Tree old = std::move(m_tree);
+    const auto old_node_count = static_cast<uint32_t>(old.nodes.size());
+    auto OldIndex = [&](const uint32_t i) { return i == 0 ? 1 : i + 2; };
+    auto AddedIndex = [&](const uint32_t i) { return i == 0 ? 2 : old_node_count + 1 + i; };
+
+    Tree tree;
+    tree.nodes.resize(old.nodes.size() + added.nodes.size() + 1);
+    tree.parents.resize(tree.nodes.size());
+    tree.items = std::move(old.items);
+    tree.items.reserve(m_bounds.size());
+    for (const uint32_t item : added.items)
+    {
+        tree.items.push_back(first_item + item);
+    }
+
+    BoundingBox root_box = old.nodes[0].box;
+    root_box.Expand(added.nodes[0].box);
+    tree.nodes[0] = { .box = root_box, .first = 0, .count = static_cast<uint32_t>(tree.items.size()), .left = 1 };
+    tree.parents[0] = 0;
+    for (uint32_t i = 0; i < old.nodes.size(); ++i)
+    {
+        Node node = old.nodes[i];
+        node.left = node.IsLeaf() ? 0 : OldIndex(node.left);
+        tree.nodes[OldIndex(i)] = node;
+        tree.parents[OldIndex(i)] = i == 0 ? 0 : OldIndex(old.parents[i]);
+    }
+    for (uint32_t i = 0; i < added.nodes.size(); ++i)
+    {
+        Node node = added.nodes[i];
+        node.first += first_item;
+        node.left = node.IsLeaf() ? 0 : AddedIndex(node.left);
+        tree.nodes[AddedIndex(i)] = node;
+        tree.parents[AddedIndex(i)] = i == 0 ? 0 : AddedIndex(added.parents[i]);
+    }
+    // Neither half was built with the other in mind, a rebuild starts once the merged tree is clearly worse than both.
+    tree.cost = std::max(old.cost, added.cost);
+    m_tree = std::move(tree);
+
+    // Old objects keep their item positions, so only their leaf indices move and only new objects are written out.
+    for (uint32_t& leaf : m_item_leaves)
+    {
+        leaf = OldIndex(leaf);
+    }
+    m_item_leaves.resize(m_bounds.size());
+    m_item_positions.resize(m_bounds.size());
+    m_leaf_culler.Resize(static_cast<uint32_t>(m_tree.items.size()));
+    for (uint32_t i = AddedIndex(0); i < m_tree.nodes.size(); ++i)
+    {
+        const auto& node = m_tree.nodes[i];
+        if (!node.IsLeaf() || node.first < first_item) continue;
+        for (uint32_t j = node.first; j < node.first + node.count; ++j)
+        {
+            m_item_leaves[m_tree.items[j]] = i;
+            m_item_positions[m_tree.items[j]] = j;
+            m_leaf_culler.SetBounds(j, m_bounds[m_tree.items[j]]);
+        }
+    }
+
+    std::vector<uint8_t> dirty_nodes(m_tree.nodes.size(), 0);
+    for (uint32_t i = 0; i < old_node_count; ++i)
+    {
+        dirty_nodes[OldIndex(i)] = m_dirty_nodes[i];
+    }
+    m_dirty_nodes = std::move(dirty_nodes);
+    m_cost = ComputeCost(m_tree.nodes);
+    RebuildIfDegraded();
+}
+
+void Bvh::Update(const uint32_t index, const Bounds& bounds)
+{
+    m_empty_count += !bounds.box.IsValid();
+    m_empty_count -= !m_bounds[index].box.IsValid();
+    m_bounds[index] = bounds;
+    m_leaf_culler.SetBounds(m_item_positions[index], bounds);
+    m_dirty_nodes[m_item_leaves[index]] = 1;
+    m_refit_pending = true;
+}
+
+void Bvh::Refit()
+{
+    CPU_ZONE("BVH Refit");
+    if (m_rebuild.valid() && m_rebuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        // The new tree was built from a snapshot, so every leaf is refit to catch up with later updates.
+        SetTree(m_rebuild.get());
+        for (size_t i = 0; i < m_tree.nodes.size(); ++i)
+        {
+            m_dirty_nodes[i] = m_tree.nodes[i].IsLeaf();
+        }
+        m_refit_pending = true;
+    }
+    if (!m_refit_pending) return;
+    m_refit_pending = false;
+
+    // Children are always stored after their parent, so a reverse sweep visits them first.
+    auto& nodes = m_tree.nodes;
+    for (size_t i = nodes.size(); i-- > 0;)
+    {
+        if (!m_dirty_nodes[i]) continue;
+        m_dirty_nodes[i] = 0;
+
+        auto& node = nodes[i];
+        BoundingBox box;
+        if (node.IsLeaf())
+        {
+            for (uint32_t j = node.first; j < node.first + node.count; ++j)
+            {
+                box.Expand(m_bounds[m_tree.items[j]].box);
+            }
+        }
+        else
+        {
+            box = nodes[node.left].box;
+            box.Expand(nodes[node.left + 1].box);
+        }
+        node.box = box;
+        if (i != 0)
+        {
+            m_dirty_nodes[m_tree.parents[i]] = 1;
+        }
+    }
+
+    m_cost = ComputeCost(nodes);
+    RebuildIfDegraded();
+}
+
+void Bvh::RebuildIfDegraded()
+{
+    if (m_rebuild.valid() || m_cost <= m_tree.cost * REBUILD_THRESHOLD) return;
+
+    std::vector<BoundingBox> boxes(m_bounds.size());
+    std::ranges::transform(m_bounds, boxes.begin(), &Bounds::box);
+    m_rebuild = std::async(std::launch::async, &Bvh::BuildTree, std::move(boxes));
+}
+
+Bvh::Tree Bvh::BuildTree(std::vector<BoundingBox> boxes)
+{
+    CPU_ZONE("BVH Build Tree");
+    Tree tree;
+    const auto count = static_cast<uint32_t>(boxes.size());
+    if (count == 0) return tree;
+
+    std::vector<glm::vec3> centroids(count);
+    std::ranges::transform(boxes, centroids.begin(), &BoundingBox::GetCenter);
+    tree.items.resize(count);
+    std::iota(tree.items.begin(), tree.items.end(), 0u);
+    tree.nodes.reserve(count * 2);
+    tree.parents.reserve(count * 2);
+    tree.nodes.push_back({ .first = 0, .count = count });
+    tree.parents.push_back(0);
+
+    std::vector<uint32_t> stack{ 0 };
+    while (!stack.empty())
+    {
+        const uint32_t node_index = stack.back();
+        stack.pop_back();
+        const Node node = tree.nodes[node_index];
+
+        BoundingBox box;
+        BoundingBox centroid_box;
+        for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            box.Expand(boxes[tree.items[i]]);
+            centroid_box.Expand(centroids[tree.items[i]]);
+        }
+        tree.nodes[node_index].box = box;
+        if (node.count <= MAX_LEAF_SIZE) continue;
+
+        const glm::vec3 extent = centroid_box.max - centroid_box.min;
+        int axis = 0;
+        if (extent.y > extent[axis]) axis = 1;
+        if (extent.z > extent[axis]) axis = 2;
+
+        uint32_t* begin = tree.items.data() + node.first;
+        uint32_t* end = begin + node.count;
+        uint32_t* middle = begin;
+        if (extent[axis] > 0.f)
+        {
+            const float scale = static_cast<float>(BIN_COUNT) / extent[axis];
+            auto GetBin = [&](const uint32_t item)
+            {
+                const auto bin = static_cast<uint32_t>((centroids[item][axis] - centroid_box.min[axis]) * scale);
+                return std::min(bin, BIN_COUNT - 1);
+            };
+
+            std::array<BoundingBox, BIN_COUNT> bin_boxes;
+            std::array<uint32_t, BIN_COUNT> bin_counts{};
+            for (const uint32_t* item = begin; item != end; ++item)
+            {
+                const uint32_t bin = GetBin(*item);
+                bin_boxes[bin].Expand(boxes[*item]);
+                ++bin_counts[bin];
+            }
+
+            std::array<float, BIN_COUNT> right_costs{};
+            BoundingBox right_box;
+            uint32_t right_count = 0;
+            for (uint32_t bin = BIN_COUNT - 1; bin > 0; --bin)
+            {
+                right_box.Expand(bin_boxes[bin]);
+                right_count += bin_counts[bin];
+                right_costs[bin - 1] = SurfaceArea(right_box) * static_cast<float>(right_count);
+            }
+
+            BoundingBox left_box;
+            uint32_t left_count = 0;
+            float best_cost = std::numeric_limits<float>::max();
+            uint32_t best_bin = 0;
+            for (uint32_t bin = 0; bin + 1 < BIN_COUNT; ++bin)
+            {
+                left_box.Expand(bin_boxes[bin]);
+                left_count += bin_counts[bin];
+                const float cost = SurfaceArea(left_box) * static_cast<float>(left_count) + right_costs[bin];
+                if (left_count > 0 && left_count < node.count && cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_bin = bin;
+                }
+            }
+            middle = std::partition(begin, end, [&](const uint32_t item) { return GetBin(item) <= best_bin; });
+        }
+
+        // Every centroid landed in one bin, fall back to splitting at the median.
+        if (middle == begin || middle == end)
+        {
+            middle = begin + node.count / 2;
+            std::nth_element(begin,
+                             middle,
+                             end,
+                             [&](const uint32_t a, const uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+        }
+
+        const auto left_count = static_cast<uint32_t>(middle - begin);
+        const auto left = static_cast<uint32_t>(tree.nodes.size());
+        tree.nodes[node_index].left = left;
+        tree.nodes.push_back({ .first = node.first, .count = left_count });
+        tree.nodes.push_back({ .first = node.first + left_count, .count = node.count - left_count });
+        tree.parents.push_back(node_index);
+        tree.parents.push_back(node_index);
+        stack.push_back(left);
+        stack.push_back(left + 1);
+    }
+
+    tree.cost = ComputeCost(tree.nodes);
+    return tree;
+}
+
+float Bvh::ComputeCost(const std::span<const Node> nodes)
+{
+    if (nodes.empty()) return 0.f;
+    const float root_area = SurfaceArea(nodes[0].box);
+    if (root_area <= 0.f) return 0.f;
+
+    // Unit cost per traversal step and per object test, weighted by the chance a random ray hits the node.
+    float cost = 0.f;
+    for (const auto& node : nodes)
+    {
+        cost += SurfaceArea(node.box) * (node.IsLeaf() ? static_cast<float>(node.count) : 1.f);
+    }
+    return cost / root_area;
+}
+
+void Bvh::SetTree(Tree tree)
+{
+    m_tree = std::move(tree);
+    m_item_leaves.resize(m_bounds.size());
+    m_item_positions.resize(m_bounds.size());
+    for (uint32_t i = 0; i < m_tree.nodes.size(); ++i)
+    {
+        const auto& node = m_tree.nodes[i];
+        if (!node.IsLeaf()) continue;
+        for (uint32_t j = node.first; j < node.first + node.count; ++j)
+        {
+            m_item_leaves[m_tree.items[j]] = i;
+            m_item_positions[m_tree.items[j]] = j;
+        }
+    }
+
+    m_leaf_culler.Resize(static_cast<uint32_t>(m_tree.items.size()));
+    for (uint32_t i = 0; i < m_tree.items.size(); ++i)
+    {
+        m_leaf_culler.SetBounds(i, m_bounds[m_tree.items[i]]);
+    }
+    m_dirty_nodes.assign(m_tree.nodes.size(), 0);
+    m_cost = m_tree.cost;
+}
+
+void Bvh::AppendItems(const Node& node, std::vector<uint32_t>& results) const
+{
+    const auto items = std::span(m_tree.items).subspan(node.first, node.count);
+    if (m_empty_count == 0)
+    {
+        results.insert_range(results.end(), items);
+        return;
+    }
+    for (const uint32_t item : items)
+    {
+        if (m_bounds[item].box.IsValid())
+        {
+            results.push_back(item);
+        }
+    }
+}
+
+void Bvh::QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& results) const
+{
+    QueryFrustums(std::span(&frustum, 1), std::span(&results, 1));
+}
+
+void Bvh::QueryFrustums(const std::span<const Frustum> frustums, const std::span<std::vector<uint32_t>> results) const
+{
+    CPU_ZONE("BVH Frustum Query");
+    if (m_tree.nodes.empty()) return;
+
+    // Each frustum is a bit in the mask, it is dropped once a node is fully inside or outside of it.
+    constexpr size_t batch_size = 32;
+    for (size_t batch = 0; batch < frustums.size(); batch += batch_size)
+    {
+        const size_t batch_count = std::min(batch_size, frustums.size() - batch);
+        const auto all = static_cast<uint32_t>((uint64_t(1) << batch_count) - 1);
+        std::vector<std::pair<uint32_t, uint32_t>> stack{ { 0, all } };
+        while (!stack.empty())
+        {
+            const auto [node_index, mask] = stack.back();
+            stack.pop_back();
+            const auto& node = m_tree.nodes[node_index];
+
+            uint32_t partial = 0;
+            for (uint32_t bits = mask; bits; bits &= bits - 1)
+            {
+                const auto query = static_cast<uint32_t>(std::countr_zero(bits));
+                const auto& frustum = frustums[batch + query];
+                auto& result = results[batch + query];
+                switch (Classify(frustum, node.box))
+                {
+                case Overlap::eOutside:
+                    break;
+                case Overlap::eInside:
+                    AppendItems(node, result);
+                    break;
+                case Overlap::eIntersects:
+                    if (node.IsLeaf())
+                    {
+                        const size_t offset = result.size();
+                        m_leaf_culler.Cull(frustum, node.first, node.count, result);
+                        for (size_t i = offset; i < result.size(); ++i)
+                        {
+                            result[i] = m_tree.items[result[i]];
+                        }
+                    }
+                    else
+                    {
+                        partial |= 1u << query;
+                    }
+                    break;
+                }
+            }
+
+            if (partial)
+            {
+                stack.emplace_back(node.left + 1, partial);
+                stack.emplace_back(node.left, partial);
+            }
+        }
+    }
+}
+
+void Bvh::QuerySphere(const BoundingSphere& sphere, std::vector<uint32_t>& results) const
+{
+    QuerySpheres(std::span(&sphere, 1), std::span(&results, 1));
+}
+
+void Bvh::QuerySpheres(const std::span<const BoundingSphere> spheres, const std::span<std::vector<uint32_t>> results) const
+{
+    CPU_ZONE("BVH Sphere Query");
+    if (m_tree.nodes.empty()) return;
+
+    std::vector<uint32_t> stack;
+    for (size_t query = 0; query < spheres.size(); ++query)
+    {
+        const auto& sphere = spheres[query];
+        stack.assign(1, 0);
+        while (!stack.empty())
+        {
+            const auto& node = m_tree.nodes[stack.back()];
+            stack.pop_back();
+            if (!Overlaps(sphere, node.box)) continue;
+
+            if (!node.IsLeaf())
+            {
+                stack.push_back(node.left + 1);
+                stack.push_back(node.left);
+                continue;
+            }
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                const uint32_t item = m_tree.items[i];
+                if (Overlaps(sphere, m_bounds[item].box))
+                {
+                    results[query].push_back(item);
+                }
+            }
+        }
+    }
+}
+
+void Bvh::QueryBox(const BoundingBox& box, std::vector<uint32_t>& results) const
+{
+    QueryBoxes(std::span(&box, 1), std::span(&results, 1));
+}
+
+void Bvh::QueryBoxes(const std::span<const BoundingBox> boxes, const std::span<std::vector<uint32_t>> results) const
+{
+    CPU_ZONE("BVH Box Query");
+    if (m_tree.nodes.empty()) return;
+
+    std::vector<uint32_t> stack;
+    for (size_t query = 0; query < boxes.size(); ++query)
+    {
+        const auto& box = boxes[query];
+        stack.assign(1, 0);
+        while (!stack.empty())
+        {
+            const auto& node = m_tree.nodes[stack.back()];
+            stack.pop_back();
+            if (!Overlaps(box, node.box)) continue;
+
+            if (!node.IsLeaf())
+            {
+                stack.push_back(node.left + 1);
+                stack.push_back(node.left);
+                continue;
+            }
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                const uint32_t item = m_tree.items[i];
+                if (Overlaps(box, m_bounds[item].box))
+                {
+                    results[query].push_back(item);
+                }
+            }
+        }
+    }
+}
+
+std::optional<RayHit> Bvh::Raycast(const Ray& ray, const float max_distance, const RayIntersector& intersect) const
+{
+    std::optional<RayHit> hit;
+    if (m_tree.nodes.empty()) return hit;
+
+    const glm::vec3 inv_direction = InverseDirection(ray.direction);
+    float closest = max_distance;
+    std::vector<std::pair<uint32_t, float>> stack;
+    if (const auto distance = Intersect(m_tree.nodes[0].box, ray.origin, inv_direction, closest))
+    {
+        stack.emplace_back(0, *distance);
+    }
+
+    // Children are visited nearest first so most of the far side of the tree is rejected by the closest hit.
+    while (!stack.empty())
+    {
+        const auto [node_index, node_distance] = stack.back();
+        stack.pop_back();
+        if (node_distance > closest) continue;
+
+        const auto& node = m_tree.nodes[node_index];
+        if (node.IsLeaf())
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                const uint32_t item = m_tree.items[i];
+                const auto& box = m_bounds[item].box;
+                auto distance = Intersect(box, ray.origin, inv_direction, closest);
+                if (!distance) continue;
+                if (intersect)
+                {
+                    distance = intersect(item, ray, closest);
+                }
+                else if (Contains(box, ray.origin))
+                {
+                    continue;
+                }
+                if (distance && *distance <= closest)
+                {
+                    closest = *distance;
+                    hit = RayHit{ .index = item, .distance = *distance };
+                }
+            }
+            continue;
+        }
+
+        auto near = Intersect(m_tree.nodes[node.left].box, ray.origin, inv_direction, closest);
+        auto far = Intersect(m_tree.nodes[node.left + 1].box, ray.origin, inv_direction, closest);
+        uint32_t near_index = node.left;
+        uint32_t far_index = node.left + 1;
+        if (far && (!near || *far < *near))
+        {
+            std::swap(near, far);
+            std::swap(near_index, far_index);
+        }
+        if (far)
+        {
+            stack.emplace_back(far_index, *far);
+        }
+        if (near)
+        {
+            stack.emplace_back(near_index, *near);
+        }
+    }
+    return hit;
+}
+
+void Bvh::Raycast(const std::span<const Ray> rays, const std::span<std::optional<RayHit>> hits) const
+{
+    CPU_ZONE("BVH Raycast");
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        hits[i] = Raycast(rays[i]);
+    }
+}
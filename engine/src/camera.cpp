@@ -9,6 +9,30 @@ glm::vec4 NormalizePlane(const glm::vec4 p)
     return p / len;
 }
 
+bool Frustum::Intersects(const BoundingSphere& sphere) const
+{
+    for (const auto& plane : planes)
+    {
+        if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius) return false;
+    }
+    return true;
+}
+
+bool Frustum::Intersects(const BoundingBox& box) const
+{
+    // An empty box holds nothing, and its infinite extents would turn the plane distances into NaN.
+    if (!box.IsValid()) return false;
+
+    const glm::vec3 center = box.GetCenter();
+    const glm::vec3 extents = box.GetExtents();
+    for (const auto& plane : planes)
+    {
+        const float radius = glm::dot(extents, glm::abs(glm::vec3(plane)));
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+    }
+    return true;
+}
+
 Frustum Camera::CreateFrustum() const
 {
     auto vp = m_proj_matrix * m_view_matrix;
@@ -40,6 +64,16 @@ Frustum Camera::CreateFrustum(const glm::mat4& view_proj)
     return frustum;
 }
 
+Ray Camera::ScreenPointToRay(const glm::vec2 ndc) const
+{
+    const glm::mat4 inv_view_proj = glm::inverse(m_proj_matrix * m_view_matrix);
+    glm::vec4 near_point = inv_view_proj * glm::vec4(ndc, 0.f, 1.f);
+    glm::vec4 far_point = inv_view_proj * glm::vec4(ndc, 1.f, 1.f);
+    near_point /= near_point.w;
+    far_point /= far_point.w;
+    return { .origin = glm::vec3(near_point), .direction = glm::normalize(glm::vec3(far_point - near_point)) };
+}
+
 void Camera::Update(const float delta_time)
 {
     auto& input = m_engine->GetInput();
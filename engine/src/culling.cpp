@@ -0,0 +1,194 @@
+#include "culling.hpp"
+#include "profiler.hpp"
+#include <immintrin.h>
+
+void FrustumCuller::Resize(const uint32_t count)
+{
+    // Padded by the widest batch so the SIMD loops never read past the end from any start, the tail lanes are masked off.
+    const uint32_t padded = count + 7;
+    m_count = count;
+    for (auto* values : { &m_sphere_x,
+                          &m_sphere_y,
+                          &m_sphere_z,
+                          &m_sphere_radius,
+                          &m_box_x,
+                          &m_box_y,
+                          &m_box_z,
+                          &m_extent_x,
+                          &m_extent_y,
+                          &m_extent_z })
+    {
+        values->resize(padded, 0.f);
+    }
+}
+
+void FrustumCuller::SetBounds(const uint32_t index, const Bounds& bounds)
+{
+    if (!bounds.box.IsValid())
+    {
+        // Nothing to draw, a sphere of negative infinite radius fails every plane without NaNs reaching the lanes.
+        SetBounds(index, { .box = { .min = glm::vec3(0.f), .max = glm::vec3(0.f) },
+                           .sphere = { .radius = -std::numeric_limits<float>::infinity() } });
+        return;
+    }
+
+    const glm::vec3 center = bounds.box.GetCenter();
+    const glm::vec3 extents = bounds.box.GetExtents();
+    m_sphere_x[index] = bounds.sphere.center.x;
+    m_sphere_y[index] = bounds.sphere.center.y;
+    m_sphere_z[index] = bounds.sphere.center.z;
+    m_sphere_radius[index] = bounds.sphere.radius;
+    m_box_x[index] = center.x;
+    m_box_y[index] = center.y;
+    m_box_z[index] = center.z;
+    m_extent_x[index] = extents.x;
+    m_extent_y[index] = extents.y;
+    m_extent_z[index] = extents.z;
+}
+
+bool FrustumCuller::IsVisible(const Frustum& frustum, const uint32_t index) const
+{
+    for (const auto& plane : frustum.planes)
+    {
+        const float sphere_distance =
+            plane.x * m_sphere_x[index] + plane.y * m_sphere_y[index] + plane.z * m_sphere_z[index] + plane.w;
+        if (sphere_distance < -m_sphere_radius[index]) return false;
+
+        const float box_distance = plane.x * m_box_x[index] + plane.y * m_box_y[index] + plane.z * m_box_z[index] + plane.w;
+        const float box_radius = std::abs(plane.x) * m_extent_x[index] + std::abs(plane.y) * m_extent_y[index] +
+                                 std::abs(plane.z) * m_extent_z[index];
+        if (box_distance < -box_radius) return false;
+    }
+    return true;
+}
+
+void FrustumCuller::CullScalar(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+    for (uint32_t i = 0; i < m_count; ++i)
+    {
+        if (IsVisible(frustum, i))
+        {
+            visible.push_back(i);
+        }
+    }
+}
+
+void FrustumCuller::Cull(const Frustum& frustum, const uint32_t first, const uint32_t count, std::vector<uint32_t>& visible) const
+{
+    const uint32_t end = first + count;
+    const size_t offset = visible.size();
+    visible.resize(offset + count);
+    uint32_t* out = visible.data() + offset;
+    uint32_t written = 0;
+
+#if defined(__AVX2__)
+    constexpr uint32_t lanes = 8;
+    const __m256 sign_mask = _mm256_set1_ps(-0.f);
+    std::array<std::array<__m256, 4>, 6> planes;
+    std::array<std::array<__m256, 3>, 6> abs_planes;
+    for (size_t p = 0; p < 6; ++p)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            abs_planes[p][c] = _mm256_andnot_ps(sign_mask, planes[p][c]);
+        }
+    }
+
+    for (uint32_t base = first; base < end; base += lanes)
+    {
+        const __m256 sx = _mm256_loadu_ps(&m_sphere_x[base]);
+        const __m256 sy = _mm256_loadu_ps(&m_sphere_y[base]);
+        const __m256 sz = _mm256_loadu_ps(&m_sphere_z[base]);
+        const __m256 neg_radius = _mm256_xor_ps(_mm256_loadu_ps(&m_sphere_radius[base]), sign_mask);
+        const __m256 bx = _mm256_loadu_ps(&m_box_x[base]);
+        const __m256 by = _mm256_loadu_ps(&m_box_y[base]);
+        const __m256 bz = _mm256_loadu_ps(&m_box_z[base]);
+        const __m256 ex = _mm256_loadu_ps(&m_extent_x[base]);
+        const __m256 ey = _mm256_loadu_ps(&m_extent_y[base]);
+        const __m256 ez = _mm256_loadu_ps(&m_extent_z[base]);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t p = 0; p < 6; ++p)
+        {
+            const auto& [px, py, pz, pw] = planes[p];
+            const __m256 sphere_distance =
+                _mm256_fmadd_ps(px, sx, _mm256_fmadd_ps(py, sy, _mm256_fmadd_ps(pz, sz, pw)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(sphere_distance, neg_radius, _CMP_GE_OQ));
+
+            const __m256 box_distance = _mm256_fmadd_ps(px, bx, _mm256_fmadd_ps(py, by, _mm256_fmadd_ps(pz, bz, pw)));
+            const __m256 box_radius = _mm256_fmadd_ps(abs_planes[p][0],
+                                                      ex,
+                                                      _mm256_fmadd_ps(abs_planes[p][1], ey, _mm256_mul_ps(abs_planes[p][2], ez)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(box_distance, _mm256_xor_ps(box_radius, sign_mask), _CMP_GE_OQ));
+        }
+
+        auto mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+#elif defined(__SSE2__) || defined(_M_X64)
+    constexpr uint32_t lanes = 4;
+    const __m128 sign_mask = _mm_set1_ps(-0.f);
+    std::array<std::array<__m128, 4>, 6> planes;
+    std::array<std::array<__m128, 3>, 6> abs_planes;
+    for (size_t p = 0; p < 6; ++p)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            abs_planes[p][c] = _mm_andnot_ps(sign_mask, planes[p][c]);
+        }
+    }
+
+    for (uint32_t base = first; base < end; base += lanes)
+    {
+        const __m128 sx = _mm_loadu_ps(&m_sphere_x[base]);
+        const __m128 sy = _mm_loadu_ps(&m_sphere_y[base]);
+        const __m128 sz = _mm_loadu_ps(&m_sphere_z[base]);
+        const __m128 neg_radius = _mm_xor_ps(_mm_loadu_ps(&m_sphere_radius[base]), sign_mask);
+        const __m128 bx = _mm_loadu_ps(&m_box_x[base]);
+        const __m128 by = _mm_loadu_ps(&m_box_y[base]);
+        const __m128 bz = _mm_loadu_ps(&m_box_z[base]);
+        const __m128 ex = _mm_loadu_ps(&m_extent_x[base]);
+        const __m128 ey = _mm_loadu_ps(&m_extent_y[base]);
+        const __m128 ez = _mm_loadu_ps(&m_extent_z[base]);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t p = 0; p < 6; ++p)
+        {
+            const auto& [px, py, pz, pw] = planes[p];
+            const __m128 sphere_distance =
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, sx), _mm_mul_ps(py, sy)), _mm_add_ps(_mm_mul_ps(pz, sz), pw));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(sphere_distance, neg_radius));
+
+            const __m128 box_distance =
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, bx), _mm_mul_ps(py, by)), _mm_add_ps(_mm_mul_ps(pz, bz), pw));
+            const __m128 box_radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_planes[p][0], ex), _mm_mul_ps(abs_planes[p][1], ey)),
+                                                 _mm_mul_ps(abs_planes[p][2], ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(box_distance, _mm_xor_ps(box_radius, sign_mask)));
+        }
+
+        auto mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+#else
+    constexpr uint32_t lanes = 1;
+    for (uint32_t base = first; base < end; base += lanes)
+    {
+        uint32_t mask = IsVisible(frustum, base) ? 1u : 0u;
+#endif
+        if (end - base < lanes)
+        {
+            mask &= (1u << (end - base)) - 1u;
+        }
+        while (mask)
+        {
+            out[written++] = base + static_cast<uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+    }
+
+    visible.resize(offset + written);
+}
@@ -0,0 +1,50 @@
+#include "draw_sort.hpp"
+
+uint64_t DrawSorter::CreateKey(const DrawOrder order,
+                               const DrawPass pass,
+                               const uint8_t pipeline,
+                               const uint16_t material,
+                               const float depth)
+{
+    const uint64_t depth_bits = std::bit_cast<uint32_t>(std::max(depth, 0.f));
+    const uint64_t key = static_cast<uint64_t>(pass) << 56 | static_cast<uint64_t>(pipeline) << 48;
+    if (order == DrawOrder::eFrontToBack)
+    {
+        return key | depth_bits << 16 | material;
+    }
+    return key | static_cast<uint64_t>(material) << 32 | depth_bits;
+}
+
+void DrawSorter::Sort(const std::span<DrawSortItem> items)
+{
+    constexpr uint32_t DIGIT_COUNT = 8;
+    std::array<std::array<uint32_t, 256>, DIGIT_COUNT> histograms{};
+    for (const auto& item : items)
+    {
+        for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit)
+        {
+            ++histograms[digit][(item.key >> (digit * 8)) & 0xFF];
+        }
+    }
+
+    m_scratch.resize(items.size());
+    std::span<DrawSortItem> src = items;
+    std::span<DrawSortItem> dst = m_scratch;
+    for (uint32_t digit = 0; digit < DIGIT_COUNT; ++digit)
+    {
+        auto& offsets = histograms[digit];
+        if (std::ranges::find(offsets, static_cast<uint32_t>(items.size())) != offsets.end()) continue;
+
+        std::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin(), 0u);
+        for (const auto& item : src)
+        {
+            dst[offsets[(item.key >> (digit * 8)) & 0xFF]++] = item;
+        }
+        std::swap(src, dst);
+    }
+
+    if (src.data() != items.data())
+    {
+        std::ranges::copy(src, items.begin());
+    }
+}
@@ -2,6 +2,12 @@
 #include "engine.hpp"
 #include "imgui.h"
 
+Editor::~Editor()
+{
+    // The sweep job writes into the editor, so it has to finish first.
+    m_engine->GetJobSystem().Wait(m_meshlet_sweep);
+}
+
 void Editor::Render(const uint64_t* image_handle)
 {
 
@@ -11,6 +17,14 @@ void Editor::Render(const uint64_t* image_handle)
                  ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoScrollbar |
                      ImGuiWindowFlags_NoScrollWithMouse);
     ImGui::Image(*image_handle, ImGui::GetContentRegionAvail());
+    if (ImGui::IsItemClicked(ImGuiMouseButton_Left))
+    {
+        const ImVec2 min = ImGui::GetItemRectMin();
+        const ImVec2 size = ImGui::GetItemRectSize();
+        const ImVec2 mouse = ImGui::GetMousePos();
+        const glm::vec2 uv((mouse.x - min.x) / size.x, (mouse.y - min.y) / size.y);
+        PickActor(glm::vec2(uv.x * 2.f - 1.f, 1.f - uv.y * 2.f));
+    }
 
     if (ImGui::BeginDragDropTarget())
     {
@@ -28,9 +42,20 @@ void Editor::Render(const uint64_t* image_handle)
 
     ImGui::End();
     UpdateRenderSettings();
+    UpdateMeshletTuner();
     m_content_browser.Render();
 }
 
+void Editor::PickActor(const glm::vec2 ndc)
+{
+    const auto ray = m_engine->GetCamera().ScreenPointToRay(ndc);
+    m_selected_hit = m_engine->GetRenderer().Raycast(ray);
+    m_selected_actor = {};
+    if (!m_selected_hit) return;
+
+    m_selected_actor = m_engine->GetScene().FindRenderableOwner(m_selected_hit->index).value_or(ActorHandle{});
+}
+
 void Editor::UpdateRenderSettings()
 {
     ImGui::Begin("Render Settings");
@@ -43,34 +68,47 @@ void Editor::UpdateRenderSettings()
         ImGui::DragFloat("Grass LOD Distance", &grass_pass.lod_distance);
         ImGui::Checkbox("Apply View Space Thickening", &grass_pass.apply_view_space_thicken);
 
+        auto budget = static_cast<int>(grass_pass.upload_budget);
+        if (ImGui::DragInt("Patch Upload Budget", &budget, 256.f, 1, 1 << 24))
+        {
+            grass_pass.upload_budget = static_cast<uint32_t>(budget);
+        }
+        ImGui::Text("Patches: %u / %zu uploaded, %u sent last frame",
+                    grass_pass.uploaded_count,
+                    grass_pass.patches.size(),
+                    grass_pass.sent_patches);
+        const auto& scatter = grass_pass.scatter.GetStats();
+        ImGui::Text("Scattered %u from %u candidates in %u tiles, %.1f ms, %.0f per second",
+                    scatter.patches,
+                    scatter.candidates,
+                    scatter.tiles,
+                    scatter.build_ms,
+                    scatter.patches_per_second);
+
         if (ImGui::Button("Add Grass Patch"))
         {
             grass_pass.patches.emplace_back(GrassPatch{});
-            grass_pass.buffer.Write(grass_pass.patches.data(), 0, sizeof(GrassPatch) * grass_pass.patches.size());
+            grass_pass.dirty_patches.Mark(static_cast<uint32_t>(grass_pass.patches.size() - 1));
         }
 
-        bool update_patches = false;
-        for (uint32_t i = 0; i < grass_pass.patches.size(); ++i)
+        // Scattered grass runs to millions of patches, only the rows in view are built.
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(grass_pass.patches.size()));
+        while (clipper.Step())
         {
-            ImGui::PushID(("Grass " + std::to_string(i)).c_str());
-            auto& patch = grass_pass.patches[i];
-            if (ImGui::DragFloat3("Position", glm::value_ptr(patch.position)))
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
             {
-                update_patches = true;
-            }
-            if (ImGui::DragFloat("Height", &patch.height))
-            {
-                update_patches = true;
-            }
-            if (ImGui::DragFloat("Radius", &patch.radius))
-            {
-                update_patches = true;
+                ImGui::PushID(i);
+                auto& patch = grass_pass.patches[i];
+                bool changed = ImGui::DragFloat3("Position", glm::value_ptr(patch.position));
+                changed |= ImGui::DragFloat("Height", &patch.height);
+                changed |= ImGui::DragFloat("Radius", &patch.radius);
+                if (changed)
+                {
+                    grass_pass.dirty_patches.Mark(static_cast<uint32_t>(i));
+                }
+                ImGui::PopID();
             }
-            ImGui::PopID();
-        }
-        if (update_patches)
-        {
-            grass_pass.buffer.Write(grass_pass.patches.data(), 0, sizeof(GrassPatch) * grass_pass.patches.size());
         }
     }
 
@@ -89,70 +127,294 @@ void Editor::UpdateRenderSettings()
 
     auto& camera = m_engine->GetCamera();
     ImGui::DragFloat("Move Speed", &camera.m_move_speed);
-    auto dir_lights = renderer.GetDirectionalLights();
     if (ImGui::CollapsingHeader("Lights"))
     {
         if (ImGui::Button("Add Directional Light"))
         {
-            renderer.AddDirectionalLight({});
+            renderer.AddDirectionalLight({ .direction = glm::vec3(0.f, -1.f, 0.f) });
         }
 
-        for (int i = 0; i < dir_lights.size(); ++i)
+        // Lights move when others are added or removed, so each row is edited through the handle of its slot.
+        const auto& dir_lights = renderer.GetDirectionalLights();
+        for (uint32_t i = 0; i < dir_lights.GetCount(); ++i)
         {
-            auto& dir_light = dir_lights[i];
-            auto& euler = renderer.m_dir_light_eulers[i];
-            ImGui::PushID(i);
-            if (ImGui::SliderFloat3("Light Rotation (Euler)", glm::value_ptr(euler), -180.0f, 180.0f))
+            const auto handle = dir_lights.GetHandle(i);
+            auto dir_light = *dir_lights.Get(handle);
+            auto euler = dir_light.GetDirectionEuler();
+            ImGui::PushID(static_cast<int>(handle.index));
+            bool changed = ImGui::SliderFloat2("Light Rotation (Euler)", glm::value_ptr(euler), -180.0f, 180.0f);
+            if (changed)
             {
-                glm::mat4 rot = glm::yawPitchRoll(glm::radians(euler.y), glm::radians(euler.x), glm::radians(euler.z));
-                auto forward = glm::vec3(0.0f, 0.0f, -1.0f);
-                dir_light.direction = glm::normalize(glm::vec3(rot * glm::vec4(forward, 0.0f)));
-                m_rebuild_lights = true;
+                dir_light.SetDirectionEuler(euler);
             }
-
-            if (ImGui::DragFloat("Intensity", &dir_light.intensity))
+            changed |= ImGui::DragFloat("Intensity", &dir_light.intensity);
+            changed |= ImGui::DragFloat3("Color", glm::value_ptr(dir_light.color));
+            bool cast_shadows = dir_light.cast_shadows;
+            if (ImGui::Checkbox("Cast Shadows", &cast_shadows))
             {
-                m_rebuild_lights = true;
+                dir_light.cast_shadows = cast_shadows;
+                changed = true;
             }
-            if (ImGui::DragFloat3("Color", glm::value_ptr(dir_light.color)))
+            if (changed)
             {
-                m_rebuild_lights = true;
+                renderer.UpdateDirectionalLight(handle, dir_light);
+            }
+            if (ImGui::Button("Remove"))
+            {
+                renderer.RemoveDirectionalLight(handle);
+                --i;
             }
             ImGui::PopID();
         }
+
+        auto budget = static_cast<int>(renderer.GetLightUpdateBudget());
+        if (ImGui::DragInt("Light Update Budget", &budget, 16.f, 1, 1 << 20))
+        {
+            renderer.SetLightUpdateBudget(static_cast<uint32_t>(budget));
+        }
+        ImGui::Text("Pending Light Updates: %u",
+                    renderer.GetPointLights().GetPendingCount() + renderer.GetDirectionalLights().GetPendingCount());
+        const auto& clusters = renderer.GetLightClusters().GetStats();
+        ImGui::Text("Point Lights: %u, %u cluster indices", clusters.lights, clusters.indices);
+        ImGui::Text("Clusters: %u / %u occupied, at most %u lights, %.3f ms",
+                    clusters.occupied_clusters,
+                    LightClusterGrid::CLUSTER_COUNT,
+                    clusters.max_cluster_lights,
+                    clusters.build_ms);
+    }
+
+    if (ImGui::CollapsingHeader("Shadows"))
+    {
+        auto& cascades = renderer.m_shadow_pass.cascades;
+        auto settings = cascades.GetSettings();
+        auto count = static_cast<int>(settings.count);
+        bool changed = ImGui::SliderInt("Cascades", &count, 1, static_cast<int>(ShadowCascades::MAX_CASCADES));
+        changed |= ImGui::SliderFloat("Split Lambda", &settings.lambda, 0.f, 1.f);
+        changed |= ImGui::DragFloat("Max Distance", &settings.max_distance, 1.f, 1.f, 5000.f);
+        if (changed)
+        {
+            settings.count = static_cast<uint32_t>(count);
+            cascades.SetSettings(settings);
+        }
+        const auto fitted = cascades.GetCascades();
+        const auto levels = renderer.m_shadow_pass.cache.GetLevels();
+        for (uint32_t i = 0; i < fitted.size(); ++i)
+        {
+            const auto& cascade = fitted[i];
+            ImGui::Text("Cascade %u: %.1f - %.1f m, %.3f m texels, %dx%d tiles",
+                        i,
+                        cascade.near_depth,
+                        cascade.split_depth,
+                        2.f * cascade.bounds.radius / static_cast<float>(settings.resolution),
+                        levels[i].count.x,
+                        levels[i].count.y);
+        }
+
+        auto& cache = renderer.m_shadow_pass.cache;
+        auto budget = static_cast<int>(renderer.m_shadow_pass.tile_budget);
+        if (ImGui::SliderInt("Tile Budget", &budget, 1, static_cast<int>(ShadowTileCache::MAX_RENDERS)))
+        {
+            renderer.m_shadow_pass.tile_budget = static_cast<uint32_t>(budget);
+        }
+        const auto& stats = cache.GetStats();
+        ImGui::Text("Tiles: %u / %u resident, %u missing", stats.resident, ShadowTileCache::PAGE_COUNT, stats.missing);
+        ImGui::Text("Redrawn: %u of %u requested, %u invalidated, %u evicted",
+                    stats.redrawn,
+                    stats.requested,
+                    stats.invalidated,
+                    stats.evicted);
+        if (ImGui::Button("Clear Tiles"))
+        {
+            cache.Clear();
+        }
+    }
+
+    auto& occlusion_pass = renderer.GetOcclusionPass();
+    if (ImGui::CollapsingHeader("Occlusion Culling"))
+    {
+        ImGui::Checkbox("Enabled", &occlusion_pass.enabled);
+        const auto& stats = occlusion_pass.culler.GetStats();
+        const float cull_rate = stats.tested ? static_cast<float>(stats.occluded) / static_cast<float>(stats.tested) : 0.f;
+        ImGui::Text("Occluders: %u (%u triangles)",
+                    static_cast<uint32_t>(occlusion_pass.instances.size()),
+                    stats.occluder_triangles);
+        ImGui::Text("Occluded: %u / %u (%.1f%%)", stats.occluded, stats.tested, cull_rate * 100.f);
+        if (ImGui::Button("Save Depth"))
+        {
+            occlusion_pass.culler.SaveDepth("occlusion_depth.pgm");
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Draw Order"))
+    {
+        constexpr std::array orders = { "Submission", "Front To Back", "Material" };
+        const auto order_combo = [&](const char* label, DrawOrder& order)
+        {
+            int current = static_cast<int>(order);
+            if (ImGui::Combo(label, &current, orders.data(), static_cast<int>(orders.size())))
+            {
+                order = static_cast<DrawOrder>(current);
+            }
+        };
+        order_combo("Depth Prepass", renderer.m_depth_prepass.order);
+        order_combo("Geometry", renderer.m_geometry_order);
+        order_combo("Shadows", renderer.m_shadow_pass.order);
+    }
+
+    if (ImGui::CollapsingHeader("Selection"))
+    {
+        const auto& bvh = renderer.GetBvh();
+        ImGui::Text("BVH: %u objects, %u nodes", bvh.GetCount(), bvh.GetNodeCount());
+        ImGui::Text("SAH Cost: %.1f (built %.1f)%s",
+                    bvh.GetCost(),
+                    bvh.GetBuildCost(),
+                    bvh.IsRebuilding() ? ", rebuilding" : "");
+        if (m_selected_hit)
+        {
+            ImGui::Text("Renderable %u at %.2f", m_selected_hit->index, m_selected_hit->distance);
+        }
+        if (const auto actor = m_engine->GetScene().GetActor(m_selected_actor); actor.IsValid())
+        {
+            const auto bounds = actor.GetBounds();
+            auto transform = actor.GetTransform();
+            ImGui::Text("Actor: %s", actor.GetName().c_str());
+            bool changed = ImGui::DragFloat3("Position", glm::value_ptr(transform.position), 0.1f);
+            changed |= ImGui::DragFloat3("Rotation", glm::value_ptr(transform.rotation), 0.01f);
+            changed |= ImGui::DragFloat3("Scale", glm::value_ptr(transform.scale), 0.01f);
+            if (changed)
+            {
+                actor.SetTransform(transform);
+            }
+            ImGui::Text("Actor Bounds: %.2f %.2f %.2f / %.2f %.2f %.2f",
+                        bounds.box.min.x,
+                        bounds.box.min.y,
+                        bounds.box.min.z,
+                        bounds.box.max.x,
+                        bounds.box.max.y,
+                        bounds.box.max.z);
+        }
     }
 
-    if (m_rebuild_lights)
+    if (ImGui::CollapsingHeader("Frame Timing"))
     {
-        constexpr ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove |
-                                           ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_AlwaysAutoResize |
-                                           ImGuiWindowFlags_NoScrollbar;
+        bool pipelined = m_engine->IsPipelined();
+        if (ImGui::Checkbox("Pipelined Rendering", &pipelined))
+        {
+            m_engine->SetPipelined(pipelined);
+        }
+        const float frame_time = ImGui::GetIO().DeltaTime * 1000.f;
+        ImGui::Text("Frame Time: %.2f ms (%.0f fps)", frame_time, frame_time > 0.f ? 1000.f / frame_time : 0.f);
+        ImGui::Text("Input To Present: %.2f ms", renderer.GetFrameLatency());
+        ImGui::Text("Uploaded: %.1f KB", static_cast<float>(renderer.GetUploadBytes()) / 1024.f);
 
-        ImGuiIO& io = ImGui::GetIO();
-        ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x - 10, 10), ImGuiCond_Always, ImVec2(1, 0));
-        ImGui::SetNextWindowFocus();
+        if (ImGui::Checkbox("Dynamic Resolution", &renderer.m_dynamic_resolution))
+        {
+            renderer.m_resolution_controller.Reset();
+        }
+        auto& controller = renderer.m_resolution_controller;
+        float target_ms = controller.GetTargetMs();
+        if (ImGui::SliderFloat("Target Frame Time", &target_ms, 4.f, 50.f, "%.1f ms"))
+        {
+            controller.SetTargetMs(target_ms);
+        }
+        ImGui::Text("Render Scale: %.0f%% (smoothed %.2f ms)", renderer.GetRenderScale() * 100.f, controller.GetFilteredMs());
 
-        ImGui::Begin("##rebuild_alert", nullptr, flags);
+        auto& timestep = m_engine->GetTimestep();
+        float tick_rate = timestep.GetTickRate();
+        if (ImGui::SliderFloat("Tick Rate", &tick_rate, 10.f, 240.f, "%.0f Hz"))
+        {
+            timestep.SetTickRate(tick_rate);
+        }
+        int max_steps = static_cast<int>(timestep.GetMaxSteps());
+        if (ImGui::SliderInt("Max Ticks Per Frame", &max_steps, 1, 16))
+        {
+            timestep.SetMaxSteps(static_cast<uint32_t>(max_steps));
+        }
+        ImGui::Text("Ticks: %u this frame, %llu total (alpha %.2f)",
+                    timestep.GetLastSteps(),
+                    static_cast<unsigned long long>(timestep.GetTickCount()),
+                    timestep.GetAlpha());
+        ImGui::Text("Dropped: %.2f s", timestep.GetDroppedTime());
+    }
 
-        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.65f, 0.35f, 0.0f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.80f, 0.45f, 0.0f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.50f, 0.25f, 0.0f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.85f, 0.0f, 1.0f));
+    if (ImGui::CollapsingHeader("GPU Buffers"))
+    {
+        for (const auto* buffer : renderer.GetGrowableBuffers())
+        {
+            ImGui::Text("%.*s: %u / %u (%.1f KB, grown %u times)",
+                        static_cast<int>(buffer->GetName().size()),
+                        buffer->GetName().data(),
+                        buffer->GetCount(),
+                        buffer->GetCapacity(),
+                        static_cast<float>(buffer->GetSizeBytes()) / 1024.f,
+                        buffer->GetGrowCount());
+        }
+        const auto& upload = renderer.GetFrameUploadBuffer();
+        const auto& ring = upload.GetRing();
+        ImGui::Text("%.*s: %.1f / %.1f KB over %u frames in flight (grown %u times)",
+                    static_cast<int>(upload.GetName().size()),
+                    upload.GetName().data(),
+                    static_cast<float>(ring.GetUsedBytes()) / 1024.f,
+                    static_cast<float>(ring.GetCapacity()) / 1024.f,
+                    ring.GetFramesInFlight(),
+                    upload.GetGrowCount());
+
+        const auto& pool = renderer.GetGeometryPool();
+        for (uint32_t i = 0; i < pool.GetPageCount(); ++i)
+        {
+            const auto& page = pool.GetPage(i);
+            ImGui::Text("Geometry Page %u", i);
+            for (const auto& [name, allocator] : {std::pair{"Vertices", &page.vertex_allocator},
+                                                  std::pair{"Meshlets", &page.meshlet_allocator},
+                                                  std::pair{"Meshlet Vertices", &page.meshlet_vertex_allocator},
+                                                  std::pair{"Meshlet Triangles", &page.meshlet_triangle_allocator}})
+            {
+                ImGui::BulletText("%s: %u / %u free, largest block %u",
+                                  name,
+                                  allocator->GetFreeSize(),
+                                  allocator->GetSize(),
+                                  allocator->GetLargestFreeBlock());
+            }
+        }
+    }
 
-        ImGui::SetCursorPosY(ImGui::GetCursorPosY() + ImGui::GetStyle().FramePadding.y);
-        ImGui::Text("Lighting needs to be rebuilt [!]");
-        ImGui::SameLine();
-        if (ImGui::Button("Rebuild Lights"))
+    if (ImGui::CollapsingHeader("Frame Graph"))
+    {
+        ImGui::Checkbox("SSAO", &renderer.m_ssao_pass.enabled);
+        ImGui::Checkbox("Bloom", &renderer.m_bloom_pass.enabled);
+        int blur_count = static_cast<int>(renderer.m_bloom_pass.blur_count);
+        if (ImGui::SliderInt("Bloom Blur Passes", &blur_count, 0, 20))
         {
-            m_engine->GetRenderer().GenerateStaticShadowMap();
-            renderer.m_dir_light_buffer.Write(&renderer.m_dir_lights.back(),
-                                              0,
-                                              sizeof(DirectionalLight) * renderer.m_dir_lights.size());
-            m_rebuild_lights = false;
+            renderer.m_bloom_pass.blur_count = static_cast<uint32_t>(blur_count);
         }
 
-        ImGui::PopStyleColor(4);
-        ImGui::End();
+        const auto& graph = renderer.GetFrameGraph();
+        const auto& stats = graph.GetStats();
+        ImGui::Text("Passes: %u declared, %u culled", stats.declared_passes, stats.culled_passes);
+        ImGui::Text("Compiles: %u, cached: %u", stats.compiles, stats.cache_hits);
+        ImGui::Text("Build: %.3f ms (%.3f ms average)", stats.build_ms, stats.GetAverageBuildMs());
+
+        const auto& planner = graph.GetPlanner();
+        const auto& report = planner.GetReport();
+        constexpr float mb = 1024.f * 1024.f;
+        ImGui::Text("%.1f MB separate, %.1f MB aliased (%.1f MB saved)",
+                    static_cast<float>(report.unaliased_bytes) / mb,
+                    static_cast<float>(report.aliased_bytes) / mb,
+                    static_cast<float>(report.GetSavedBytes()) / mb);
+        ImGui::Text("%u blocks over %zu passes, %u unused",
+                    report.block_count,
+                    planner.GetPasses().size(),
+                    report.unused_textures);
+        for (const auto& texture : planner.GetTextures())
+        {
+            if (texture.first_pass == TransientPlanner::NONE) continue;
+            ImGui::BulletText("%.*s: block %u, passes %u - %u",
+                              static_cast<int>(texture.name.size()),
+                              texture.name.data(),
+                              texture.block,
+                              texture.first_pass,
+                              texture.last_pass);
+        }
     }
 
     if (ImGui::CollapsingHeader("Tonemap Pass"))
@@ -162,6 +424,70 @@ void Editor::UpdateRenderSettings()
     ImGui::End();
 }
 
+void Editor::UpdateMeshletTuner()
+{
+    ImGui::Begin("Meshlet Budgets");
+    if (m_meshlet_sweep_running && m_meshlet_sweep.IsDone())
+    {
+        m_meshlet_sweep_running = false;
+        m_meshlet_stats = std::move(m_pending_meshlet_stats);
+        MeshletTuner::Print(m_meshlet_stats);
+    }
+    if (m_meshlet_sweep_running)
+    {
+        ImGui::TextUnformatted("Sweeping...");
+    }
+    else if (ImGui::Button("Run Sweep"))
+    {
+        // The sweep loads and rebuilds every asset, so it runs on the job system and the results show up when done.
+        m_meshlet_sweep_running = true;
+        auto& job_system = m_engine->GetJobSystem();
+        job_system.Schedule(
+            [this, &job_system]
+            {
+                const auto configs = MeshletTuner::DefaultConfigs();
+                m_pending_meshlet_stats =
+                    MeshletTuner::Sweep(job_system, std::filesystem::current_path() / "assets", configs);
+            },
+            &m_meshlet_sweep);
+    }
+
+    if (!m_meshlet_stats.empty() && ImGui::BeginTable("##meshlet_stats", 8, ImGuiTableFlags_Borders))
+    {
+        ImGui::TableSetupColumn("Verts");
+        ImGui::TableSetupColumn("Tris");
+        ImGui::TableSetupColumn("Cone Weight");
+        ImGui::TableSetupColumn("Meshlets");
+        ImGui::TableSetupColumn("Vertex Fill");
+        ImGui::TableSetupColumn("Triangle Fill");
+        ImGui::TableSetupColumn("Tightness");
+        ImGui::TableSetupColumn("Cone Cull");
+        ImGui::TableHeadersRow();
+        for (const auto& stats : m_meshlet_stats)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", stats.config.max_vertices);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", stats.config.max_triangles);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stats.config.cone_weight);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", stats.meshlet_count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.vertex_fill);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.triangle_fill);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.bounds_tightness);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.cone_cull_rate);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
 void ContentBrowser::Render()
 {
     ImGui::Begin("Content Browser");
@@ -1,14 +1,127 @@
 #include "engine.hpp"
+#include "profiler.hpp"
 
-Engine::Engine()
+Engine::Engine(const EngineCreateInfo& create_info) : m_max_frames(create_info.max_frames)
 {
-    m_window = std::make_unique<Window>();
+    m_job_system = create_info.worker_count ? std::make_unique<JobSystem>(create_info.worker_count)
+                                            : std::make_unique<JobSystem>();
+    m_window = std::make_unique<Window>(create_info.size, create_info.headless);
     m_input = std::make_unique<Input>(*m_window);
-    m_renderer = std::make_unique<Renderer>(this);
+    m_renderer = std::make_unique<Renderer>(this, create_info.headless);
     m_editor = std::make_unique<Editor>(this);
     m_camera = std::make_unique<Camera>(this);
     m_resources = std::make_unique<Resources>(this);
     m_scene = std::make_unique<Scene>(this);
 }
 
-Engine::~Engine() {}
+Engine::~Engine()
+{
+    WaitForRenderThread();
+    if (m_render_thread.joinable())
+    {
+        m_render_thread_running = false;
+        m_render_start.release();
+        m_render_thread.join();
+    }
+}
+
+void Engine::SubmitFrame(const std::chrono::high_resolution_clock::time_point frame_start, const float delta_time)
+{
+    CPU_PLOT("Frame Time", delta_time * 1000.f);
+    CPU_PLOT("Simulation Ticks", static_cast<int64_t>(m_timestep.GetLastSteps()));
+
+    // Sync point, from here until the next frame is kicked off the render thread is idle, so queued GPU work and
+    // resource creation run now and the renderer takes its snapshot of the simulation.
+    WaitForRenderThread();
+    m_job_system->RunMainThreadJobs();
+    m_renderer->Extract(frame_start);
+
+    if (!m_pipelined)
+    {
+        m_renderer->Render();
+        return;
+    }
+
+    if (!m_render_thread.joinable())
+    {
+        m_render_thread_running = true;
+        m_render_thread = std::thread([this] { RenderThreadLoop(); });
+    }
+    m_render_in_flight = true;
+    m_render_start.release();
+}
+
+void Engine::ReportHeadlessRun() const
+{
+    const auto& frame = m_renderer->GetNullFrame();
+    std::println("Headless run: {} frames in {:.2f} s ({:.3f} ms per frame) on {} workers",
+                 m_frame_count,
+                 m_time,
+                 m_frame_count ? m_time * 1000.f / static_cast<float>(m_frame_count) : 0.f,
+                 m_job_system->GetWorkerCount());
+    std::println("Last frame: {} passes, {} dispatches ({} groups), {} push constant bytes, {} uploads ({} bytes)",
+                 frame.passes.size(),
+                 frame.dispatches,
+                 frame.dispatch_groups,
+                 frame.push_constant_bytes,
+                 frame.uploads,
+                 frame.upload_bytes);
+    std::println("Render scale: {:.2f}", m_renderer->GetRenderScale());
+    const auto& graph = m_renderer->GetFrameGraph();
+    const auto& graph_stats = graph.GetStats();
+    std::println("Frame graph: {} passes, {} culled, {} compiles, {} cached, {:.4f} ms per build",
+                 graph_stats.declared_passes,
+                 graph_stats.culled_passes,
+                 graph_stats.compiles,
+                 graph_stats.cache_hits,
+                 graph_stats.GetAverageBuildMs());
+    const auto& transients = graph.GetPlanner().GetReport();
+    std::println("Transient targets: {} bytes separate, {} bytes in {} aliased blocks",
+                 transients.unaliased_bytes,
+                 transients.aliased_bytes,
+                 transients.block_count);
+    const auto& shadow_tiles = m_renderer->GetShadowPass().cache.GetStats();
+    std::println("Shadow tiles: {} redrawn, {} resident, {} missing",
+                 shadow_tiles.redrawn,
+                 shadow_tiles.resident,
+                 shadow_tiles.missing);
+    const auto& clusters = m_renderer->GetLightClusters().GetStats();
+    std::println("Light clusters: {} point lights, {} indices, {} occupied, at most {} per cluster, {:.3f} ms",
+                 clusters.lights,
+                 clusters.indices,
+                 clusters.occupied_clusters,
+                 clusters.max_cluster_lights,
+                 clusters.build_ms);
+    const auto& grass = m_renderer->GetGrassPass();
+    const auto& scatter = grass.scatter.GetStats();
+    std::println("Grass: {} of {} patches uploaded, scattered {} from {} candidates in {} tiles, {:.1f} ms, {:.0f} per second",
+                 grass.uploaded_count,
+                 grass.patches.size(),
+                 scatter.patches,
+                 scatter.candidates,
+                 scatter.tiles,
+                 scatter.build_ms,
+                 scatter.patches_per_second);
+}
+
+void Engine::WaitForRenderThread()
+{
+    if (!m_render_in_flight) return;
+
+    CPU_ZONE("Wait For Render Thread");
+    m_render_done.acquire();
+    m_render_in_flight = false;
+}
+
+void Engine::RenderThreadLoop()
+{
+    CPU_THREAD_NAME("Render Thread");
+    while (true)
+    {
+        m_render_start.acquire();
+        if (!m_render_thread_running) return;
+
+        m_renderer->Render();
+        m_render_done.release();
+    }
+}
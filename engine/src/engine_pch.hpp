@@ -11,10 +11,25 @@
 #include "print"
 #include "optional"
 #include "random"
+#include "bit"
+#include "numeric"
+#include "algorithm"
+#include "future"
+#include "thread"
+#include "mutex"
+#include "condition_variable"
+#include "atomic"
+#include "deque"
+#include "semaphore"
+#include "chrono"
+#include "cstring"
+#include "cassert"
 
 #include "GLFW/glfw3.h"
+#ifdef _WIN32
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include "GLFW/glfw3native.h"
+#endif
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/vec2.hpp"
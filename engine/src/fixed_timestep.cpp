@@ -0,0 +1,41 @@
+#include "fixed_timestep.hpp"
+
+FixedTimestep::FixedTimestep(const float tick_rate, const uint32_t max_steps)
+    : m_tick_rate(tick_rate), m_step(1.0 / tick_rate), m_max_steps(std::max(max_steps, 1u))
+{
+}
+
+uint32_t FixedTimestep::Advance(const float delta_time)
+{
+    m_accumulator += std::max(static_cast<double>(delta_time), 0.0);
+    auto steps = static_cast<uint32_t>(m_accumulator / m_step);
+    m_accumulator -= steps * m_step;
+    if (steps > m_max_steps)
+    {
+        m_dropped_time += (steps - m_max_steps) * m_step;
+        steps = m_max_steps;
+    }
+
+    m_last_steps = steps;
+    m_tick_count += steps;
+    return steps;
+}
+
+void FixedTimestep::Reset()
+{
+    m_accumulator = 0.0;
+    m_last_steps = 0;
+    m_tick_count = 0;
+    m_dropped_time = 0.0;
+}
+
+void FixedTimestep::SetTickRate(const float tick_rate)
+{
+    if (tick_rate <= 0.f) return;
+
+    // Keep the same fraction of a tick pending so interpolation doesn't jump.
+    const double alpha = m_accumulator / m_step;
+    m_tick_rate = tick_rate;
+    m_step = 1.0 / tick_rate;
+    m_accumulator = alpha * m_step;
+}
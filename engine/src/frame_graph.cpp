@@ -0,0 +1,210 @@
+#include "frame_graph.hpp"
+
+namespace
+{
+    // FNV-1a, the declaration is a few hundred bytes so anything fancier would not show up.
+    constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+    constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+    uint64_t HashBytes(uint64_t hash, const void* data, const size_t size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    uint64_t HashValue(const uint64_t hash, const T& value)
+    {
+        return HashBytes(hash, &value, sizeof(T));
+    }
+
+    uint64_t HashString(const uint64_t hash, const std::string_view string)
+    {
+        return HashValue(HashBytes(hash, string.data(), string.size()), string.size());
+    }
+} // namespace
+
+void FrameGraph::Reset()
+{
+    m_build_start = std::chrono::high_resolution_clock::now();
+    m_textures.clear();
+    m_passes.clear();
+    m_accesses.clear();
+}
+
+uint32_t FrameGraph::AddTexture(const std::string_view name, const uint64_t size)
+{
+    m_textures.push_back({ .name = name, .size = size });
+    return static_cast<uint32_t>(m_textures.size() - 1);
+}
+
+FrameGraph& FrameGraph::AddPass(const std::string_view name, RecordFunction record)
+{
+    m_passes.push_back({
+        .name = name,
+        .first_access = static_cast<uint32_t>(m_accesses.size()),
+        .record = std::move(record),
+    });
+    return *this;
+}
+
+FrameGraph& FrameGraph::Read(const uint32_t texture) { return AddAccess(texture, FrameGraphState::eRead, true); }
+
+FrameGraph& FrameGraph::Write(const uint32_t texture) { return AddAccess(texture, FrameGraphState::eWrite, false); }
+
+FrameGraph& FrameGraph::Modify(const uint32_t texture) { return AddAccess(texture, FrameGraphState::eWrite, true); }
+
+FrameGraph& FrameGraph::AddAccess(const uint32_t texture, const FrameGraphState state, const bool load)
+{
+    m_accesses.push_back({ .texture = texture, .state = state, .load = load });
+    ++m_passes.back().access_count;
+    return *this;
+}
+
+FrameGraph& FrameGraph::SetOutput()
+{
+    m_passes.back().output = true;
+    return *this;
+}
+
+bool FrameGraph::Compile()
+{
+    const uint64_t hash = ComputeHash();
+    const bool changed = !m_compiled || hash != m_stats.hash;
+    if (changed)
+    {
+        Cull();
+        PlanAliasing();
+        m_stats.hash = hash;
+        ++m_stats.compiles;
+        m_compiled = true;
+    }
+    else
+    {
+        ++m_stats.cache_hits;
+    }
+
+    m_stats.declared_passes = static_cast<uint32_t>(m_passes.size());
+    const auto now = std::chrono::high_resolution_clock::now();
+    m_stats.build_ms = std::chrono::duration<float, std::milli>(now - m_build_start).count();
+    m_stats.total_build_ms += m_stats.build_ms;
+    return changed;
+}
+
+void FrameGraph::Execute() const
+{
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+    {
+        if (m_alive[i] && m_passes[i].record)
+        {
+            m_passes[i].record();
+        }
+    }
+}
+
+bool FrameGraph::IsCulled(const std::string_view name) const
+{
+    bool declared = false;
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+    {
+        if (m_passes[i].name != name) continue;
+        if (m_alive[i]) return false;
+        declared = true;
+    }
+    return declared;
+}
+
+uint64_t FrameGraph::ComputeHash() const
+{
+    uint64_t hash = FNV_OFFSET;
+    for (const auto& [name, size] : m_textures)
+    {
+        hash = HashValue(HashString(hash, name), size);
+    }
+    for (const auto& pass : m_passes)
+    {
+        hash = HashValue(HashString(hash, pass.name), pass.output);
+        for (const auto& [texture, state, load] : GetAccesses(pass))
+        {
+            hash = HashValue(HashValue(HashValue(hash, texture), state), load);
+        }
+        hash = HashValue(hash, pass.access_count);
+    }
+    return hash;
+}
+
+std::span<const FrameGraph::Access> FrameGraph::GetAccesses(const Pass& pass) const
+{
+    return std::span(m_accesses).subspan(pass.first_access, pass.access_count);
+}
+
+void FrameGraph::Cull()
+{
+    // Walking backwards, a pass survives when it is an output or writes a texture a surviving later pass reads. A
+    // surviving Write hides whatever came before it, so only reads and Modify keep earlier writers alive.
+    m_alive.assign(m_passes.size(), 0);
+    m_needed.assign(m_textures.size(), 0);
+    m_stats.culled_passes = 0;
+    for (uint32_t i = static_cast<uint32_t>(m_passes.size()); i-- > 0;)
+    {
+        const auto& pass = m_passes[i];
+        const auto accesses = GetAccesses(pass);
+        bool alive = pass.output;
+        for (const auto& [texture, state, load] : accesses)
+        {
+            alive |= state == FrameGraphState::eWrite && m_needed[texture];
+        }
+        if (!alive)
+        {
+            ++m_stats.culled_passes;
+            continue;
+        }
+
+        m_alive[i] = 1;
+        for (const auto& [texture, state, load] : accesses)
+        {
+            if (!load)
+            {
+                m_needed[texture] = 0;
+            }
+        }
+        for (const auto& [texture, state, load] : accesses)
+        {
+            if (load)
+            {
+                m_needed[texture] = 1;
+            }
+        }
+    }
+}
+
+void FrameGraph::PlanAliasing()
+{
+    m_planner.Reset();
+    for (const auto& [name, size] : m_textures)
+    {
+        m_planner.AddTexture(name, size);
+    }
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+    {
+        if (!m_alive[i]) continue;
+        m_planner.AddPass(m_passes[i].name);
+        for (const auto& [texture, state, load] : GetAccesses(m_passes[i]))
+        {
+            // Modify reads what was there, so a texture modified before anything writes it carries over frames.
+            if (load)
+            {
+                m_planner.Read(texture);
+            }
+            else
+            {
+                m_planner.Write(texture);
+            }
+        }
+    }
+    m_planner.Plan();
+}
@@ -0,0 +1,343 @@
+#include "grass_scatter.hpp"
+#include "profiler.hpp"
+#include "stb_image.h"
+
+namespace
+{
+    constexpr glm::vec2 EMPTY_CELL = glm::vec2(std::numeric_limits<float>::infinity());
+
+    // Height of the plane above an XZ position, the plane's normal never lies flat.
+    float GetPlaneHeight(const glm::vec4& plane, const glm::vec2 position)
+    {
+        return (plane.w - plane.x * position.x - plane.z * position.y) / plane.y;
+    }
+
+    float Cross(const glm::vec2 a, const glm::vec2 b) { return a.x * b.y - a.y * b.x; }
+} // namespace
+
+float GrassDensityMap::Sample(const glm::vec2 position) const
+{
+    if (values.empty()) return 1.f;
+
+    const glm::vec2 uv = (position - min) / (max - min);
+    if (uv.x < 0.f || uv.y < 0.f || uv.x > 1.f || uv.y > 1.f) return 0.f;
+
+    const glm::vec2 texel = uv * glm::vec2(width - 1, height - 1);
+    const glm::uvec2 first = glm::min(glm::uvec2(texel), glm::uvec2(width - 1, height - 1));
+    const glm::uvec2 last = glm::min(first + 1u, glm::uvec2(width - 1, height - 1));
+    const glm::vec2 t = texel - glm::vec2(first);
+    const float top = glm::mix(values[first.y * width + first.x], values[first.y * width + last.x], t.x);
+    const float bottom = glm::mix(values[last.y * width + first.x], values[last.y * width + last.x], t.x);
+    return glm::mix(top, bottom, t.y);
+}
+
+GrassDensityMap GrassDensityMap::Load(const std::filesystem::path& path, const glm::vec2 min, const glm::vec2 max)
+{
+    int w, h, channels;
+    unsigned char* data = stbi_load(path.string().c_str(), &w, &h, &channels, 4);
+    if (!data) return {};
+
+    GrassDensityMap map{
+        .min = min,
+        .max = max,
+        .width = static_cast<uint32_t>(w),
+        .height = static_cast<uint32_t>(h),
+        .values = std::vector<float>(static_cast<size_t>(w) * h),
+    };
+    for (size_t i = 0; i < map.values.size(); ++i)
+    {
+        map.values[i] = static_cast<float>(data[i * 4]) / 255.f;
+    }
+    stbi_image_free(data);
+    return map;
+}
+
+void GrassSurface::AddMesh(const std::span<const glm::vec3> positions,
+                           const std::span<const uint32_t> indices,
+                           const glm::mat4& transform)
+{
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const glm::vec3 a = transform * glm::vec4(positions[indices[i]], 1.f);
+        const glm::vec3 b = transform * glm::vec4(positions[indices[i + 1]], 1.f);
+        const glm::vec3 c = transform * glm::vec4(positions[indices[i + 2]], 1.f);
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        const float length = glm::length(normal);
+        // Walls and degenerate triangles cover nothing when seen from above.
+        if (length == 0.f || std::abs(normal.y) < length * 1e-3f) continue;
+
+        normal /= normal.y < 0.f ? -length : length;
+        m_corners.insert(m_corners.end(), { a, b, c });
+        m_planes.emplace_back(normal, glm::dot(normal, a));
+    }
+}
+
+void GrassSurface::Build(const float cell_size)
+{
+    m_cell_size = std::max(cell_size, 1e-3f);
+    m_cells.clear();
+    m_cell_heights.clear();
+    if (m_planes.empty())
+    {
+        m_min = m_max = {};
+        m_size = {};
+        return;
+    }
+
+    m_min = glm::vec2(std::numeric_limits<float>::max());
+    m_max = glm::vec2(std::numeric_limits<float>::lowest());
+    for (const auto& corner : m_corners)
+    {
+        m_min = glm::min(m_min, glm::vec2(corner.x, corner.z));
+        m_max = glm::max(m_max, glm::vec2(corner.x, corner.z));
+    }
+    m_size = glm::max(glm::uvec2(glm::ceil((m_max - m_min) / m_cell_size)), glm::uvec2(1));
+    m_cells.assign(static_cast<size_t>(m_size.x) * m_size.y, NO_TRIANGLE);
+    m_cell_heights.assign(m_cells.size(), std::numeric_limits<float>::lowest());
+    for (uint32_t i = 0; i < m_planes.size(); ++i)
+    {
+        Rasterize(i);
+    }
+}
+
+std::optional<GrassSurfacePoint> GrassSurface::Sample(const glm::vec2 position) const
+{
+    if (m_cells.empty()) return std::nullopt;
+
+    const glm::vec2 cell = glm::floor((position - m_min) / m_cell_size);
+    if (cell.x < 0.f || cell.y < 0.f || cell.x >= static_cast<float>(m_size.x) || cell.y >= static_cast<float>(m_size.y))
+    {
+        return std::nullopt;
+    }
+    const uint32_t triangle = m_cells[static_cast<uint32_t>(cell.y) * m_size.x + static_cast<uint32_t>(cell.x)];
+    if (triangle == NO_TRIANGLE) return std::nullopt;
+
+    const glm::vec4& plane = m_planes[triangle];
+    return GrassSurfacePoint{ .height = GetPlaneHeight(plane, position), .normal = glm::vec3(plane) };
+}
+
+void GrassSurface::Rasterize(const uint32_t triangle)
+{
+    const glm::vec2 a(m_corners[triangle * 3].x, m_corners[triangle * 3].z);
+    const glm::vec2 b(m_corners[triangle * 3 + 1].x, m_corners[triangle * 3 + 1].z);
+    const glm::vec2 c(m_corners[triangle * 3 + 2].x, m_corners[triangle * 3 + 2].z);
+    const glm::vec4& plane = m_planes[triangle];
+    const float area = Cross(b - a, c - a);
+
+    const auto keep = [&](const glm::uvec2 cell, const glm::vec2 point)
+    {
+        const uint32_t index = cell.y * m_size.x + cell.x;
+        const float height = GetPlaneHeight(plane, point);
+        if (height <= m_cell_heights[index]) return;
+        m_cell_heights[index] = height;
+        m_cells[index] = triangle;
+    };
+    const auto to_cell = [&](const glm::vec2 point)
+    { return glm::min(glm::uvec2(glm::max((point - m_min) / m_cell_size, 0.f)), m_size - 1u); };
+
+    const glm::uvec2 first = to_cell(glm::min(a, glm::min(b, c)));
+    const glm::uvec2 last = to_cell(glm::max(a, glm::max(b, c)));
+    for (uint32_t y = first.y; y <= last.y; ++y)
+    {
+        for (uint32_t x = first.x; x <= last.x; ++x)
+        {
+            const glm::vec2 center = m_min + (glm::vec2(x, y) + 0.5f) * m_cell_size;
+            // Same side of every edge as the triangle's winding.
+            const float w0 = Cross(b - a, center - a) * area;
+            const float w1 = Cross(c - b, center - b) * area;
+            const float w2 = Cross(a - c, center - c) * area;
+            if (w0 >= 0.f && w1 >= 0.f && w2 >= 0.f)
+            {
+                keep({ x, y }, center);
+            }
+        }
+    }
+    // A triangle too small to cover any center still claims the cell around its centroid.
+    const glm::vec2 centroid = (a + b + c) / 3.f;
+    keep(to_cell(centroid), centroid);
+}
+
+void GrassScatter::Generate(JobSystem& job_system,
+                            const GrassSurface& surface,
+                            const GrassDensityMap& density,
+                            const GrassScatterSettings& settings,
+                            std::vector<GrassPatch>& patches)
+{
+    CPU_ZONE("Scatter Grass");
+    const auto start = std::chrono::high_resolution_clock::now();
+    patches.clear();
+    m_stats = {};
+    if (surface.GetTriangleCount() == 0) return;
+
+    m_seed = settings.seed;
+    m_spacing = std::max(settings.spacing, 0.01f);
+    // A cell's diagonal is the spacing, so no cell ever holds two samples.
+    m_cell_size = m_spacing / glm::root_two<float>();
+    m_min = surface.GetMin();
+    m_size = glm::max(glm::uvec2(glm::ceil((surface.GetMax() - m_min) / m_cell_size)), glm::uvec2(1));
+    m_tile_count = (m_size + TILE_CELLS - 1u) / TILE_CELLS;
+    m_cells.assign(static_cast<size_t>(m_size.x) * m_size.y, EMPTY_CELL);
+    m_tiles.resize(m_tile_count.x * m_tile_count.y);
+
+    // A tile only reads the cells next to its own, so tiles two apart never see each other's writes.
+    std::vector<uint32_t> parity_tiles;
+    for (uint32_t parity = 0; parity < 4; ++parity)
+    {
+        parity_tiles.clear();
+        for (uint32_t y = parity / 2; y < m_tile_count.y; y += 2)
+        {
+            for (uint32_t x = parity % 2; x < m_tile_count.x; x += 2)
+            {
+                parity_tiles.push_back(y * m_tile_count.x + x);
+            }
+        }
+        job_system.ParallelFor(static_cast<uint32_t>(parity_tiles.size()),
+                               1,
+                               [&](const uint32_t begin, const uint32_t end)
+                               {
+                                   for (uint32_t i = begin; i < end; ++i)
+                                   {
+                                       FillTile(parity_tiles[i]);
+                                   }
+                               });
+    }
+    job_system.ParallelFor(static_cast<uint32_t>(m_tiles.size()),
+                           1,
+                           [&](const uint32_t begin, const uint32_t end)
+                           {
+                               for (uint32_t i = begin; i < end; ++i)
+                               {
+                                   PlantTile(i, surface, density, settings);
+                               }
+                           });
+
+    size_t count = 0;
+    for (const auto& tile : m_tiles)
+    {
+        count += tile.patches.size();
+        m_stats.candidates += static_cast<uint32_t>(tile.samples.size());
+    }
+    patches.reserve(count);
+    for (const auto& tile : m_tiles)
+    {
+        patches.insert_range(patches.end(), tile.patches);
+    }
+
+    const auto now = std::chrono::high_resolution_clock::now();
+    m_stats.tiles = static_cast<uint32_t>(m_tiles.size());
+    m_stats.patches = static_cast<uint32_t>(patches.size());
+    m_stats.build_ms = std::chrono::duration<float, std::milli>(now - start).count();
+    m_stats.patches_per_second = m_stats.build_ms > 0.f ? static_cast<float>(m_stats.patches) * 1000.f / m_stats.build_ms
+                                                        : 0.f;
+}
+
+void GrassScatter::FillTile(const uint32_t tile)
+{
+    auto& [samples, active, patches] = m_tiles[tile];
+    samples.clear();
+    active.clear();
+    auto generator = CreateGenerator(tile, 0);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    const glm::uvec2 coord(tile % m_tile_count.x, tile / m_tile_count.x);
+    const glm::uvec2 first_cell = coord * TILE_CELLS;
+    const glm::uvec2 last_cell = glm::min(first_cell + TILE_CELLS, m_size) - 1u;
+    const glm::vec2 min = m_min + glm::vec2(first_cell) * m_cell_size;
+    const glm::vec2 max = m_min + glm::vec2(last_cell + 1u) * m_cell_size;
+    const auto insert = [&](const glm::vec2 sample)
+    {
+        // Clamped so rounding at the tile's edge never writes into a neighbour.
+        const glm::uvec2 cell = glm::clamp(glm::uvec2((sample - m_min) / m_cell_size), first_cell, last_cell);
+        m_cells[cell.y * m_size.x + cell.x] = sample;
+        samples.push_back(sample);
+        active.push_back(sample);
+    };
+
+    // Tiles filled before may already crowd this one, so the first sample gets as many tries as any other.
+    for (uint32_t i = 0; i < ATTEMPTS && active.empty(); ++i)
+    {
+        const glm::vec2 sample = min + (max - min) * glm::vec2(unit(generator), unit(generator));
+        if (IsFree(sample))
+        {
+            insert(sample);
+        }
+    }
+
+    // Bridson with Roberts' change: candidates sit evenly around a circle just past the spacing from an active sample,
+    // starting at a random angle, which packs the disk tighter with far fewer tries than random points in a ring.
+    const float distance = m_spacing * 1.0001f;
+    const glm::vec2 step(std::cos(glm::two_pi<float>() / ATTEMPTS), std::sin(glm::two_pi<float>() / ATTEMPTS));
+    while (!active.empty())
+    {
+        const auto index = std::uniform_int_distribution<size_t>(0, active.size() - 1)(generator);
+        const glm::vec2 center = active[index];
+        const float angle = unit(generator) * glm::two_pi<float>();
+        glm::vec2 direction(std::cos(angle), std::sin(angle));
+        bool spawned = false;
+        for (uint32_t i = 0; i < ATTEMPTS && !spawned; ++i)
+        {
+            const glm::vec2 sample = center + distance * direction;
+            direction = { direction.x * step.x - direction.y * step.y, direction.x * step.y + direction.y * step.x };
+            if (sample.x < min.x || sample.y < min.y || sample.x >= max.x || sample.y >= max.y || !IsFree(sample))
+            {
+                continue;
+            }
+            insert(sample);
+            spawned = true;
+        }
+        if (!spawned)
+        {
+            active[index] = active.back();
+            active.pop_back();
+        }
+    }
+}
+
+void GrassScatter::PlantTile(const uint32_t tile,
+                             const GrassSurface& surface,
+                             const GrassDensityMap& density,
+                             const GrassScatterSettings& settings)
+{
+    auto& [samples, active, patches] = m_tiles[tile];
+    patches.clear();
+    auto generator = CreateGenerator(tile, 1);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    const float min_normal_y = std::cos(glm::radians(settings.max_slope_degrees));
+    for (const auto& sample : samples)
+    {
+        // Thinning the disk by density keeps what is left evenly spread.
+        const float keep = unit(generator);
+        const float shorten = unit(generator);
+        const auto point = surface.Sample(sample);
+        if (!point || point->normal.y < min_normal_y || keep >= density.Sample(sample)) continue;
+
+        GrassPatch patch = settings.patch;
+        patch.position = { sample.x, point->height, sample.y };
+        patch.height *= 1.f - settings.height_variation * shorten;
+        patches.push_back(patch);
+    }
+}
+
+bool GrassScatter::IsFree(const glm::vec2 sample) const
+{
+    const glm::ivec2 cell(glm::floor((sample - m_min) / m_cell_size));
+    const glm::ivec2 first = glm::max(cell - 2, glm::ivec2(0));
+    const glm::ivec2 last = glm::min(cell + 2, glm::ivec2(m_size) - 1);
+    const float min_distance_sq = m_spacing * m_spacing;
+    for (int y = first.y; y <= last.y; ++y)
+    {
+        for (int x = first.x; x <= last.x; ++x)
+        {
+            // Empty cells are infinitely far away.
+            const glm::vec2 offset = m_cells[y * m_size.x + x] - sample;
+            if (glm::dot(offset, offset) < min_distance_sq) return false;
+        }
+    }
+    return true;
+}
+
+std::mt19937 GrassScatter::CreateGenerator(const uint32_t tile, const uint32_t stream) const
+{
+    std::seed_seq seed{ m_seed, tile % m_tile_count.x, tile / m_tile_count.x, stream };
+    return std::mt19937(seed);
+}
@@ -147,6 +147,8 @@ int ToGLFWKey(const KeyboardKey key)
 
 Input::Input(Window& window) : m_window(window)
 {
+    if (window.IsHeadless()) return;
+
     glfwSetWindowUserPointer(window.GetHandle(), this);
     glfwSetCursorPosCallback(window.GetHandle(),
                              [](GLFWwindow* window, double x_pos, double y_pos)
@@ -0,0 +1,186 @@
+#include "job_system.hpp"
+#include "profiler.hpp"
+
+namespace
+{
+    // Index of the pool worker running on this thread, -1 for threads outside the pool.
+    thread_local int t_worker_index = -1;
+} // namespace
+
+JobSystem::JobSystem(const uint32_t worker_count)
+{
+    for (uint32_t i = 0; i < worker_count; ++i)
+    {
+        m_queues.emplace_back(std::make_unique<WorkerQueue>());
+    }
+    for (uint32_t i = 0; i < worker_count; ++i)
+    {
+        m_workers.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard lock(m_wake_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void JobSystem::Schedule(std::function<void()> function, JobCounter* counter)
+{
+    if (counter)
+    {
+        counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    Push({ .function = std::move(function), .counter = counter });
+}
+
+void JobSystem::ScheduleAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter)
+{
+    if (counter)
+    {
+        counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    Job job{ .function = std::move(function), .counter = counter };
+    {
+        // The last job of the dependency drains its continuations under the same lock, so none can be missed.
+        std::lock_guard lock(dependency.m_mutex);
+        if (!dependency.IsDone())
+        {
+            dependency.m_continuations.push_back(std::move(job));
+            return;
+        }
+    }
+    Push(std::move(job));
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    CPU_ZONE("Job Wait");
+    while (!counter.IsDone())
+    {
+        if (!TryRunJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+    std::lock_guard lock(counter.m_mutex);
+}
+
+void JobSystem::RunOnMainThread(std::function<void()> function)
+{
+    std::lock_guard lock(m_main_thread_mutex);
+    m_main_thread_jobs.push_back(std::move(function));
+}
+
+void JobSystem::RunMainThreadJobs()
+{
+    CPU_ZONE("Main Thread Jobs");
+    std::vector<std::function<void()>> jobs;
+    {
+        std::lock_guard lock(m_main_thread_mutex);
+        jobs.swap(m_main_thread_jobs);
+    }
+    for (auto& job : jobs)
+    {
+        job();
+    }
+}
+
+void JobSystem::Push(Job job)
+{
+    if (m_queues.empty())
+    {
+        Execute(job);
+        return;
+    }
+
+    const uint32_t queue_index = t_worker_index >= 0
+                                     ? static_cast<uint32_t>(t_worker_index)
+                                     : m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+    {
+        std::lock_guard lock(m_queues[queue_index]->mutex);
+        m_queues[queue_index]->jobs.push_back(std::move(job));
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard lock(m_wake_mutex);
+    }
+    m_wake.notify_one();
+}
+
+bool JobSystem::TryRunJob()
+{
+    const auto queue_count = static_cast<uint32_t>(m_queues.size());
+    const uint32_t self = t_worker_index >= 0 ? static_cast<uint32_t>(t_worker_index) : 0;
+    for (uint32_t i = 0; i < queue_count; ++i)
+    {
+        const uint32_t queue_index = (self + i) % queue_count;
+        auto& queue = *m_queues[queue_index];
+        std::optional<Job> job;
+        {
+            std::lock_guard lock(queue.mutex);
+            if (queue.jobs.empty()) continue;
+            // Newest first from our own deque keeps its data warm, the oldest is stolen since it tends to be the largest.
+            if (static_cast<int>(queue_index) == t_worker_index)
+            {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            }
+            else
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            }
+        }
+        m_queued.fetch_sub(1, std::memory_order_relaxed);
+        Execute(*job);
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::Execute(Job& job)
+{
+    {
+        CPU_ZONE("Job");
+        job.function();
+    }
+    if (!job.counter) return;
+
+    // The counter is only touched under its lock, Wait takes the same lock before returning so the owner can't
+    // destroy it while the last job is still draining the continuations.
+    std::vector<Job> continuations;
+    {
+        std::lock_guard lock(job.counter->m_mutex);
+        if (job.counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            continuations.swap(job.counter->m_continuations);
+        }
+    }
+    for (auto& continuation : continuations)
+    {
+        Push(std::move(continuation));
+    }
+}
+
+void JobSystem::WorkerLoop(const uint32_t index)
+{
+    t_worker_index = static_cast<int>(index);
+    const std::string name = "Worker " + std::to_string(index);
+    CPU_THREAD_NAME(name.c_str());
+
+    while (m_running)
+    {
+        if (TryRunJob()) continue;
+
+        std::unique_lock lock(m_wake_mutex);
+        m_wake.wait(lock, [this] { return !m_running || m_queued.load(std::memory_order_acquire) > 0; });
+    }
+}
@@ -0,0 +1,282 @@
+#include "light_clusters.hpp"
+#include <immintrin.h>
+
+void LightClusterGrid::LightSet::Resize(const uint32_t size)
+{
+    // Padded by the widest batch, the tail lanes are masked off.
+    count = size;
+    for (auto* values : { &x, &y, &z, &radius })
+    {
+        values->resize(size + 7, 0.f);
+    }
+    index.resize(size);
+}
+
+void LightClusterGrid::LightSet::Gather(const LightSet& source, const std::span<const uint32_t> positions)
+{
+    Resize(static_cast<uint32_t>(positions.size()));
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t position = positions[i];
+        x[i] = source.x[position];
+        y[i] = source.y[position];
+        z[i] = source.z[position];
+        radius[i] = source.radius[position];
+        index[i] = source.index[position];
+    }
+}
+
+void LightClusterGrid::Build(JobSystem& job_system, const Camera& camera, const std::span<const BoundingSphere> lights)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    UpdateBoxes(camera);
+    TransformLights(camera, lights);
+    job_system.ParallelFor(DEPTH_SLICES,
+                           1,
+                           [this](const uint32_t begin, const uint32_t end)
+                           {
+                               for (uint32_t slice = begin; slice < end; ++slice)
+                               {
+                                   BinSlice(slice);
+                               }
+                           });
+    Join();
+    UpdateStats(start);
+}
+
+void LightClusterGrid::BuildReference(const Camera& camera, const std::span<const BoundingSphere> lights)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    UpdateBoxes(camera);
+    TransformLights(camera, lights);
+    m_clusters.resize(CLUSTER_COUNT);
+    m_indices.clear();
+    for (uint32_t cluster = 0; cluster < CLUSTER_COUNT; ++cluster)
+    {
+        const auto offset = static_cast<uint32_t>(m_indices.size());
+        for (uint32_t i = 0; i < m_lights.count; ++i)
+        {
+            const BoundingSphere sphere{ .center = { m_lights.x[i], m_lights.y[i], m_lights.z[i] },
+                                         .radius = m_lights.radius[i] };
+            if (Overlaps(sphere, m_cluster_boxes[cluster]))
+            {
+                m_indices.push_back(m_lights.index[i]);
+            }
+        }
+        m_clusters[cluster] = { .offset = offset, .count = static_cast<uint32_t>(m_indices.size()) - offset };
+    }
+    UpdateStats(start);
+}
+
+void LightClusterGrid::UpdateBoxes(const Camera& camera)
+{
+    const glm::vec4 projection(camera.m_proj_matrix[0][0],
+                               camera.m_proj_matrix[1][1],
+                               camera.m_near_plane,
+                               camera.m_far_plane);
+    if (projection == m_projection && !m_cluster_boxes.empty()) return;
+    m_projection = projection;
+
+    // Slice 0 runs from the near plane to the first split, the others split the rest of the depth range evenly in log
+    // space, so slice = floor(log(depth) * scale + bias) for anything past the first split.
+    const float near_plane = camera.m_near_plane;
+    const float first_split = std::max(NEAR_SLICE_DEPTH, near_plane);
+    const float far_plane = std::max(camera.m_far_plane, first_split * 2.f);
+    const float scale = static_cast<float>(DEPTH_SLICES - 1) / std::log(far_plane / first_split);
+    m_slice_scale_bias = { scale, 1.f - std::log(first_split) * scale };
+    const auto get_split = [&](const uint32_t slice)
+    {
+        if (slice == 0) return near_plane;
+        if (slice == DEPTH_SLICES) return far_plane;
+        return std::exp((static_cast<float>(slice) - m_slice_scale_bias.y) / scale);
+    };
+
+    // A view space point at depth d seen at x and y in normalized device coordinates sits at x * d / proj[0][0] and
+    // y * d / proj[1][1], so the box around a range of tiles only needs its four corners at both ends of the slice.
+    const auto get_box = [&](const float near_depth, const float far_depth, const glm::vec2 ndc_min, const glm::vec2 ndc_max)
+    {
+        Box box{ .min = glm::vec3(std::numeric_limits<float>::max()), .max = glm::vec3(std::numeric_limits<float>::lowest()) };
+        for (const float depth : { near_depth, far_depth })
+        {
+            for (const float x : { ndc_min.x, ndc_max.x })
+            {
+                for (const float y : { ndc_min.y, ndc_max.y })
+                {
+                    const glm::vec3 corner(x * depth / projection.x, y * depth / projection.y, -depth);
+                    box.min = glm::min(box.min, corner);
+                    box.max = glm::max(box.max, corner);
+                }
+            }
+        }
+        return box;
+    };
+
+    m_cluster_boxes.resize(CLUSTER_COUNT);
+    for (uint32_t slice = 0; slice < DEPTH_SLICES; ++slice)
+    {
+        const float near_depth = get_split(slice);
+        const float far_depth = get_split(slice + 1);
+        m_slice_boxes[slice] = get_box(near_depth, far_depth, glm::vec2(-1.f), glm::vec2(1.f));
+        for (uint32_t row = 0; row < GRID_Y; ++row)
+        {
+            // Row 0 is the top of the screen, where y is 1 in normalized device coordinates.
+            const float y_max = 1.f - 2.f * static_cast<float>(row) / GRID_Y;
+            const float y_min = 1.f - 2.f * static_cast<float>(row + 1) / GRID_Y;
+            m_row_boxes[slice * GRID_Y + row] = get_box(near_depth, far_depth, { -1.f, y_min }, { 1.f, y_max });
+            for (uint32_t column = 0; column < GRID_X; ++column)
+            {
+                const float x_min = -1.f + 2.f * static_cast<float>(column) / GRID_X;
+                const float x_max = -1.f + 2.f * static_cast<float>(column + 1) / GRID_X;
+                m_cluster_boxes[(slice * GRID_Y + row) * GRID_X + column] =
+                    get_box(near_depth, far_depth, { x_min, y_min }, { x_max, y_max });
+            }
+        }
+    }
+}
+
+void LightClusterGrid::TransformLights(const Camera& camera, const std::span<const BoundingSphere> lights)
+{
+    m_lights.Resize(static_cast<uint32_t>(lights.size()));
+    for (uint32_t i = 0; i < m_lights.count; ++i)
+    {
+        const glm::vec3 center = camera.m_view_matrix * glm::vec4(lights[i].center, 1.f);
+        m_lights.x[i] = center.x;
+        m_lights.y[i] = center.y;
+        m_lights.z[i] = center.z;
+        m_lights.radius[i] = lights[i].radius;
+        m_lights.index[i] = i;
+    }
+}
+
+void LightClusterGrid::BinSlice(const uint32_t slice_index)
+{
+    auto& slice = m_slices[slice_index];
+    slice.indices.clear();
+    slice.positions.resize(m_lights.count);
+    auto* positions = slice.positions.data();
+
+    const uint32_t slice_count = Overlap(m_lights, m_slice_boxes[slice_index], positions);
+    slice.lights.Gather(m_lights, std::span(slice.positions).first(slice_count));
+    for (uint32_t row = 0; row < GRID_Y; ++row)
+    {
+        const uint32_t row_count = Overlap(slice.lights, m_row_boxes[slice_index * GRID_Y + row], positions);
+        slice.row_lights.Gather(slice.lights, std::span(slice.positions).first(row_count));
+        for (uint32_t column = 0; column < GRID_X; ++column)
+        {
+            const auto& box = m_cluster_boxes[(slice_index * GRID_Y + row) * GRID_X + column];
+            const uint32_t count = Overlap(slice.row_lights, box, positions);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                slice.indices.push_back(slice.row_lights.index[positions[i]]);
+            }
+            slice.counts[row * GRID_X + column] = count;
+        }
+    }
+}
+
+bool LightClusterGrid::Overlaps(const BoundingSphere& sphere, const Box& box)
+{
+    // Same operations in the same order as the SIMD paths, so both agree on spheres that just touch a box.
+    const glm::vec3 distance = glm::max(glm::max(box.min - sphere.center, sphere.center - box.max), glm::vec3(0.f));
+    const float distance_squared = distance.x * distance.x + distance.y * distance.y + distance.z * distance.z;
+    return distance_squared <= sphere.radius * sphere.radius;
+}
+
+uint32_t LightClusterGrid::Overlap(const LightSet& lights, const Box& box, uint32_t* positions)
+{
+    uint32_t written = 0;
+#if defined(__AVX2__)
+    constexpr uint32_t lanes = 8;
+    const __m256 min_x = _mm256_set1_ps(box.min.x);
+    const __m256 min_y = _mm256_set1_ps(box.min.y);
+    const __m256 min_z = _mm256_set1_ps(box.min.z);
+    const __m256 max_x = _mm256_set1_ps(box.max.x);
+    const __m256 max_y = _mm256_set1_ps(box.max.y);
+    const __m256 max_z = _mm256_set1_ps(box.max.z);
+    const __m256 zero = _mm256_setzero_ps();
+    for (uint32_t base = 0; base < lights.count; base += lanes)
+    {
+        const __m256 x = _mm256_loadu_ps(&lights.x[base]);
+        const __m256 y = _mm256_loadu_ps(&lights.y[base]);
+        const __m256 z = _mm256_loadu_ps(&lights.z[base]);
+        const __m256 radius = _mm256_loadu_ps(&lights.radius[base]);
+        const __m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(min_x, x), _mm256_sub_ps(x, max_x)), zero);
+        const __m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(min_y, y), _mm256_sub_ps(y, max_y)), zero);
+        const __m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(min_z, z), _mm256_sub_ps(z, max_z)), zero);
+        const __m256 distance_squared =
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        const __m256 inside = _mm256_cmp_ps(distance_squared, _mm256_mul_ps(radius, radius), _CMP_LE_OQ);
+        auto mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+#elif defined(__SSE2__) || defined(_M_X64)
+    constexpr uint32_t lanes = 4;
+    const __m128 min_x = _mm_set1_ps(box.min.x);
+    const __m128 min_y = _mm_set1_ps(box.min.y);
+    const __m128 min_z = _mm_set1_ps(box.min.z);
+    const __m128 max_x = _mm_set1_ps(box.max.x);
+    const __m128 max_y = _mm_set1_ps(box.max.y);
+    const __m128 max_z = _mm_set1_ps(box.max.z);
+    const __m128 zero = _mm_setzero_ps();
+    for (uint32_t base = 0; base < lights.count; base += lanes)
+    {
+        const __m128 x = _mm_loadu_ps(&lights.x[base]);
+        const __m128 y = _mm_loadu_ps(&lights.y[base]);
+        const __m128 z = _mm_loadu_ps(&lights.z[base]);
+        const __m128 radius = _mm_loadu_ps(&lights.radius[base]);
+        const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_x, x), _mm_sub_ps(x, max_x)), zero);
+        const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_y, y), _mm_sub_ps(y, max_y)), zero);
+        const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(min_z, z), _mm_sub_ps(z, max_z)), zero);
+        const __m128 distance_squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        const __m128 inside = _mm_cmple_ps(distance_squared, _mm_mul_ps(radius, radius));
+        auto mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+#else
+    constexpr uint32_t lanes = 1;
+    for (uint32_t base = 0; base < lights.count; base += lanes)
+    {
+        const BoundingSphere sphere{ .center = { lights.x[base], lights.y[base], lights.z[base] },
+                                     .radius = lights.radius[base] };
+        uint32_t mask = Overlaps(sphere, box) ? 1u : 0u;
+#endif
+        if (lights.count - base < lanes)
+        {
+            mask &= (1u << (lights.count - base)) - 1u;
+        }
+        while (mask)
+        {
+            positions[written++] = base + static_cast<uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+    }
+    return written;
+}
+
+void LightClusterGrid::Join()
+{
+    m_clusters.resize(CLUSTER_COUNT);
+    m_indices.clear();
+    for (uint32_t slice_index = 0; slice_index < DEPTH_SLICES; ++slice_index)
+    {
+        const auto& slice = m_slices[slice_index];
+        auto offset = static_cast<uint32_t>(m_indices.size());
+        for (uint32_t i = 0; i < slice.counts.size(); ++i)
+        {
+            m_clusters[slice_index * GRID_X * GRID_Y + i] = { .offset = offset, .count = slice.counts[i] };
+            offset += slice.counts[i];
+        }
+        m_indices.insert_range(m_indices.end(), slice.indices);
+    }
+}
+
+void LightClusterGrid::UpdateStats(const std::chrono::high_resolution_clock::time_point start)
+{
+    m_stats = {
+        .lights = m_lights.count,
+        .indices = static_cast<uint32_t>(m_indices.size()),
+    };
+    for (const auto& cluster : m_clusters)
+    {
+        m_stats.occupied_clusters += cluster.count > 0;
+        m_stats.max_cluster_lights = std::max(m_stats.max_cluster_lights, cluster.count);
+    }
+    const auto now = std::chrono::high_resolution_clock::now();
+    m_stats.build_ms = std::chrono::duration<float, std::milli>(now - start).count();
+}
@@ -0,0 +1,219 @@
+#include "meshlet_tuner.hpp"
+#include "profiler.hpp"
+
+std::vector<MeshletConfig> MeshletTuner::DefaultConfigs()
+{
+    std::vector<MeshletConfig> configs;
+    for (const uint32_t max_vertices : { 32u, 64u, 96u, 128u })
+    {
+        for (const uint32_t max_triangles : { 64u, 124u, 192u, 256u })
+        {
+            for (const float cone_weight : { 0.f, 0.25f, 0.5f })
+            {
+                configs.push_back({ .max_vertices = max_vertices, .max_triangles = max_triangles, .cone_weight = cone_weight });
+            }
+        }
+    }
+    return configs;
+}
+
+std::vector<glm::vec3> MeshletTuner::GetOrbitCameras(const std::span<const glm::vec3> positions, const uint32_t count)
+{
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const auto& position : positions)
+    {
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+    }
+    const glm::vec3 center = (min + max) * 0.5f;
+    const float radius = glm::max(glm::length(max - min) * 0.5f, 0.001f);
+
+    // Fibonacci sphere so the samples cover every side of the mesh evenly and deterministically.
+    std::vector<glm::vec3> cameras;
+    cameras.reserve(count);
+    const float golden_angle = glm::pi<float>() * (3.f - std::sqrt(5.f));
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float y = 1.f - (static_cast<float>(i) + 0.5f) / static_cast<float>(count) * 2.f;
+        const float ring = std::sqrt(1.f - y * y);
+        const float theta = golden_angle * static_cast<float>(i);
+        cameras.push_back(center + glm::vec3(std::cos(theta) * ring, y, std::sin(theta) * ring) * radius * 2.5f);
+    }
+    return cameras;
+}
+
+bool MeshletTuner::IsConeCulled(const CullData& cull_data, const glm::vec3& camera_position)
+{
+    const auto axis_x = static_cast<int8_t>(cull_data.cone_packed >> 0 & 0xFF);
+    const auto axis_y = static_cast<int8_t>(cull_data.cone_packed >> 8 & 0xFF);
+    const auto axis_z = static_cast<int8_t>(cull_data.cone_packed >> 16 & 0xFF);
+    const auto cutoff = static_cast<int8_t>(cull_data.cone_packed >> 24 & 0xFF);
+
+    const float cone_cutoff = static_cast<float>(cutoff) / 127.f;
+    if (cone_cutoff >= 1.f) return false;
+
+    const glm::vec3 axis = glm::vec3(axis_x, axis_y, axis_z) / 127.f;
+    const glm::vec3 offset = camera_position - cull_data.cone_apex;
+    const float distance = glm::length(offset);
+    if (distance <= 0.f) return false;
+    return glm::dot(offset / distance, -glm::normalize(axis)) > cone_cutoff;
+}
+
+MeshletStats MeshletTuner::Evaluate(const std::span<const MeshGeometry> geometry,
+                                    const MeshletConfig& config,
+                                    const std::span<const glm::vec3> camera_positions)
+{
+    MeshletStats stats{ .config = config };
+    double vertex_fill = 0.0;
+    double triangle_fill = 0.0;
+    double tightness = 0.0;
+    uint64_t cone_tests = 0;
+    uint64_t cone_culled = 0;
+    std::chrono::duration<float, std::milli> build_time{};
+
+    for (const auto& mesh : geometry)
+    {
+        if (mesh.indices.empty()) continue;
+        stats.mesh_count++;
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        const auto [meshlets, meshlet_vertices, meshlet_triangles] =
+            Resources::BuildMeshlets(mesh.positions, mesh.indices, config);
+        build_time += std::chrono::high_resolution_clock::now() - start;
+
+        const auto cameras = camera_positions.empty() ? GetOrbitCameras(mesh.positions, 16)
+                                                      : std::vector(camera_positions.begin(), camera_positions.end());
+
+        for (const auto& meshlet : meshlets)
+        {
+            const meshopt_Bounds bounds = meshopt_computeMeshletBounds(&meshlet_vertices[meshlet.vertex_offset],
+                                                                       &meshlet_triangles[meshlet.triangle_offset],
+                                                                       meshlet.triangle_count,
+                                                                       reinterpret_cast<const float*>(mesh.positions.data()),
+                                                                       mesh.positions.size(),
+                                                                       sizeof(glm::vec3));
+
+            float area = 0.f;
+            for (uint32_t i = 0; i < meshlet.triangle_count; ++i)
+            {
+                const auto* tri = &meshlet_triangles[meshlet.triangle_offset + i * 3];
+                const auto& p0 = mesh.positions[meshlet_vertices[meshlet.vertex_offset + tri[0]]];
+                const auto& p1 = mesh.positions[meshlet_vertices[meshlet.vertex_offset + tri[1]]];
+                const auto& p2 = mesh.positions[meshlet_vertices[meshlet.vertex_offset + tri[2]]];
+                area += glm::length(glm::cross(p1 - p0, p2 - p0)) * 0.5f;
+            }
+            const float disc_area = glm::pi<float>() * bounds.radius * bounds.radius;
+            tightness += disc_area > 0.f ? glm::min(area / disc_area, 1.f) : 1.f;
+
+            const CullData cull_data{
+                .center = glm::vec3(bounds.center[0], bounds.center[1], bounds.center[2]),
+                .radius = bounds.radius,
+                .cone_apex = glm::vec3(bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]),
+                .cone_packed = Resources::PackCone(bounds),
+            };
+            for (const auto& camera : cameras)
+            {
+                cone_culled += IsConeCulled(cull_data, camera);
+            }
+            cone_tests += cameras.size();
+
+            vertex_fill += static_cast<double>(meshlet.vertex_count) / config.max_vertices;
+            triangle_fill += static_cast<double>(meshlet.triangle_count) / config.max_triangles;
+            stats.triangle_count += meshlet.triangle_count;
+        }
+        stats.meshlet_count += static_cast<uint32_t>(meshlets.size());
+    }
+
+    if (stats.meshlet_count)
+    {
+        stats.vertex_fill = static_cast<float>(vertex_fill / stats.meshlet_count);
+        stats.triangle_fill = static_cast<float>(triangle_fill / stats.meshlet_count);
+        stats.bounds_tightness = static_cast<float>(tightness / stats.meshlet_count);
+    }
+    if (cone_tests)
+    {
+        stats.cone_cull_rate = static_cast<float>(static_cast<double>(cone_culled) / cone_tests);
+    }
+    stats.build_ms = build_time.count();
+    return stats;
+}
+
+std::vector<MeshletStats> MeshletTuner::Sweep(JobSystem& job_system,
+                                              const std::filesystem::path& asset_root,
+                                              const std::span<const MeshletConfig> configs,
+                                              const std::span<const glm::vec3> camera_positions)
+{
+    CPU_ZONE("Meshlet Sweep");
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(asset_root))
+    {
+        const auto extension = entry.path().extension();
+        if (!entry.is_regular_file() || (extension != ".gltf" && extension != ".glb")) continue;
+        files.push_back(entry.path());
+    }
+    // Sorted so the meshes, and the timings with them, come out the same whichever order the directory lists them in.
+    std::ranges::sort(files);
+
+    std::vector<std::vector<MeshGeometry>> file_geometry(files.size());
+    job_system.ParallelFor(static_cast<uint32_t>(files.size()),
+                           1,
+                           [&](const uint32_t begin, const uint32_t end)
+                           {
+                               for (uint32_t i = begin; i < end; ++i)
+                               {
+                                   file_geometry[i] = Resources::LoadGeometry(files[i]);
+                               }
+                           });
+    std::vector<MeshGeometry> geometry;
+    for (auto& meshes : file_geometry)
+    {
+        geometry.insert(geometry.end(), std::make_move_iterator(meshes.begin()), std::make_move_iterator(meshes.end()));
+    }
+
+    std::vector<MeshletStats> stats(configs.size());
+    job_system.ParallelFor(static_cast<uint32_t>(configs.size()),
+                           1,
+                           [&](const uint32_t begin, const uint32_t end)
+                           {
+                               for (uint32_t i = begin; i < end; ++i)
+                               {
+                                   // Only the hard meshoptimizer limits apply here, sweeping past the shader budgets
+                                   // is the point of the tool.
+                                   const MeshletConfig valid_config{
+                                       .max_vertices = std::clamp(configs[i].max_vertices, 3u, 255u),
+                                       .max_triangles = std::clamp(configs[i].max_triangles & ~3u, 4u, 512u),
+                                       .cone_weight = std::clamp(configs[i].cone_weight, 0.f, 1.f),
+                                   };
+                                   stats[i] = Evaluate(geometry, valid_config, camera_positions);
+                               }
+                           });
+    return stats;
+}
+
+void MeshletTuner::Print(const std::span<const MeshletStats> stats)
+{
+    std::println("{:>6} {:>6} {:>6} | {:>9} {:>8} {:>8} {:>9} {:>9} {:>9}",
+                 "verts",
+                 "tris",
+                 "cone",
+                 "meshlets",
+                 "v fill",
+                 "t fill",
+                 "tightness",
+                 "cone cull",
+                 "build ms");
+    for (const auto& s : stats)
+    {
+        std::println("{:>6} {:>6} {:>6.2f} | {:>9} {:>8.3f} {:>8.3f} {:>9.3f} {:>9.3f} {:>9.2f}",
+                     s.config.max_vertices,
+                     s.config.max_triangles,
+                     s.config.cone_weight,
+                     s.meshlet_count,
+                     s.vertex_fill,
+                     s.triangle_fill,
+                     s.bounds_tightness,
+                     s.cone_cull_rate,
+                     s.build_ms);
+    }
+}
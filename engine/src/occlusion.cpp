@@ -0,0 +1,312 @@
+#include "occlusion.hpp"
+#include "profiler.hpp"
+#include <immintrin.h>
+
+namespace
+{
+    // Edges are normalised to pixel distances, and adjacent triangles clipped from different ends never land exactly on
+    // the same line, so a sliver of slack keeps single pixel cracks from punching holes through whole HiZ blocks.
+    constexpr float EDGE_EPSILON = 0.01f;
+
+    glm::vec3 ToScreen(const glm::vec4& clip)
+    {
+        const float inv_w = 1.f / clip.w;
+        return {
+            (clip.x * inv_w * 0.5f + 0.5f) * static_cast<float>(OcclusionCuller::WIDTH),
+            (0.5f - clip.y * inv_w * 0.5f) * static_cast<float>(OcclusionCuller::HEIGHT),
+            clip.z * inv_w,
+        };
+    }
+
+    // Clamped while still a float, casting a coordinate far outside the int range is undefined.
+    int ToPixel(const float coordinate, const uint32_t size)
+    {
+        return static_cast<int>(std::clamp(coordinate, 0.f, static_cast<float>(size - 1)));
+    }
+} // namespace
+
+OcclusionCuller::OcclusionCuller() : m_depth(WIDTH * HEIGHT, 1.f), m_hiz(HIZ_WIDTH * HIZ_HEIGHT, 1.f) {}
+
+void OcclusionCuller::Render(JobSystem& job_system,
+                             const glm::mat4& view_proj,
+                             const std::span<const OccluderInstance> occluders)
+{
+    CPU_ZONE("Occlusion Rasterize");
+    m_view_proj = view_proj;
+    m_stats = {};
+    m_triangles.clear();
+    for (auto& bin : m_bins)
+    {
+        bin.clear();
+    }
+
+    {
+        CPU_ZONE("Occlusion Setup");
+        for (const auto& [occluder, transform] : occluders)
+        {
+            const glm::mat4 mvp = view_proj * transform;
+            m_clip_positions.resize(occluder->positions.size());
+            for (size_t i = 0; i < occluder->positions.size(); ++i)
+            {
+                m_clip_positions[i] = mvp * glm::vec4(occluder->positions[i], 1.f);
+            }
+            for (size_t i = 0; i + 2 < occluder->indices.size(); i += 3)
+            {
+                AddTriangle(m_clip_positions[occluder->indices[i]],
+                            m_clip_positions[occluder->indices[i + 1]],
+                            m_clip_positions[occluder->indices[i + 2]]);
+            }
+        }
+    }
+
+    // Every tile owns its own pixels and HiZ blocks, so they can be filled without any synchronisation.
+    job_system.ParallelFor(TILES_X * TILES_Y,
+                           1,
+                           [this](const uint32_t begin, const uint32_t end)
+                           {
+                               for (uint32_t tile_index = begin; tile_index < end; ++tile_index)
+                               {
+                                   RasterizeTile(tile_index);
+                                   BuildHiZ(tile_index);
+                               }
+                           });
+    m_stats.occluder_triangles = static_cast<uint32_t>(m_triangles.size());
+}
+
+void OcclusionCuller::AddTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2)
+{
+    // Clip against the near plane (z >= 0 with zero to one depth), which turns the triangle into at most a quad.
+    const std::array<glm::vec4, 3> input{ c0, c1, c2 };
+    std::array<glm::vec4, 4> polygon;
+    uint32_t count = 0;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const glm::vec4& a = input[i];
+        const glm::vec4& b = input[(i + 1) % 3];
+        const bool a_inside = a.z >= 0.f;
+        if (a_inside)
+        {
+            polygon[count++] = a;
+        }
+        if (a_inside != (b.z >= 0.f))
+        {
+            polygon[count++] = a + (b - a) * (a.z / (a.z - b.z));
+        }
+    }
+
+    for (uint32_t i = 1; i + 1 < count; ++i)
+    {
+        SetupTriangle(polygon[0], polygon[i], polygon[i + 1]);
+    }
+}
+
+void OcclusionCuller::SetupTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2)
+{
+    glm::vec3 p0 = ToScreen(c0);
+    glm::vec3 p1 = ToScreen(c1);
+    glm::vec3 p2 = ToScreen(c2);
+
+    // Occluders are solid, so back faces hide just as much and are kept by flipping them to a consistent winding.
+    float area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+    // Vertices right on the camera plane project to infinity, the area catches those as well as degenerate triangles.
+    if (!std::isfinite(area) || std::abs(area) < 1e-6f) return;
+    if (area < 0.f)
+    {
+        std::swap(p1, p2);
+        area = -area;
+    }
+
+    const float min_x = std::min({ p0.x, p1.x, p2.x });
+    const float min_y = std::min({ p0.y, p1.y, p2.y });
+    const float max_x = std::max({ p0.x, p1.x, p2.x });
+    const float max_y = std::max({ p0.y, p1.y, p2.y });
+    if (max_x < 0.f || max_y < 0.f || min_x >= static_cast<float>(WIDTH) || min_y >= static_cast<float>(HEIGHT)) return;
+
+    ScreenTriangle triangle{
+        .min_x = ToPixel(min_x, WIDTH),
+        .min_y = ToPixel(min_y, HEIGHT),
+        .max_x = ToPixel(max_x, WIDTH),
+        .max_y = ToPixel(max_y, HEIGHT),
+    };
+
+    const std::array<glm::vec3, 3> points{ p0, p1, p2 };
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const glm::vec3& a = points[i];
+        const glm::vec3& b = points[(i + 1) % 3];
+        const float edge_a = a.y - b.y;
+        const float edge_b = b.x - a.x;
+        const float inv_length = 1.f / std::sqrt(edge_a * edge_a + edge_b * edge_b);
+        triangle.edges[i] = glm::vec3(edge_a, edge_b, -(edge_a * a.x + edge_b * a.y)) * inv_length;
+    }
+
+    const float dzdx = ((p1.z - p0.z) * (p2.y - p0.y) - (p2.z - p0.z) * (p1.y - p0.y)) / area;
+    const float dzdy = ((p2.z - p0.z) * (p1.x - p0.x) - (p1.z - p0.z) * (p2.x - p0.x)) / area;
+    triangle.depth = { dzdx, dzdy, p0.z - dzdx * p0.x - dzdy * p0.y };
+
+    const auto triangle_index = static_cast<uint32_t>(m_triangles.size());
+    m_triangles.push_back(triangle);
+    for (int y = triangle.min_y / static_cast<int>(TILE_SIZE); y <= triangle.max_y / static_cast<int>(TILE_SIZE); ++y)
+    {
+        for (int x = triangle.min_x / static_cast<int>(TILE_SIZE); x <= triangle.max_x / static_cast<int>(TILE_SIZE); ++x)
+        {
+            m_bins[y * TILES_X + x].push_back(triangle_index);
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeTile(const uint32_t tile_index)
+{
+    const int tile_x = static_cast<int>(tile_index % TILES_X * TILE_SIZE);
+    const int tile_y = static_cast<int>(tile_index / TILES_X * TILE_SIZE);
+    for (int y = tile_y; y < tile_y + static_cast<int>(TILE_SIZE); ++y)
+    {
+        std::fill_n(m_depth.data() + y * WIDTH + tile_x, TILE_SIZE, 1.f);
+    }
+
+    for (const uint32_t triangle_index : m_bins[tile_index])
+    {
+        const auto& triangle = m_triangles[triangle_index];
+        // Rows start on a multiple of 4 so every batch stays inside the tile, pixels outside the triangle are masked.
+        const int min_x = std::max(triangle.min_x, tile_x) & ~3;
+        const int min_y = std::max(triangle.min_y, tile_y);
+        const int max_x = std::min(triangle.max_x, tile_x + static_cast<int>(TILE_SIZE) - 1);
+        const int max_y = std::min(triangle.max_y, tile_y + static_cast<int>(TILE_SIZE) - 1);
+        const auto& [e0, e1, e2] = triangle.edges;
+        const glm::vec3& z = triangle.depth;
+
+        for (int y = min_y; y <= max_y; ++y)
+        {
+            const float py = static_cast<float>(y) + 0.5f;
+            float* row = m_depth.data() + y * WIDTH;
+#if defined(__SSE2__) || defined(_M_X64)
+            const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(min_x) + 0.5f), _mm_setr_ps(0.f, 1.f, 2.f, 3.f));
+            __m128 w0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0.x), px), _mm_set1_ps(e0.y * py + e0.z));
+            __m128 w1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e1.x), px), _mm_set1_ps(e1.y * py + e1.z));
+            __m128 w2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e2.x), px), _mm_set1_ps(e2.y * py + e2.z));
+            __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(z.x), px), _mm_set1_ps(z.y * py + z.z));
+            const __m128 step0 = _mm_set1_ps(e0.x * 4.f);
+            const __m128 step1 = _mm_set1_ps(e1.x * 4.f);
+            const __m128 step2 = _mm_set1_ps(e2.x * 4.f);
+            const __m128 depth_step = _mm_set1_ps(z.x * 4.f);
+            const __m128 slack = _mm_set1_ps(-EDGE_EPSILON);
+
+            for (int x = min_x; x <= max_x; x += 4)
+            {
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, slack), _mm_cmpge_ps(w1, slack)),
+                                                 _mm_cmpge_ps(w2, slack));
+                if (_mm_movemask_ps(inside))
+                {
+                    const __m128 previous = _mm_loadu_ps(row + x);
+                    const __m128 nearest = _mm_min_ps(previous, depth);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+                }
+                w0 = _mm_add_ps(w0, step0);
+                w1 = _mm_add_ps(w1, step1);
+                w2 = _mm_add_ps(w2, step2);
+                depth = _mm_add_ps(depth, depth_step);
+            }
+#else
+            for (int x = min_x; x <= max_x; ++x)
+            {
+                const glm::vec3 p(static_cast<float>(x) + 0.5f, py, 1.f);
+                if (glm::dot(e0, p) >= -EDGE_EPSILON && glm::dot(e1, p) >= -EDGE_EPSILON && glm::dot(e2, p) >= -EDGE_EPSILON)
+                {
+                    row[x] = std::min(row[x], glm::dot(z, p));
+                }
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionCuller::BuildHiZ(const uint32_t tile_index)
+{
+    // Each HiZ texel keeps the furthest occluder depth of its block, anything behind that is hidden everywhere in it.
+    constexpr uint32_t blocks_per_tile = TILE_SIZE / HIZ_BLOCK;
+    const uint32_t block_x = tile_index % TILES_X * blocks_per_tile;
+    const uint32_t block_y = tile_index / TILES_X * blocks_per_tile;
+    for (uint32_t by = block_y; by < block_y + blocks_per_tile; ++by)
+    {
+        for (uint32_t bx = block_x; bx < block_x + blocks_per_tile; ++bx)
+        {
+            float furthest = 0.f;
+            for (uint32_t y = by * HIZ_BLOCK; y < (by + 1) * HIZ_BLOCK; ++y)
+            {
+                const float* row = m_depth.data() + y * WIDTH + bx * HIZ_BLOCK;
+                furthest = std::max(furthest, *std::max_element(row, row + HIZ_BLOCK));
+            }
+            m_hiz[by * HIZ_WIDTH + bx] = furthest;
+        }
+    }
+}
+
+bool OcclusionCuller::IsOccluded(const BoundingBox& box) const
+{
+    if (!box.IsValid()) return false;
+
+    glm::vec2 min_screen(std::numeric_limits<float>::max());
+    glm::vec2 max_screen(std::numeric_limits<float>::lowest());
+    float nearest = 1.f;
+    for (uint32_t corner = 0; corner < 8; ++corner)
+    {
+        const glm::vec3 point(corner & 1 ? box.max.x : box.min.x,
+                              corner & 2 ? box.max.y : box.min.y,
+                              corner & 4 ? box.max.z : box.min.z);
+        const glm::vec4 clip = m_view_proj * glm::vec4(point, 1.f);
+        // Boxes reaching past the near plane surround the camera and can never be hidden.
+        if (clip.z < 0.f) return false;
+
+        const glm::vec3 screen = ToScreen(clip);
+        min_screen = glm::min(min_screen, glm::vec2(screen));
+        max_screen = glm::max(max_screen, glm::vec2(screen));
+        nearest = std::min(nearest, screen.z);
+    }
+
+    // Off screen boxes are left to the frustum, and the negated compare also lets NaN bounds through as visible.
+    if (!(max_screen.x >= 0.f && max_screen.y >= 0.f && min_screen.x < static_cast<float>(WIDTH) &&
+          min_screen.y < static_cast<float>(HEIGHT)))
+    {
+        return false;
+    }
+    const int min_x = ToPixel(min_screen.x, WIDTH);
+    const int min_y = ToPixel(min_screen.y, HEIGHT);
+    const int max_x = ToPixel(max_screen.x, WIDTH);
+    const int max_y = ToPixel(max_screen.y, HEIGHT);
+
+    for (int y = min_y / static_cast<int>(HIZ_BLOCK); y <= max_y / static_cast<int>(HIZ_BLOCK); ++y)
+    {
+        for (int x = min_x / static_cast<int>(HIZ_BLOCK); x <= max_x / static_cast<int>(HIZ_BLOCK); ++x)
+        {
+            if (m_hiz[y * HIZ_WIDTH + x] >= nearest) return false;
+        }
+    }
+    return true;
+}
+
+void OcclusionCuller::Cull(const std::span<const Bounds> bounds, std::vector<uint32_t>& visible)
+{
+    CPU_ZONE("Occlusion Cull");
+    const auto tested = static_cast<uint32_t>(visible.size());
+    std::erase_if(visible, [&](const uint32_t index) { return IsOccluded(bounds[index].box); });
+    m_stats.tested += tested;
+    m_stats.occluded += tested - static_cast<uint32_t>(visible.size());
+}
+
+void OcclusionCuller::SaveDepth(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        printf("Failed to write occlusion depth: %s\n", path.string().c_str());
+        return;
+    }
+
+    file << "P5\n" << WIDTH << " " << HEIGHT << "\n65535\n";
+    for (const float depth : m_depth)
+    {
+        const auto value = static_cast<uint16_t>(std::clamp(depth, 0.f, 1.f) * 65535.f + 0.5f);
+        const std::array bytes{ static_cast<char>(value >> 8), static_cast<char>(value & 0xFF) };
+        file.write(bytes.data(), bytes.size());
+    }
+}
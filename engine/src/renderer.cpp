@@ -9,21 +9,272 @@
 #include "d3d12/d3d12_texture_view.hpp"
 #include "d3d12/d3d12_context.hpp"
 
-void MeshRenderer::Draw(Swift::ICommand* command, const bool dispatch_amp) const
+namespace
 {
-    if (dispatch_amp)
+    uint32_t GetSamplerIndex(const Swift::ISampler* sampler) { return sampler ? sampler->GetDescriptorIndex() : 0; }
+
+    // The amplification shader culls 32 meshlets per group.
+    uint32_t GetAmplificationGroupCount(const uint32_t meshlet_count) { return (meshlet_count + 31) / 32; }
+
+    // Row of a matrix as a plane equation, dotted with a world position it gives that component of the result.
+    glm::vec4 GetRow(const glm::mat4& matrix, const int row)
     {
-        const uint32_t num_amp_groups = (m_meshlet_count + 31) / 32;
-        command->DispatchMesh(num_amp_groups, 1, 1);
+        return { matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row] };
     }
-    else
+
+    template <typename Recorder, typename Packets>
+    void RecordPackets(const Recorder& recorder, const Packets& packets, const bool dispatch_amp)
+    {
+        for (const auto& packet : packets)
+        {
+            recorder.PushConstants(&packet, sizeof(packet));
+            recorder.DispatchMesh(dispatch_amp ? GetAmplificationGroupCount(packet.meshlet_count) : packet.meshlet_count,
+                                  1,
+                                  1);
+        }
+    }
+} // namespace
+
+GrowableBuffer::GrowableBuffer(Swift::IContext* context, const uint32_t element_size, const std::string_view name)
+    : m_context(context), m_name(name), m_element_size(element_size)
+{
+    Reserve(MIN_CAPACITY, 0);
+    m_count = 0;
+    m_grow_count = 0;
+}
+
+bool GrowableBuffer::Reserve(const uint32_t count, const uint64_t frame)
+{
+    m_count = count;
+    if (count <= m_capacity) return false;
+
+    uint32_t capacity = std::max(m_capacity, MIN_CAPACITY);
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+    m_capacity = capacity;
+    ++m_grow_count;
+    if (!m_context) return true;
+
+    if (m_view.buffer)
+    {
+        m_retired.push_back({ .view = m_view, .frame = frame });
+    }
+    m_view = BufferViewBuilder(m_context, capacity * m_element_size).SetNumElements(capacity).SetName(m_name).Build();
+    return true;
+}
+
+void GrowableBuffer::CollectRetired(const uint64_t frame)
+{
+    std::erase_if(m_retired,
+                  [&](const RetiredBuffer& retired)
+                  {
+                      if (frame < retired.frame + RETIRE_FRAMES) return false;
+                      retired.view.Destroy(m_context);
+                      return true;
+                  });
+}
+
+FrameUploadBuffer::FrameUploadBuffer(Swift::IContext* context, const std::string_view name)
+    : m_context(context), m_name(name)
+{
+    if (m_context)
+    {
+        auto* device = static_cast<ID3D12Device*>(m_context->GetDevice());
+        device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence));
+    }
+    Grow(0);
+    m_grow_count = 0;
+}
+
+void FrameUploadBuffer::BeginFrame()
+{
+    const uint64_t completed = GetCompletedValue();
+    m_ring.Recycle(completed);
+    std::erase_if(m_retired,
+                  [&](const RetiredBuffer& retired)
+                  {
+                      if (retired.fence_value > completed) return false;
+                      retired.view.Destroy(m_context);
+                      return true;
+                  });
+}
+
+uint32_t FrameUploadBuffer::Allocate(const uint32_t size, const uint32_t alignment)
+{
+    uint64_t offset = m_ring.Allocate(size, alignment);
+    if (offset == UploadRing::NONE)
+    {
+        Grow(size);
+        offset = m_ring.Allocate(size, alignment);
+    }
+    return static_cast<uint32_t>(offset);
+}
+
+void FrameUploadBuffer::EndFrame()
+{
+    if (m_fence)
+    {
+        auto* queue = static_cast<ID3D12CommandQueue*>(m_context->GetGraphicsQueue()->GetQueue());
+        queue->Signal(m_fence, m_fence_value);
+    }
+    m_ring.EndFrame(m_fence_value);
+    ++m_fence_value;
+}
+
+void FrameUploadBuffer::Destroy()
+{
+    if (!m_context) return;
+
+    for (const auto& retired : m_retired)
+    {
+        retired.view.Destroy(m_context);
+    }
+    m_retired.clear();
+    m_view.Destroy(m_context);
+    m_view = {};
+    m_fence->Release();
+    m_fence = nullptr;
+}
+
+void FrameUploadBuffer::Grow(const uint32_t size)
+{
+    uint64_t capacity = std::max<uint64_t>(m_ring.GetCapacity() * 2, MIN_CAPACITY);
+    while (capacity < static_cast<uint64_t>(size) * GROW_FRAMES)
+    {
+        capacity *= 2;
+    }
+    // The frames in flight keep reading the old buffer, the fresh ring starts empty.
+    m_ring = UploadRing(capacity);
+    ++m_grow_count;
+    if (!m_context) return;
+
+    if (m_view.buffer)
     {
-        command->DispatchMesh(m_meshlet_count, 1, 1);
+        m_retired.push_back({ .view = m_view, .fence_value = m_fence_value });
     }
+    m_view = BufferViewBuilder(m_context, static_cast<uint32_t>(capacity))
+                 .SetNumElements(static_cast<uint32_t>(capacity / sizeof(uint32_t)))
+                 .SetName(m_name)
+                 .Build();
 }
 
-Renderer::Renderer(Engine* engine) : m_engine(engine)
+uint64_t FrameUploadBuffer::GetCompletedValue() const
 {
+    // Headless frames never reach a GPU, so they are done as soon as they end.
+    return m_fence ? m_fence->GetCompletedValue() : m_fence_value - 1;
+}
+
+GeometryAllocation GeometryPool::Allocate(const Mesh& mesh)
+{
+    GeometryAllocation allocation{};
+    for (uint32_t i = 0; i < m_pages.size(); ++i)
+    {
+        allocation.page = i;
+        if (TryAllocate(m_pages[i], mesh, allocation)) return allocation;
+    }
+    AddPage(mesh);
+    allocation.page = static_cast<uint32_t>(m_pages.size() - 1);
+    TryAllocate(m_pages.back(), mesh, allocation);
+    return allocation;
+}
+
+void GeometryPool::Free(const GeometryAllocation& allocation)
+{
+    auto& page = m_pages[allocation.page];
+    page.vertex_allocator.Free(allocation.vertices);
+    page.meshlet_allocator.Free(allocation.meshlets);
+    page.meshlet_vertex_allocator.Free(allocation.meshlet_vertices);
+    page.meshlet_triangle_allocator.Free(allocation.meshlet_triangles);
+}
+
+void GeometryPool::Retire(const GeometryAllocation& allocation, const uint64_t frame)
+{
+    m_retired.push_back({ .allocation = allocation, .frame = frame });
+}
+
+void GeometryPool::CollectRetired(const uint64_t frame)
+{
+    std::erase_if(m_retired,
+                  [&](const RetiredAllocation& retired)
+                  {
+                      if (frame < retired.frame + RETIRE_FRAMES) return false;
+                      Free(retired.allocation);
+                      return true;
+                  });
+}
+
+bool GeometryPool::TryAllocate(GeometryPage& page, const Mesh& mesh, GeometryAllocation& allocation)
+{
+    // Empty streams still take one element so every offset points inside the page.
+    const auto count = [](const size_t size) { return std::max(static_cast<uint32_t>(size), 1u); };
+    const auto vertices = page.vertex_allocator.Allocate(count(mesh.positions.size()));
+    const auto meshlets = page.meshlet_allocator.Allocate(count(mesh.meshlets.size()));
+    const auto meshlet_vertices = page.meshlet_vertex_allocator.Allocate(count(mesh.meshlet_vertices.size()));
+    const auto meshlet_triangles = page.meshlet_triangle_allocator.Allocate(count(mesh.meshlet_triangles.size()));
+    if (vertices && meshlets && meshlet_vertices && meshlet_triangles)
+    {
+        allocation.vertices = *vertices;
+        allocation.meshlets = *meshlets;
+        allocation.meshlet_vertices = *meshlet_vertices;
+        allocation.meshlet_triangles = *meshlet_triangles;
+        return true;
+    }
+
+    if (vertices) page.vertex_allocator.Free(*vertices);
+    if (meshlets) page.meshlet_allocator.Free(*meshlets);
+    if (meshlet_vertices) page.meshlet_vertex_allocator.Free(*meshlet_vertices);
+    if (meshlet_triangles) page.meshlet_triangle_allocator.Free(*meshlet_triangles);
+    return false;
+}
+
+void GeometryPool::AddPage(const Mesh& mesh)
+{
+    const auto fit = [](const size_t size, const uint32_t page_size)
+    { return std::max(static_cast<uint32_t>(size), page_size); };
+    const uint32_t vertices = fit(mesh.positions.size(), PAGE_VERTICES);
+    const uint32_t meshlets = fit(mesh.meshlets.size(), PAGE_MESHLETS);
+    const uint32_t meshlet_vertices = fit(mesh.meshlet_vertices.size(), PAGE_MESHLET_VERTICES);
+    const uint32_t meshlet_triangles = fit(mesh.meshlet_triangles.size(), PAGE_MESHLET_TRIANGLES);
+    auto& page = m_pages.emplace_back(GeometryPage{
+        .vertex_allocator = TlsfAllocator(vertices),
+        .meshlet_allocator = TlsfAllocator(meshlets),
+        .meshlet_vertex_allocator = TlsfAllocator(meshlet_vertices),
+        .meshlet_triangle_allocator = TlsfAllocator(meshlet_triangles),
+    });
+    if (!m_context) return;
+
+    page.positions = BufferViewBuilder(m_context, sizeof(glm::vec3) * vertices)
+                         .SetNumElements(vertices)
+                         .SetName("Geometry Positions")
+                         .Build();
+    page.attributes = BufferViewBuilder(m_context, sizeof(Vertex) * vertices)
+                          .SetNumElements(vertices)
+                          .SetName("Geometry Attributes")
+                          .Build();
+    page.meshlets = BufferViewBuilder(m_context, sizeof(meshopt_Meshlet) * meshlets)
+                        .SetNumElements(meshlets)
+                        .SetName("Geometry Meshlets")
+                        .Build();
+    page.meshlet_vertices = BufferViewBuilder(m_context, sizeof(uint32_t) * meshlet_vertices)
+                                .SetNumElements(meshlet_vertices)
+                                .SetName("Geometry Meshlet Vertices")
+                                .Build();
+    page.meshlet_triangles = BufferViewBuilder(m_context, sizeof(uint32_t) * meshlet_triangles)
+                                 .SetNumElements(meshlet_triangles)
+                                 .SetName("Geometry Meshlet Triangles")
+                                 .Build();
+}
+
+Renderer::Renderer(Engine* engine, const bool headless) : m_engine(engine), m_headless(headless)
+{
+    if (m_headless)
+    {
+        InitGrowableBuffers();
+        return;
+    }
+
     InitContext();
     InitImgui();
 
@@ -40,71 +291,16 @@ Renderer::Renderer(Engine* engine) : m_engine(engine)
 
     m_profiler = std::make_unique<GPUProfiler>(m_context);
 
-    m_engine->GetWindow().AddResizeCallback(
-        [&](const glm::uvec2 size)
-        {
-            m_context->GetGraphicsQueue()->WaitIdle();
-            m_context->ResizeBuffers(size.x, size.y);
-            m_render_texture.Destroy(m_context);
-            m_depth_texture.Destroy(m_context);
-            m_post_process_hdr.m_dst_texture.Destroy(m_context);
-            m_post_process_hdr.m_src_texture.Destroy(m_context);
-            m_post_process_ldr.m_dst_texture.Destroy(m_context);
-            m_post_process_ldr.m_src_texture.Destroy(m_context);
-
-            m_render_texture =
-                TextureViewBuilder(m_context, size)
-                    .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
-                    .SetFormat(Swift::Format::eRGBA16F)
-                    .Build();
-
-            m_post_process_hdr.m_src_texture =
-                TextureViewBuilder(m_context, size)
-                    .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
-                    .SetFormat(Swift::Format::eRGBA16F)
-                    .Build();
-            m_post_process_hdr.m_dst_texture =
-                TextureViewBuilder(m_context, size)
-                    .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
-                    .SetFormat(Swift::Format::eRGBA16F)
-                    .Build();
-
-            m_post_process_ldr.m_src_texture =
-                TextureViewBuilder(m_context, size)
-                    .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
-                    .SetFormat(Swift::Format::eRGBA8_UNORM)
-                    .Build();
-            m_post_process_ldr.m_dst_texture =
-                TextureViewBuilder(m_context, size)
-                    .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
-                    .SetFormat(Swift::Format::eRGBA8_UNORM)
-                    .Build();
-
-            m_depth_texture =
-                TextureViewBuilder(m_context, size)
-                    .SetFlags(EnumFlags(Swift::TextureFlags::eDepthStencil) | Swift::TextureFlags::eShaderResource)
-                    .SetFormat(Swift::Format::eD32F)
-                    .Build();
-
-            m_ssao_pass.gen_texture =
-                TextureViewBuilder(m_context, size)
-                    .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
-                    .SetFormat(Swift::Format::eR8_UNORM)
-                    .SetName("SSAO Gen Texture")
-                    .Build();
-
-            m_ssao_pass.blur_texture =
-                TextureViewBuilder(m_context, size)
-                    .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
-                    .SetFormat(Swift::Format::eR8_UNORM)
-                    .SetName("SSAO Blur Texture")
-                    .Build();
-        });
+    // Window callbacks fire while polling events on the main thread, the textures are only recreated at the sync point.
+    m_engine->GetWindow().AddResizeCallback([&](const glm::uvec2 size) { m_pending_resize = size; });
 }
 
 Renderer::~Renderer()
 {
+    if (m_headless) return;
+
     m_context->GetGraphicsQueue()->WaitIdle();
+    m_frame_upload_buffer.Destroy();
     ImGui_ImplDX12_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -112,23 +308,78 @@ Renderer::~Renderer()
     Swift::DestroyContext(m_context);
 }
 
-void Renderer::UpdateGlobalConstantBuffer(const Camera& camera) const
+void Renderer::Resize(const glm::uvec2 size)
+{
+    m_context->GetGraphicsQueue()->WaitIdle();
+    m_context->ResizeBuffers(size.x, size.y);
+    m_render_texture.Destroy(m_context);
+    m_depth_texture.Destroy(m_context);
+    m_post_process_hdr.m_dst_texture.Destroy(m_context);
+    m_post_process_hdr.m_src_texture.Destroy(m_context);
+    m_post_process_ldr.m_dst_texture.Destroy(m_context);
+    m_post_process_ldr.m_src_texture.Destroy(m_context);
+
+    m_render_texture =
+        TextureViewBuilder(m_context, size)
+            .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
+            .SetFormat(Swift::Format::eRGBA16F)
+            .Build();
+
+    m_post_process_hdr.m_src_texture =
+        TextureViewBuilder(m_context, size)
+            .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
+            .SetFormat(Swift::Format::eRGBA16F)
+            .Build();
+    m_post_process_hdr.m_dst_texture =
+        TextureViewBuilder(m_context, size)
+            .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
+            .SetFormat(Swift::Format::eRGBA16F)
+            .Build();
+
+    m_post_process_ldr.m_src_texture =
+        TextureViewBuilder(m_context, size)
+            .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
+            .SetFormat(Swift::Format::eRGBA8_UNORM)
+            .Build();
+    m_post_process_ldr.m_dst_texture =
+        TextureViewBuilder(m_context, size)
+            .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
+            .SetFormat(Swift::Format::eRGBA8_UNORM)
+            .Build();
+
+    m_depth_texture =
+        TextureViewBuilder(m_context, size)
+            .SetFlags(EnumFlags(Swift::TextureFlags::eDepthStencil) | Swift::TextureFlags::eShaderResource)
+            .SetFormat(Swift::Format::eD32F)
+            .Build();
+
+    m_ssao_pass.gen_texture =
+        TextureViewBuilder(m_context, size)
+            .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
+            .SetFormat(Swift::Format::eR8_UNORM)
+            .SetName("SSAO Gen Texture")
+            .Build();
+
+    m_ssao_pass.blur_texture =
+        TextureViewBuilder(m_context, size)
+            .SetFlags(EnumFlags(Swift::TextureFlags::eRenderTarget) | Swift::TextureFlags::eShaderResource)
+            .SetFormat(Swift::Format::eR8_UNORM)
+            .SetName("SSAO Blur Texture")
+            .Build();
+}
+
+void Renderer::UpdateGlobalConstantBuffer(const FrameSnapshot& snapshot)
 {
     CPU_ZONE("Update Constant Buffer")
-    constexpr float near_plane = 1.0f;
-    constexpr float far_plane = 1200.f;
-    const glm::mat4 sun_proj = glm::orthoRH_ZO(-500.0f, 500.0f, -500.f, 500.0f, near_plane, far_plane);
-    constexpr float sun_distance = 150.f;
-    const glm::vec3 sun_pos = -glm::normalize(m_dir_lights[0].direction) * sun_distance;
-    const auto sun_view = glm::lookAtRH(sun_pos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-
-    auto screen_size = m_engine->GetWindow().GetSize();
+    const auto& camera = snapshot.camera;
+    auto screen_size = snapshot.screen_size;
     auto inv_screen_size = glm::vec2(1.0) / glm::vec2(screen_size);
-    const GlobalConstantInfo info{
+    const auto cascades = m_shadow_pass.cascades.GetCascades();
+    const auto& cache = m_shadow_pass.cache;
+    GlobalConstantInfo info{
         .view_proj = camera.m_proj_matrix * camera.m_view_matrix,
         .view = camera.m_view_matrix,
         .proj = camera.m_proj_matrix,
-        .sun_view_proj = sun_proj * sun_view,
         .inv_view_proj = glm::inverse(camera.m_proj_matrix * camera.m_view_matrix),
         .inv_proj = glm::inverse(camera.m_proj_matrix),
         .cam_pos = camera.m_position,
@@ -147,17 +398,38 @@ void Renderer::UpdateGlobalConstantBuffer(const Camera& camera) const
         .frustum_buffer_index = m_frustum_buffer.GetDescriptorIndex(),
         .point_light_buffer_index = m_point_light_buffer.GetDescriptorIndex(),
         .dir_light_buffer_index = m_dir_light_buffer.GetDescriptorIndex(),
-        .point_light_count = static_cast<uint32_t>(m_point_lights.size()),
-        .dir_light_count = static_cast<uint32_t>(m_dir_lights.size()),
-        .shadow_texture_index = m_shadow_pass.texture.GetSRVDescriptorIndex(),
+        .point_light_count = static_cast<uint32_t>(m_uploaded_point_lights.size()),
+        .dir_light_count = static_cast<uint32_t>(m_uploaded_dir_lights.size()),
+        .cascade_count = static_cast<uint32_t>(cascades.size()),
         .grass_buffer_index = m_grass_pass.buffer.GetDescriptorIndex(),
         .ibl_texture_index = m_specular_ibl_texture.GetSRVDescriptorIndex(),
-        .ssao_texture_index = m_ssao_pass.blur_texture.GetSRVDescriptorIndex(),
+        .ssao_texture_index = GetAmbientOcclusionTexture().GetSRVDescriptorIndex(),
         .screen_size = screen_size,
         .inv_screen_size = inv_screen_size,
+        .render_scale = glm::vec2(GetRenderExtent(screen_size)) * inv_screen_size,
+        .shadow_depth_range = cache.GetDepthRange(),
+        .frame_upload_buffer_index = m_frame_upload_buffer.GetDescriptorIndex(),
+        .light_cluster_offset = m_light_cluster_offset / static_cast<uint32_t>(sizeof(uint32_t)),
+        .light_slice_scale_bias = m_light_clusters.GetSliceScaleBias(),
+        .shadow_atlas_index = m_shadow_pass.atlas.GetSRVDescriptorIndex(),
+        .shadow_light_view = cache.GetLightView(),
     };
-    const auto current_index = m_context->GetFrameIndex();
-    m_global_constant_buffers[current_index].Write(&info, 0, sizeof(GlobalConstantInfo));
+    const auto levels = cache.GetLevels();
+    for (uint32_t i = 0; i < cascades.size(); ++i)
+    {
+        info.cascades[i] = {
+            .split_depth = cascades[i].split_depth,
+            .tile_size = levels[i].tile_size,
+            .tile_origin = levels[i].origin,
+        };
+    }
+    const auto renders = cache.GetRenders();
+    for (uint32_t i = 0; i < renders.size(); ++i)
+    {
+        info.shadow_tile_view_projs[i] = renders[i].view_proj;
+    }
+    std::ranges::copy(cache.GetPageTable(), info.shadow_pages.begin());
+    Upload(m_global_constant_buffers[GetFrameIndex()], &info, 0, sizeof(GlobalConstantInfo));
 }
 
 void Renderer::RenderImGUI(Swift::ICommand* command) const
@@ -166,7 +438,6 @@ void Renderer::RenderImGUI(Swift::ICommand* command) const
     auto* render_target = m_context->GetCurrentRenderTarget();
     Swift::RenderAttachmentInfo color_attachment_info{ .render_target = render_target, .load_op = Swift::LoadOp::eLoad };
     command->BeginRender(color_attachment_info, std::nullopt);
-    ImGui::Render();
     ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), static_cast<ID3D12GraphicsCommandList*>(command->GetCommandList()));
     command->EndRender();
 }
@@ -187,83 +458,161 @@ void Renderer::ImGUINewFrame()
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 }
-void Renderer::Update()
+void Renderer::Extract(const std::chrono::high_resolution_clock::time_point frame_start)
 {
-    CPU_ZONE("Rendering Loop");
-    m_context->NewFrame();
+    CPU_ZONE("Extract Frame");
+    if (m_pending_resize)
+    {
+        Resize(*m_pending_resize);
+        m_pending_resize.reset();
+    }
 
-    auto* command = m_context->GetCurrentCommand();
-    auto& camera = m_engine->GetCamera();
+    // The editor reads and edits simulation state, so its UI is built here and the render thread only submits it.
+    if (!m_headless)
+    {
+        ImGUINewFrame();
+        const auto render_image_descriptor =
+            static_cast<Swift::D3D12::TextureView*>(m_post_process_ldr.m_dst_texture.srv)->GetDescriptorData().gpu_handle.ptr;
+        m_engine->GetEditor().Render(&render_image_descriptor);
+        ImGui::Render();
+    }
 
-    m_render_graph.NewFrame(command);
+    auto& snapshot = m_snapshots[m_snapshot_index];
+    FillSnapshot(snapshot);
+    snapshot.frame_start = frame_start;
+    m_snapshot_index ^= 1;
+    m_snapshots[m_snapshot_index].transforms.clear();
+    m_snapshots[m_snapshot_index].removed.clear();
+    m_snapshots[m_snapshot_index].grass_patches.reset();
+}
 
-    UpdateGlobalConstantBuffer(camera);
+void Renderer::Render()
+{
+    CPU_ZONE("Rendering Loop");
+    auto& snapshot = GetRenderSnapshot();
+    Swift::ICommand* command = nullptr;
+    if (m_headless)
+    {
+        m_null_frame.Reset();
+    }
+    else
+    {
+        m_context->NewFrame();
+        for (auto* buffer : { &m_transform_buffer,
+                              &m_material_buffer,
+                              &m_cull_data_buffer,
+                              &m_point_light_buffer,
+                              &m_dir_light_buffer,
+                              &m_grass_pass.buffer })
+        {
+            buffer->CollectRetired(m_frame_number);
+        }
+        command = m_context->GetCurrentCommand();
+        m_render_graph.NewFrame(command);
+    }
+    m_frame_upload_buffer.BeginFrame();
+    // Headless frames free removed geometry on the same schedule, so the pool behaves the same without a GPU.
+    m_geometry_pool.CollectRetired(m_frame_number);
+
+    const auto& camera = snapshot.camera;
+
+    ApplySnapshot(snapshot);
+    UpdateRenderScale(snapshot);
+    UploadDirtyRanges();
+    // The cascades are fitted while building the draw lists and the constants carry them.
+    BuildDrawLists(snapshot);
+    // After the draw lists, which decide the shadow tiles drawn this frame.
+    DeclareFrameGraph(snapshot.screen_size);
+    BuildLightClusters(snapshot);
+    UpdateGlobalConstantBuffer(snapshot);
 
     {
         CPU_ZONE("Update Frustum Buffer")
         const auto frustum = camera.CreateFrustum();
-
-        auto vp = camera.m_proj_matrix * camera.m_view_matrix;
-        for(int i = 0; i < 4; i++)
-            std::println("vp[{}]: {}, {}, {}, {}", i, vp[i].x, vp[i].y, vp[i].z, vp[i].w);
-
-        m_frustum_buffer.Write(&frustum, 0, sizeof(Frustum));
+        Upload(m_frustum_buffer, &frustum, 0, sizeof(Frustum));
     }
 
-    m_profiler->NewFrame();
-
-    ImGUINewFrame();
-
-    command->Begin();
-
-    auto current_index = m_context->GetFrameIndex();
-    command->BindConstantBuffer(m_global_constant_buffers[current_index].buffer, 1);
-
-    ClearTextures(command);
+    if (!m_headless)
+    {
+        m_profiler->NewFrame();
 
-    DrawDepthPrePass();
-    DrawSSAOPass();
-    DrawGeometry();
-    DrawGrassPass();
-    DrawSkybox();
-    DrawBloomPass();
-    DrawVolumetricFog();
-    DrawTonemapPass();
+        command->Begin();
+        command->BindConstantBuffer(m_global_constant_buffers[GetFrameIndex()].buffer, 1);
+    }
 
-    m_render_graph.Execute();
+    m_frame_graph.Execute();
 
-    const auto render_image_descriptor =
-        static_cast<Swift::D3D12::TextureView*>(m_post_process_ldr.m_dst_texture.srv)->GetDescriptorData().gpu_handle.ptr;
-    m_engine->GetEditor().Render(&render_image_descriptor);
+    if (!m_headless)
+    {
+        m_render_graph.Execute();
 
-    auto* render_target_texture = m_context->GetCurrentSwapchainTexture();
-    RenderImGUI(command);
+        auto* render_target_texture = m_context->GetCurrentSwapchainTexture();
+        RenderImGUI(command);
 
-    command->TransitionImage(render_target_texture, Swift::ResourceState::ePresent);
-    command->End();
+        command->TransitionImage(render_target_texture, Swift::ResourceState::ePresent);
+        command->End();
 
-    {
         CPU_ZONE("Present Time")
         m_context->Present(false);
     }
+    m_frame_upload_buffer.EndFrame();
+
+    const auto now = std::chrono::high_resolution_clock::now();
+    m_frame_latency = std::chrono::duration<float, std::milli>(now - snapshot.frame_start).count();
+    CPU_PLOT("Frame Latency", m_frame_latency);
+    m_last_upload_bytes = m_upload_bytes;
+    m_upload_bytes = 0;
+    ++m_frame_number;
+    CPU_PLOT("Upload Bytes", static_cast<int64_t>(m_last_upload_bytes));
 }
 
-void Renderer::GenerateStaticShadowMap()
+void Renderer::AssertRenderIdle() const
 {
-    auto& camera = m_engine->GetCamera();
-    UpdateGlobalConstantBuffer(camera);
-    m_context->GetGraphicsQueue()->WaitIdle();
-    const auto command = m_context->CreateCommand(m_context->GetGraphicsQueue());
-    m_render_graph.NewFrame(command);
-    command->Begin();
-    const auto current_index = m_context->GetFrameIndex();
-    command->BindConstantBuffer(m_global_constant_buffers[current_index].buffer, 1);
-    DrawShadowPass(command);
-    m_render_graph.Execute();
-    command->End();
-    const auto fence_value = m_context->GetGraphicsQueue()->Execute(command);
-    m_context->GetGraphicsQueue()->Wait(fence_value);
-    m_context->DestroyCommand(command);
+    assert(m_engine->IsRenderIdle() && "Renderer state touched while a frame renders, queue it with RunOnMainThread");
+}
+
+void Renderer::FillSnapshot(FrameSnapshot& snapshot)
+{
+    snapshot.camera = m_engine->GetCamera();
+    // Every snapshot is rendered exactly once, so the changes taken here reach the light buffers exactly once.
+    m_point_lights.TakeChanges(m_light_update_budget, snapshot.point_lights);
+    m_dir_lights.TakeChanges(m_light_update_budget, snapshot.dir_lights);
+    CPU_PLOT("Pending Light Updates",
+             static_cast<int64_t>(m_point_lights.GetPendingCount() + m_dir_lights.GetPendingCount()));
+    snapshot.grass_patches = std::exchange(m_scattered_grass, std::nullopt);
+    snapshot.screen_size = m_engine->GetWindow().GetSize();
+    snapshot.time = m_engine->GetTime();
+}
+
+void Renderer::ApplySnapshot(FrameSnapshot& snapshot)
+{
+    CPU_ZONE("Apply Snapshot");
+    for (const auto& [offset, size, transform] : snapshot.transforms)
+    {
+        for (uint32_t i = offset; i < offset + size; ++i)
+        {
+            SetRenderableTransform(i, transform * m_renderables[i].m_local_transform);
+        }
+    }
+    for (const auto& [offset, size] : snapshot.removed)
+    {
+        for (uint32_t i = offset; i < offset + size; ++i)
+        {
+            RemoveRenderable(i);
+        }
+    }
+    if (snapshot.grass_patches)
+    {
+        // Swapped rather than copied, the old patches are freed with the snapshot at the next Extract.
+        std::swap(m_grass_pass.patches, *snapshot.grass_patches);
+        m_grass_pass.dirty_patches = {};
+        m_grass_pass.uploaded_count = 0;
+    }
+    snapshot.point_lights.Apply(m_uploaded_point_lights, m_dirty_point_lights);
+    snapshot.dir_lights.Apply(m_uploaded_dir_lights, m_dirty_dir_lights);
+    m_dir_shadow_caster_count = snapshot.dir_lights.shadow_caster_count;
+    UploadDirty<PointLight>(m_point_light_buffer, m_uploaded_point_lights, m_dirty_point_lights);
+    UploadDirty<DirectionalLight>(m_dir_light_buffer, m_uploaded_dir_lights, m_dirty_dir_lights);
 }
 
 void Renderer::InitContext()
@@ -362,14 +711,22 @@ void Renderer::InitBuffers()
 {
     for (auto& buffer : m_global_constant_buffers)
     {
-        buffer = BufferViewBuilder(m_context, 65536).Build();
+        buffer = BufferViewBuilder(m_context, GLOBAL_CONSTANT_SIZE).Build();
     }
-    m_transform_buffer = BufferViewBuilder(m_context, 10'000 * sizeof(glm::mat4)).SetNumElements(10'000).Build();
-    m_point_light_buffer = BufferViewBuilder(m_context, sizeof(PointLight) * 100).SetNumElements(100).Build();
-    m_dir_light_buffer = BufferViewBuilder(m_context, sizeof(DirectionalLight) * 100).SetNumElements(100).Build();
-    m_material_buffer = BufferViewBuilder(m_context, sizeof(Material) * 10'000).SetNumElements(10'000).Build();
-    m_cull_data_buffer = BufferViewBuilder(m_context, sizeof(CullData) * 1'000'000).SetNumElements(1'000'000).Build();
     m_frustum_buffer = BufferViewBuilder(m_context, sizeof(Frustum)).SetNumElements(1).Build();
+    InitGrowableBuffers();
+}
+
+void Renderer::InitGrowableBuffers()
+{
+    m_transform_buffer = GrowableBuffer(m_context, sizeof(glm::mat4), "Transform Buffer");
+    m_material_buffer = GrowableBuffer(m_context, sizeof(Material), "Material Buffer");
+    m_cull_data_buffer = GrowableBuffer(m_context, sizeof(CullData), "Cull Data Buffer");
+    m_point_light_buffer = GrowableBuffer(m_context, sizeof(PointLight), "Point Light Buffer");
+    m_dir_light_buffer = GrowableBuffer(m_context, sizeof(DirectionalLight), "Directional Light Buffer");
+    m_grass_pass.buffer = GrowableBuffer(m_context, sizeof(GrassPatch), "Grass Patch Buffer");
+    m_frame_upload_buffer = FrameUploadBuffer(m_context, "Frame Upload Buffer");
+    m_geometry_pool = GeometryPool(m_context);
 
     Material default_material{
         .albedo = glm::vec4(1.0f),
@@ -386,7 +743,9 @@ void Renderer::InitBuffers()
     default_material.occlusion_index = m_dummy_white_texture.GetSRVDescriptorIndex();
     default_material.emissive_index = m_dummy_black_texture.GetSRVDescriptorIndex();
     default_material.normal_index = m_dummy_normal_texture.GetSRVDescriptorIndex();
-    m_material_buffer.Write(&default_material, 0, sizeof(Material));
+    // Meshes without a material use slot 0, model materials are appended after it.
+    m_materials.push_back(default_material);
+    m_dirty_materials.Mark(0);
 }
 
 void Renderer::InitDepthPrepass()
@@ -406,11 +765,12 @@ void Renderer::InitDepthPrepass()
 
 void Renderer::InitShadowPass()
 {
-    m_shadow_pass.texture = TextureViewBuilder(m_context, { 4096, 4096 })
-                                .SetFormat(Swift::Format::eD32F)
-                                .SetFlags(EnumFlags(Swift::TextureFlags::eDepthStencil) | Swift::TextureFlags::eShaderResource)
-                                .SetName("Shadow Texture")
-                                .Build();
+    m_shadow_pass.atlas =
+        TextureViewBuilder(m_context, { ShadowTileCache::ATLAS_WIDTH, ShadowTileCache::ATLAS_HEIGHT })
+            .SetFormat(Swift::Format::eD32F)
+            .SetFlags(EnumFlags(Swift::TextureFlags::eDepthStencil) | Swift::TextureFlags::eShaderResource)
+            .SetName("Shadow Atlas")
+            .Build();
 
     m_shadow_pass.shader = Swift::GraphicsShaderBuilder(m_context)
                                .SetDSVFormat(Swift::Format::eD32F)
@@ -494,10 +854,6 @@ void Renderer::InitSkyboxShader()
 
 void Renderer::InitGrassPass()
 {
-    m_grass_pass.buffer = BufferViewBuilder(m_context, 10'000'000 * sizeof(GrassPatch))
-                              .SetNumElements(10'000'000)
-                              .SetName("Grass Patch Buffer")
-                              .Build();
     m_grass_pass.shader = Swift::GraphicsShaderBuilder(m_context)
                               .SetRTVFormats({ Swift::Format::eRGBA16F })
                               .SetDSVFormat(Swift::Format::eD32F)
@@ -578,47 +934,69 @@ void Renderer::InitTonemapPass()
 
 std::tuple<uint32_t, uint32_t> Renderer::CreateMeshRenderers(Model& model, const glm::mat4& transform)
 {
-    struct MeshBuffers
-    {
-        BufferView position_buffer;
-        BufferView attrib_buffer;
-        BufferView meshlet_buffer;
-        BufferView meshlet_vertex_buffer;
-        BufferView meshlet_tris_buffer;
-    };
-
-    std::vector<MeshBuffers> mesh_buffers;
-    mesh_buffers.reserve(model.meshes.size());
+    std::vector<GeometryAllocation> mesh_geometry;
+    mesh_geometry.reserve(model.meshes.size());
+    std::vector<int> mesh_occluders;
+    mesh_occluders.reserve(model.meshes.size());
+    const auto first_pick_mesh = static_cast<uint32_t>(m_pick_meshes.size());
 
     for (const auto& mesh : model.meshes)
     {
-        MeshBuffers mesh_buffer;
-        mesh_buffer.position_buffer = BufferViewBuilder(m_context, sizeof(glm::vec3) * mesh.positions.size())
-                                          .SetData(mesh.positions.data())
-                                          .SetNumElements(mesh.positions.size())
-                                          .Build();
-        mesh_buffer.attrib_buffer = BufferViewBuilder(m_context, sizeof(Vertex) * mesh.vertex_attribs.size())
-                                        .SetData(mesh.vertex_attribs.data())
-                                        .SetNumElements(mesh.vertex_attribs.size())
-                                        .Build();
-        mesh_buffer.meshlet_buffer = BufferViewBuilder(m_context, sizeof(meshopt_Meshlet) * mesh.meshlets.size())
-                                         .SetData(mesh.meshlets.data())
-                                         .SetNumElements(mesh.meshlets.size())
-                                         .Build();
-        mesh_buffer.meshlet_vertex_buffer = BufferViewBuilder(m_context, sizeof(uint32_t) * mesh.meshlet_vertices.size())
-                                                .SetData(mesh.meshlet_vertices.data())
-                                                .SetNumElements(mesh.meshlet_vertices.size())
-                                                .Build();
-        mesh_buffer.meshlet_tris_buffer = BufferViewBuilder(m_context, sizeof(uint32_t) * mesh.meshlet_triangles.size())
-                                              .SetData(mesh.meshlet_triangles.data())
-                                              .SetNumElements(mesh.meshlet_triangles.size())
-                                              .Build();
-        mesh_buffers.push_back(mesh_buffer);
+        int occluder_index = -1;
+        if (mesh.occluder)
+        {
+            occluder_index = static_cast<int>(m_occlusion_pass.occluders.size());
+            m_occlusion_pass.occluders.push_back(*mesh.occluder);
+        }
+        mesh_occluders.push_back(occluder_index);
+
+        auto& pick_mesh = m_pick_meshes.emplace_back(PickMesh{ .positions = mesh.positions });
+        for (const auto& meshlet : mesh.meshlets)
+        {
+            for (uint32_t i = 0; i < meshlet.triangle_count; ++i)
+            {
+                const uint32_t packed = mesh.meshlet_triangles[meshlet.triangle_offset + i];
+                for (uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t local_vertex = packed >> corner * 8 & 0xFF;
+                    pick_mesh.indices.push_back(mesh.meshlet_vertices[meshlet.vertex_offset + local_vertex]);
+                }
+            }
+        }
+
+        const auto geometry = m_geometry_pool.Allocate(mesh);
+        const auto& page = m_geometry_pool.GetPage(geometry.page);
+        Upload(page.positions,
+               mesh.positions.data(),
+               geometry.vertices.offset * sizeof(glm::vec3),
+               sizeof(glm::vec3) * mesh.positions.size());
+        Upload(page.attributes,
+               mesh.vertex_attribs.data(),
+               geometry.vertices.offset * sizeof(Vertex),
+               sizeof(Vertex) * mesh.vertex_attribs.size());
+        Upload(page.meshlets,
+               mesh.meshlets.data(),
+               geometry.meshlets.offset * sizeof(meshopt_Meshlet),
+               sizeof(meshopt_Meshlet) * mesh.meshlets.size());
+        Upload(page.meshlet_vertices,
+               mesh.meshlet_vertices.data(),
+               geometry.meshlet_vertices.offset * sizeof(uint32_t),
+               sizeof(uint32_t) * mesh.meshlet_vertices.size());
+        Upload(page.meshlet_triangles,
+               mesh.meshlet_triangles.data(),
+               geometry.meshlet_triangles.offset * sizeof(uint32_t),
+               sizeof(uint32_t) * mesh.meshlet_triangles.size());
+        mesh_geometry.push_back(geometry);
     }
 
     uint32_t texture_offset = m_textures.size();
     for (auto& texture : model.textures)
     {
+        if (m_headless)
+        {
+            m_textures.emplace_back();
+            continue;
+        }
         auto* t = Swift::TextureBuilder(m_context, texture.width, texture.height)
                       .SetFormat(texture.format)
                       .SetArraySize(texture.array_size)
@@ -653,11 +1031,12 @@ std::tuple<uint32_t, uint32_t> Renderer::CreateMeshRenderers(Model& model, const
     std::vector<MeshRenderer> renderers;
     renderers.reserve(model.nodes.size());
     uint32_t bounding_offset = m_cull_data.size();
+    const auto first_transform = static_cast<uint32_t>(m_transforms.size());
+    const auto first_material = static_cast<uint32_t>(m_materials.size());
+    const auto first_cull_data = static_cast<uint32_t>(m_cull_data.size());
     for (const auto& node : model.nodes)
     {
         const auto& mesh = model.meshes[node.mesh_index];
-        const auto& [pos_buffer, vertex_buffer, meshlet_buffer, meshlet_vertex_buffer, meshlet_tris_buffer] =
-            mesh_buffers[node.mesh_index];
         const auto transform_index = static_cast<uint32_t>(m_transforms.size());
         auto final_transform = transform * model.transforms[node.transform_index];
         m_transforms.emplace_back(final_transform);
@@ -668,131 +1047,591 @@ std::tuple<uint32_t, uint32_t> Renderer::CreateMeshRenderers(Model& model, const
             m_materials.emplace_back(model.materials[mesh.material_index]);
         }
         renderers.push_back({
-            .m_position_buffer = pos_buffer,
-            .m_attrib_buffer = vertex_buffer,
-            .m_mesh_buffer = meshlet_buffer,
-            .m_mesh_vertex_buffer = meshlet_vertex_buffer,
-            .m_mesh_triangle_buffer = meshlet_tris_buffer,
+            .m_geometry = mesh_geometry[node.mesh_index],
             .m_meshlet_count = static_cast<uint32_t>(mesh.meshlets.size()),
             .m_material_index = material_index,
             .m_transform_index = transform_index,
             .m_bounding_offset = bounding_offset,
+            .m_local_bounds = mesh.bounds,
+            .m_occluder_index = mesh_occluders[node.mesh_index],
+            .m_pick_mesh_index = first_pick_mesh + node.mesh_index,
+            .m_local_transform = model.transforms[node.transform_index],
         });
+        m_world_bounds.emplace_back(mesh.bounds.Transform(final_transform));
+        m_shadow_pass.cache.Invalidate(m_world_bounds.back().box);
 
         bounding_offset += mesh.meshlets.size();
     }
+    m_mesh_users.resize(m_pick_meshes.size());
+    for (const auto& node : model.nodes)
+    {
+        ++m_mesh_users[first_pick_mesh + node.mesh_index];
+    }
+    // Meshes no node draws are never needed, nothing has read their geometry yet so it goes right away.
+    for (uint32_t i = 0; i < model.meshes.size(); ++i)
+    {
+        if (m_mesh_users[first_pick_mesh + i] > 0) continue;
+        m_geometry_pool.Free(mesh_geometry[i]);
+        m_pick_meshes[first_pick_mesh + i] = {};
+    }
     m_cull_data.insert_range(m_cull_data.end(), model.cull_datas);
+    m_dirty_transforms.Mark(first_transform, static_cast<uint32_t>(m_transforms.size()));
+    m_dirty_materials.Mark(first_material, static_cast<uint32_t>(m_materials.size()));
+    m_dirty_cull_data.Mark(first_cull_data, static_cast<uint32_t>(m_cull_data.size()));
     auto offset = static_cast<uint32_t>(m_renderables.size());
     auto size = static_cast<uint32_t>(renderers.size());
     m_renderables.insert_range(m_renderables.end(), renderers);
+    UpdateDrawPackets(offset, size);
+    m_bvh.Insert(std::span(m_world_bounds).subspan(offset));
     return { offset, size };
 }
 
+void Renderer::UpdateDrawPackets(const uint32_t first, const uint32_t count)
+{
+    m_depth_packets.resize(m_renderables.size());
+    m_geometry_packets.resize(m_renderables.size());
+    const uint32_t shadow_sampler_index = GetSamplerIndex(m_shadow_comparison_sampler);
+    const uint32_t sampler_index = GetSamplerIndex(m_bilinear_sampler);
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        const auto& renderable = m_renderables[i];
+        const auto& geometry = renderable.m_geometry;
+        const auto& page = m_geometry_pool.GetPage(geometry.page);
+        m_depth_packets[i] = {
+            .position_buffer = page.positions.GetDescriptorIndex(),
+            .meshlet_buffer = page.meshlets.GetDescriptorIndex(),
+            .mesh_vertex_buffer = page.meshlet_vertices.GetDescriptorIndex(),
+            .mesh_triangle_buffer = page.meshlet_triangles.GetDescriptorIndex(),
+            .transform_index = renderable.m_transform_index,
+            .meshlet_count = renderable.m_meshlet_count,
+            .bounding_offset = renderable.m_bounding_offset,
+            .vertex_offset = geometry.vertices.offset,
+            .meshlet_offset = geometry.meshlets.offset,
+            .meshlet_vertex_offset = geometry.meshlet_vertices.offset,
+            .meshlet_triangle_offset = geometry.meshlet_triangles.offset,
+        };
+        m_geometry_packets[i] = {
+            .shadow_sampler_index = shadow_sampler_index,
+            .sampler_index = sampler_index,
+            .position_buffer = page.positions.GetDescriptorIndex(),
+            .vertex_buffer = page.attributes.GetDescriptorIndex(),
+            .meshlet_buffer = page.meshlets.GetDescriptorIndex(),
+            .mesh_vertex_buffer = page.meshlet_vertices.GetDescriptorIndex(),
+            .mesh_triangle_buffer = page.meshlet_triangles.GetDescriptorIndex(),
+            .material_index = renderable.m_material_index,
+            .transform_index = renderable.m_transform_index,
+            .meshlet_count = renderable.m_meshlet_count,
+            .bounding_offset = renderable.m_bounding_offset,
+            .vertex_offset = geometry.vertices.offset,
+            .meshlet_offset = geometry.meshlets.offset,
+            .meshlet_vertex_offset = geometry.meshlet_vertices.offset,
+            .meshlet_triangle_offset = geometry.meshlet_triangles.offset,
+        };
+    }
+}
+
+void Renderer::SetRenderableTransform(const uint32_t renderable_index, const glm::mat4& transform)
+{
+    const auto& renderable = m_renderables[renderable_index];
+    if (renderable.m_removed) return;
+    // Setting the same transform again would redraw every shadow tile under the renderable for nothing.
+    if (m_transforms[renderable.m_transform_index] == transform) return;
+    m_transforms[renderable.m_transform_index] = transform;
+    // The tiles it left and the tiles it entered both have to be drawn again.
+    m_shadow_pass.cache.Invalidate(m_world_bounds[renderable_index].box);
+    m_world_bounds[renderable_index] = renderable.m_local_bounds.Transform(transform);
+    m_shadow_pass.cache.Invalidate(m_world_bounds[renderable_index].box);
+    m_bvh.Update(renderable_index, m_world_bounds[renderable_index]);
+
+    m_dirty_transforms.Mark(renderable.m_transform_index);
+}
+
+void Renderer::RemoveRenderable(const uint32_t renderable_index)
+{
+    auto& renderable = m_renderables[renderable_index];
+    if (renderable.m_removed) return;
+    renderable.m_removed = true;
+    // Its shadow is still drawn into the tiles it covered.
+    m_shadow_pass.cache.Invalidate(m_world_bounds[renderable_index].box);
+    // Empty bounds fail every frustum, overlap and ray test, so it drops out of the draw lists, shadows and picking.
+    m_world_bounds[renderable_index] = {};
+    m_bvh.Update(renderable_index, m_world_bounds[renderable_index]);
+
+    // The nodes of a model share its meshes, the geometry stays until the last of them is gone. Frames still in flight
+    // may draw it, so its ranges are only handed out again once those have completed.
+    if (--m_mesh_users[renderable.m_pick_mesh_index] > 0) return;
+    m_geometry_pool.Retire(renderable.m_geometry, m_frame_number);
+    m_pick_meshes[renderable.m_pick_mesh_index] = {};
+}
+
+void Renderer::SetActorTransform(const uint32_t offset, const uint32_t size, const glm::mat4& transform)
+{
+    if (size == 0) return;
+    m_snapshots[m_snapshot_index].transforms.push_back({ .offset = offset, .size = size, .transform = transform });
+}
+
+void Renderer::RemoveRenderables(const uint32_t offset, const uint32_t size)
+{
+    if (size == 0) return;
+    m_snapshots[m_snapshot_index].removed.push_back({ .offset = offset, .size = size });
+}
+
+void Renderer::UploadDirtyRanges()
+{
+    CPU_ZONE("Upload Dirty Ranges");
+    UploadDirty<glm::mat4>(m_transform_buffer, m_transforms, m_dirty_transforms);
+    UploadDirty<Material>(m_material_buffer, m_materials, m_dirty_materials);
+    UploadDirty<CullData>(m_cull_data_buffer, m_cull_data, m_dirty_cull_data);
+    UploadGrassPatches();
+}
+
+void Renderer::UploadGrassPatches()
+{
+    auto& grass = m_grass_pass;
+    const auto count = static_cast<uint32_t>(grass.patches.size());
+    grass.uploaded_count = std::min(grass.uploaded_count, count);
+    grass.sent_patches = 0;
+    if (grass.buffer.Reserve(count, m_frame_number))
+    {
+        // A new buffer starts out empty, the patches drawn so far are written again at once so none disappear.
+        grass.dirty_patches.Mark(0, grass.uploaded_count);
+    }
+    const auto upload = [&](const uint32_t begin, const uint32_t end)
+    {
+        Upload(grass.buffer.GetView(), &grass.patches[begin], begin * sizeof(GrassPatch), (end - begin) * sizeof(GrassPatch));
+        grass.sent_patches += end - begin;
+    };
+    // Edits past the drawn patches are written with their chunk.
+    grass.dirty_patches.Flush(
+        [&](const uint32_t begin, const uint32_t end)
+        {
+            if (begin < grass.uploaded_count)
+            {
+                upload(begin, std::min(end, grass.uploaded_count));
+            }
+        });
+    const uint32_t end = std::min(count, grass.uploaded_count + std::max(grass.upload_budget, 1u));
+    if (end > grass.uploaded_count)
+    {
+        upload(grass.uploaded_count, end);
+        grass.uploaded_count = end;
+    }
+    CPU_PLOT("Grass Patches Pending", static_cast<int64_t>(count - grass.uploaded_count));
+}
+
+void Renderer::ScatterGrass(const GrassSurface& surface,
+                            const GrassDensityMap& density,
+                            const GrassScatterSettings& settings)
+{
+    auto& patches = m_scattered_grass.emplace();
+    m_grass_pass.scatter.Generate(m_engine->GetJobSystem(), surface, density, settings, patches);
+}
+
+template <typename T>
+void Renderer::UploadDirty(GrowableBuffer& buffer, const std::span<const T> data, DirtyRanges& ranges)
+{
+    const auto count = static_cast<uint32_t>(data.size());
+    if (buffer.Reserve(count, m_frame_number))
+    {
+        ranges.Mark(0, count);
+    }
+    ranges.Flush([&](const uint32_t begin, const uint32_t end)
+                 { Upload(buffer.GetView(), &data[begin], begin * sizeof(T), (end - begin) * sizeof(T)); });
+}
+
+void Renderer::Upload(const BufferView& buffer, const void* data, const uint32_t offset, const size_t size)
+{
+    if (size == 0) return;
+
+    m_upload_bytes += size;
+    if (m_headless)
+    {
+        ++m_null_frame.uploads;
+        m_null_frame.upload_bytes += size;
+        return;
+    }
+    buffer.Write(data, offset, static_cast<uint32_t>(size));
+}
+
+void Renderer::DeclareFrameGraph(const glm::uvec2 size)
+{
+    CPU_ZONE("Declare Frame Graph");
+    auto& graph = m_frame_graph;
+    graph.Reset();
+    const uint64_t pixels = static_cast<uint64_t>(size.x) * size.y;
+    // Shadow tiles outlive the frame, every shadow pass modifies the atlas and the planner keeps it out of aliasing.
+    constexpr uint64_t shadow_texels = static_cast<uint64_t>(ShadowTileCache::ATLAS_WIDTH) * ShadowTileCache::ATLAS_HEIGHT;
+    const uint32_t shadow = graph.AddTexture("Shadow Atlas", shadow_texels * 4);
+    const uint32_t scene = graph.AddTexture("Scene", pixels * 8);
+    const uint32_t depth = graph.AddTexture("Depth", pixels * 4);
+    const uint32_t ssao_gen = graph.AddTexture("SSAO Gen", pixels);
+    const uint32_t ssao_blur = graph.AddTexture("SSAO Blur", pixels);
+    // The post process pairs ping pong, index 0 is whichever texture is the destination when the frame starts.
+    const std::array hdr = { graph.AddTexture("HDR Ping", pixels * 8), graph.AddTexture("HDR Pong", pixels * 8) };
+    // No pass touches the LDR source, the report lists it as unused.
+    graph.AddTexture("LDR Source", pixels * 4);
+    const uint32_t ldr_dst = graph.AddTexture("LDR Target", pixels * 4);
+    uint32_t hdr_dst = 0;
+    const auto swap_hdr = [&] { hdr_dst ^= 1; };
+
+    // Disabled effects are still declared, nothing reads what they write so Compile culls them and they are never
+    // recorded. The Draw functions swap the post process pairs as they record, so the swaps here follow the same order.
+    graph.AddPass("Clear Textures",
+                  [this]
+                  {
+                      if (!m_headless) ClearTextures(m_context->GetCurrentCommand());
+                  })
+        .Write(scene)
+        .Write(depth);
+    for (uint32_t i = 0; i < m_shadow_pass.cache.GetRenders().size(); ++i)
+    {
+        graph.AddPass("Shadow Pass", [this, i] { DrawShadowPass(i); }).Modify(shadow);
+    }
+    graph.AddPass("Depth Prepass", [this] { DrawDepthPrePass(); }).Write(depth);
+    graph.AddPass("SSAO Gen Pass", [this] { DrawSSAOGenPass(); }).Read(depth).Write(ssao_gen);
+    graph.AddPass("SSAO BlurPass", [this] { DrawSSAOBlurPass(); }).Read(ssao_gen).Write(ssao_blur);
+    graph.AddPass("GeometryPass", [this] { DrawGeometry(); }).Read(shadow).Modify(scene).Modify(depth);
+    if (m_ssao_pass.enabled)
+    {
+        graph.Read(ssao_blur);
+    }
+    if (m_grass_pass.uploaded_count > 0)
+    {
+        graph.AddPass("Grass Pass", [this] { DrawGrassPass(); }).Modify(scene).Modify(depth);
+    }
+    graph.AddPass("Skybox Pass", [this] { DrawSkybox(); }).Modify(scene).Modify(depth);
+    graph.AddPass("Bloom Extract Pass", [this] { DrawBloomExtractPass(); }).Read(scene).Write(hdr[hdr_dst]);
+    for (uint32_t i = 0; i < m_bloom_pass.blur_count; ++i)
+    {
+        swap_hdr();
+        graph.AddPass("Bloom Blur Pass", [this, i] { DrawBloomBlurPass(i); })
+            .Read(hdr[hdr_dst ^ 1])
+            .Write(hdr[hdr_dst]);
+    }
+    swap_hdr();
+    graph.AddPass("Bloom Combine Pass", [this] { DrawBloomCombinePass(); })
+        .Read(scene)
+        .Read(hdr[hdr_dst ^ 1])
+        .Write(hdr[hdr_dst]);
+    if (m_bloom_pass.enabled)
+    {
+        swap_hdr();
+    }
+    graph.AddPass("Fog Pass", [this] { DrawVolumetricFog(); })
+        .Read(m_bloom_pass.enabled ? hdr[hdr_dst ^ 1] : scene)
+        .Read(depth)
+        .Read(shadow)
+        .Write(hdr[hdr_dst]);
+    swap_hdr();
+    graph.AddPass("Tonemap Pass", [this] { DrawTonemapPass(); }).Read(hdr[hdr_dst ^ 1]).Write(ldr_dst);
+    // The editor draws the LDR target with ImGui after the render graph ran.
+    graph.AddPass("Editor Viewport").Read(ldr_dst).SetOutput();
+    graph.Compile();
+    CPU_PLOT("Frame Graph Build", graph.GetStats().build_ms);
+}
+
+void Renderer::UpdateRenderScale(const FrameSnapshot& snapshot)
+{
+    // Measured between frame starts so it covers everything the frame waited on, not just the render thread.
+    if (m_last_frame_start != std::chrono::high_resolution_clock::time_point{})
+    {
+        const float frame_ms =
+            std::chrono::duration<float, std::milli>(snapshot.frame_start - m_last_frame_start).count();
+        m_render_scale = m_dynamic_resolution ? m_resolution_controller.Update(frame_ms) : 1.f;
+    }
+    m_last_frame_start = snapshot.frame_start;
+    CPU_PLOT("Render Scale", m_render_scale);
+}
+
+glm::uvec2 Renderer::GetRenderExtent(const glm::uvec2 screen_size) const
+{
+    return glm::max(glm::uvec2(glm::vec2(screen_size) * m_render_scale + 0.5f), glm::uvec2(1));
+}
+
+const TextureView& Renderer::GetAmbientOcclusionTexture() const
+{
+    return m_frame_graph.IsCulled("SSAO Gen Pass") ? m_dummy_white_texture : m_ssao_pass.blur_texture;
+}
+
+void Renderer::DeclareNullPass(const std::string_view name, const uint32_t fullscreen_dispatches)
+{
+    m_null_frame.passes.push_back(name);
+    m_null_frame.dispatches += fullscreen_dispatches;
+    m_null_frame.dispatch_groups += fullscreen_dispatches;
+}
+
+std::optional<RayHit> Renderer::Raycast(const Ray& ray) const
+{
+    AssertRenderIdle();
+    // The BVH narrows it down to the boxes along the ray, the nearest triangle decides what was hit.
+    auto IntersectRenderable = [&](const uint32_t index, const Ray& world_ray, const float max_distance)
+    {
+        const auto& renderable = m_renderables[index];
+        const auto& mesh = m_pick_meshes[renderable.m_pick_mesh_index];
+        const glm::mat4 world_to_local = glm::inverse(m_transforms[renderable.m_transform_index]);
+        // The direction isn't normalized again, so distances along the local ray match the world ray.
+        const Ray local_ray{
+            .origin = glm::vec3(world_to_local * glm::vec4(world_ray.origin, 1.f)),
+            .direction = glm::vec3(world_to_local * glm::vec4(world_ray.direction, 0.f)),
+        };
+
+        std::optional<float> closest;
+        float limit = max_distance;
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            const auto distance = local_ray.Intersect(mesh.positions[mesh.indices[i]],
+                                                      mesh.positions[mesh.indices[i + 1]],
+                                                      mesh.positions[mesh.indices[i + 2]]);
+            if (distance && *distance <= limit)
+            {
+                limit = *distance;
+                closest = distance;
+            }
+        }
+        return closest;
+    };
+    return m_bvh.Raycast(ray, std::numeric_limits<float>::max(), IntersectRenderable);
+}
+
+Bounds Renderer::GetBounds(const uint32_t offset, const uint32_t size, const glm::mat4& transform) const
+{
+    Bounds bounds{};
+    for (uint32_t i = offset; i < offset + size; ++i)
+    {
+        const auto& renderable = m_renderables[i];
+        bounds = Bounds::Merge(bounds, renderable.m_local_bounds.Transform(transform * renderable.m_local_transform));
+    }
+    return bounds;
+}
+
+void Renderer::BuildDrawLists(const FrameSnapshot& snapshot)
+{
+    CPU_ZONE("Build Draw Lists");
+    const auto& camera = snapshot.camera;
+    m_bvh.Refit();
+    m_visible_renderables.clear();
+    m_bvh.QueryFrustum(camera.CreateFrustum(), m_visible_renderables);
+
+    if (m_occlusion_pass.enabled)
+    {
+        // Only occluders that survived the frustum test can cover anything on screen.
+        auto& instances = m_occlusion_pass.instances;
+        instances.clear();
+        for (const uint32_t index : m_visible_renderables)
+        {
+            const auto& renderable = m_renderables[index];
+            if (renderable.m_occluder_index == -1) continue;
+            instances.push_back({
+                .occluder = &m_occlusion_pass.occluders[renderable.m_occluder_index],
+                .transform = m_transforms[renderable.m_transform_index],
+            });
+        }
+        m_occlusion_pass.culler.Render(m_engine->GetJobSystem(), camera.m_proj_matrix * camera.m_view_matrix, instances);
+        m_occlusion_pass.culler.Cull(m_world_bounds, m_visible_renderables);
+        CPU_PLOT("Occluded Renderables", static_cast<int64_t>(m_occlusion_pass.culler.GetStats().occluded));
+    }
+
+    // Only the tiles the cache schedules are drawn, each culling its own casters.
+    auto& cascades = m_shadow_pass.cascades;
+    auto& cache = m_shadow_pass.cache;
+    // The first shadow casting directional light is the sun, casters are always packed first.
+    if (m_dir_shadow_caster_count == 0)
+    {
+        cascades.Reset();
+    }
+    else
+    {
+        cascades.Fit(camera, m_uploaded_dir_lights[0].direction, m_bvh.GetBounds());
+    }
+    cache.BeginFrame(cascades.GetLightView(),
+                     cascades.GetCascades(),
+                     cascades.GetSettings().resolution,
+                     m_bvh.GetBounds());
+    cache.Schedule(m_shadow_pass.tile_budget);
+    const auto renders = cache.GetRenders();
+    const auto render_count = static_cast<uint32_t>(renders.size());
+    std::array<Frustum, ShadowTileCache::MAX_RENDERS> tile_frustums{};
+    for (uint32_t i = 0; i < render_count; ++i)
+    {
+        tile_frustums[i] = Camera::CreateFrustum(renders[i].view_proj);
+    }
+    for (auto& casters : m_visible_shadow_renderables)
+    {
+        casters.clear();
+    }
+    m_bvh.QueryFrustums(std::span(tile_frustums).first(render_count),
+                        std::span(m_visible_shadow_renderables).first(render_count));
+    size_t shadow_casters = 0;
+    for (const auto& casters : m_visible_shadow_renderables)
+    {
+        shadow_casters += casters.size();
+    }
+    CPU_PLOT("Visible Renderables", static_cast<int64_t>(m_visible_renderables.size()));
+    CPU_PLOT("Visible Shadow Casters", static_cast<int64_t>(shadow_casters));
+    CPU_PLOT("Shadow Tiles Redrawn", static_cast<int64_t>(render_count));
+
+    {
+        CPU_ZONE("Build Draw Streams");
+        // Clip w of a perspective projection is the view depth, the sun's orthographic depth is clip z.
+        const glm::vec4 view_plane = GetRow(camera.m_proj_matrix * camera.m_view_matrix, 3);
+        BuildDrawStream<DepthDrawPacket>(DrawPass::eDepthPrepass,
+                                         m_depth_prepass.order,
+                                         view_plane,
+                                         m_visible_renderables,
+                                         m_depth_packets,
+                                         m_depth_stream);
+        BuildDrawStream<GeometryDrawPacket>(DrawPass::eGeometry,
+                                            m_geometry_order,
+                                            view_plane,
+                                            m_visible_renderables,
+                                            m_geometry_packets,
+                                            m_geometry_stream);
+        for (uint32_t i = 0; i < render_count; ++i)
+        {
+            auto& stream = m_shadow_streams[i];
+            BuildDrawStream<DepthDrawPacket>(DrawPass::eShadow,
+                                             m_shadow_pass.order,
+                                             GetRow(renders[i].view_proj, 2),
+                                             m_visible_shadow_renderables[i],
+                                             m_depth_packets,
+                                             stream);
+            for (auto& packet : stream.packets)
+            {
+                packet.shadow_tile_index = i;
+            }
+        }
+    }
+}
+
+void Renderer::BuildLightClusters(const FrameSnapshot& snapshot)
+{
+    CPU_ZONE("Build Light Clusters");
+    m_light_spheres.resize(m_uploaded_point_lights.size());
+    for (uint32_t i = 0; i < m_light_spheres.size(); ++i)
+    {
+        const auto& light = m_uploaded_point_lights[i];
+        m_light_spheres[i] = { .center = light.position, .radius = light.range };
+    }
+    m_light_clusters.Build(m_engine->GetJobSystem(), snapshot.camera, m_light_spheres);
+    CPU_PLOT("Light Cluster Indices", static_cast<int64_t>(m_light_clusters.GetStats().indices));
+
+    // Both lists are rebuilt every frame, so they go into this frame's space of the upload ring as one allocation with
+    // the indices right after the ranges, where the shader looks for them.
+    const auto clusters = m_light_clusters.GetClusters();
+    const auto indices = m_light_clusters.GetLightIndices();
+    m_light_cluster_offset = m_frame_upload_buffer.Allocate(
+        static_cast<uint32_t>(clusters.size_bytes() + indices.size_bytes()), alignof(LightClusterRange));
+    Upload(m_frame_upload_buffer.GetView(), clusters.data(), m_light_cluster_offset, clusters.size_bytes());
+    Upload(m_frame_upload_buffer.GetView(),
+           indices.data(),
+           m_light_cluster_offset + static_cast<uint32_t>(clusters.size_bytes()),
+           indices.size_bytes());
+}
+
+template <typename Packet>
+void Renderer::BuildDrawStream(const DrawPass pass,
+                               const DrawOrder order,
+                               const glm::vec4& depth_plane,
+                               const std::span<const uint32_t> visible,
+                               const std::span<const Packet> packets,
+                               DrawStream<Packet>& stream)
+{
+    stream.Build(m_engine->GetJobSystem(),
+                 order != DrawOrder::eSubmission,
+                 visible,
+                 packets,
+                 [&](const uint32_t index)
+                 {
+                     const int material_index = m_renderables[index].m_material_index;
+                     const auto alpha_mode =
+                         material_index == -1 ? Swift::AlphaMode::eOpaque : m_materials[material_index].alpha_mode;
+                     const glm::vec3 center = m_world_bounds[index].sphere.center;
+                     return DrawSorter::CreateKey(order,
+                                                  pass,
+                                                  static_cast<uint8_t>(alpha_mode),
+                                                  static_cast<uint16_t>(material_index + 1),
+                                                  glm::dot(depth_plane, glm::vec4(center, 1.f)));
+                 });
+}
+
+template <typename Packet>
+void Renderer::RecordNullStream(const DrawStream<Packet>& stream, const bool dispatch_amp)
+{
+    const std::span<const Packet> packets = stream.packets;
+    const auto count = static_cast<uint32_t>(packets.size());
+    std::vector<NullFrameStats> chunk_stats((count + DRAW_CHUNK_SIZE - 1) / DRAW_CHUNK_SIZE);
+    m_engine->GetJobSystem().ParallelFor(count,
+                                         DRAW_CHUNK_SIZE,
+                                         [&](const uint32_t begin, const uint32_t end)
+                                         {
+                                             const NullCommandRecorder recorder(chunk_stats[begin / DRAW_CHUNK_SIZE]);
+                                             RecordPackets(recorder, packets.subspan(begin, end - begin), dispatch_amp);
+                                         });
+    for (const auto& stats : chunk_stats)
+    {
+        m_null_frame.Merge(stats);
+    }
+}
+
 void Renderer::DrawDepthPrePass()
 {
     CPU_ZONE("Depth Prepass");
+    if (m_headless)
+    {
+        DeclareNullPass("Depth Prepass", 0);
+        RecordNullStream(m_depth_stream, true);
+        return;
+    }
     GPU_ZONE(m_profiler, m_context->GetCurrentCommand(), "Depth Prepass");
-    const auto& window = m_engine->GetWindow();
-    auto window_size = window.GetSize();
+    const auto render_size = GetRenderExtent(GetRenderSnapshot().screen_size);
     m_render_graph.AddPass("Depth Prepass", m_depth_prepass.shader)
         .WriteDepthStencil(m_depth_texture.depth_stencil)
         .SetDepthLoadOp(Swift::LoadOp::eClear)
-        .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
-        .SetExecute(
-            [&](Swift::ICommand* command)
-            {
-                for (const auto& renderable : m_renderables)
-                {
-                    const struct PushConstants
-                    {
-                        uint32_t position_buffer;
-                        uint32_t meshlet_buffer;
-                        uint32_t mesh_vertex_buffer;
-                        uint32_t mesh_triangle_buffer;
-
-                        uint32_t transform_index;
-                        uint32_t meshlet_count;
-                        uint32_t bounding_offset;
-                    } push_constants{
-                        .position_buffer = renderable.m_position_buffer.GetDescriptorIndex(),
-                        .meshlet_buffer = renderable.m_mesh_buffer.GetDescriptorIndex(),
-                        .mesh_vertex_buffer = renderable.m_mesh_vertex_buffer.GetDescriptorIndex(),
-                        .mesh_triangle_buffer = renderable.m_mesh_triangle_buffer.GetDescriptorIndex(),
-                        .transform_index = renderable.m_transform_index,
-                        .meshlet_count = renderable.m_meshlet_count,
-                        .bounding_offset = renderable.m_bounding_offset,
-                    };
-                    command->PushConstants(&push_constants, sizeof(PushConstants));
-                    renderable.Draw(command, true);
-                }
-            });
+        .SetRenderExtents(Swift::Float2(render_size.x, render_size.y))
+        .SetExecute([&](Swift::ICommand* command)
+                    { RecordPackets(SwiftCommandRecorder(command), m_depth_stream.packets, true); });
 }
 
 void Renderer::DrawGeometry()
 {
     CPU_ZONE("Geometry Pass");
+    if (m_headless)
+    {
+        DeclareNullPass("GeometryPass", 0);
+        RecordNullStream(m_geometry_stream, true);
+        return;
+    }
     GPU_ZONE(m_profiler, m_context->GetCurrentCommand(), "Geometry Pass");
-    const auto& window = m_engine->GetWindow();
-    auto window_size = window.GetSize();
+    const auto render_size = GetRenderExtent(GetRenderSnapshot().screen_size);
     m_render_graph.AddPass("GeometryPass", m_pbr_shader)
-        .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
-        .Read(m_ssao_pass.blur_texture.srv)
+        .SetRenderExtents(Swift::Float2(render_size.x, render_size.y))
+        .Read(GetAmbientOcclusionTexture().srv)
+        .Read(m_shadow_pass.atlas.srv)
         .WriteRenderTarget(m_render_texture.render_target)
         .WriteDepthStencil(m_depth_texture.depth_stencil)
-        .SetExecute(
-            [&](Swift::ICommand* command)
-            {
-                for (const auto& renderable : m_renderables)
-                {
-                    const struct PushConstants
-                    {
-                        uint32_t shadow_sampler_index;
-                        uint32_t sampler_index;
-                        uint32_t position_buffer;
-                        uint32_t vertex_buffer;
-
-                        uint32_t meshlet_buffer;
-                        uint32_t mesh_vertex_buffer;
-                        uint32_t mesh_triangle_buffer;
-                        int material_index;
-
-                        uint32_t transform_index;
-                        uint32_t meshlet_count;
-                        uint32_t bounding_offset;
-                    } push_constants{
-                        .shadow_sampler_index = m_shadow_comparison_sampler->GetDescriptorIndex(),
-                        .sampler_index = m_bilinear_sampler->GetDescriptorIndex(),
-                        .position_buffer = renderable.m_position_buffer.GetDescriptorIndex(),
-                        .vertex_buffer = renderable.m_attrib_buffer.GetDescriptorIndex(),
-                        .meshlet_buffer = renderable.m_mesh_buffer.GetDescriptorIndex(),
-                        .mesh_vertex_buffer = renderable.m_mesh_vertex_buffer.GetDescriptorIndex(),
-                        .mesh_triangle_buffer = renderable.m_mesh_triangle_buffer.GetDescriptorIndex(),
-                        .material_index = renderable.m_material_index,
-                        .transform_index = renderable.m_transform_index,
-                        .meshlet_count = renderable.m_meshlet_count,
-                        .bounding_offset = renderable.m_bounding_offset,
-                    };
-                    command->PushConstants(&push_constants, sizeof(PushConstants));
-                    renderable.Draw(command, true);
-                }
-            });
+        .SetExecute([&](Swift::ICommand* command)
+                    { RecordPackets(SwiftCommandRecorder(command), m_geometry_stream.packets, true); });
 }
 
-void Renderer::DrawSSAOPass()
+void Renderer::DrawSSAOGenPass()
 {
-    const auto& window = m_engine->GetWindow();
-    auto window_size = window.GetSize();
+    if (m_headless)
+    {
+        DeclareNullPass("SSAO Gen Pass");
+        return;
+    }
+    const auto render_size = GetRenderExtent(GetRenderSnapshot().screen_size);
 
     m_render_graph.AddPass("SSAO Gen Pass", m_ssao_pass.gen_shader)
         .SetRenderLoadOp(Swift::LoadOp::eClear)
-        .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
+        .SetRenderExtents(Swift::Float2(render_size.x, render_size.y))
         .Read(m_depth_texture.srv)
         .Read(m_ssao_pass.noise_texture.srv)
         .WriteRenderTarget(m_ssao_pass.gen_texture.render_target)
         .SetExecute(
             [&](Swift::ICommand* command)
             {
-                const auto noise_scale = glm::vec2(window_size[0] / 4.f, window_size[1] / 4.f);
+                const auto noise_scale = glm::vec2(render_size[0] / 4.f, render_size[1] / 4.f);
                 const struct PushConstant
                 {
                     uint32_t depth_texture_index;
@@ -813,10 +1652,19 @@ void Renderer::DrawSSAOPass()
                 command->PushConstants(&pc, sizeof(PushConstant));
                 command->DispatchMesh(1, 1, 1);
             });
+}
 
+void Renderer::DrawSSAOBlurPass()
+{
+    if (m_headless)
+    {
+        DeclareNullPass("SSAO BlurPass");
+        return;
+    }
+    const auto render_size = GetRenderExtent(GetRenderSnapshot().screen_size);
     m_render_graph.AddPass("SSAO BlurPass", m_ssao_pass.blur_shader)
         .SetRenderLoadOp(Swift::LoadOp::eClear)
-        .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
+        .SetRenderExtents(Swift::Float2(render_size.x, render_size.y))
         .Read(m_ssao_pass.gen_texture.srv)
         .WriteRenderTarget(m_ssao_pass.blur_texture.render_target)
         .SetExecute(
@@ -838,12 +1686,16 @@ void Renderer::DrawSSAOPass()
 void Renderer::DrawSkybox()
 {
     CPU_ZONE("Skybox Pass");
+    if (m_headless)
+    {
+        DeclareNullPass("Skybox Pass");
+        return;
+    }
     GPU_ZONE(m_profiler, m_context->GetCurrentCommand(), "Skybox Pass");
-    const auto& window = m_engine->GetWindow();
-    auto window_size = window.GetSize();
+    const auto render_size = GetRenderExtent(GetRenderSnapshot().screen_size);
 
     m_render_graph.AddPass("Skybox Pass", m_skybox_pass.shader)
-        .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
+        .SetRenderExtents(Swift::Float2(render_size.x, render_size.y))
         .WriteRenderTarget(m_render_texture.render_target)
         .WriteDepthStencil(m_depth_texture.depth_stencil)
         .SetExecute(
@@ -860,59 +1712,69 @@ void Renderer::DrawSkybox()
             });
 }
 
-void Renderer::DrawShadowPass(Swift::ICommand* shadow_command)
+void Renderer::DrawShadowPass(const uint32_t render)
 {
-    if (!shadow_command)
+    CPU_ZONE("Shadow Pass");
+    if (m_headless)
     {
-        shadow_command = m_context->GetCurrentCommand();
+        DeclareNullPass("Shadow Pass", 0);
+        RecordNullStream(m_shadow_streams[render], false);
+        return;
     }
-    CPU_ZONE("Shadow Pass");
-    GPU_ZONE(m_profiler, shadow_command, "Shadow Pass");
-
+    GPU_ZONE(m_profiler, m_context->GetCurrentCommand(), "Shadow Pass");
+    constexpr auto resolution = static_cast<float>(ShadowTileCache::TILE_RESOLUTION);
+    const glm::uvec2 origin = ShadowTileCache::GetPageOrigin(m_shadow_pass.cache.GetRenders()[render].page);
     m_render_graph.AddPass("Shadow Pass", m_shadow_pass.shader)
-        .SetRenderExtents(Swift::Float2(4096, 4096))
-        .SetDepthLoadOp(Swift::LoadOp::eClear)
-        .WriteDepthStencil(m_shadow_pass.texture.depth_stencil)
+        .SetRenderExtents(Swift::Float2(static_cast<float>(ShadowTileCache::ATLAS_WIDTH),
+                                        static_cast<float>(ShadowTileCache::ATLAS_HEIGHT)))
+        .SetDepthLoadOp(Swift::LoadOp::eLoad)
+        .WriteDepthStencil(m_shadow_pass.atlas.depth_stencil)
         .SetExecute(
-            [&](Swift::ICommand* command)
+            [&, render, origin](Swift::ICommand* command)
             {
-                for (const auto& renderable : m_renderables)
-                {
-                    const struct PushConstants
-                    {
-                        uint32_t position_buffer;
-                        uint32_t meshlet_buffer;
-                        uint32_t mesh_vertex_buffer;
-                        uint32_t mesh_triangle_buffer;
-
-                        uint32_t transform_index;
-                        uint32_t meshlet_count;
-                        uint32_t bounding_offset;
-                    } push_constants{
-                        .position_buffer = renderable.m_position_buffer.GetDescriptorIndex(),
-                        .meshlet_buffer = renderable.m_mesh_buffer.GetDescriptorIndex(),
-                        .mesh_vertex_buffer = renderable.m_mesh_vertex_buffer.GetDescriptorIndex(),
-                        .mesh_triangle_buffer = renderable.m_mesh_triangle_buffer.GetDescriptorIndex(),
-                        .transform_index = renderable.m_transform_index,
-                        .meshlet_count = renderable.m_meshlet_count,
-                        .bounding_offset = renderable.m_bounding_offset,
-                    };
-                    command->PushConstants(&push_constants, sizeof(PushConstants));
-                    renderable.Draw(command, false);
-                }
+                // The rest of the atlas holds resident tiles, so only the page's rect is cleared and drawn.
+                auto* command_list = static_cast<ID3D12GraphicsCommandList*>(command->GetCommandList());
+                const D3D12_RECT rect{
+                    .left = static_cast<LONG>(origin.x),
+                    .top = static_cast<LONG>(origin.y),
+                    .right = static_cast<LONG>(origin.x + ShadowTileCache::TILE_RESOLUTION),
+                    .bottom = static_cast<LONG>(origin.y + ShadowTileCache::TILE_RESOLUTION),
+                };
+                const D3D12_VIEWPORT viewport{
+                    .TopLeftX = static_cast<float>(origin.x),
+                    .TopLeftY = static_cast<float>(origin.y),
+                    .Width = resolution,
+                    .Height = resolution,
+                    .MinDepth = 0.f,
+                    .MaxDepth = 1.f,
+                };
+                const auto* depth_stencil = static_cast<Swift::D3D12::TextureView*>(m_shadow_pass.atlas.depth_stencil);
+                command_list->ClearDepthStencilView(depth_stencil->GetDescriptorData().cpu_handle,
+                                                    D3D12_CLEAR_FLAG_DEPTH,
+                                                    1.f,
+                                                    0,
+                                                    1,
+                                                    &rect);
+                command_list->RSSetViewports(1, &viewport);
+                command_list->RSSetScissorRects(1, &rect);
+                RecordPackets(SwiftCommandRecorder(command), m_shadow_streams[render].packets, false);
             });
 }
 
 void Renderer::DrawGrassPass()
 {
-    if (m_grass_pass.patches.empty()) return;
     CPU_ZONE("Grass Pass");
+    if (m_headless)
+    {
+        DeclareNullPass("Grass Pass", 0);
+        NullCommandRecorder(m_null_frame).DispatchMesh((m_grass_pass.uploaded_count + 31) / 32, 1, 1);
+        return;
+    }
     GPU_ZONE(m_profiler, m_context->GetCurrentCommand(), "Grass Pass");
 
-    const auto& window = m_engine->GetWindow();
-    auto window_size = window.GetSize();
+    const auto render_size = GetRenderExtent(GetRenderSnapshot().screen_size);
     m_render_graph.AddPass("Grass Pass", m_grass_pass.shader)
-        .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
+        .SetRenderExtents(Swift::Float2(render_size.x, render_size.y))
         .WriteRenderTarget(m_render_texture.render_target)
         .WriteDepthStencil(m_depth_texture.depth_stencil)
         .SetExecute(
@@ -932,22 +1794,26 @@ void Renderer::DrawGrassPass()
                     .wind_strength = m_grass_pass.wind_strength,
                     .apply_view_space_thicken = m_grass_pass.apply_view_space_thicken,
                     .lod_distance = m_grass_pass.lod_distance,
-                    .grass_count = static_cast<uint32_t>(m_grass_pass.patches.size()),
-                    .time = m_engine->GetTime(),
+                    .grass_count = m_grass_pass.uploaded_count,
+                    .time = GetRenderSnapshot().time,
                 };
                 command->PushConstants(&pc, sizeof(PushConstant));
 
-                const uint32_t num_amp_groups = (m_grass_pass.patches.size() + 31) / 32;
+                const uint32_t num_amp_groups = (m_grass_pass.uploaded_count + 31) / 32;
                 command->DispatchMesh(num_amp_groups, 1, 1);
             });
 }
 
-void Renderer::DrawBloomPass()
+void Renderer::DrawBloomExtractPass()
 {
-    const auto& window = m_engine->GetWindow();
-    auto window_size = window.GetSize();
+    if (m_headless)
+    {
+        DeclareNullPass("Bloom Extract Pass");
+        return;
+    }
+    const auto render_size = GetRenderExtent(GetRenderSnapshot().screen_size);
     m_render_graph.AddPass("Bloom Extract Pass", m_bloom_pass.extract_shader)
-        .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
+        .SetRenderExtents(Swift::Float2(render_size.x, render_size.y))
         .Read(m_render_texture.srv)
         .WriteRenderTarget(m_post_process_hdr.m_dst_texture.render_target)
         .SetExecute(
@@ -964,38 +1830,53 @@ void Renderer::DrawBloomPass()
                 command->PushConstants(&pc, sizeof(PushConstant));
                 command->DispatchMesh(1, 1, 1);
             });
+}
 
-    for (int i = 0; i < m_bloom_pass.blur_count; ++i)
+void Renderer::DrawBloomBlurPass(const uint32_t blur)
+{
+    if (m_headless)
     {
-        m_post_process_hdr.Swap();
-        uint32_t src_idx = m_post_process_hdr.m_src_texture.GetSRVDescriptorIndex();
-        uint32_t horizontal = i % 2 == 0 ? 1u : 0u;
-
-        m_render_graph.AddPass("Bloom Blur Pass", m_bloom_pass.blur_shader)
-            .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
-            .Read(m_post_process_hdr.m_src_texture.srv)
-            .WriteRenderTarget(m_post_process_hdr.m_dst_texture.render_target)
-            .SetExecute(
-                [&, src_idx, horizontal](Swift::ICommand* command)
-                {
-                    const struct BlurPushConstant
-                    {
-                        uint32_t bloom_texture_index;
-                        uint32_t bilinear_sampler_index;
-                        uint32_t horizontal;
-                    } blur_pc{
-                        .bloom_texture_index = src_idx,
-                        .bilinear_sampler_index = m_bilinear_sampler->GetDescriptorIndex(),
-                        .horizontal = horizontal,
-                    };
-                    command->PushConstants(&blur_pc, sizeof(BlurPushConstant));
-                    command->DispatchMesh(1, 1, 1);
-                });
+        DeclareNullPass("Bloom Blur Pass");
+        return;
     }
+    const auto render_size = GetRenderExtent(GetRenderSnapshot().screen_size);
+    m_post_process_hdr.Swap();
+    uint32_t src_idx = m_post_process_hdr.m_src_texture.GetSRVDescriptorIndex();
+    uint32_t horizontal = blur % 2 == 0 ? 1u : 0u;
+
+    m_render_graph.AddPass("Bloom Blur Pass", m_bloom_pass.blur_shader)
+        .SetRenderExtents(Swift::Float2(render_size.x, render_size.y))
+        .Read(m_post_process_hdr.m_src_texture.srv)
+        .WriteRenderTarget(m_post_process_hdr.m_dst_texture.render_target)
+        .SetExecute(
+            [&, src_idx, horizontal](Swift::ICommand* command)
+            {
+                const struct BlurPushConstant
+                {
+                    uint32_t bloom_texture_index;
+                    uint32_t bilinear_sampler_index;
+                    uint32_t horizontal;
+                } blur_pc{
+                    .bloom_texture_index = src_idx,
+                    .bilinear_sampler_index = m_bilinear_sampler->GetDescriptorIndex(),
+                    .horizontal = horizontal,
+                };
+                command->PushConstants(&blur_pc, sizeof(BlurPushConstant));
+                command->DispatchMesh(1, 1, 1);
+            });
+}
 
+void Renderer::DrawBloomCombinePass()
+{
+    if (m_headless)
+    {
+        DeclareNullPass("Bloom Combine Pass");
+        return;
+    }
+    const auto render_size = GetRenderExtent(GetRenderSnapshot().screen_size);
     m_post_process_hdr.Swap();
     m_render_graph.AddPass("Bloom Combine Pass", m_bloom_pass.combine_shader)
-        .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
+        .SetRenderExtents(Swift::Float2(render_size.x, render_size.y))
         .Read(m_post_process_hdr.m_src_texture.srv)
         .WriteRenderTarget(m_post_process_hdr.m_dst_texture.render_target)
         .SetExecute(
@@ -1020,16 +1901,27 @@ void Renderer::DrawBloomPass()
 
 void Renderer::DrawVolumetricFog()
 {
-    m_post_process_hdr.Swap();
-    const auto& window = m_engine->GetWindow();
-    auto window_size = window.GetSize();
+    if (m_headless)
+    {
+        DeclareNullPass("Fog Pass");
+        return;
+    }
+    // Without bloom the fog reads the lit scene directly.
+    const bool bloom = !m_frame_graph.IsCulled("Bloom Extract Pass");
+    if (bloom)
+    {
+        m_post_process_hdr.Swap();
+    }
+    const auto& source = bloom ? m_post_process_hdr.m_src_texture : m_render_texture;
+    const auto render_size = GetRenderExtent(GetRenderSnapshot().screen_size);
     m_render_graph.AddPass("Fog Pass", m_fog_pass.shader)
-        .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
-        .Read(m_post_process_hdr.m_src_texture.srv)
+        .SetRenderExtents(Swift::Float2(render_size.x, render_size.y))
+        .Read(source.srv)
         .Read(m_depth_texture.srv)
+        .Read(m_shadow_pass.atlas.srv)
         .WriteRenderTarget(m_post_process_hdr.m_dst_texture.render_target)
         .SetExecute(
-            [&, src_idx = m_post_process_hdr.m_src_texture.GetSRVDescriptorIndex()](Swift::ICommand* command)
+            [&, src_idx = source.GetSRVDescriptorIndex()](Swift::ICommand* command)
             {
                 const struct PushConstant
                 {
@@ -1053,9 +1945,13 @@ void Renderer::DrawVolumetricFog()
 
 void Renderer::DrawTonemapPass()
 {
+    if (m_headless)
+    {
+        DeclareNullPass("Tonemap Pass");
+        return;
+    }
     m_post_process_hdr.Swap();
-    const auto& window = m_engine->GetWindow();
-    auto window_size = window.GetSize();
+    auto window_size = GetRenderSnapshot().screen_size;
     m_render_graph.AddPass("Tonemap Pass", m_tonemap_pass.shader)
         .SetRenderExtents(Swift::Float2(window_size.x, window_size.y))
         .Read(m_post_process_hdr.m_src_texture.srv)
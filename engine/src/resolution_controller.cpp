@@ -0,0 +1,39 @@
+#include "resolution_controller.hpp"
+
+ResolutionController::ResolutionController(const float target_ms, const ResolutionGains gains)
+    : m_target_ms(std::max(target_ms, 1.f)), m_gains(gains)
+{
+}
+
+float ResolutionController::Update(const float frame_ms)
+{
+    if (!m_primed)
+    {
+        m_filtered_ms = frame_ms;
+        m_primed = true;
+    }
+    m_filtered_ms += (frame_ms - m_filtered_ms) * SMOOTHING;
+
+    // Relative error, positive when there is time to spare.
+    float error = (m_target_ms - m_filtered_ms) / m_target_ms;
+    if (std::abs(error) < DEAD_BAND)
+    {
+        error = 0.f;
+    }
+
+    const float delta = m_gains.proportional * (error - m_error) + m_gains.integral * error +
+                        m_gains.derivative * (error - 2.f * m_error + m_previous_error);
+    m_previous_error = m_error;
+    m_error = error;
+    m_area = std::clamp(m_area + delta, MIN_SCALE * MIN_SCALE, MAX_SCALE * MAX_SCALE);
+    return GetScale();
+}
+
+void ResolutionController::Reset()
+{
+    m_area = 1.f;
+    m_filtered_ms = 0.f;
+    m_error = 0.f;
+    m_previous_error = 0.f;
+    m_primed = false;
+}
@@ -59,6 +59,8 @@ constexpr Swift::Format FromDXGIFormat(const dds::DXGI_FORMAT format) noexcept
 
 Swift::ITexture* Resources::LoadTexture(const std::filesystem::path& path) const
 {
+    if (m_engine->GetRenderer().IsHeadless()) return nullptr;
+
     std::ifstream stream;
     stream.open(path, std::ios::binary);
     std::vector<char> header_data;
@@ -77,17 +79,30 @@ Swift::ITexture* Resources::LoadTexture(const std::filesystem::path& path) const
         .Build();
 }
 
+MeshletConfig Resources::ClampMeshletConfig(const MeshletConfig& config)
+{
+    // meshoptimizer wants a triangle budget divisible by 4, and the mesh shaders can't emit more than they declare.
+    return MeshletConfig{
+        .max_vertices = std::clamp(config.max_vertices, 3u, MESHLET_MAX_VERTICES),
+        .max_triangles = std::clamp(config.max_triangles & ~3u, 4u, MESHLET_MAX_TRIANGLES),
+        .cone_weight = std::clamp(config.cone_weight, 0.f, 1.f),
+    };
+}
+
 std::tuple<std::vector<meshopt_Meshlet>, std::vector<uint32_t>, std::vector<uint8_t>> Resources::BuildMeshlets(
     const std::span<const glm::vec3> positions,
-    const std::span<const uint32_t> indices)
+    const std::span<const uint32_t> indices,
+    const MeshletConfig& config)
 {
     std::vector<meshopt_Meshlet> meshlets;
     std::vector<uint32_t> mesh_vertices;
     std::vector<uint8_t> mesh_triangles;
-    const auto max_meshlets = meshopt_buildMeshletsBound(indices.size(), 64, 124);
+    if (indices.empty()) return { meshlets, mesh_vertices, mesh_triangles };
+
+    const auto max_meshlets = meshopt_buildMeshletsBound(indices.size(), config.max_vertices, config.max_triangles);
     meshlets.resize(max_meshlets);
-    mesh_vertices.resize(max_meshlets * 64);
-    mesh_triangles.resize(max_meshlets * 124 * 3);
+    mesh_vertices.resize(max_meshlets * config.max_vertices);
+    mesh_triangles.resize(max_meshlets * config.max_triangles * 3);
     const auto meshlet_count = meshopt_buildMeshlets(meshlets.data(),
                                                      mesh_vertices.data(),
                                                      mesh_triangles.data(),
@@ -96,9 +111,9 @@ std::tuple<std::vector<meshopt_Meshlet>, std::vector<uint32_t>, std::vector<uint
                                                      reinterpret_cast<const float*>(positions.data()),
                                                      positions.size(),
                                                      sizeof(glm::vec3),
-                                                     64,
-                                                     124,
-                                                     0.f);
+                                                     config.max_vertices,
+                                                     config.max_triangles,
+                                                     config.cone_weight);
     const auto& [vertex_offset, triangle_offset, vertex_count, triangle_count] = meshlets[meshlet_count - 1];
     for (size_t i = 0; i < meshlet_count; i++)
     {
@@ -334,6 +349,46 @@ uint32_t Resources::PackCone(const meshopt_Bounds& bounds)
            (uint32_t(uint8_t(bounds.cone_axis_s8[2])) << 16) | (uint32_t(uint8_t(bounds.cone_cutoff_s8)) << 24);
 }
 
+std::optional<Occluder> Resources::BuildOccluder(const std::span<const glm::vec3> positions,
+                                                const std::span<const uint32_t> indices,
+                                                const Bounds& bounds)
+{
+    if (bounds.sphere.radius < OCCLUDER_MIN_RADIUS || indices.size() < 3) return std::nullopt;
+
+    // Borders are locked so the simplified shell can't shrink away from the walls it stands in for.
+    std::vector<uint32_t> simplified(indices.size());
+    const size_t target_index_count = std::min<size_t>(indices.size(), OCCLUDER_MAX_TRIANGLES * 3);
+    float error = 0.f;
+    simplified.resize(meshopt_simplify(simplified.data(),
+                                       indices.data(),
+                                       indices.size(),
+                                       reinterpret_cast<const float*>(positions.data()),
+                                       positions.size(),
+                                       sizeof(glm::vec3),
+                                       target_index_count,
+                                       0.01f,
+                                       meshopt_SimplifyLockBorder,
+                                       &error));
+    if (simplified.empty() || simplified.size() > OCCLUDER_MAX_TRIANGLES * 3) return std::nullopt;
+
+    Occluder occluder{ .positions = std::vector<glm::vec3>(positions.size()) };
+    const size_t vertex_count = meshopt_optimizeVertexFetch(occluder.positions.data(),
+                                                            simplified.data(),
+                                                            simplified.size(),
+                                                            positions.data(),
+                                                            positions.size(),
+                                                            sizeof(glm::vec3));
+    occluder.positions.resize(vertex_count);
+    occluder.indices = std::move(simplified);
+    return occluder;
+}
+
+bool Resources::IsOpaque(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive)
+{
+    return !primitive.materialIndex.has_value() ||
+           asset.materials[primitive.materialIndex.value()].alphaMode == fastgltf::AlphaMode::Opaque;
+}
+
 std::vector<Mesh> Resources::LoadMesh(Model& model, const fastgltf::Asset& asset, const fastgltf::Mesh& mesh)
 {
     std::vector<Mesh> meshes;
@@ -342,7 +397,7 @@ std::vector<Mesh> Resources::LoadMesh(Model& model, const fastgltf::Asset& asset
     {
         auto indices = LoadIndices(asset, prim);
         const auto [positions, vertices] = LoadVertices(asset, prim, indices);
-        auto [meshlets, meshlet_vertices, meshlet_triangles] = BuildMeshlets(positions, indices);
+        auto [meshlets, meshlet_vertices, meshlet_triangles] = BuildMeshlets(positions, indices, model.meshlet_config);
 
         for (const auto& meshlet : meshlets)
         {
@@ -370,7 +425,13 @@ std::vector<Mesh> Resources::LoadMesh(Model& model, const fastgltf::Asset& asset
             .meshlet_vertices = meshlet_vertices,
             .meshlet_triangles = repacked_triangles,
             .material_index = static_cast<int>(prim.materialIndex.value_or(-1)),
+            .bounds = Bounds::FromPoints(positions),
         };
+        // Alpha tested and blended surfaces show what is behind them, so only opaque ones may hide anything.
+        if (IsOpaque(asset, prim))
+        {
+            m.occluder = BuildOccluder(positions, indices, m.bounds);
+        }
         meshes.emplace_back(m);
     }
     return meshes;
@@ -431,7 +492,7 @@ Sampler Resources::LoadSampler(const fastgltf::Sampler& sampler)
     return s;
 }
 
-std::shared_ptr<Actor> Resources::LoadModel(const std::filesystem::path& path, const glm::vec3 position, const glm::vec3 scale)
+std::optional<fastgltf::Asset> Resources::ParseGltf(const std::filesystem::path& path)
 {
     constexpr auto extensions = fastgltf::Extensions::KHR_materials_transmission | fastgltf::Extensions::KHR_materials_volume |
                                 fastgltf::Extensions::KHR_materials_specular |
@@ -444,7 +505,7 @@ std::shared_ptr<Actor> Resources::LoadModel(const std::filesystem::path& path, c
     if (data.error() != fastgltf::Error::None)
     {
         printf("Failed to load glTF: %s\n", fastgltf::getErrorMessage(data.error()).data());
-        return nullptr;
+        return std::nullopt;
     }
 
     constexpr auto gltfOptions = fastgltf::Options::LoadExternalBuffers;
@@ -453,24 +514,74 @@ std::shared_ptr<Actor> Resources::LoadModel(const std::filesystem::path& path, c
     if (asset.error() != fastgltf::Error::None)
     {
         printf("Failed to parse glTF: %s\n", fastgltf::getErrorMessage(asset.error()).data());
-        return nullptr;
+        return std::nullopt;
     }
+    return std::move(asset.get());
+}
+
+std::vector<MeshGeometry> Resources::LoadGeometry(const std::filesystem::path& path)
+{
+    std::vector<MeshGeometry> geometry;
+    const auto asset = ParseGltf(path);
+    if (!asset) return geometry;
+
+    std::vector<std::pair<uint32_t, uint32_t>> mesh_ranges;
+    for (const auto& mesh : asset->meshes)
+    {
+        const auto start = static_cast<uint32_t>(geometry.size());
+        for (const auto& prim : mesh.primitives)
+        {
+            const auto* const position_it = prim.findAttribute("POSITION");
+            if (position_it == prim.attributes.end()) continue;
+
+            const auto& position_accessor = asset->accessors[position_it->accessorIndex];
+            MeshGeometry g{
+                .name = std::string(mesh.name),
+                .positions = std::vector<glm::vec3>(position_accessor.count),
+                .indices = LoadIndices(asset.value(), prim),
+                .opaque = IsOpaque(asset.value(), prim),
+            };
+            fastgltf::iterateAccessorWithIndex<glm::vec3>(asset.value(),
+                                                          position_accessor,
+                                                          [&](const glm::vec3& position, const size_t index)
+                                                          { g.positions[index] = position; });
+            geometry.emplace_back(std::move(g));
+        }
+        mesh_ranges.emplace_back(start, static_cast<uint32_t>(geometry.size()) - start);
+    }
+
+    const auto [nodes, transforms] = LoadNodes(asset.value(), mesh_ranges);
+    for (const auto& node : nodes)
+    {
+        geometry[node.mesh_index].instances.push_back(transforms[node.transform_index]);
+    }
+    return geometry;
+}
+
+ActorHandle Resources::LoadModel(const std::filesystem::path& path,
+                                 const glm::vec3 position,
+                                 const glm::vec3 scale,
+                                 const MeshletConfig& meshlet_config)
+{
+    auto asset = ParseGltf(path);
+    if (!asset) return {};
 
     Model m{};
+    m.meshlet_config = ClampMeshletConfig(meshlet_config);
 
     std::vector<std::pair<uint32_t, uint32_t>> mesh_ranges;
 
     for (auto& mesh : asset->meshes)
     {
         uint32_t start = static_cast<uint32_t>(m.meshes.size());
-        auto meshes = LoadMesh(m, asset.get(), mesh);
+        auto meshes = LoadMesh(m, asset.value(), mesh);
         m.meshes.insert(m.meshes.end(), meshes.begin(), meshes.end());
         mesh_ranges.push_back({ start, static_cast<uint32_t>(meshes.size()) });
     }
 
     for (auto& texture : asset->textures)
     {
-        auto tex = LoadTexture(std::filesystem::path(path).parent_path().string(), asset.get(), texture);
+        auto tex = LoadTexture(std::filesystem::path(path).parent_path().string(), asset.value(), texture);
         m.textures.emplace_back(tex);
     }
 
@@ -486,11 +597,15 @@ std::shared_ptr<Actor> Resources::LoadModel(const std::filesystem::path& path, c
         m.samplers.emplace_back(samp);
     }
 
-    std::tie(m.nodes, m.transforms) = LoadNodes(asset.get(), mesh_ranges, position, scale);
+    std::tie(m.nodes, m.transforms) = LoadNodes(asset.value(), mesh_ranges);
 
-    auto actor = m_engine->GetScene().AddActor<Actor>();
-    actor->AddModel(m);
-    return actor;
+    // Node transforms stay relative to the actor so moving it later moves the whole model.
+    auto& scene = m_engine->GetScene();
+    const auto handle = scene.CreateActor(path.stem().string());
+    scene.SetTransform(handle, { .position = position, .scale = scale });
+    scene.UpdateTransforms();
+    scene.GetActor(handle).AddModel(m);
+    return handle;
 }
 
 std::tuple<std::vector<glm::vec3>, std::vector<Vertex>> Resources::LoadVertices(const fastgltf::Asset& asset,
@@ -574,18 +689,15 @@ std::vector<uint32_t> Resources::LoadIndices(const fastgltf::Asset& asset, const
 
 std::tuple<std::vector<Node>, std::vector<glm::mat4>> Resources::LoadNodes(
     const fastgltf::Asset& asset,
-    const std::vector<std::pair<uint32_t, uint32_t>>& mesh_ranges,
-    const glm::vec3 position,
-    const glm::vec3 scale)
+    const std::vector<std::pair<uint32_t, uint32_t>>& mesh_ranges)
 {
     std::vector<Node> nodes;
     std::vector<glm::mat4> transforms;
 
     const auto& scene = asset.scenes[asset.defaultScene.value_or(0)];
-    const auto transform = glm::translate(glm::mat4(1.f), position) * glm::scale(glm::mat4(1.0f), scale);
     for (const auto& nodeIndex : scene.nodeIndices)
     {
-        LoadNode(asset, nodeIndex, transform, nodes, transforms, mesh_ranges);
+        LoadNode(asset, nodeIndex, glm::mat4(1.f), nodes, transforms, mesh_ranges);
     }
 
     return { nodes, transforms };
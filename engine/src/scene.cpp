@@ -1,9 +1,398 @@
 #include "scene.hpp"
+#include "engine.hpp"
+#include "profiler.hpp"
+#include <immintrin.h>
 
-void Scene::Update(const float dt) const
+namespace
 {
-    for (const auto actor : m_actors)
+    glm::mat4 MultiplyMatrices(const glm::mat4& a, const glm::mat4& b)
     {
-        actor->Update(dt);
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128 a0 = _mm_loadu_ps(&a[0].x);
+        const __m128 a1 = _mm_loadu_ps(&a[1].x);
+        const __m128 a2 = _mm_loadu_ps(&a[2].x);
+        const __m128 a3 = _mm_loadu_ps(&a[3].x);
+        glm::mat4 result;
+        for (int i = 0; i < 4; ++i)
+        {
+            const __m128 xy = _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[i].x)), _mm_mul_ps(a1, _mm_set1_ps(b[i].y)));
+            const __m128 zw = _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b[i].z)), _mm_mul_ps(a3, _mm_set1_ps(b[i].w)));
+            _mm_storeu_ps(&result[i].x, _mm_add_ps(xy, zw));
+        }
+        return result;
+#else
+        return a * b;
+#endif
     }
-}
\ No newline at end of file
+
+#if defined(__SSE2__) || defined(_M_X64)
+    __m128 Select(const __m128 mask, const __m128 a, const __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // Sine and cosine of four angles with Cephes' single precision polynomials, after reducing the angles by a multiple of
+    // pi / 4. Matches std::sin and std::cos to a few ulp for angles up to a few thousand radians.
+    void SinCos(__m128 x, __m128& sin, __m128& cos)
+    {
+        const __m128 sign_mask = _mm_set1_ps(-0.f);
+        __m128 sin_sign = _mm_and_ps(x, sign_mask);
+        x = _mm_andnot_ps(sign_mask, x);
+
+        // Octant of the angle, rounded up to an even one so the remainder lands in [-pi / 4, pi / 4].
+        __m128i octant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f)));
+        octant = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+        const __m128 y = _mm_cvtepi32_ps(octant);
+        x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-0.78515625f)));
+        x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-2.4187564849853515625e-4f)));
+        x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-3.77489497744594108e-8f)));
+
+        sin_sign = _mm_xor_ps(sin_sign, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29)));
+        const __m128i cos_octant = _mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)), _mm_set1_epi32(4));
+        const __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(cos_octant, 29));
+
+        const __m128 z = _mm_mul_ps(x, x);
+        __m128 cos_poly = _mm_set1_ps(2.443315711809948e-5f);
+        cos_poly = _mm_add_ps(_mm_mul_ps(cos_poly, z), _mm_set1_ps(-1.388731625493765e-3f));
+        cos_poly = _mm_add_ps(_mm_mul_ps(cos_poly, z), _mm_set1_ps(4.166664568298827e-2f));
+        cos_poly = _mm_mul_ps(_mm_mul_ps(cos_poly, z), z);
+        cos_poly = _mm_add_ps(_mm_sub_ps(cos_poly, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.f));
+        __m128 sin_poly = _mm_set1_ps(-1.9515295891e-4f);
+        sin_poly = _mm_add_ps(_mm_mul_ps(sin_poly, z), _mm_set1_ps(8.3321608736e-3f));
+        sin_poly = _mm_add_ps(_mm_mul_ps(sin_poly, z), _mm_set1_ps(-1.6666654611e-1f));
+        sin_poly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sin_poly, z), x), x);
+
+        // Odd octant pairs swap the two polynomials.
+        const __m128 keep = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)), _mm_setzero_si128()));
+        sin = _mm_xor_ps(Select(keep, sin_poly, cos_poly), sin_sign);
+        cos = _mm_xor_ps(Select(keep, cos_poly, sin_poly), cos_sign);
+    }
+#endif
+
+    // Transform::ToMatrix for a batch of actors. The SSE path builds four matrices at once with one actor per lane,
+    // the euler angles' sines and cosines are most of the cost and vectorize fully.
+    void ComputeLocalMatrices(const std::span<const Transform> transforms,
+                              const std::span<const uint32_t> indices,
+                              const std::span<glm::mat4> matrices)
+    {
+        size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+        for (; i + 4 <= indices.size(); i += 4)
+        {
+            const Transform& t0 = transforms[indices[i]];
+            const Transform& t1 = transforms[indices[i + 1]];
+            const Transform& t2 = transforms[indices[i + 2]];
+            const Transform& t3 = transforms[indices[i + 3]];
+            auto Gather = [&](const glm::vec3 Transform::*member, const int component)
+            {
+                return _mm_setr_ps((t0.*member)[component], (t1.*member)[component], (t2.*member)[component], (t3.*member)[component]);
+            };
+
+            // Same euler order as glm::quat(glm::vec3).
+            const __m128 half = _mm_set1_ps(0.5f);
+            __m128 sx, cx, sy, cy, sz, cz;
+            SinCos(_mm_mul_ps(Gather(&Transform::rotation, 0), half), sx, cx);
+            SinCos(_mm_mul_ps(Gather(&Transform::rotation, 1), half), sy, cy);
+            SinCos(_mm_mul_ps(Gather(&Transform::rotation, 2), half), sz, cz);
+            const __m128 cxcy = _mm_mul_ps(cx, cy);
+            const __m128 sxsy = _mm_mul_ps(sx, sy);
+            const __m128 sxcy = _mm_mul_ps(sx, cy);
+            const __m128 cxsy = _mm_mul_ps(cx, sy);
+            const __m128 qw = _mm_add_ps(_mm_mul_ps(cxcy, cz), _mm_mul_ps(sxsy, sz));
+            const __m128 qx = _mm_sub_ps(_mm_mul_ps(sxcy, cz), _mm_mul_ps(cxsy, sz));
+            const __m128 qy = _mm_add_ps(_mm_mul_ps(cxsy, cz), _mm_mul_ps(sxcy, sz));
+            const __m128 qz = _mm_sub_ps(_mm_mul_ps(cxcy, sz), _mm_mul_ps(sxsy, cz));
+
+            const __m128 two = _mm_set1_ps(2.f);
+            const __m128 one = _mm_set1_ps(1.f);
+            const __m128 xx = _mm_mul_ps(qx, qx);
+            const __m128 yy = _mm_mul_ps(qy, qy);
+            const __m128 zz = _mm_mul_ps(qz, qz);
+            const __m128 xy = _mm_mul_ps(qx, qy);
+            const __m128 xz = _mm_mul_ps(qx, qz);
+            const __m128 yz = _mm_mul_ps(qy, qz);
+            const __m128 wx = _mm_mul_ps(qw, qx);
+            const __m128 wy = _mm_mul_ps(qw, qy);
+            const __m128 wz = _mm_mul_ps(qw, qz);
+            const __m128 scale_x = Gather(&Transform::scale, 0);
+            const __m128 scale_y = Gather(&Transform::scale, 1);
+            const __m128 scale_z = Gather(&Transform::scale, 2);
+
+            // One register per matrix element across the four actors, transposed back into four matrices per column.
+            __m128 columns[4][4] = {
+                { _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), scale_x),
+                  _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), scale_x),
+                  _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), scale_x),
+                  _mm_setzero_ps() },
+                { _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), scale_y),
+                  _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), scale_y),
+                  _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), scale_y),
+                  _mm_setzero_ps() },
+                { _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), scale_z),
+                  _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), scale_z),
+                  _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), scale_z),
+                  _mm_setzero_ps() },
+                { Gather(&Transform::position, 0), Gather(&Transform::position, 1), Gather(&Transform::position, 2), one },
+            };
+            for (int column = 0; column < 4; ++column)
+            {
+                auto& [r0, r1, r2, r3] = columns[column];
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                _mm_storeu_ps(&matrices[i][column].x, r0);
+                _mm_storeu_ps(&matrices[i + 1][column].x, r1);
+                _mm_storeu_ps(&matrices[i + 2][column].x, r2);
+                _mm_storeu_ps(&matrices[i + 3][column].x, r3);
+            }
+        }
+#endif
+        for (; i < indices.size(); ++i)
+        {
+            matrices[i] = transforms[indices[i]].ToMatrix();
+        }
+    }
+} // namespace
+
+Pose Pose::FromMatrix(const glm::mat4& matrix)
+{
+    const glm::vec3 scale(glm::length(glm::vec3(matrix[0])),
+                          glm::length(glm::vec3(matrix[1])),
+                          glm::length(glm::vec3(matrix[2])));
+    const glm::vec3 safe_scale = glm::max(scale, glm::vec3(1e-6f));
+    return { .position = glm::vec3(matrix[3]),
+             .rotation = glm::quat_cast(glm::mat3(glm::vec3(matrix[0]) / safe_scale.x,
+                                                  glm::vec3(matrix[1]) / safe_scale.y,
+                                                  glm::vec3(matrix[2]) / safe_scale.z)),
+             .scale = scale };
+}
+
+glm::mat4 Pose::Blend(const Pose& a, const Pose& b, const float alpha)
+{
+    // Normalized lerp rather than slerp. Between two ticks the rotation is small enough that the uneven speed along the
+    // arc can't be seen, and it skips the trig, which made blending cost more per frame than a tick did.
+    const glm::quat target = glm::dot(a.rotation, b.rotation) < 0.f ? -b.rotation : b.rotation;
+    const glm::quat rotation = glm::normalize(a.rotation * (1.f - alpha) + target * alpha);
+    const glm::vec3 scale = glm::mix(a.scale, b.scale, alpha);
+    glm::mat4 result = glm::mat4_cast(rotation);
+    result[0] *= scale.x;
+    result[1] *= scale.y;
+    result[2] *= scale.z;
+    result[3] = glm::vec4(glm::mix(a.position, b.position, alpha), 1.f);
+    return result;
+}
+
+ActorHandle Scene::CreateActor(const std::string_view name)
+{
+    uint32_t slot;
+    if (!m_free_slots.empty())
+    {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(m_slot_generations.size());
+        m_slot_dense_indices.push_back(0);
+        m_slot_generations.push_back(0);
+    }
+
+    m_slot_dense_indices[slot] = static_cast<uint32_t>(m_dense_slots.size());
+    m_dense_slots.push_back(slot);
+    m_transforms.emplace_back();
+    m_world_matrices.emplace_back(1.f);
+    m_parents.emplace_back();
+    m_children.emplace_back();
+    m_dirty.push_back(0);
+    m_bounds.emplace_back();
+    m_renderables.emplace_back();
+    m_names.emplace_back(name);
+    return { .index = slot, .generation = m_slot_generations[slot] };
+}
+
+void Scene::DestroyActor(const ActorHandle handle)
+{
+    if (!IsValid(handle)) return;
+
+    // Children become roots, so their world matrix is rebuilt from their own local transform.
+    for (const auto child : std::vector(GetChildren(handle).begin(), GetChildren(handle).end()))
+    {
+        SetParent(child, {});
+    }
+    SetParent(handle, {});
+
+    const uint32_t dense_index = GetDenseIndex(handle);
+    if (const auto& [offset, size] = m_renderables[dense_index]; size != 0)
+    {
+        m_engine->GetRenderer().RemoveRenderables(offset, size);
+    }
+    auto RemoveAt = [dense_index](auto& values)
+    {
+        values[dense_index] = std::move(values.back());
+        values.pop_back();
+    };
+    RemoveAt(m_dense_slots);
+    RemoveAt(m_transforms);
+    RemoveAt(m_world_matrices);
+    RemoveAt(m_parents);
+    RemoveAt(m_children);
+    RemoveAt(m_dirty);
+    RemoveAt(m_bounds);
+    RemoveAt(m_renderables);
+    RemoveAt(m_names);
+    if (dense_index < m_dense_slots.size())
+    {
+        m_slot_dense_indices[m_dense_slots[dense_index]] = dense_index;
+    }
+
+    ++m_slot_generations[handle.index];
+    m_free_slots.push_back(handle.index);
+}
+
+bool Scene::IsValid(const ActorHandle handle) const
+{
+    // Destroying bumps the slot's generation, so a matching generation means the slot is still held by this actor.
+    return handle.index < m_slot_generations.size() && m_slot_generations[handle.index] == handle.generation;
+}
+
+ActorHandle Scene::GetHandle(const uint32_t dense_index) const
+{
+    const uint32_t slot = m_dense_slots[dense_index];
+    return { .index = slot, .generation = m_slot_generations[slot] };
+}
+
+std::optional<ActorHandle> Scene::FindRenderableOwner(const uint32_t renderable_index) const
+{
+    for (uint32_t i = 0; i < m_renderables.size(); ++i)
+    {
+        if (m_renderables[i].Contains(renderable_index)) return GetHandle(i);
+    }
+    return std::nullopt;
+}
+
+void Scene::SetTransform(const ActorHandle handle, const Transform& transform)
+{
+    if (!IsValid(handle)) return;
+    const uint32_t dense_index = GetDenseIndex(handle);
+    m_transforms[dense_index] = transform;
+    m_dirty[dense_index] = 1;
+}
+
+bool Scene::SetParent(const ActorHandle child, const ActorHandle parent)
+{
+    if (!IsValid(child)) return false;
+    for (auto ancestor = parent; IsValid(ancestor); ancestor = GetParent(ancestor))
+    {
+        if (ancestor == child)
+        {
+            printf("Can't parent an actor to itself or one of its descendants\n");
+            return false;
+        }
+    }
+
+    const uint32_t dense_index = GetDenseIndex(child);
+    if (const auto previous = m_parents[dense_index]; IsValid(previous))
+    {
+        std::erase(m_children[GetDenseIndex(previous)], child);
+    }
+    m_parents[dense_index] = IsValid(parent) ? parent : ActorHandle{};
+    if (IsValid(parent))
+    {
+        m_children[GetDenseIndex(parent)].push_back(child);
+    }
+    m_dirty[dense_index] = 1;
+    return true;
+}
+
+void Scene::UpdateTransforms()
+{
+    CPU_ZONE("Update Transforms");
+    // Collect every dirty subtree from its top-most dirty actor, parents always land before their children.
+    m_update_order.clear();
+    m_update_parents.clear();
+    for (uint32_t i = 0; i < m_dirty.size(); ++i)
+    {
+        if (!m_dirty[i]) continue;
+
+        bool dirty_ancestor = false;
+        for (auto ancestor = m_parents[i]; IsValid(ancestor); ancestor = GetParent(ancestor))
+        {
+            if (m_dirty[GetDenseIndex(ancestor)])
+            {
+                dirty_ancestor = true;
+                break;
+            }
+        }
+        if (dirty_ancestor) continue;
+
+        const size_t first = m_update_order.size();
+        m_update_order.push_back(i);
+        m_update_parents.push_back(IsValid(m_parents[i]) ? GetDenseIndex(m_parents[i]) : NO_PARENT);
+        for (size_t j = first; j < m_update_order.size(); ++j)
+        {
+            for (const auto child : m_children[m_update_order[j]])
+            {
+                m_update_order.push_back(GetDenseIndex(child));
+                m_update_parents.push_back(m_update_order[j]);
+            }
+        }
+    }
+    if (m_update_order.empty()) return;
+
+    m_local_matrices.resize(m_update_order.size());
+    ComputeLocalMatrices(m_transforms, m_update_order, m_local_matrices);
+
+    // Every parent was resolved up front and comes before its children, so this is a straight pass over the contiguous
+    // local matrices with no hierarchy lookups left in it.
+    for (size_t i = 0; i < m_update_order.size(); ++i)
+    {
+        const uint32_t index = m_update_order[i];
+        const uint32_t parent = m_update_parents[i];
+        const glm::mat4 world = parent != NO_PARENT ? MultiplyMatrices(m_world_matrices[parent], m_local_matrices[i])
+                                                    : m_local_matrices[i];
+        if (m_renderables[index].size != 0)
+        {
+            m_interpolated.push_back({ .handle = GetHandle(index),
+                                       .previous = Pose::FromMatrix(m_world_matrices[index]),
+                                       .current = Pose::FromMatrix(world) });
+        }
+        m_world_matrices[index] = world;
+        m_dirty[index] = 0;
+    }
+
+    for (const uint32_t index : m_update_order)
+    {
+        const auto& [offset, size] = m_renderables[index];
+        if (size == 0) continue;
+        auto& renderer = m_engine->GetRenderer();
+        renderer.SetActorTransform(offset, size, m_world_matrices[index]);
+        m_bounds[index] = renderer.GetBounds(offset, size, m_world_matrices[index]);
+    }
+    CPU_PLOT("Updated Transforms", static_cast<int64_t>(m_update_order.size()));
+}
+
+void Scene::Update()
+{
+    CPU_ZONE("Scene Update");
+    // Whatever moved last tick was last drawn part way there, snap it to its final pose before this tick's movers
+    // take over the list.
+    for (const auto& [handle, previous, current] : m_interpolated)
+    {
+        if (!IsValid(handle)) continue;
+        const uint32_t index = GetDenseIndex(handle);
+        const auto& [offset, size] = m_renderables[index];
+        m_engine->GetRenderer().SetActorTransform(offset, size, m_world_matrices[index]);
+    }
+    m_interpolated.clear();
+    UpdateTransforms();
+}
+
+void Scene::Interpolate(const float alpha)
+{
+    CPU_ZONE("Interpolate Transforms");
+    for (const auto& [handle, previous, current] : m_interpolated)
+    {
+        if (!IsValid(handle)) continue;
+        const auto& [offset, size] = m_renderables[GetDenseIndex(handle)];
+        m_engine->GetRenderer().SetActorTransform(offset, size, Pose::Blend(previous, current, alpha));
+    }
+    CPU_PLOT("Interpolated Actors", static_cast<int64_t>(m_interpolated.size()));
+}
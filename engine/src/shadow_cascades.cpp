@@ -0,0 +1,100 @@
+#include "shadow_cascades.hpp"
+
+void ShadowCascades::ComputeSplits(const float near_plane,
+                                   const float far_plane,
+                                   const float lambda,
+                                   const std::span<float> splits)
+{
+    const auto count = static_cast<float>(splits.size());
+    for (uint32_t i = 0; i < splits.size(); ++i)
+    {
+        const float fraction = static_cast<float>(i + 1) / count;
+        const float logarithmic = near_plane * std::pow(far_plane / near_plane, fraction);
+        const float uniform = near_plane + (far_plane - near_plane) * fraction;
+        splits[i] = glm::mix(uniform, logarithmic, lambda);
+    }
+    if (!splits.empty())
+    {
+        splits.back() = far_plane;
+    }
+}
+
+void ShadowCascades::SetSettings(const ShadowCascadeSettings& settings)
+{
+    m_settings = settings;
+    m_settings.count = std::clamp(settings.count, 1u, MAX_CASCADES);
+    m_settings.lambda = std::clamp(settings.lambda, 0.f, 1.f);
+    m_settings.resolution = std::max(settings.resolution, 16u);
+}
+
+void ShadowCascades::Fit(const Camera& camera, const glm::vec3 light_direction, const BoundingBox& casters)
+{
+    m_count = std::clamp(m_settings.count, 1u, MAX_CASCADES);
+    const float near_plane = camera.m_near_plane;
+    const float far_plane = std::max(std::min(camera.m_far_plane, m_settings.max_distance), near_plane * 2.f);
+    std::array<float, MAX_CASCADES> splits{};
+    ComputeSplits(near_plane, far_plane, m_settings.lambda, std::span(splits).first(m_count));
+
+    // The light's rotation never changes with the camera, only the window into it moves.
+    const glm::vec3 direction = glm::normalize(light_direction);
+    const glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.f, 0.f, 1.f) : glm::vec3(0.f, 1.f, 0.f);
+    m_light_view = glm::lookAtRH(glm::vec3(0.f), direction, up);
+    const glm::mat4& view = m_light_view;
+    const glm::mat4 inv_camera_view = glm::inverse(camera.m_view_matrix);
+
+    // Depth along the light of the caster closest to it, the light looks down -z.
+    float caster_depth = std::numeric_limits<float>::max();
+    if (casters.IsValid())
+    {
+        for (uint32_t corner = 0; corner < 8; ++corner)
+        {
+            const glm::vec3 point(corner & 1 ? casters.max.x : casters.min.x,
+                                  corner & 2 ? casters.max.y : casters.min.y,
+                                  corner & 4 ? casters.max.z : casters.min.z);
+            caster_depth = std::min(caster_depth, -(view * glm::vec4(point, 1.f)).z);
+        }
+    }
+
+    // Squared slope of the corner rays, a slice corner at view depth d is d * sqrt(slope) off the view axis.
+    const float tan_y = std::tan(camera.m_fov * 0.5f);
+    const float tan_x = tan_y * camera.m_aspect_ratio;
+    const float slope = tan_x * tan_x + tan_y * tan_y;
+
+    float slice_near = near_plane;
+    for (uint32_t i = 0; i < m_count; ++i)
+    {
+        const float slice_far = splits[i];
+        // On the view axis where the near and far corners are equally far away, or at the far cap's center when the
+        // slice is too deep for that point to lie inside it.
+        const float center_depth = std::min((slice_near + slice_far) * (1.f + slope) * 0.5f, slice_far);
+        const float far_offset = slice_far - center_depth;
+        float radius = std::sqrt(far_offset * far_offset + slice_far * slice_far * slope);
+        // Rounded up so float noise never changes the texel size.
+        radius = std::ceil(radius * 16.f) / 16.f;
+
+        const glm::vec3 center = inv_camera_view * glm::vec4(0.f, 0.f, -center_depth, 1.f);
+        glm::vec3 light_center = view * glm::vec4(center, 1.f);
+        // Snapping moves the center by up to a texel, so the map spans one more texel on every side than the sphere.
+        const float texel_size = 2.f * radius / static_cast<float>(m_settings.resolution - 2);
+        const float extent = radius + texel_size;
+        light_center.x = std::floor(light_center.x / texel_size) * texel_size;
+        light_center.y = std::floor(light_center.y / texel_size) * texel_size;
+
+        const float depth = -light_center.z;
+        const float z_near = std::min(depth - radius, caster_depth);
+        const float z_far = depth + radius;
+        const glm::mat4 proj = glm::orthoRH_ZO(light_center.x - extent,
+                                               light_center.x + extent,
+                                               light_center.y - extent,
+                                               light_center.y + extent,
+                                               z_near,
+                                               z_far);
+        m_cascades[i] = {
+            .view_proj = proj * view,
+            .near_depth = slice_near,
+            .split_depth = slice_far,
+            .bounds = { .center = center, .radius = radius },
+        };
+        slice_near = slice_far;
+    }
+}
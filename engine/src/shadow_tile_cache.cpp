@@ -0,0 +1,236 @@
+#include "shadow_tile_cache.hpp"
+
+namespace
+{
+    std::array<glm::vec3, 8> GetCorners(const BoundingBox& box)
+    {
+        std::array<glm::vec3, 8> corners;
+        for (uint32_t i = 0; i < corners.size(); ++i)
+        {
+            corners[i] = { i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y, i & 4 ? box.max.z : box.min.z };
+        }
+        return corners;
+    }
+} // namespace
+
+ShadowTileCache::ShadowTileCache() { m_page_table.fill(NO_PAGE); }
+
+void ShadowTileCache::BeginFrame(const glm::mat4& light_view,
+                                 const std::span<const ShadowCascade> cascades,
+                                 const uint32_t resolution,
+                                 const BoundingBox& casters)
+{
+    ++m_frame;
+    m_renders.clear();
+    m_stats = { .invalidated = m_pending_invalidated };
+    m_pending_invalidated = 0;
+
+    // Every tile maps the same depth range, so it has to cover every caster and changing it redraws everything.
+    glm::vec2 depth_range = m_depth_range;
+    if (casters.IsValid())
+    {
+        float min_depth = std::numeric_limits<float>::max();
+        float max_depth = std::numeric_limits<float>::lowest();
+        for (const auto& corner : GetCorners(casters))
+        {
+            const float depth = -(light_view * glm::vec4(corner, 1.f)).z;
+            min_depth = std::min(min_depth, depth);
+            max_depth = std::max(max_depth, depth);
+        }
+        depth_range = { std::floor(min_depth / DEPTH_SNAP) * DEPTH_SNAP, std::ceil(max_depth / DEPTH_SNAP) * DEPTH_SNAP };
+        depth_range.y = std::max(depth_range.y, depth_range.x + DEPTH_SNAP);
+    }
+    if (light_view != m_light_view || depth_range != m_depth_range)
+    {
+        Clear();
+        m_light_view = light_view;
+        m_depth_range = depth_range;
+    }
+
+    m_level_count = static_cast<uint32_t>(std::min<size_t>(cascades.size(), m_levels.size()));
+    for (uint32_t i = 0; i < m_level_count; ++i)
+    {
+        const auto& bounds = cascades[i].bounds;
+        auto& level = m_levels[i];
+        const float tile_size = 2.f * bounds.radius * TILE_RESOLUTION / static_cast<float>(resolution);
+        if (tile_size != level.tile_size)
+        {
+            DropLevel(i);
+            level.tile_size = tile_size;
+        }
+        const glm::vec2 center(light_view * glm::vec4(bounds.center, 1.f));
+        const glm::ivec2 first(glm::floor((center - bounds.radius) / tile_size));
+        const glm::ivec2 last(glm::floor((center + bounds.radius) / tile_size));
+        level.origin = first;
+        level.count = glm::min(last - first + 1, glm::ivec2(static_cast<int>(WINDOW)));
+    }
+
+    // Tiles a cascade still needs are never evicted this frame.
+    for (auto& page : m_pages)
+    {
+        if (page.level >= m_level_count) continue;
+        const auto& level = m_levels[page.level];
+        const glm::ivec2 offset = page.coord - level.origin;
+        if (offset.x >= 0 && offset.y >= 0 && offset.x < level.count.x && offset.y < level.count.y)
+        {
+            page.last_used = m_frame;
+        }
+    }
+    BuildPageTable();
+}
+
+void ShadowTileCache::Invalidate(const BoundingBox& box)
+{
+    if (!box.IsValid()) return;
+
+    glm::vec2 min(std::numeric_limits<float>::max());
+    glm::vec2 max(std::numeric_limits<float>::lowest());
+    for (const auto& corner : GetCorners(box))
+    {
+        const glm::vec2 point(m_light_view * glm::vec4(corner, 1.f));
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    for (auto& page : m_pages)
+    {
+        if (page.level == NO_PAGE || page.dirty) continue;
+        const float tile_size = m_levels[page.level].tile_size;
+        const glm::ivec2 first(glm::floor(min / tile_size));
+        const glm::ivec2 last(glm::floor(max / tile_size));
+        if (page.coord.x < first.x || page.coord.y < first.y || page.coord.x > last.x || page.coord.y > last.y) continue;
+        page.dirty = true;
+        ++m_pending_invalidated;
+    }
+}
+
+void ShadowTileCache::Clear()
+{
+    m_pages.fill({});
+    m_page_table.fill(NO_PAGE);
+}
+
+void ShadowTileCache::Schedule(const uint32_t budget)
+{
+    struct Request
+    {
+        uint32_t level;
+        glm::ivec2 coord;
+        uint32_t page;
+        float distance;
+    };
+    std::vector<Request> requests;
+    for (uint32_t i = 0; i < m_level_count; ++i)
+    {
+        const auto& level = m_levels[i];
+        const glm::vec2 center = glm::vec2(level.origin) + glm::vec2(level.count) * 0.5f;
+        for (int y = 0; y < level.count.y; ++y)
+        {
+            for (int x = 0; x < level.count.x; ++x)
+            {
+                const glm::ivec2 coord = level.origin + glm::ivec2(x, y);
+                const uint32_t page = m_page_table[GetSlot(i, coord)];
+                if (page != NO_PAGE && !m_pages[page].dirty) continue;
+                const glm::vec2 offset = glm::vec2(coord) + 0.5f - center;
+                requests.push_back({ .level = i, .coord = coord, .page = page, .distance = glm::dot(offset, offset) });
+            }
+        }
+    }
+    // Nearest cascade first, and inside one a missing tile before a stale one, closest to the camera first.
+    std::ranges::sort(requests,
+                      [](const Request& a, const Request& b)
+                      {
+                          const bool a_resident = a.page != NO_PAGE;
+                          const bool b_resident = b.page != NO_PAGE;
+                          return std::tie(a.level, a_resident, a.distance) < std::tie(b.level, b_resident, b.distance);
+                      });
+    m_stats.requested = static_cast<uint32_t>(requests.size());
+
+    const uint32_t max_renders = std::min(budget, MAX_RENDERS);
+    for (const auto& [level_index, coord, resident_page, distance] : requests)
+    {
+        if (m_renders.size() >= max_renders) break;
+        const uint32_t page = resident_page == NO_PAGE ? AllocatePage() : resident_page;
+        if (page == NO_PAGE) continue;
+
+        m_pages[page] = { .level = level_index, .coord = coord, .last_used = m_frame, .dirty = false };
+        m_page_table[GetSlot(level_index, coord)] = page;
+        const float tile_size = m_levels[level_index].tile_size;
+        const glm::vec2 min = glm::vec2(coord) * tile_size;
+        const glm::vec2 max = glm::vec2(coord + 1) * tile_size;
+        const glm::mat4 proj = glm::orthoRH_ZO(min.x, max.x, min.y, max.y, m_depth_range.x, m_depth_range.y);
+        m_renders.push_back({ .page = page, .level = level_index, .coord = coord, .view_proj = proj * m_light_view });
+    }
+
+    m_stats.redrawn = static_cast<uint32_t>(m_renders.size());
+    for (const auto& request : requests)
+    {
+        m_stats.missing += m_page_table[GetSlot(request.level, request.coord)] == NO_PAGE;
+    }
+    for (const auto& page : m_pages)
+    {
+        m_stats.resident += page.level != NO_PAGE;
+    }
+}
+
+uint32_t ShadowTileCache::GetSlot(const uint32_t level, const glm::ivec2 coord) const
+{
+    const glm::ivec2 offset = coord - m_levels[level].origin;
+    if (offset.x < 0 || offset.y < 0 || offset.x >= static_cast<int>(WINDOW) || offset.y >= static_cast<int>(WINDOW))
+    {
+        return NO_PAGE;
+    }
+    return level * WINDOW_TILES + offset.y * WINDOW + offset.x;
+}
+
+uint32_t ShadowTileCache::AllocatePage()
+{
+    // A free page if there is one, otherwise the least recently needed tile no cascade needs this frame.
+    uint32_t best = NO_PAGE;
+    for (uint32_t i = 0; i < m_pages.size(); ++i)
+    {
+        const auto& page = m_pages[i];
+        if (page.level == NO_PAGE) return i;
+        if (page.last_used < m_frame && (best == NO_PAGE || page.last_used < m_pages[best].last_used))
+        {
+            best = i;
+        }
+    }
+    if (best == NO_PAGE) return NO_PAGE;
+
+    const auto& evicted = m_pages[best];
+    if (evicted.level < m_level_count)
+    {
+        if (const uint32_t slot = GetSlot(evicted.level, evicted.coord); slot != NO_PAGE)
+        {
+            m_page_table[slot] = NO_PAGE;
+        }
+    }
+    m_pages[best] = {};
+    ++m_stats.evicted;
+    return best;
+}
+
+void ShadowTileCache::DropLevel(const uint32_t level)
+{
+    for (auto& page : m_pages)
+    {
+        if (page.level == level)
+        {
+            page = {};
+        }
+    }
+}
+
+void ShadowTileCache::BuildPageTable()
+{
+    m_page_table.fill(NO_PAGE);
+    for (uint32_t i = 0; i < m_pages.size(); ++i)
+    {
+        const auto& page = m_pages[i];
+        if (page.level >= m_level_count) continue;
+        if (const uint32_t slot = GetSlot(page.level, page.coord); slot != NO_PAGE)
+        {
+            m_page_table[slot] = i;
+        }
+    }
+}
@@ -0,0 +1,184 @@
+#include "tlsf_allocator.hpp"
+
+TlsfAllocator::TlsfAllocator(const uint32_t size) : m_size(size)
+{
+    for (auto& heads : m_free_heads)
+    {
+        heads.fill(NONE);
+    }
+    if (size == 0) return;
+
+    InsertFree(CreateBlock(0, size));
+}
+
+std::pair<uint32_t, uint32_t> TlsfAllocator::GetBin(const uint32_t size)
+{
+    if (size < SL_COUNT) return { 0, size };
+
+    const uint32_t log2 = std::bit_width(size) - 1;
+    return { log2 - SL_BITS + 1, (size >> (log2 - SL_BITS)) - SL_COUNT };
+}
+
+uint32_t TlsfAllocator::FindBlock(const uint32_t size) const
+{
+    // Rounding up to the next bin means the head of any bin found fits without walking its list.
+    uint32_t search_size = size;
+    if (size >= SL_COUNT)
+    {
+        const uint32_t round = (1u << (std::bit_width(size) - 1 - SL_BITS)) - 1;
+        search_size = size > std::numeric_limits<uint32_t>::max() - round ? size : size + round;
+    }
+    auto [fl, sl] = GetBin(search_size);
+    uint32_t sl_map = m_sl_bitmaps[fl] & (~0u << sl);
+    if (!sl_map)
+    {
+        const uint32_t fl_map = fl + 1 < FL_COUNT ? m_fl_bitmap & (~0u << (fl + 1)) : 0;
+        if (fl_map)
+        {
+            fl = std::countr_zero(fl_map);
+            sl_map = m_sl_bitmaps[fl];
+        }
+    }
+    if (sl_map) return m_free_heads[fl][std::countr_zero(sl_map)];
+
+    // Nothing in a larger bin, a block in the size's own bin may still be big enough.
+    const auto [exact_fl, exact_sl] = GetBin(size);
+    for (uint32_t block = m_free_heads[exact_fl][exact_sl]; block != NONE; block = m_blocks[block].next_free)
+    {
+        if (m_blocks[block].size >= size) return block;
+    }
+    return NONE;
+}
+
+std::optional<TlsfAllocation> TlsfAllocator::Allocate(const uint32_t size)
+{
+    if (size == 0 || size > m_free_size) return std::nullopt;
+
+    const uint32_t block = FindBlock(size);
+    if (block == NONE) return std::nullopt;
+    RemoveFree(block);
+    if (m_blocks[block].size > size)
+    {
+        const uint32_t remainder = CreateBlock(m_blocks[block].offset + size, m_blocks[block].size - size);
+        m_blocks[block].size = size;
+        m_blocks[remainder].prev_physical = block;
+        m_blocks[remainder].next_physical = m_blocks[block].next_physical;
+        if (m_blocks[block].next_physical != NONE)
+        {
+            m_blocks[m_blocks[block].next_physical].prev_physical = remainder;
+        }
+        m_blocks[block].next_physical = remainder;
+        InsertFree(remainder);
+    }
+
+    ++m_allocation_count;
+    return TlsfAllocation{ .offset = m_blocks[block].offset, .size = size, .block = block };
+}
+
+void TlsfAllocator::Free(const TlsfAllocation& allocation)
+{
+    uint32_t block = allocation.block;
+    --m_allocation_count;
+    if (const uint32_t next = m_blocks[block].next_physical; next != NONE && m_blocks[next].free)
+    {
+        RemoveFree(next);
+        Merge(block, next);
+    }
+    if (const uint32_t prev = m_blocks[block].prev_physical; prev != NONE && m_blocks[prev].free)
+    {
+        RemoveFree(prev);
+        Merge(prev, block);
+        block = prev;
+    }
+    InsertFree(block);
+}
+
+uint32_t TlsfAllocator::GetLargestFreeBlock() const
+{
+    if (!m_fl_bitmap) return 0;
+
+    const uint32_t fl = 31 - std::countl_zero(m_fl_bitmap);
+    const uint32_t sl = 31 - std::countl_zero(m_sl_bitmaps[fl]);
+    uint32_t largest = 0;
+    for (uint32_t block = m_free_heads[fl][sl]; block != NONE; block = m_blocks[block].next_free)
+    {
+        largest = std::max(largest, m_blocks[block].size);
+    }
+    return largest;
+}
+
+uint32_t TlsfAllocator::CreateBlock(const uint32_t offset, const uint32_t size)
+{
+    uint32_t block;
+    if (m_unused_blocks.empty())
+    {
+        block = static_cast<uint32_t>(m_blocks.size());
+        m_blocks.emplace_back();
+    }
+    else
+    {
+        block = m_unused_blocks.back();
+        m_unused_blocks.pop_back();
+        m_blocks[block] = {};
+    }
+    m_blocks[block].offset = offset;
+    m_blocks[block].size = size;
+    return block;
+}
+
+void TlsfAllocator::InsertFree(const uint32_t block)
+{
+    auto& data = m_blocks[block];
+    const auto [fl, sl] = GetBin(data.size);
+    data.free = true;
+    data.prev_free = NONE;
+    data.next_free = m_free_heads[fl][sl];
+    if (data.next_free != NONE)
+    {
+        m_blocks[data.next_free].prev_free = block;
+    }
+    m_free_heads[fl][sl] = block;
+    m_fl_bitmap |= 1u << fl;
+    m_sl_bitmaps[fl] |= 1u << sl;
+    m_free_size += data.size;
+}
+
+void TlsfAllocator::RemoveFree(const uint32_t block)
+{
+    auto& data = m_blocks[block];
+    const auto [fl, sl] = GetBin(data.size);
+    if (data.prev_free != NONE)
+    {
+        m_blocks[data.prev_free].next_free = data.next_free;
+    }
+    else
+    {
+        m_free_heads[fl][sl] = data.next_free;
+    }
+    if (data.next_free != NONE)
+    {
+        m_blocks[data.next_free].prev_free = data.prev_free;
+    }
+    if (m_free_heads[fl][sl] == NONE)
+    {
+        m_sl_bitmaps[fl] &= ~(1u << sl);
+        if (!m_sl_bitmaps[fl])
+        {
+            m_fl_bitmap &= ~(1u << fl);
+        }
+    }
+    data.free = false;
+    m_free_size -= data.size;
+}
+
+// Folds next into block, both have to be out of the free lists.
+void TlsfAllocator::Merge(const uint32_t block, const uint32_t next)
+{
+    m_blocks[block].size += m_blocks[next].size;
+    m_blocks[block].next_physical = m_blocks[next].next_physical;
+    if (m_blocks[next].next_physical != NONE)
+    {
+        m_blocks[m_blocks[next].next_physical].prev_physical = block;
+    }
+    m_unused_blocks.push_back(next);
+}
@@ -0,0 +1,137 @@
+#include "transient_planner.hpp"
+
+void TransientPlanner::Reset()
+{
+    m_textures.clear();
+    m_passes.clear();
+    m_block_sizes.clear();
+    m_block_ends.clear();
+    m_report = {};
+}
+
+uint32_t TransientPlanner::AddTexture(const std::string_view name, const uint64_t size)
+{
+    m_textures.push_back({
+        .name = name,
+        .size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT,
+        .first_pass = NONE,
+        .block = NONE,
+    });
+    return static_cast<uint32_t>(m_textures.size() - 1);
+}
+
+TransientPlanner& TransientPlanner::AddPass(const std::string_view name)
+{
+    m_passes.push_back(name);
+    return *this;
+}
+
+TransientPlanner& TransientPlanner::Read(const uint32_t texture)
+{
+    auto& info = m_textures[texture];
+    if (info.first_pass == NONE)
+    {
+        info.first_pass = 0;
+        info.persistent = true;
+    }
+    Touch(texture);
+    return *this;
+}
+
+TransientPlanner& TransientPlanner::Write(const uint32_t texture)
+{
+    Touch(texture);
+    return *this;
+}
+
+void TransientPlanner::Touch(const uint32_t texture)
+{
+    auto& info = m_textures[texture];
+    const auto pass = static_cast<uint32_t>(m_passes.size() - 1);
+    if (info.first_pass == NONE)
+    {
+        info.first_pass = pass;
+    }
+    info.last_pass = pass;
+}
+
+void TransientPlanner::Plan()
+{
+    m_order.clear();
+    for (uint32_t i = 0; i < m_textures.size(); ++i)
+    {
+        auto& texture = m_textures[i];
+        if (texture.first_pass == NONE) continue;
+        if (texture.persistent)
+        {
+            texture.last_pass = static_cast<uint32_t>(m_passes.size() - 1);
+        }
+        m_order.push_back(i);
+    }
+    // Walking lifetimes by start and reusing any block whose last texture has already died is the greedy interval
+    // colouring, it never uses more blocks than textures alive at once. Bigger textures go first on ties so they open
+    // the blocks the smaller ones then fit into.
+    std::ranges::sort(m_order,
+                      [&](const uint32_t a, const uint32_t b)
+                      {
+                          const auto& lhs = m_textures[a];
+                          const auto& rhs = m_textures[b];
+                          if (lhs.first_pass != rhs.first_pass) return lhs.first_pass < rhs.first_pass;
+                          return lhs.size > rhs.size;
+                      });
+
+    m_block_sizes.clear();
+    m_block_ends.clear();
+    for (const uint32_t index : m_order)
+    {
+        auto& texture = m_textures[index];
+        // Among the free blocks take the smallest one the texture fits in, otherwise grow the largest.
+        uint32_t best = NONE;
+        for (uint32_t block = 0; block < m_block_sizes.size(); ++block)
+        {
+            if (m_block_ends[block] >= texture.first_pass) continue;
+            if (best == NONE)
+            {
+                best = block;
+                continue;
+            }
+            const bool fits = m_block_sizes[block] >= texture.size;
+            const bool best_fits = m_block_sizes[best] >= texture.size;
+            if (fits != best_fits)
+            {
+                if (fits) best = block;
+                continue;
+            }
+            const bool smaller = m_block_sizes[block] < m_block_sizes[best];
+            const bool larger = m_block_sizes[block] > m_block_sizes[best];
+            if (fits ? smaller : larger)
+            {
+                best = block;
+            }
+        }
+
+        if (best == NONE)
+        {
+            best = static_cast<uint32_t>(m_block_sizes.size());
+            m_block_sizes.push_back(0);
+            m_block_ends.push_back(0);
+        }
+        m_block_sizes[best] = std::max(m_block_sizes[best], texture.size);
+        m_block_ends[best] = texture.last_pass;
+        texture.block = best;
+    }
+
+    m_report = { .block_count = static_cast<uint32_t>(m_block_sizes.size()) };
+    for (const auto& texture : m_textures)
+    {
+        m_report.unaliased_bytes += texture.size;
+        if (texture.first_pass == NONE)
+        {
+            ++m_report.unused_textures;
+        }
+    }
+    for (const uint64_t size : m_block_sizes)
+    {
+        m_report.aliased_bytes += size;
+    }
+}
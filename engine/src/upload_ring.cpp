@@ -0,0 +1,40 @@
+#include "upload_ring.hpp"
+
+uint64_t UploadRing::Allocate(const uint64_t size, const uint64_t alignment)
+{
+    assert(std::has_single_bit(alignment) && "Alignment must be a power of two");
+    if (m_capacity == 0 || size > m_capacity) return NONE;
+    if (m_head == m_tail)
+    {
+        // Nothing is in use, start over at the beginning so a large allocation doesn't have to skip the tail.
+        m_head = m_tail = (m_head + m_capacity - 1) / m_capacity * m_capacity;
+    }
+
+    const uint64_t offset = m_head % m_capacity;
+    uint64_t padding = (alignment - offset % alignment) % alignment;
+    if (offset + padding + size > m_capacity)
+    {
+        // Wrapping to the start, which is aligned for every alignment.
+        padding = m_capacity - offset;
+    }
+    if (m_head + padding + size - m_tail > m_capacity) return NONE;
+
+    m_head += padding + size;
+    return (m_head - size) % m_capacity;
+}
+
+void UploadRing::EndFrame(const uint64_t fence_value)
+{
+    assert((m_frames.empty() || fence_value > m_frames.back().fence_value) && "Fence values must increase");
+    m_frames.push_back({ .end = m_head, .fence_value = fence_value });
+}
+
+void UploadRing::Recycle(const uint64_t completed_value)
+{
+    while (!m_frames.empty() && m_frames.front().fence_value <= completed_value)
+    {
+        // Frames closed before the ring restarted at its beginning end behind the tail.
+        m_tail = std::max(m_tail, m_frames.front().end);
+        m_frames.pop_front();
+    }
+}
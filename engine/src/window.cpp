@@ -1,32 +1,55 @@
 #include "window.hpp"
 
-Window::Window()
+Window::Window(const glm::uvec2 size, const bool headless) : m_headless_size(size)
 {
+    if (headless) return;
+
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
-    m_window = glfwCreateWindow(1280, 720, "Window", nullptr, nullptr);
+    m_window = glfwCreateWindow(static_cast<int>(size.x), static_cast<int>(size.y), "Window", nullptr, nullptr);
 }
 
 Window::~Window()
 {
+    if (!m_window) return;
+
     glfwDestroyWindow(m_window);
     glfwTerminate();
 }
 
-bool Window::IsRunning() const { return !glfwWindowShouldClose(m_window); }
+bool Window::IsRunning() const { return m_window ? !glfwWindowShouldClose(m_window) : !m_close_requested; }
+
+void Window::Close()
+{
+    m_close_requested = true;
+    if (m_window)
+    {
+        glfwSetWindowShouldClose(m_window, GLFW_TRUE);
+    }
+}
 
-void Window::PollEvents() const { glfwPollEvents(); }
+void Window::PollEvents() const
+{
+    if (!m_window) return;
+    glfwPollEvents();
+}
 
 void* Window::GetNativeWindow() const
 {
-    return glfwGetWin32Window(m_window);
+#ifdef _WIN32
+    return m_window ? glfwGetWin32Window(m_window) : nullptr;
+#else
+    return nullptr;
+#endif
 }
 
 GLFWwindow* Window::GetHandle() const { return m_window; }
 
 glm::uvec2 Window::GetSize() const
 {
+    if (!m_window) return m_headless_size;
+
     int width = 0, height = 0;
     glfwGetWindowSize(m_window, &width, &height);
     return {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
@@ -34,6 +57,7 @@ glm::uvec2 Window::GetSize() const
 
 void Window::LockMouse(const bool toggle)
 {
+    if (!m_window) return;
     m_is_locked = toggle;
     if (toggle)
     {
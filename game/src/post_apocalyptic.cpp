@@ -13,7 +13,6 @@ PostApocalyptic::PostApocalyptic(Engine *engine) : m_engine(engine)
     dir_light.SetDirectionEuler(glm::vec3(-20.0f, 135.0f, 0.0f));
     m_engine->GetRenderer().AddDirectionalLight(dir_light);
     m_engine->GetResources().LoadModel("assets/cathedral/cathedral.gltf", glm::vec3(0), glm::vec3(1.f));
-    m_engine->GetRenderer().GenerateStaticShadowMap();
 }
 
 void PostApocalyptic::Update(float dt)
@@ -21,10 +20,25 @@ void PostApocalyptic::Update(float dt)
 
 }
 
-int main()
+// Pass --headless [frames] to run the frame loop without a window or GPU, e.g. to profile CPU frame cost,
+// and --workers <count> to size the job system when comparing how that cost scales with cores.
+int main(const int argc, char** argv)
 {
-    Engine engine;
+    EngineCreateInfo create_info{};
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const bool has_value = i + 1 < argc && argv[i + 1][0] >= '0' && argv[i + 1][0] <= '9';
+        if (arg == "--headless")
+        {
+            create_info.headless = true;
+            create_info.max_frames = has_value ? static_cast<uint32_t>(std::stoul(argv[++i])) : 1000;
+        }
+        else if (arg == "--workers" && has_value)
+        {
+            create_info.worker_count = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+    }
+    Engine engine(create_info);
     engine.Run<PostApocalyptic>();
 }
-
-
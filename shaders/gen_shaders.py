@@ -12,6 +12,9 @@ SLANG_BINARY = (
 
 ROOT_DIR = Path(__file__).parent
 OUT_FILE = Path(__file__).parent.parent / "engine" / "inc" / "shader_data.hpp"
+# Limits the C++ side owns, passed to every shader as defines so the two can never disagree.
+SHARED_CONSTANTS_FILE = Path(__file__).parent.parent / "engine" / "inc" / "resources.hpp"
+SHARED_CONSTANTS = ["MESHLET_MAX_VERTICES", "MESHLET_MAX_TRIANGLES"]
 
 SLANG_TARGET = "dxil"
 
@@ -50,7 +53,17 @@ def detect_shader_stages(shader_path: Path) -> list[tuple[str, str]]:
 
     return stages
 
-def compile_to_dxil(shader_path: Path, entry_point: str, stage: str) -> bytes:
+def read_shared_constants() -> list[str]:
+    text = SHARED_CONSTANTS_FILE.read_text(encoding="utf-8")
+    defines = []
+    for name in SHARED_CONSTANTS:
+        match = re.search(rf"constexpr\s+\w+\s+{name}\s*=\s*(\d+)", text)
+        if not match:
+            raise RuntimeError(f"{name} not found in {SHARED_CONSTANTS_FILE}")
+        defines.append(f"-D{name}={match.group(1)}")
+    return defines
+
+def compile_to_dxil(shader_path: Path, entry_point: str, stage: str, defines: list[str]) -> bytes:
     profile = f"{stage}_6_6"
     dxil_path = shader_path.with_suffix(f".{entry_point}.dxil.tmp")
 
@@ -63,6 +76,7 @@ def compile_to_dxil(shader_path: Path, entry_point: str, stage: str) -> bytes:
         "-g",
         "-O0",
         "-o", str(dxil_path),
+        *defines,
     ]
 
     print(f"Compiling: {shader_path} [{entry_point} - {stage}]")
@@ -74,6 +88,7 @@ def compile_to_dxil(shader_path: Path, entry_point: str, stage: str) -> bytes:
 
 def main():
     arrays = []
+    defines = read_shared_constants()
 
     for file in ROOT_DIR.rglob("*"):
         if not file.is_file():
@@ -92,7 +107,7 @@ def main():
 
         for entry_point, stage in stages:
             try:
-                bytecode = compile_to_dxil(file, entry_point, stage)
+                bytecode = compile_to_dxil(file, entry_point, stage, defines)
             except subprocess.CalledProcessError as e:
                 print(f"Failed: {file} [{entry_point}]: {e}")
                 continue
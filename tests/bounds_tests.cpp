@@ -0,0 +1,152 @@
+#include "camera.hpp"
+#include "test.hpp"
+
+namespace
+{
+    std::vector<glm::vec3> RandomPoints(std::mt19937& rng, const uint32_t count)
+    {
+        std::uniform_real_distribution<float> coordinate(-10.f, 10.f);
+        std::vector<glm::vec3> points(count);
+        for (auto& point : points)
+        {
+            point = { coordinate(rng), coordinate(rng), coordinate(rng) };
+        }
+        return points;
+    }
+
+    glm::mat4 RandomTransform(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        std::uniform_real_distribution<float> scale(0.1f, 4.f);
+        glm::mat4 transform = glm::translate(glm::mat4(1.f), glm::vec3(unit(rng), unit(rng), unit(rng)) * 50.f);
+        transform = glm::rotate(transform, unit(rng) * glm::pi<float>(), glm::vec3(unit(rng), unit(rng), 1.f));
+        return glm::scale(transform, glm::vec3(scale(rng), scale(rng), scale(rng)));
+    }
+
+    bool Contains(const BoundingBox& box, const glm::vec3& point, const float epsilon = 1e-3f)
+    {
+        return point.x >= box.min.x - epsilon && point.y >= box.min.y - epsilon && point.z >= box.min.z - epsilon &&
+               point.x <= box.max.x + epsilon && point.y <= box.max.y + epsilon && point.z <= box.max.z + epsilon;
+    }
+
+    bool Contains(const BoundingSphere& sphere, const glm::vec3& point, const float epsilon = 1e-3f)
+    {
+        return glm::length(point - sphere.center) <= sphere.radius + epsilon;
+    }
+
+    Frustum CreateTestFrustum()
+    {
+        // Looking down -z from the origin.
+        const glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+        const glm::mat4 proj = glm::perspective(glm::radians(90.f), 1.f, 0.1f, 100.f);
+        return Camera::CreateFrustum(proj * view);
+    }
+} // namespace
+
+TEST(Bounds, FromPointsContainsEveryPoint)
+{
+    std::mt19937 rng(1);
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        const auto points = RandomPoints(rng, 1 + i);
+        const Bounds bounds = Bounds::FromPoints(points);
+        CHECK(bounds.box.IsValid());
+        for (const auto& point : points)
+        {
+            CHECK(Contains(bounds.box, point, 0.f));
+            CHECK(Contains(bounds.sphere, point));
+        }
+        // The sphere is centered on the box, so it never needs more than the half diagonal.
+        CHECK(bounds.sphere.radius <= glm::length(bounds.box.GetExtents()) + 1e-3f);
+    }
+}
+
+TEST(Bounds, EmptyPointsGiveInvalidBounds)
+{
+    const Bounds bounds = Bounds::FromPoints({});
+    CHECK(!bounds.box.IsValid());
+    CHECK(bounds.sphere.radius == 0.f);
+    CHECK(!bounds.Transform(glm::mat4(1.f)).box.IsValid());
+}
+
+TEST(Bounds, TransformContainsTransformedPoints)
+{
+    std::mt19937 rng(2);
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        const auto points = RandomPoints(rng, 16);
+        const glm::mat4 transform = RandomTransform(rng);
+        const Bounds world = Bounds::FromPoints(points).Transform(transform);
+        for (const auto& point : points)
+        {
+            const glm::vec3 world_point = transform * glm::vec4(point, 1.f);
+            CHECK(Contains(world.box, world_point));
+            CHECK(Contains(world.sphere, world_point));
+        }
+    }
+}
+
+TEST(Bounds, IdentityTransformKeepsBox)
+{
+    const BoundingBox box{ .min = glm::vec3(-1.f, 2.f, -3.f), .max = glm::vec3(4.f, 5.f, 6.f) };
+    const BoundingBox same = box.Transform(glm::mat4(1.f));
+    CHECK(same.min == box.min);
+    CHECK(same.max == box.max);
+}
+
+TEST(Bounds, MergeContainsBoth)
+{
+    std::mt19937 rng(3);
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        const auto a_points = RandomPoints(rng, 8);
+        auto b_points = RandomPoints(rng, 8);
+        for (auto& point : b_points)
+        {
+            point = point * 0.1f + glm::vec3(static_cast<float>(i), 0.f, 0.f);
+        }
+        const Bounds a = Bounds::FromPoints(a_points);
+        const Bounds b = Bounds::FromPoints(b_points);
+        const Bounds merged = Bounds::Merge(a, b);
+        for (const auto* source : { &a, &b })
+        {
+            CHECK(Contains(merged.box, source->box.min, 0.f));
+            CHECK(Contains(merged.box, source->box.max, 0.f));
+            CHECK(glm::length(source->sphere.center - merged.sphere.center) + source->sphere.radius <=
+                  merged.sphere.radius + 1e-3f);
+        }
+    }
+}
+
+TEST(Bounds, MergeWithInvalidKeepsOther)
+{
+    const Bounds valid = Bounds::FromPoints(std::array{ glm::vec3(1.f), glm::vec3(2.f) });
+    const Bounds merged = Bounds::Merge(Bounds{}, valid);
+    CHECK(merged.box.min == valid.box.min);
+    CHECK(merged.box.max == valid.box.max);
+    CHECK(Bounds::Merge(valid, Bounds{}).sphere.radius == valid.sphere.radius);
+}
+
+TEST(Bounds, FrustumAcceptsInsideAndRejectsOutside)
+{
+    const Frustum frustum = CreateTestFrustum();
+    const auto at = [](const glm::vec3& center, const float size)
+    { return Bounds::FromPoints(std::array{ center - glm::vec3(size), center + glm::vec3(size) }); };
+
+    CHECK(frustum.Intersects(at({ 0.f, 0.f, -10.f }, 1.f)));
+    // Straddling the near plane and the left plane still counts.
+    CHECK(frustum.Intersects(at({ 0.f, 0.f, 0.f }, 1.f)));
+    CHECK(frustum.Intersects(at({ -10.f, 0.f, -9.f }, 1.5f)));
+    // Behind the camera, past the far plane and well outside the 90 degree cone.
+    CHECK(!frustum.Intersects(at({ 0.f, 0.f, 10.f }, 1.f)));
+    CHECK(!frustum.Intersects(at({ 0.f, 0.f, -200.f }, 1.f)));
+    CHECK(!frustum.Intersects(at({ 30.f, 0.f, -10.f }, 1.f)));
+    CHECK(!frustum.Intersects(at({ 0.f, -30.f, -10.f }, 1.f)));
+}
+
+TEST(Bounds, FrustumRejectsInvalidBox)
+{
+    const Frustum frustum = CreateTestFrustum();
+    CHECK(!frustum.Intersects(BoundingBox{}));
+    CHECK(!frustum.Intersects(Bounds{}));
+}
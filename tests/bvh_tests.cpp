@@ -0,0 +1,298 @@
+#include "bvh.hpp"
+#include "test.hpp"
+
+namespace
+{
+    std::vector<Bounds> RandomBounds(std::mt19937& rng, const uint32_t count)
+    {
+        std::uniform_real_distribution<float> position(-100.f, 100.f);
+        std::uniform_real_distribution<float> size(0.1f, 6.f);
+        std::vector<Bounds> bounds(count);
+        for (auto& object : bounds)
+        {
+            const glm::vec3 center(position(rng), position(rng), position(rng));
+            const glm::vec3 extents(size(rng), size(rng), size(rng));
+            object = Bounds::FromPoints(std::array{ center - extents, center + extents });
+        }
+        return bounds;
+    }
+
+    Bounds Cube(const glm::vec3& center, const float extent)
+    {
+        return Bounds::FromPoints(std::array{ center - glm::vec3(extent), center + glm::vec3(extent) });
+    }
+
+    bool Overlaps(const BoundingBox& a, const BoundingBox& b)
+    {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y &&
+               a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+
+    std::vector<uint32_t> Sorted(std::vector<uint32_t> indices)
+    {
+        std::ranges::sort(indices);
+        return indices;
+    }
+
+    // Every query shape against brute force, the tree must neither lose nor invent objects.
+    void CheckQueries(const Bvh& bvh, std::span<const Bounds> bounds, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> position(-100.f, 100.f);
+        for (uint32_t query = 0; query < 16; ++query)
+        {
+            const glm::vec3 center(position(rng), position(rng), position(rng));
+            const BoundingBox box = Cube(center, 20.f).box;
+            std::vector<uint32_t> expected;
+            for (uint32_t i = 0; i < bounds.size(); ++i)
+            {
+                if (Overlaps(box, bounds[i].box)) expected.push_back(i);
+            }
+            std::vector<uint32_t> found;
+            bvh.QueryBox(box, found);
+            CHECK(Sorted(found) == expected);
+
+            const BoundingSphere sphere{ .center = center, .radius = 25.f };
+            expected.clear();
+            for (uint32_t i = 0; i < bounds.size(); ++i)
+            {
+                const glm::vec3 offset = center - glm::clamp(center, bounds[i].box.min, bounds[i].box.max);
+                if (glm::dot(offset, offset) <= sphere.radius * sphere.radius) expected.push_back(i);
+            }
+            found.clear();
+            bvh.QuerySphere(sphere, found);
+            CHECK(Sorted(found) == expected);
+
+            const glm::mat4 view = glm::lookAt(center, glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+            const Frustum frustum = Camera::CreateFrustum(glm::perspective(glm::radians(70.f), 1.f, 0.1f, 120.f) * view);
+            found.clear();
+            bvh.QueryFrustum(frustum, found);
+            found = Sorted(found);
+            CHECK(std::ranges::adjacent_find(found) == found.end());
+            for (uint32_t i = 0; i < bounds.size(); ++i)
+            {
+                // Grown and shrunk by a little so boxes touching a plane may go either way.
+                const bool reported = std::ranges::binary_search(found, i);
+                BoundingBox grown = bounds[i].box;
+                grown.min -= glm::vec3(1e-3f);
+                grown.max += glm::vec3(1e-3f);
+                BoundingBox shrunk = bounds[i].box;
+                shrunk.min += glm::vec3(1e-3f);
+                shrunk.max -= glm::vec3(1e-3f);
+                if (!frustum.Intersects(grown)) CHECK(!reported);
+                if (frustum.Intersects(shrunk)) CHECK(reported);
+            }
+        }
+    }
+} // namespace
+
+TEST(Bvh, QueriesMatchBruteForce)
+{
+    std::mt19937 rng(1);
+    for (const uint32_t count : { 1u, 8u, 9u, 500u, 5000u })
+    {
+        const auto bounds = RandomBounds(rng, count);
+        Bvh bvh;
+        bvh.Build(bounds);
+        CHECK(bvh.GetCount() == count);
+        CheckQueries(bvh, bounds, rng);
+    }
+}
+
+TEST(Bvh, InsertMatchesBuild)
+{
+    std::mt19937 rng(2);
+    auto bounds = RandomBounds(rng, 3000);
+    Bvh bvh;
+    // Uneven batches, including a single object, the way models are added one after another.
+    uint32_t inserted = 0;
+    for (const uint32_t batch : { 1000u, 1u, 7u, 992u, 1000u })
+    {
+        bvh.Insert(std::span(bounds).subspan(inserted, batch));
+        inserted += batch;
+        CHECK(bvh.GetCount() == inserted);
+        CheckQueries(bvh, std::span(bounds).first(inserted), rng);
+    }
+
+    // Updates queued before an insert are still applied by the next refit.
+    bounds[3] = Cube(glm::vec3(500.f), 1.f);
+    bvh.Update(3, bounds[3]);
+    bounds.push_back(Cube(glm::vec3(-500.f), 1.f));
+    bvh.Insert(std::span(bounds).last(1));
+    bvh.Refit();
+    CHECK(bvh.GetBounds().max.x >= 501.f);
+    CHECK(bvh.GetBounds().min.x <= -501.f);
+    CheckQueries(bvh, bounds, rng);
+}
+
+TEST(Bvh, RefitFollowsUpdates)
+{
+    std::mt19937 rng(3);
+    auto bounds = RandomBounds(rng, 2000);
+    Bvh bvh;
+    bvh.Build(bounds);
+    std::uniform_real_distribution<float> offset(-30.f, 30.f);
+    for (uint32_t frame = 0; frame < 8; ++frame)
+    {
+        for (uint32_t i = frame; i < bounds.size(); i += 5)
+        {
+            bounds[i] = bounds[i].Transform(glm::translate(glm::mat4(1.f), glm::vec3(offset(rng), 0.f, offset(rng))));
+            bvh.Update(i, bounds[i]);
+        }
+        bvh.Refit();
+        CheckQueries(bvh, bounds, rng);
+    }
+}
+
+TEST(Bvh, RaycastFindsNearestBox)
+{
+    std::mt19937 rng(4);
+    const auto bounds = RandomBounds(rng, 2000);
+    Bvh bvh;
+    bvh.Build(bounds);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        // Starting outside the scene, so no box contains the origin.
+        const Ray ray{ .origin = glm::vec3(unit(rng), unit(rng), 1.f) * glm::vec3(50.f, 50.f, 200.f),
+                       .direction = glm::vec3(unit(rng) * 0.2f, unit(rng) * 0.2f, -1.f) };
+        std::optional<float> expected;
+        for (const auto& object : bounds)
+        {
+            const glm::vec3 t0 = (object.box.min - ray.origin) / ray.direction;
+            const glm::vec3 t1 = (object.box.max - ray.origin) / ray.direction;
+            const glm::vec3 near = glm::min(t0, t1);
+            const glm::vec3 far = glm::max(t0, t1);
+            const float enter = std::max({ near.x, near.y, near.z, 0.f });
+            const float exit = std::min({ far.x, far.y, far.z });
+            if (enter <= exit && (!expected || enter < *expected)) expected = enter;
+        }
+        const auto hit = bvh.Raycast(ray);
+        CHECK(hit.has_value() == expected.has_value());
+        if (hit && expected) CHECK_NEAR(hit->distance, *expected, 1e-3f);
+    }
+}
+
+TEST(Bvh, RaycastAlongAxes)
+{
+    // Zero direction components with the origin on the lower slab planes used to turn into NaN and miss.
+    const std::vector bounds = { Cube(glm::vec3(0.f, 0.f, -10.f), 1.f), Cube(glm::vec3(10.f, 1.f, 0.f), 1.f) };
+    Bvh bvh;
+    bvh.Build(bounds);
+
+    const auto forward = bvh.Raycast({ .origin = glm::vec3(-1.f, -1.f, 0.f), .direction = glm::vec3(0.f, 0.f, -1.f) });
+    CHECK(forward && forward->index == 0);
+    if (forward) CHECK_NEAR(forward->distance, 9.f, 1e-4f);
+
+    const auto side = bvh.Raycast({ .origin = glm::vec3(0.f, 0.f, -1.f), .direction = glm::vec3(1.f, 0.f, 0.f) });
+    CHECK(side && side->index == 1);
+    if (side) CHECK_NEAR(side->distance, 9.f, 1e-4f);
+
+    CHECK(!bvh.Raycast({ .origin = glm::vec3(0.f, 5.f, 0.f), .direction = glm::vec3(0.f, 1.f, 0.f) }));
+}
+
+TEST(Bvh, RaycastSkipsBoxAroundOrigin)
+{
+    // A camera inside a large hall must pick what is in front of it, not the hall.
+    const std::vector bounds = { Cube(glm::vec3(0.f), 50.f), Cube(glm::vec3(0.f, 0.f, -10.f), 1.f) };
+    Bvh bvh;
+    bvh.Build(bounds);
+    const Ray ray{ .origin = glm::vec3(0.f), .direction = glm::vec3(0.f, 0.f, -1.f) };
+    const auto hit = bvh.Raycast(ray);
+    CHECK(hit && hit->index == 1);
+
+    CHECK(!bvh.Raycast({ .origin = glm::vec3(0.f), .direction = glm::vec3(0.f, 0.f, 1.f) }));
+}
+
+TEST(Bvh, RaycastUsesIntersector)
+{
+    // Two overlapping boxes, only the farther one has a surface where the ray passes.
+    const std::vector bounds = { Cube(glm::vec3(0.f, 0.f, -10.f), 3.f), Cube(glm::vec3(0.f, 0.f, -12.f), 3.f) };
+    Bvh bvh;
+    bvh.Build(bounds);
+    std::vector<uint32_t> tested;
+    auto Intersect = [&](const uint32_t index, const Ray& ray, const float max_distance) -> std::optional<float>
+    {
+        tested.push_back(index);
+        if (index == 0) return std::nullopt;
+        const float z = -12.f;
+        const auto distance = ray.Intersect(glm::vec3(-3.f, -3.f, z), glm::vec3(3.f, -3.f, z), glm::vec3(0.f, 3.f, z));
+        if (!distance || *distance > max_distance) return std::nullopt;
+        return distance;
+    };
+    const auto hit =
+        bvh.Raycast({ .origin = glm::vec3(0.f), .direction = glm::vec3(0.f, 0.f, -1.f) }, 100.f, Intersect);
+    CHECK(hit && hit->index == 1);
+    if (hit) CHECK_NEAR(hit->distance, 12.f, 1e-4f);
+    CHECK(tested.size() == 2);
+
+    // Starting inside a box is fine once the surface decides.
+    const auto inside =
+        bvh.Raycast({ .origin = glm::vec3(0.f, 0.f, -10.f), .direction = glm::vec3(0.f, 0.f, -1.f) }, 100.f, Intersect);
+    CHECK(inside && inside->index == 1);
+}
+
+TEST(Bvh, RayTriangle)
+{
+    const glm::vec3 a(-1.f, -1.f, -5.f);
+    const glm::vec3 b(1.f, -1.f, -5.f);
+    const glm::vec3 c(0.f, 1.f, -5.f);
+    const Ray ray{ .origin = glm::vec3(0.f), .direction = glm::vec3(0.f, 0.f, -1.f) };
+    const auto front = ray.Intersect(a, b, c);
+    CHECK(front.has_value());
+    if (front) CHECK_NEAR(*front, 5.f, 1e-5f);
+    // Two sided, winding doesn't matter.
+    CHECK(ray.Intersect(a, c, b).has_value());
+    // Behind the origin and beside the triangle.
+    const Ray behind{ .origin = glm::vec3(0.f, 0.f, -6.f), .direction = ray.direction };
+    CHECK(!behind.Intersect(a, b, c));
+    const Ray beside{ .origin = glm::vec3(2.f, 0.f, 0.f), .direction = ray.direction };
+    CHECK(!beside.Intersect(a, b, c));
+    // Parallel to the plane.
+    const Ray parallel{ .origin = glm::vec3(0.f, 0.f, -5.f), .direction = glm::vec3(1.f, 0.f, 0.f) };
+    CHECK(!parallel.Intersect(a, b, c));
+    // Distances are in units of the direction, a scaled direction halves them.
+    const Ray scaled_ray{ .origin = glm::vec3(0.f), .direction = glm::vec3(0.f, 0.f, -2.f) };
+    const auto scaled = scaled_ray.Intersect(a, b, c);
+    CHECK(scaled.has_value());
+    if (scaled) CHECK_NEAR(*scaled, 2.5f, 1e-5f);
+}
+
+TEST(Bvh, EmptyBoundsAreNeverReported)
+{
+    // Removed objects keep their slot with empty bounds, a query covering their whole node must still skip them.
+    std::vector<Bounds> bounds;
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        bounds.push_back(Cube(glm::vec3(static_cast<float>(i) * 3.f, 0.f, -20.f), 1.f));
+    }
+    Bvh bvh;
+    bvh.Build(bounds);
+    for (const uint32_t removed : { 0u, 5u, 31u })
+    {
+        bvh.Update(removed, Bounds{});
+    }
+    bvh.Refit();
+
+    const Frustum everything = Camera::CreateFrustum(glm::orthoRH_ZO(-10.f, 110.f, -10.f, 10.f, 0.f, 100.f));
+    std::vector<uint32_t> visible;
+    bvh.QueryFrustum(everything, visible);
+    CHECK(visible.size() == 29);
+    std::vector<uint32_t> overlapping;
+    bvh.QueryBox(Cube(glm::vec3(0.f), 1000.f).box, overlapping);
+    CHECK(overlapping.size() == 29);
+    for (const uint32_t removed : { 0u, 5u, 31u })
+    {
+        CHECK(std::ranges::find(visible, removed) == visible.end());
+        CHECK(std::ranges::find(overlapping, removed) == overlapping.end());
+    }
+    // Straight through where object 0 was.
+    const auto hit = bvh.Raycast({ .origin = glm::vec3(0.f, 0.f, 0.f), .direction = glm::vec3(0.f, 0.f, -1.f) });
+    CHECK(!hit);
+
+    // Back in place, it is found again.
+    bvh.Update(5, bounds[5]);
+    bvh.Refit();
+    visible.clear();
+    bvh.QueryFrustum(everything, visible);
+    CHECK(visible.size() == 30);
+}
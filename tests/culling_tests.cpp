@@ -0,0 +1,135 @@
+#include "culling.hpp"
+#include "test.hpp"
+
+namespace
+{
+    std::vector<Bounds> RandomBounds(std::mt19937& rng, const uint32_t count)
+    {
+        std::uniform_real_distribution<float> position(-120.f, 120.f);
+        std::uniform_real_distribution<float> size(0.1f, 8.f);
+        std::vector<Bounds> bounds(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            // Every 17th object has nothing to draw and must never be reported visible.
+            if (i % 17 == 16) continue;
+
+            const glm::vec3 center(position(rng), position(rng), position(rng));
+            const glm::vec3 extents(size(rng), size(rng), size(rng));
+            bounds[i] = Bounds::FromPoints(std::array{ center - extents, center + extents });
+        }
+        return bounds;
+    }
+
+    Frustum RandomFrustum(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> unit(-1.f, 1.f);
+        const glm::vec3 eye = glm::vec3(unit(rng), unit(rng), unit(rng)) * 30.f;
+        const glm::vec3 target = eye + glm::vec3(unit(rng), unit(rng) * 0.5f, unit(rng));
+        const glm::mat4 view = glm::lookAt(eye, target, glm::vec3(0.f, 1.f, 0.f));
+        const glm::mat4 proj = glm::perspective(glm::radians(60.f + 30.f * unit(rng)), 16.f / 9.f, 0.1f, 150.f);
+        return Camera::CreateFrustum(proj * view);
+    }
+
+    // Within rounding of a plane the SIMD paths may fuse multiplies and land on the other side, that is not a bug.
+    bool IsBorderline(const Frustum& frustum, const Bounds& bounds)
+    {
+        for (const auto& plane : frustum.planes)
+        {
+            const glm::vec3 normal(plane);
+            const float sphere = glm::dot(normal, bounds.sphere.center) + plane.w + bounds.sphere.radius;
+            const float box = glm::dot(normal, bounds.box.GetCenter()) + plane.w +
+                              glm::dot(bounds.box.GetExtents(), glm::abs(normal));
+            if (std::abs(sphere) < 1e-3f || std::abs(box) < 1e-3f) return true;
+        }
+        return false;
+    }
+
+    void CheckMatchesFrustum(const Frustum& frustum,
+                             std::span<const Bounds> bounds,
+                             const uint32_t first,
+                             const std::vector<uint32_t>& visible)
+    {
+        size_t next = 0;
+        for (uint32_t i = first; i < first + bounds.size(); ++i)
+        {
+            const bool reported = next < visible.size() && visible[next] == i;
+            next += reported;
+            if (reported != frustum.Intersects(bounds[i - first]))
+            {
+                CHECK(IsBorderline(frustum, bounds[i - first]));
+            }
+        }
+        // Every index was consumed in order, so the list is ascending and has nothing outside the range.
+        CHECK(next == visible.size());
+    }
+} // namespace
+
+TEST(Culling, SimdMatchesCameraFrustum)
+{
+    std::mt19937 rng(1);
+    for (const uint32_t count : { 0u, 1u, 7u, 8u, 9u, 1000u, 4099u })
+    {
+        const auto bounds = RandomBounds(rng, count);
+        FrustumCuller culler;
+        culler.Resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            culler.SetBounds(i, bounds[i]);
+        }
+        for (uint32_t f = 0; f < 8; ++f)
+        {
+            const Frustum frustum = RandomFrustum(rng);
+            std::vector<uint32_t> visible;
+            culler.Cull(frustum, visible);
+            CheckMatchesFrustum(frustum, bounds, 0, visible);
+
+            std::vector<uint32_t> scalar;
+            culler.CullScalar(frustum, scalar);
+            CheckMatchesFrustum(frustum, bounds, 0, scalar);
+        }
+    }
+}
+
+TEST(Culling, SubrangesAppendInOrder)
+{
+    std::mt19937 rng(2);
+    const auto bounds = RandomBounds(rng, 1000);
+    FrustumCuller culler;
+    culler.Resize(1000);
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        culler.SetBounds(i, bounds[i]);
+    }
+    const Frustum frustum = RandomFrustum(rng);
+
+    // Odd starts and lengths exercise the unaligned loads and the masked tail of every batch.
+    std::vector<uint32_t> visible = { 12345 };
+    culler.Cull(frustum, 3, 500, visible);
+    CHECK(visible.front() == 12345);
+    CheckMatchesFrustum(frustum, std::span(bounds).subspan(3, 500), 3, std::vector(visible.begin() + 1, visible.end()));
+
+    std::vector<uint32_t> tail;
+    culler.Cull(frustum, 995, 5, tail);
+    CheckMatchesFrustum(frustum, std::span(bounds).subspan(995, 5), 995, tail);
+}
+
+TEST(Culling, EverythingInsideIsKept)
+{
+    const Frustum frustum = Camera::CreateFrustum(glm::perspective(glm::radians(90.f), 1.f, 0.1f, 100.f));
+    FrustumCuller culler;
+    culler.Resize(37);
+    for (uint32_t i = 0; i < 37; ++i)
+    {
+        const glm::vec3 center(0.f, 0.f, -5.f - static_cast<float>(i));
+        culler.SetBounds(i, Bounds::FromPoints(std::array{ center - glm::vec3(0.5f), center + glm::vec3(0.5f) }));
+    }
+    std::vector<uint32_t> visible;
+    culler.Cull(frustum, visible);
+    CHECK(visible.size() == 37);
+
+    culler.SetBounds(20, Bounds{});
+    visible.clear();
+    culler.Cull(frustum, visible);
+    CHECK(visible.size() == 36);
+    CHECK(std::ranges::find(visible, 20u) == visible.end());
+}
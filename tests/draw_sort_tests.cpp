@@ -0,0 +1,140 @@
+#include "draw_sort.hpp"
+#include "test.hpp"
+
+namespace
+{
+    // Radix sort output against std::stable_sort, indices included, so stability is checked along with order.
+    bool MatchesStableSort(DrawSorter& sorter, std::vector<DrawSortItem> items)
+    {
+        auto expected = items;
+        std::ranges::stable_sort(expected, {}, &DrawSortItem::key);
+        sorter.Sort(items);
+        return std::ranges::equal(items,
+                                  expected,
+                                  [](const DrawSortItem& a, const DrawSortItem& b)
+                                  { return a.key == b.key && a.index == b.index; });
+    }
+} // namespace
+
+TEST(DrawSort, MatchesStableSort)
+{
+    std::mt19937_64 rng(3);
+    DrawSorter sorter;
+    for (const uint32_t count : { 0u, 1u, 2u, 255u, 256u, 257u, 10'000u })
+    {
+        // Full width keys, and keys from few distinct values so ties are everywhere.
+        std::vector<DrawSortItem> random(count);
+        std::vector<DrawSortItem> ties(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            random[i] = { .key = rng(), .index = i };
+            ties[i] = { .key = rng() % 8 << 40 | rng() % 4, .index = i };
+        }
+        CHECK(MatchesStableSort(sorter, random));
+        CHECK(MatchesStableSort(sorter, ties));
+    }
+}
+
+TEST(DrawSort, SharedDigitsAreSkipped)
+{
+    // Every key has the same upper six bytes, and then all identical keys, both have to come out sorted and stable.
+    DrawSorter sorter;
+    std::mt19937 rng(4);
+    std::vector<DrawSortItem> items(1000);
+    for (uint32_t i = 0; i < items.size(); ++i)
+    {
+        items[i] = { .key = 0xABCD'1234'5678'0000ull | rng() % 0x10000, .index = i };
+    }
+    CHECK(MatchesStableSort(sorter, items));
+    for (auto& item : items)
+    {
+        item.key = 42;
+    }
+    CHECK(MatchesStableSort(sorter, items));
+}
+
+TEST(DrawSort, KeysOrderByPassPipelineThenMode)
+{
+    using enum DrawOrder;
+    // The pass and the pipeline outrank everything after them.
+    CHECK(DrawSorter::CreateKey(eMaterial, DrawPass::eDepthPrepass, 255, 65535, 1e9f) <
+          DrawSorter::CreateKey(eMaterial, DrawPass::eGeometry, 0, 0, 0.f));
+    CHECK(DrawSorter::CreateKey(eFrontToBack, DrawPass::eShadow, 1, 0, 0.f) >
+          DrawSorter::CreateKey(eFrontToBack, DrawPass::eShadow, 0, 65535, 1e9f));
+
+    // Front to back orders by depth before material, material order the other way around.
+    CHECK(DrawSorter::CreateKey(eFrontToBack, DrawPass::eGeometry, 0, 9, 1.f) <
+          DrawSorter::CreateKey(eFrontToBack, DrawPass::eGeometry, 0, 1, 2.f));
+    CHECK(DrawSorter::CreateKey(eMaterial, DrawPass::eGeometry, 0, 1, 2.f) <
+          DrawSorter::CreateKey(eMaterial, DrawPass::eGeometry, 0, 9, 1.f));
+    CHECK(DrawSorter::CreateKey(eMaterial, DrawPass::eGeometry, 0, 5, 1.f) <
+          DrawSorter::CreateKey(eMaterial, DrawPass::eGeometry, 0, 5, 1.5f));
+
+    // Float bits sort like the values for every positive depth, negative depths land at the camera.
+    float previous = 0.f;
+    for (const float depth : { 1e-30f, 1e-3f, 0.5f, 1.f, 1.0001f, 100.f, 1e20f })
+    {
+        CHECK(DrawSorter::CreateKey(eFrontToBack, DrawPass::eGeometry, 0, 0, previous) <
+              DrawSorter::CreateKey(eFrontToBack, DrawPass::eGeometry, 0, 0, depth));
+        previous = depth;
+    }
+    CHECK(DrawSorter::CreateKey(eFrontToBack, DrawPass::eGeometry, 0, 0, -5.f) ==
+          DrawSorter::CreateKey(eFrontToBack, DrawPass::eGeometry, 0, 0, 0.f));
+}
+
+TEST(DrawSort, StreamIsTheSameOnEveryPoolSize)
+{
+    struct Packet
+    {
+        uint32_t index;
+        uint32_t meshlet_count;
+    };
+
+    // Keys with many ties, so any difference in how chunks were split or joined would reorder equal keys.
+    constexpr uint32_t count = 5000;
+    std::mt19937 rng(4);
+    std::vector<Packet> packets(count);
+    std::vector<uint64_t> keys(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        packets[i] = { .index = i, .meshlet_count = static_cast<uint32_t>(rng() % 4) };
+        keys[i] = rng() % 16;
+    }
+    std::vector<uint32_t> visible;
+    for (uint32_t i = 0; i < count; i += 1 + rng() % 3)
+    {
+        visible.push_back(i);
+    }
+
+    const std::span<const Packet> all(packets);
+    const auto key_of = [&](const uint32_t i) { return keys[i]; };
+    JobSystem caller_only(0);
+    DrawStream<Packet> reference;
+    reference.Build(caller_only, true, visible, all, key_of);
+    bool ordered = true;
+    for (uint32_t i = 1; i < reference.packets.size(); ++i)
+    {
+        const auto& a = reference.packets[i - 1];
+        const auto& b = reference.packets[i];
+        ordered &= std::tie(keys[a.index], a.index) < std::tie(keys[b.index], b.index);
+    }
+    CHECK(ordered);
+    CHECK(std::ranges::none_of(reference.packets, [](const Packet& packet) { return packet.meshlet_count == 0; }));
+    const auto drawn = std::ranges::count_if(visible, [&](const uint32_t i) { return packets[i].meshlet_count != 0; });
+    CHECK(reference.packets.size() == static_cast<size_t>(drawn));
+
+    // Unsorted streams keep the visible order.
+    DrawStream<Packet> unsorted;
+    unsorted.Build(caller_only, false, visible, all, [](uint32_t) { return 0ull; });
+    CHECK(std::ranges::is_sorted(unsorted.packets, {}, &Packet::index));
+
+    bool same = true;
+    for (const uint32_t workers : { 1u, 3u, 7u })
+    {
+        JobSystem jobs(workers);
+        DrawStream<Packet> stream;
+        stream.Build(jobs, true, visible, all, key_of);
+        same &= std::ranges::equal(stream.packets, reference.packets, {}, &Packet::index, &Packet::index);
+    }
+    CHECK(same);
+}
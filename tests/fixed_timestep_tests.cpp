@@ -0,0 +1,120 @@
+#include "fixed_timestep.hpp"
+#include "test.hpp"
+
+namespace
+{
+    // A ball thrown up and bouncing, integrated once per tick. Any dependence on frame times would show up as a
+    // different trajectory for the same number of ticks.
+    struct Ball
+    {
+        float height = 0.f;
+        float velocity = 10.f;
+
+        void Tick(const float dt)
+        {
+            velocity -= 9.81f * dt;
+            height += velocity * dt;
+            if (height < 0.f)
+            {
+                height = -height;
+                velocity = -velocity * 0.8f;
+            }
+        }
+    };
+
+    // Runs the frames through a fresh 30 Hz timestep, returns the ball and the number of ticks run.
+    std::pair<Ball, uint64_t> Simulate(const std::vector<float>& frame_times)
+    {
+        FixedTimestep timestep(30.f);
+        Ball ball;
+        for (const float frame_time : frame_times)
+        {
+            const uint32_t steps = timestep.Advance(frame_time);
+            for (uint32_t i = 0; i < steps; ++i)
+            {
+                ball.Tick(timestep.GetStep());
+            }
+        }
+        return { ball, timestep.GetTickCount() };
+    }
+} // namespace
+
+TEST(FixedTimestep, SimulationIgnoresFramePacing)
+{
+    // Half a tick past ten seconds, at 144 Hz, at 60 Hz and with random frame times adding up to the same
+    // total. Ending half way between ticks keeps float rounding in the frame times from changing the tick count.
+    constexpr double total = 10.0 + 0.5 / 30.0;
+    const std::vector<float> fast(static_cast<size_t>(total * 144.0), 1.f / 144.f);
+    const std::vector<float> slow(static_cast<size_t>(total * 60.0), 1.f / 60.f);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> jitter(0.002f, 0.03f);
+    std::vector<float> jittered;
+    for (double elapsed = 0.0; elapsed < total - 1e-3;)
+    {
+        jittered.push_back(std::min(jitter(rng), static_cast<float>(total - elapsed)));
+        elapsed += jittered.back();
+    }
+
+    const auto [fast_ball, fast_ticks] = Simulate(fast);
+    const auto [slow_ball, slow_ticks] = Simulate(slow);
+    const auto [jittered_ball, jittered_ticks] = Simulate(jittered);
+    const auto [steady_ball, steady_ticks] = Simulate(std::vector<float>(300, 1.f / 30.f + 1e-6f));
+    CHECK(fast_ticks == 300 && slow_ticks == 300 && jittered_ticks == 300 && steady_ticks == 300);
+
+    // Same ticks means bit for bit the same state, whatever the frames looked like.
+    for (const Ball& ball : { slow_ball, jittered_ball, steady_ball })
+    {
+        CHECK(ball.height == fast_ball.height);
+        CHECK(ball.velocity == fast_ball.velocity);
+    }
+}
+
+TEST(FixedTimestep, AlphaIsTheLeftoverFraction)
+{
+    FixedTimestep timestep(30.f);
+    CHECK(timestep.Advance(1.f / 144.f) == 0);
+    CHECK_NEAR(timestep.GetAlpha(), 30.f / 144.f, 1e-5f);
+
+    // Frames of 1/144 s against ticks of 1/30 s, alpha always stays in [0, 1) and ticks come every 4 or 5 frames.
+    uint32_t frames_since_tick = 1;
+    for (uint32_t frame = 0; frame < 1000; ++frame)
+    {
+        const uint32_t steps = timestep.Advance(1.f / 144.f);
+        CHECK(steps <= 1);
+        CHECK(timestep.GetAlpha() >= 0.f && timestep.GetAlpha() < 1.f);
+        ++frames_since_tick;
+        if (steps == 1)
+        {
+            CHECK(frames_since_tick >= 4 && frames_since_tick <= 5);
+            frames_since_tick = 0;
+        }
+    }
+
+    // Changing the rate keeps the same fraction of a tick pending.
+    const float alpha = timestep.GetAlpha();
+    timestep.SetTickRate(120.f);
+    CHECK_NEAR(timestep.GetAlpha(), alpha, 1e-5f);
+    CHECK_NEAR(timestep.GetStep(), 1.f / 120.f, 1e-7f);
+    timestep.SetTickRate(0.f);
+    CHECK(timestep.GetTickRate() == 120.f);
+}
+
+TEST(FixedTimestep, LongFramesAreClamped)
+{
+    FixedTimestep timestep(60.f, 4);
+    // Half a second is 30 ticks, only 4 run and the rest is dropped rather than carried into the next frames.
+    CHECK(timestep.Advance(0.5f) == 4);
+    CHECK(timestep.GetLastSteps() == 4);
+    CHECK_NEAR(timestep.GetDroppedTime(), 26.0 / 60.0, 1e-4);
+    CHECK(timestep.Advance(1.f / 60.f) <= 2);
+
+    // Negative frame times from a clock hiccup are ignored.
+    const uint64_t ticks = timestep.GetTickCount();
+    CHECK(timestep.Advance(-1.f) == 0);
+    CHECK(timestep.GetTickCount() == ticks);
+
+    timestep.Reset();
+    CHECK(timestep.GetTickCount() == 0);
+    CHECK(timestep.GetDroppedTime() == 0.0);
+    CHECK(timestep.GetAlpha() == 0.f);
+}
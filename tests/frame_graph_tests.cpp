@@ -0,0 +1,76 @@
+#include "frame_graph.hpp"
+#include "test.hpp"
+
+namespace
+{
+    // A small post process chain whose optional effect is only read when enabled, recording pass names as it runs.
+    void Declare(FrameGraph& graph, std::vector<std::string_view>& recorded, const bool effect, const uint32_t blurs)
+    {
+        graph.Reset();
+        const uint32_t scene = graph.AddTexture("Scene", 8);
+        const uint32_t effect_target = graph.AddTexture("Effect", 8);
+        const uint32_t target = graph.AddTexture("Target", 4);
+        const auto Record = [&](const std::string_view name) { return [&recorded, name] { recorded.push_back(name); }; };
+        graph.AddPass("Scene", Record("Scene")).Write(scene);
+        graph.AddPass("Effect", Record("Effect")).Read(scene).Write(effect_target);
+        for (uint32_t i = 0; i < blurs; ++i)
+        {
+            graph.AddPass("Blur", Record("Blur")).Modify(effect_target);
+        }
+        graph.AddPass("Resolve", Record("Resolve")).Read(effect ? effect_target : scene).Write(target);
+        graph.AddPass("Present").Read(target).SetOutput();
+    }
+} // namespace
+
+TEST(FrameGraph, ExecuteSkipsCulledPasses)
+{
+    FrameGraph graph;
+    std::vector<std::string_view> recorded;
+    Declare(graph, recorded, true, 2);
+    CHECK(graph.Compile());
+    graph.Execute();
+    const std::vector<std::string_view> all = { "Scene", "Effect", "Blur", "Blur", "Resolve" };
+    CHECK(recorded == all);
+    CHECK(graph.GetStats().culled_passes == 0);
+
+    // Nothing reads the effect, so it and its blurs are culled and never recorded.
+    recorded.clear();
+    Declare(graph, recorded, false, 2);
+    CHECK(graph.Compile());
+    graph.Execute();
+    const std::vector<std::string_view> culled = { "Scene", "Resolve" };
+    CHECK(recorded == culled);
+    CHECK(graph.IsCulled("Effect"));
+    CHECK(graph.IsCulled("Blur"));
+    CHECK(!graph.IsCulled("Resolve"));
+    CHECK(!graph.IsCulled("Missing"));
+    CHECK(graph.GetStats().culled_passes == 3);
+}
+
+TEST(FrameGraph, UnchangedFramesReuseTheSchedule)
+{
+    FrameGraph graph;
+    std::vector<std::string_view> recorded;
+    Declare(graph, recorded, false, 1);
+    CHECK(graph.Compile());
+    for (uint32_t frame = 0; frame < 3; ++frame)
+    {
+        Declare(graph, recorded, false, 1);
+        CHECK(!graph.Compile());
+    }
+    CHECK(graph.GetStats().compiles == 1);
+    CHECK(graph.GetStats().cache_hits == 3);
+
+    // The cached schedule still runs the new frame's record functions.
+    recorded.clear();
+    graph.Execute();
+    const std::vector<std::string_view> expected = { "Scene", "Resolve" };
+    CHECK(recorded == expected);
+
+    // Any change to the passes or what they touch compiles again.
+    Declare(graph, recorded, false, 2);
+    CHECK(graph.Compile());
+    Declare(graph, recorded, true, 2);
+    CHECK(graph.Compile());
+    CHECK(graph.GetStats().compiles == 3);
+}
@@ -0,0 +1,151 @@
+#include "job_system.hpp"
+#include "test.hpp"
+
+TEST(JobSystem, ParallelForCoversEveryIndexOnce)
+{
+    // No workers runs everything inline on the caller, which has to give the same result.
+    for (const uint32_t workers : { 0u, 1u, 4u })
+    {
+        JobSystem jobs(workers);
+        for (const uint32_t batch_size : { 0u, 1u, 7u, 1000u, 5000u })
+        {
+            std::vector<std::atomic<uint32_t>> visits(3001);
+            jobs.ParallelFor(static_cast<uint32_t>(visits.size()),
+                             batch_size,
+                             [&](const uint32_t begin, const uint32_t end)
+                             {
+                                 for (uint32_t i = begin; i < end; ++i)
+                                 {
+                                     visits[i].fetch_add(1, std::memory_order_relaxed);
+                                 }
+                             });
+            CHECK(std::ranges::all_of(visits, [](const auto& count) { return count.load() == 1; }));
+        }
+        bool ran = false;
+        jobs.ParallelFor(0, 16, [&](uint32_t, uint32_t) { ran = true; });
+        CHECK(!ran);
+    }
+}
+
+TEST(JobSystem, NestedJobsAndWaitsFinish)
+{
+    // Every job fans out into more jobs and waits on them from inside the pool, a worker that blocked instead of
+    // running other jobs would deadlock once every worker waits.
+    JobSystem jobs(3);
+    std::atomic<uint32_t> leaves = 0;
+    std::function<void(uint32_t)> Spawn = [&](const uint32_t depth)
+    {
+        if (depth == 0)
+        {
+            leaves.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        JobCounter children;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            jobs.Schedule([&, depth] { Spawn(depth - 1); }, &children);
+        }
+        jobs.Wait(children);
+    };
+    for (uint32_t run = 0; run < 20; ++run)
+    {
+        leaves = 0;
+        Spawn(5);
+        CHECK(leaves.load() == 1024);
+    }
+}
+
+TEST(JobSystem, ContinuationsWaitForTheirDependency)
+{
+    JobSystem jobs(4);
+    for (uint32_t run = 0; run < 200; ++run)
+    {
+        JobCounter first;
+        JobCounter second;
+        JobCounter third;
+        std::atomic<uint32_t> first_done = 0;
+        std::atomic<bool> ordered = true;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            jobs.Schedule([&] { first_done.fetch_add(1, std::memory_order_relaxed); }, &first);
+        }
+        // A chain of three stages, each only starting once the previous one has fully finished.
+        std::atomic<uint32_t> second_done = 0;
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            jobs.ScheduleAfter(first,
+                               [&]
+                               {
+                                   if (first_done.load() != 16) ordered = false;
+                                   second_done.fetch_add(1, std::memory_order_relaxed);
+                               },
+                               &second);
+        }
+        jobs.ScheduleAfter(second,
+                           [&]
+                           {
+                               if (second_done.load() != 8) ordered = false;
+                           },
+                           &third);
+        jobs.Wait(third);
+        CHECK(ordered.load());
+        CHECK(first.IsDone() && second.IsDone());
+
+        // Scheduling after a counter that already finished runs straight away.
+        bool late = false;
+        JobCounter after_done;
+        jobs.ScheduleAfter(first, [&] { late = true; }, &after_done);
+        jobs.Wait(after_done);
+        CHECK(late);
+    }
+}
+
+TEST(JobSystem, ManyThreadsScheduleAtOnce)
+{
+    // Threads outside the pool push round robin while the workers steal, no job may be lost or run twice.
+    JobSystem jobs(4);
+    constexpr uint32_t producers = 6;
+    constexpr uint32_t jobs_per_producer = 20'000;
+    std::vector<std::atomic<uint32_t>> runs(producers * jobs_per_producer);
+    std::vector<std::thread> threads;
+    for (uint32_t producer = 0; producer < producers; ++producer)
+    {
+        threads.emplace_back(
+            [&, producer]
+            {
+                JobCounter counter;
+                for (uint32_t i = 0; i < jobs_per_producer; ++i)
+                {
+                    const uint32_t index = producer * jobs_per_producer + i;
+                    jobs.Schedule([&runs, index] { runs[index].fetch_add(1, std::memory_order_relaxed); }, &counter);
+                }
+                jobs.Wait(counter);
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    CHECK(std::ranges::all_of(runs, [](const auto& count) { return count.load() == 1; }));
+}
+
+TEST(JobSystem, MainThreadJobsRunWhenDrained)
+{
+    JobSystem jobs(2);
+    std::atomic<uint32_t> queued = 0;
+    std::vector<std::thread::id> ran_on;
+    jobs.ParallelFor(64,
+                     1,
+                     [&](uint32_t, uint32_t)
+                     {
+                         jobs.RunOnMainThread([&] { ran_on.push_back(std::this_thread::get_id()); });
+                         queued.fetch_add(1);
+                     });
+    CHECK(queued.load() == 64);
+    CHECK(ran_on.empty());
+    jobs.RunMainThreadJobs();
+    CHECK(ran_on.size() == 64);
+    CHECK(std::ranges::all_of(ran_on, [](const auto id) { return id == std::this_thread::get_id(); }));
+    jobs.RunMainThreadJobs();
+    CHECK(ran_on.size() == 64);
+}
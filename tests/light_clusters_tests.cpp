@@ -0,0 +1,135 @@
+#include "light_clusters.hpp"
+#include "test.hpp"
+
+namespace
+{
+    Camera CreateCamera(const glm::vec3& position, const glm::vec3& target)
+    {
+        Camera camera(nullptr);
+        camera.m_near_plane = 0.1f;
+        camera.m_far_plane = 500.f;
+        camera.m_view_matrix = glm::lookAtRH(position, target, glm::vec3(0.f, 1.f, 0.f));
+        camera.m_proj_matrix =
+            glm::perspective(camera.m_fov, camera.m_aspect_ratio, camera.m_near_plane, camera.m_far_plane);
+        return camera;
+    }
+
+    // Lights scattered through a box around the origin, mostly small with the odd large one.
+    std::vector<BoundingSphere> CreateLights(std::mt19937& rng, const uint32_t count, const float extent)
+    {
+        std::uniform_real_distribution<float> position(-extent, extent);
+        std::uniform_real_distribution<float> log_radius(-2.f, 5.f);
+        std::vector<BoundingSphere> lights(count);
+        for (auto& light : lights)
+        {
+            light = { .center = { position(rng), position(rng), position(rng) }, .radius = std::exp2(log_radius(rng)) };
+        }
+        return lights;
+    }
+
+    bool IsSame(const LightClusterGrid& a, const LightClusterGrid& b)
+    {
+        const auto equal_range = [](const LightClusterRange& x, const LightClusterRange& y)
+        { return x.offset == y.offset && x.count == y.count; };
+        return std::ranges::equal(a.GetClusters(), b.GetClusters(), equal_range) &&
+               std::ranges::equal(a.GetLightIndices(), b.GetLightIndices());
+    }
+} // namespace
+
+TEST(LightClusters, BuildMatchesReference)
+{
+    // Light counts around the 4 and 8 wide batches and well past them, cameras anywhere and looking every which way,
+    // with and without workers. The lists must be exactly what testing every light against every cluster gives.
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    LightClusterGrid grid;
+    LightClusterGrid reference;
+    bool same = true;
+    for (const uint32_t workers : { 0u, 4u })
+    {
+        JobSystem jobs(workers);
+        for (const uint32_t count : { 0u, 1u, 3u, 4u, 7u, 8u, 9u, 17u, 300u, 2000u })
+        {
+            const auto lights = CreateLights(rng, count, 150.f);
+            const glm::vec3 position(unit(rng) * 50.f, unit(rng) * 10.f, unit(rng) * 50.f);
+            const glm::vec3 forward(unit(rng), unit(rng) * 0.5f, unit(rng));
+            const Camera camera = CreateCamera(position, position + forward);
+            grid.Build(jobs, camera, lights);
+            reference.BuildReference(camera, lights);
+            same &= IsSame(grid, reference);
+        }
+    }
+    CHECK(same);
+    CHECK(grid.GetStats().lights == 2000);
+    CHECK(grid.GetStats().indices == reference.GetStats().indices);
+    CHECK(grid.GetStats().occupied_clusters > 0);
+}
+
+TEST(LightClusters, IndicesAreAscendingPerCluster)
+{
+    std::mt19937 rng(8);
+    JobSystem jobs(2);
+    LightClusterGrid grid;
+    const Camera camera = CreateCamera(glm::vec3(0.f, 2.f, 0.f), glm::vec3(0.f, 2.f, -1.f));
+    grid.Build(jobs, camera, CreateLights(rng, 1000, 100.f));
+
+    // Ranges follow each other with no gaps and cover the whole index list.
+    bool contiguous = true;
+    bool ascending = true;
+    uint32_t offset = 0;
+    for (const auto& cluster : grid.GetClusters())
+    {
+        contiguous &= cluster.offset == offset;
+        offset += cluster.count;
+        const auto indices = grid.GetLightIndices().subspan(cluster.offset, cluster.count);
+        ascending &= std::ranges::adjacent_find(indices, std::ranges::greater_equal()) == indices.end();
+    }
+    CHECK(grid.GetClusters().size() == LightClusterGrid::CLUSTER_COUNT);
+    CHECK(contiguous);
+    CHECK(ascending);
+    CHECK(offset == grid.GetLightIndices().size());
+}
+
+TEST(LightClusters, SmallLightLandsInItsCluster)
+{
+    // A tiny light straight ahead and a little right of and above the middle of the screen, at a depth well inside a
+    // slice, touches only the cluster the shaders would look it up in.
+    JobSystem jobs(0);
+    LightClusterGrid grid;
+    const Camera camera = CreateCamera(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f));
+    const std::vector<BoundingSphere> lights = { { .center = { 0.3f, 0.2f, -20.f }, .radius = 0.01f } };
+    grid.Build(jobs, camera, lights);
+
+    const glm::vec2 scale_bias = grid.GetSliceScaleBias();
+    const auto slice = static_cast<uint32_t>(std::floor(std::log(20.f) * scale_bias.x + scale_bias.y));
+    const uint32_t row = LightClusterGrid::GRID_Y / 2;
+    const uint32_t column = LightClusterGrid::GRID_X / 2;
+    const uint32_t cluster = (slice * LightClusterGrid::GRID_Y + row) * LightClusterGrid::GRID_X + column;
+    CHECK(grid.GetClusters()[cluster].count == 1);
+    CHECK(grid.GetLightIndices().size() == 1);
+    CHECK(grid.GetStats().occupied_clusters == 1);
+    CHECK(grid.GetStats().max_cluster_lights == 1);
+}
+
+TEST(LightClusters, LightsOutOfViewTouchNothing)
+{
+    // Behind the camera, past the far plane and far off to the side.
+    JobSystem jobs(0);
+    LightClusterGrid grid;
+    const Camera camera = CreateCamera(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f));
+    const std::vector<BoundingSphere> lights = {
+        { .center = { 0.f, 0.f, 10.f }, .radius = 5.f },
+        { .center = { 0.f, 0.f, -600.f }, .radius = 50.f },
+        { .center = { 200.f, 0.f, -10.f }, .radius = 5.f },
+    };
+    grid.Build(jobs, camera, lights);
+    CHECK(grid.GetLightIndices().empty());
+    CHECK(grid.GetStats().occupied_clusters == 0);
+    CHECK(std::ranges::all_of(grid.GetClusters(), [](const LightClusterRange& cluster) { return cluster.count == 0; }));
+
+    // A light around the camera reaches every cluster of the nearest slice.
+    const std::vector<BoundingSphere> around = { { .center = glm::vec3(0.f), .radius = 0.3f } };
+    grid.Build(jobs, camera, around);
+    const auto first_slice = grid.GetClusters().first(LightClusterGrid::GRID_X * LightClusterGrid::GRID_Y);
+    CHECK(std::ranges::all_of(first_slice, [](const LightClusterRange& cluster) { return cluster.count == 1; }));
+}
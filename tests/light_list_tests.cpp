@@ -0,0 +1,210 @@
+#include "light_list.hpp"
+#include "test.hpp"
+
+namespace
+{
+    PointLight CreatePointLight(const float x) { return { .position = { x, 0.f, 0.f } }; }
+
+    DirectionalLight CreateDirectionalLight(const float intensity, const bool caster)
+    {
+        return { .direction = { 0.f, -1.f, 0.f }, .intensity = intensity, .cast_shadows = caster };
+    }
+
+    bool IsPartitioned(const LightList<DirectionalLight>& list)
+    {
+        const auto casts = [](const DirectionalLight& light) { return CastsShadows(light); };
+        return std::ranges::all_of(list.GetShadowCasters(), casts) && std::ranges::none_of(list.GetNonCasters(), casts);
+    }
+
+    // Takes every change and brings a copy up to date the way the renderer's upload does.
+    template <typename Light>
+    void Mirror(LightList<Light>& list, std::vector<Light>& copy, const uint32_t budget)
+    {
+        LightChanges<Light> changes;
+        DirtyRanges dirty;
+        list.TakeChanges(budget, changes);
+        changes.Apply(copy, dirty);
+    }
+} // namespace
+
+TEST(LightList, AddUpdateRemove)
+{
+    LightList<PointLight> list;
+    CHECK(!list.IsValid({}));
+    CHECK(list.Get({}) == nullptr);
+
+    const auto a = list.Add(CreatePointLight(1.f));
+    const auto b = list.Add(CreatePointLight(2.f));
+    const auto c = list.Add(CreatePointLight(3.f));
+    CHECK(list.GetCount() == 3);
+    CHECK(list.Get(b)->position.x == 2.f);
+    CHECK(list.Update(b, CreatePointLight(20.f)));
+    CHECK(list.Get(b)->position.x == 20.f);
+
+    // The last light fills the hole and keeps resolving through its handle.
+    list.Remove(a);
+    CHECK(list.GetCount() == 2);
+    CHECK(!list.IsValid(a));
+    CHECK(list.Get(a) == nullptr);
+    CHECK(!list.Update(a, CreatePointLight(9.f)));
+    CHECK(list.Get(c)->position.x == 3.f);
+    CHECK(list.GetLights()[0].position.x == 3.f);
+    CHECK(list.GetHandle(0) == c);
+
+    // The freed slot is reused under a new generation, the old handle stays stale.
+    const auto d = list.Add(CreatePointLight(4.f));
+    CHECK(d.index == a.index);
+    CHECK(d.generation != a.generation);
+    CHECK(list.Get(a) == nullptr);
+    CHECK(list.Get(d)->position.x == 4.f);
+
+    // Removing twice or through a stale handle does nothing.
+    list.Remove(a);
+    list.Remove(b);
+    list.Remove(b);
+    CHECK(list.GetCount() == 2);
+    list.Clear();
+    CHECK(list.GetCount() == 0);
+    CHECK(!list.IsValid(c));
+    CHECK(!list.IsValid(d));
+}
+
+TEST(LightList, ShadowCastersStayInFront)
+{
+    LightList<DirectionalLight> list;
+    std::vector<DirectionalLightHandle> handles;
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        handles.push_back(list.Add(CreateDirectionalLight(static_cast<float>(i), i % 3 == 0)));
+    }
+    CHECK(list.GetShadowCasters().size() == 3);
+    CHECK(IsPartitioned(list));
+
+    // Turning shadows off swaps a caster with the last caster, turning them on with the first other light.
+    CHECK(list.Update(handles[3], CreateDirectionalLight(3.f, false)));
+    CHECK(list.Update(handles[5], CreateDirectionalLight(5.f, true)));
+    CHECK(list.Update(handles[7], CreateDirectionalLight(7.f, true)));
+    CHECK(list.GetShadowCasters().size() == 4);
+    CHECK(IsPartitioned(list));
+
+    // Removing a caster from the middle moves the last caster into its hole and the last light into the caster's.
+    list.Remove(handles[0]);
+    CHECK(list.GetShadowCasters().size() == 3);
+    CHECK(list.GetCount() == 7);
+    CHECK(IsPartitioned(list));
+
+    bool resolved = true;
+    for (uint32_t i = 1; i < handles.size(); ++i)
+    {
+        resolved &= list.Get(handles[i])->intensity == static_cast<float>(i);
+        resolved &= list.GetHandle(static_cast<uint32_t>(list.Get(handles[i]) - list.GetLights().data())) == handles[i];
+    }
+    CHECK(resolved);
+}
+
+TEST(LightList, UpdatesWaitForBudget)
+{
+    LightList<PointLight> list;
+    std::vector<PointLightHandle> handles;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        handles.push_back(list.Add(CreatePointLight(static_cast<float>(i))));
+    }
+
+    // Adds are handed out whatever the budget.
+    LightChanges<PointLight> changes;
+    list.TakeChanges(0, changes);
+    CHECK(changes.count == 10);
+    CHECK(changes.ranges.size() == 1);
+    CHECK(changes.values.size() == 10);
+
+    // Updating a light again before it went out does not queue it twice.
+    for (const auto& handle : handles)
+    {
+        list.Update(handle, CreatePointLight(100.f));
+    }
+    list.Update(handles[0], CreatePointLight(200.f));
+    CHECK(list.GetPendingCount() == 10);
+
+    // Oldest first, so the first three updated go out and the rest wait.
+    list.TakeChanges(3, changes);
+    CHECK(changes.values.size() == 3);
+    CHECK(changes.ranges.size() == 1);
+    CHECK(changes.ranges[0].first == 0);
+    CHECK(changes.values[0].position.x == 200.f);
+    CHECK(list.GetPendingCount() == 7);
+
+    // Removing a light that is waiting drops its update.
+    list.Remove(handles[9]);
+    CHECK(list.GetPendingCount() == 6);
+    list.TakeChanges(100, changes);
+    CHECK(list.GetPendingCount() == 0);
+    CHECK(changes.count == 9);
+    CHECK(std::ranges::all_of(changes.values, [](const PointLight& light) { return light.position.x == 100.f; }));
+
+    // Nothing changed, nothing handed out.
+    list.TakeChanges(100, changes);
+    CHECK(changes.ranges.empty());
+    CHECK(changes.values.empty());
+}
+
+TEST(LightList, RandomChurnKeepsHandlesAndCopy)
+{
+    // Random adds, removes, updates and shadow toggles. Every live handle must resolve to what was last written, the
+    // casters must stay in front, and a copy kept up to date from the changes must match the packed lights once the
+    // pending updates have gone out.
+    std::mt19937 rng(3);
+    LightList<DirectionalLight> list;
+    std::vector<std::pair<DirectionalLightHandle, DirectionalLight>> live;
+    std::vector<DirectionalLight> copy;
+    bool resolved = true;
+    bool partitioned = true;
+    bool mirrored = true;
+    for (uint32_t step = 0; step < 5000; ++step)
+    {
+        const uint32_t op = rng() % 10;
+        const DirectionalLight light = CreateDirectionalLight(static_cast<float>(step), rng() % 4 == 0);
+        if (op < 4 || live.empty())
+        {
+            live.emplace_back(list.Add(light), light);
+        }
+        else if (op < 6)
+        {
+            const uint32_t index = rng() % static_cast<uint32_t>(live.size());
+            list.Remove(live[index].first);
+            live[index] = live.back();
+            live.pop_back();
+        }
+        else
+        {
+            auto& [handle, value] = live[rng() % static_cast<uint32_t>(live.size())];
+            resolved &= list.Update(handle, light);
+            value = light;
+        }
+
+        partitioned &= IsPartitioned(list);
+        if (step % 50 == 0)
+        {
+            for (const auto& [handle, value] : live)
+            {
+                const auto* light_value = list.Get(handle);
+                resolved &= light_value != nullptr && light_value->intensity == value.intensity &&
+                            light_value->cast_shadows == value.cast_shadows;
+            }
+        }
+        // A small budget most frames, so updates queue up and go out over several of them.
+        Mirror(list, copy, 4);
+        if (step % 100 == 99)
+        {
+            Mirror(list, copy, std::numeric_limits<uint32_t>::max());
+            mirrored &= std::ranges::equal(copy,
+                                           list.GetLights(),
+                                           [](const DirectionalLight& a, const DirectionalLight& b)
+                                           { return a.intensity == b.intensity && a.cast_shadows == b.cast_shadows; });
+        }
+    }
+    CHECK(list.GetCount() == live.size());
+    CHECK(resolved);
+    CHECK(partitioned);
+    CHECK(mirrored);
+}
@@ -0,0 +1,40 @@
+#include "test.hpp"
+
+namespace
+{
+    uint32_t g_failures = 0;
+} // namespace
+
+std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> test_cases;
+    return test_cases;
+}
+
+void ReportFailure(const std::string_view expression, const std::string_view file, const int line)
+{
+    std::println("    {}:{}: CHECK({}) failed", file, line, expression);
+    ++g_failures;
+}
+
+int main(const int argc, char** argv)
+{
+    const std::string_view suite = argc > 1 ? argv[1] : "";
+    uint32_t run = 0;
+    uint32_t failed = 0;
+    for (const auto& test_case : GetTestCases())
+    {
+        if (!suite.empty() && test_case.suite != suite) continue;
+
+        const uint32_t failures = g_failures;
+        test_case.function();
+        ++run;
+        if (g_failures != failures)
+        {
+            ++failed;
+            std::println("FAILED {}.{}", test_case.suite, test_case.name);
+        }
+    }
+    std::println("{} of {} tests passed", run - failed, run);
+    return run == 0 || failed ? 1 : 0;
+}
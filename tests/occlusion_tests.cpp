@@ -0,0 +1,171 @@
+#include "occlusion.hpp"
+#include "test.hpp"
+
+namespace
+{
+    // Looking down -z from the origin with the aspect of the depth buffer.
+    glm::mat4 GetViewProj()
+    {
+        const glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+        const float aspect = static_cast<float>(OcclusionCuller::WIDTH) / static_cast<float>(OcclusionCuller::HEIGHT);
+        return glm::perspective(glm::radians(90.f), aspect, 0.1f, 100.f) * view;
+    }
+
+    Occluder Quad(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& d)
+    {
+        return { .positions = { a, b, c, d }, .indices = { 0, 1, 2, 0, 2, 3 } };
+    }
+
+    Occluder Cube()
+    {
+        Occluder cube;
+        for (uint32_t corner = 0; corner < 8; ++corner)
+        {
+            cube.positions.emplace_back(corner & 1 ? 1.f : -1.f, corner & 2 ? 1.f : -1.f, corner & 4 ? 1.f : -1.f);
+        }
+        cube.indices = { 0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1,
+                         2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3 };
+        return cube;
+    }
+
+    BoundingBox Box(const glm::vec3& center, const float size)
+    {
+        return { .min = center - glm::vec3(size), .max = center + glm::vec3(size) };
+    }
+
+    std::vector<uint16_t> ReadDepthImage(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string magic;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t max_value = 0;
+        file >> magic >> width >> height >> max_value;
+        file.get();
+        if (!file || magic != "P5" || width != OcclusionCuller::WIDTH || height != OcclusionCuller::HEIGHT) return {};
+
+        std::vector<uint16_t> values(width * height);
+        for (auto& value : values)
+        {
+            std::array<unsigned char, 2> bytes{};
+            file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+            value = static_cast<uint16_t>(bytes[0] << 8 | bytes[1]);
+        }
+        return file ? values : std::vector<uint16_t>{};
+    }
+
+    // Golden images live in tests/data, run with ENGINE_UPDATE_GOLDEN set to rewrite them after an intended change.
+    // Compilers may fuse the edge setup differently, so a few pixels along silhouettes are allowed to flip.
+    void CheckGolden(const OcclusionCuller& culler, const std::string_view name)
+    {
+        const std::filesystem::path golden_path = std::filesystem::path(ENGINE_TEST_DATA) / std::format("{}.pgm", name);
+        if (std::getenv("ENGINE_UPDATE_GOLDEN"))
+        {
+            culler.SaveDepth(golden_path);
+        }
+        const auto golden = ReadDepthImage(golden_path);
+        CHECK(!golden.empty());
+        if (golden.empty()) return;
+
+        const std::filesystem::path actual_path = std::filesystem::temp_directory_path() / std::format("{}.pgm", name);
+        culler.SaveDepth(actual_path);
+        const auto actual = ReadDepthImage(actual_path);
+        CHECK(actual.size() == golden.size());
+        if (actual.size() != golden.size()) return;
+
+        uint32_t different = 0;
+        for (size_t i = 0; i < actual.size(); ++i)
+        {
+            different += std::abs(static_cast<int>(actual[i]) - static_cast<int>(golden[i])) > 2;
+        }
+        CHECK(different <= actual.size() / 200);
+    }
+} // namespace
+
+TEST(Occlusion, WallAndFloorMatchGolden)
+{
+    JobSystem job_system(2);
+    const Occluder wall = Quad({ -5.f, -3.f, -10.f }, { 5.f, -3.f, -10.f }, { 5.f, 3.f, -10.f }, { -5.f, 3.f, -10.f });
+    const Occluder floor = Quad({ -30.f, -2.f, -1.f }, { -30.f, -2.f, -60.f }, { 30.f, -2.f, -60.f }, { 30.f, -2.f, -1.f });
+    const std::array instances{
+        OccluderInstance{ .occluder = &wall, .transform = glm::mat4(1.f) },
+        OccluderInstance{ .occluder = &floor, .transform = glm::mat4(1.f) },
+    };
+    OcclusionCuller culler;
+    culler.Render(job_system, GetViewProj(), instances);
+    CHECK(culler.GetStats().occluder_triangles == 4);
+    CheckGolden(culler, "occlusion_wall_floor");
+}
+
+TEST(Occlusion, ClippedCubesMatchGolden)
+{
+    JobSystem job_system(2);
+    const Occluder cube = Cube();
+    // One cube reaches behind the camera and has to be clipped against the near plane, the others tilt across tiles.
+    std::vector<OccluderInstance> instances;
+    instances.push_back({ .occluder = &cube,
+                          .transform = glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(3.f, -1.5f, -1.f)),
+                                                  glm::vec3(1.f, 0.5f, 3.f)) });
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        glm::mat4 transform = glm::translate(glm::mat4(1.f), glm::vec3(-12.f + 5.f * i, 1.5f * (i % 2), -8.f - 3.f * i));
+        transform = glm::rotate(transform, 0.4f * static_cast<float>(i + 1), glm::vec3(0.3f, 1.f, 0.2f));
+        instances.push_back({ .occluder = &cube, .transform = transform });
+    }
+    OcclusionCuller culler;
+    culler.Render(job_system, GetViewProj(), instances);
+    CheckGolden(culler, "occlusion_clipped_cubes");
+}
+
+TEST(Occlusion, HidesOnlyWhatIsBehind)
+{
+    JobSystem job_system(2);
+    const Occluder wall = Quad({ -5.f, -3.f, -10.f }, { 5.f, -3.f, -10.f }, { 5.f, 3.f, -10.f }, { -5.f, 3.f, -10.f });
+    const std::array instances{ OccluderInstance{ .occluder = &wall, .transform = glm::mat4(1.f) } };
+    OcclusionCuller culler;
+    culler.Render(job_system, GetViewProj(), instances);
+
+    CHECK(culler.IsOccluded(Box({ 0.f, 0.f, -20.f }, 1.f)));
+    CHECK(culler.IsOccluded(Box({ 2.f, -1.f, -50.f }, 2.f)));
+    // In front of the wall, peeking out beside it, off screen and around the camera.
+    CHECK(!culler.IsOccluded(Box({ 0.f, 0.f, -5.f }, 1.f)));
+    CHECK(!culler.IsOccluded(Box({ 9.f, 0.f, -20.f }, 1.f)));
+    CHECK(!culler.IsOccluded(Box({ 0.f, 0.f, 20.f }, 1.f)));
+    CHECK(!culler.IsOccluded(Box({ 0.f, 0.f, 0.f }, 1.f)));
+    CHECK(!culler.IsOccluded(BoundingBox{}));
+
+    const std::array bounds{
+        Bounds{ .box = Box({ 0.f, 0.f, -20.f }, 1.f) },
+        Bounds{ .box = Box({ 0.f, 0.f, -5.f }, 1.f) },
+        Bounds{ .box = Box({ 1.f, 1.f, -30.f }, 1.f) },
+    };
+    std::vector<uint32_t> visible = { 0, 1, 2 };
+    culler.Cull(bounds, visible);
+    CHECK(visible == std::vector<uint32_t>{ 1 });
+    CHECK(culler.GetStats().tested == 3);
+    CHECK(culler.GetStats().occluded == 2);
+}
+
+TEST(Occlusion, ExtremeCoordinatesStayVisible)
+{
+    JobSystem job_system(2);
+    // Just past the near plane and far off to the side, so its projected corners are enormous.
+    const Occluder sliver{ .positions = { { -1e20f, 0.f, -0.1001f }, { 1e20f, 0.f, -0.1001f }, { 0.f, 1e20f, -0.1001f } },
+                           .indices = { 0, 1, 2 } };
+    const std::array instances{ OccluderInstance{ .occluder = &sliver, .transform = glm::mat4(1.f) } };
+    OcclusionCuller culler;
+    culler.Render(job_system, GetViewProj(), instances);
+
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+    CHECK(!culler.IsOccluded({ .min = glm::vec3(nan), .max = glm::vec3(nan) }));
+    CHECK(!culler.IsOccluded({ .min = glm::vec3(-1e30f, -1e30f, -50.f), .max = glm::vec3(1e30f, 1e30f, -40.f) }));
+}
+
+TEST(Occlusion, EmptyBufferHidesNothing)
+{
+    JobSystem job_system(2);
+    OcclusionCuller culler;
+    culler.Render(job_system, GetViewProj(), {});
+    CHECK(std::ranges::all_of(culler.GetDepth(), [](const float depth) { return depth == 1.f; }));
+    CHECK(!culler.IsOccluded(Box({ 0.f, 0.f, -20.f }, 1.f)));
+}
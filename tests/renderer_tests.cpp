@@ -0,0 +1,203 @@
+#include "engine.hpp"
+#include "test.hpp"
+
+// A headless engine runs every CPU stage of the renderer's frame, so what it keeps and frees can be checked here.
+namespace
+{
+    Mesh CreateTriangle()
+    {
+        const std::vector<glm::vec3> positions = { glm::vec3(0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f) };
+        return {
+            .name = "Triangle",
+            .meshlets = { { .vertex_offset = 0, .triangle_offset = 0, .vertex_count = 3, .triangle_count = 1 } },
+            .positions = positions,
+            .vertex_attribs = std::vector<Vertex>(positions.size()),
+            .meshlet_vertices = { 0, 1, 2 },
+            .meshlet_triangles = { 0u | 1u << 8 | 2u << 16 },
+            .material_index = -1,
+            .bounds = Bounds::FromPoints(positions),
+        };
+    }
+
+    // Two meshes drawn by three nodes, the first two nodes share the first mesh.
+    Model CreateModel()
+    {
+        Model model;
+        model.meshes = { CreateTriangle(), CreateTriangle() };
+        model.transforms = { glm::mat4(1.f), glm::translate(glm::mat4(1.f), glm::vec3(2.f, 0.f, 0.f)) };
+        model.nodes = {
+            { .name = "First", .transform_index = 0, .mesh_index = 0 },
+            { .name = "Second", .transform_index = 1, .mesh_index = 0 },
+            { .name = "Third", .transform_index = 0, .mesh_index = 1 },
+        };
+        // One per meshlet of every node.
+        model.cull_datas.resize(model.nodes.size());
+        return model;
+    }
+
+    void RenderFrames(Renderer& renderer, const uint64_t count)
+    {
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            renderer.Extract(std::chrono::high_resolution_clock::now());
+            renderer.Render();
+        }
+    }
+
+    // A flat 20 by 20 square around the origin, grass grows on all of it.
+    GrassSurface CreateGround()
+    {
+        const std::array positions = { glm::vec3(-10.f, 0.f, -10.f),
+                                       glm::vec3(10.f, 0.f, -10.f),
+                                       glm::vec3(10.f, 0.f, 10.f),
+                                       glm::vec3(-10.f, 0.f, 10.f) };
+        const std::array<uint32_t, 6> indices = { 0, 1, 2, 0, 2, 3 };
+        GrassSurface surface;
+        surface.AddMesh(positions, indices, glm::mat4(1.f));
+        surface.Build(1.f);
+        return surface;
+    }
+
+    // Scatters grass over the ground and returns how many patches it made, with the budget set to take four frames.
+    uint32_t ScatterGround(Renderer& renderer, const float spacing)
+    {
+        renderer.ScatterGrass(CreateGround(), {}, { .spacing = spacing });
+        const uint32_t count = renderer.GetGrassPass().scatter.GetStats().patches;
+        renderer.GetGrassPass().upload_budget = count / 4 + 1;
+        return count;
+    }
+
+    std::array<uint32_t, 4> GetFreeSizes(const GeometryPage& page)
+    {
+        return { page.vertex_allocator.GetFreeSize(),
+                 page.meshlet_allocator.GetFreeSize(),
+                 page.meshlet_vertex_allocator.GetFreeSize(),
+                 page.meshlet_triangle_allocator.GetFreeSize() };
+    }
+
+    std::array<uint32_t, 4> GetSizes(const GeometryPage& page)
+    {
+        return { page.vertex_allocator.GetSize(),
+                 page.meshlet_allocator.GetSize(),
+                 page.meshlet_vertex_allocator.GetSize(),
+                 page.meshlet_triangle_allocator.GetSize() };
+    }
+} // namespace
+
+TEST(Renderer, RemovedModelsGiveTheirGeometryBack)
+{
+    Engine engine({ .headless = true, .worker_count = 1 });
+    auto& renderer = engine.GetRenderer();
+    const auto& pool = renderer.GetGeometryPool();
+    auto model = CreateModel();
+    const auto [offset, size] = renderer.AddRenderables(model, glm::mat4(1.f));
+    CHECK(size == 3);
+    RenderFrames(renderer, 1);
+    CHECK(pool.GetPageCount() == 1);
+    const auto loaded = GetFreeSizes(pool.GetPage(0));
+    CHECK(loaded != GetSizes(pool.GetPage(0)));
+
+    // The second node still draws the first mesh.
+    renderer.RemoveRenderables(offset, 1);
+    RenderFrames(renderer, GeometryPool::RETIRE_FRAMES + 1);
+    CHECK(pool.GetRetiredCount() == 0);
+    CHECK(GetFreeSizes(pool.GetPage(0)) == loaded);
+
+    // Frames in flight may still draw the removed meshes, their ranges stay taken until those have completed.
+    renderer.RemoveRenderables(offset + 1, size - 1);
+    RenderFrames(renderer, GeometryPool::RETIRE_FRAMES);
+    CHECK(pool.GetRetiredCount() == 2);
+    CHECK(GetFreeSizes(pool.GetPage(0)) == loaded);
+    RenderFrames(renderer, 1);
+    CHECK(pool.GetRetiredCount() == 0);
+    CHECK(GetFreeSizes(pool.GetPage(0)) == GetSizes(pool.GetPage(0)));
+
+    // Loading it again fits in the same page and takes exactly what the first load did.
+    auto reloaded = CreateModel();
+    renderer.AddRenderables(reloaded, glm::mat4(1.f));
+    RenderFrames(renderer, 1);
+    CHECK(pool.GetPageCount() == 1);
+    CHECK(GetFreeSizes(pool.GetPage(0)) == loaded);
+}
+
+TEST(Renderer, ScatteredGrassStreamsInUnderTheBudget)
+{
+    Engine engine({ .headless = true, .worker_count = 1 });
+    auto& renderer = engine.GetRenderer();
+    const auto& grass = renderer.GetGrassPass();
+    const uint32_t count = ScatterGround(renderer, 0.5f);
+    CHECK(count > 16);
+    // The patches reach the render thread with the next snapshot.
+    CHECK(grass.patches.empty());
+
+    uint32_t frames = 0;
+    while (grass.uploaded_count < count && frames < 8)
+    {
+        RenderFrames(renderer, 1);
+        ++frames;
+        CHECK(grass.patches.size() == count);
+        CHECK(grass.sent_patches == std::min(grass.upload_budget, count - (frames - 1) * grass.upload_budget));
+    }
+    CHECK(frames == 4);
+    CHECK(grass.uploaded_count == count);
+    RenderFrames(renderer, 1);
+    CHECK(grass.sent_patches == 0);
+
+    // Scattering again replaces the drawn patches, the new ones stream in from the start.
+    const uint32_t sparse_count = ScatterGround(renderer, 1.f);
+    CHECK(sparse_count < count);
+    CHECK(grass.uploaded_count == count);
+    RenderFrames(renderer, 1);
+    CHECK(grass.patches.size() == sparse_count);
+    CHECK(grass.uploaded_count == grass.upload_budget);
+    CHECK(grass.sent_patches == grass.upload_budget);
+}
+
+TEST(Renderer, EditsToDrawnGrassGoOutAtOnce)
+{
+    Engine engine({ .headless = true, .worker_count = 1 });
+    auto& renderer = engine.GetRenderer();
+    auto& grass = renderer.GetGrassPass();
+    const uint32_t count = ScatterGround(renderer, 0.5f);
+    RenderFrames(renderer, 1);
+    const uint32_t budget = grass.upload_budget;
+    CHECK(grass.uploaded_count == budget);
+
+    // The first patch is drawn, the last one hasn't been uploaded yet.
+    for (const uint32_t i : { 0u, count - 1 })
+    {
+        grass.patches[i].height = 5.f;
+        grass.dirty_patches.Mark(i);
+    }
+    RenderFrames(renderer, 1);
+    // Only the drawn patch is rewritten, the last one goes out once with its chunk.
+    CHECK(grass.sent_patches == budget + 1);
+    CHECK(grass.uploaded_count == 2 * budget);
+}
+
+TEST(Renderer, GrowingTheGrassBufferResendsOnlyDrawnPatches)
+{
+    Engine engine({ .headless = true, .worker_count = 1 });
+    auto& renderer = engine.GetRenderer();
+    auto& grass = renderer.GetGrassPass();
+    const uint32_t count = ScatterGround(renderer, 0.5f);
+    grass.upload_budget = count;
+    RenderFrames(renderer, 1);
+    CHECK(grass.uploaded_count == count);
+
+    // Added the way the editor adds them, until they no longer fit the buffer.
+    const uint32_t capacity = grass.buffer.GetCapacity();
+    const uint32_t grow_count = grass.buffer.GetGrowCount();
+    while (grass.patches.size() <= capacity)
+    {
+        grass.patches.emplace_back(GrassPatch{});
+        grass.dirty_patches.Mark(static_cast<uint32_t>(grass.patches.size() - 1));
+    }
+    grass.upload_budget = 4;
+    RenderFrames(renderer, 1);
+    CHECK(grass.buffer.GetGrowCount() == grow_count + 1);
+    // The new buffer gets the drawn patches back at once and only the first chunk of the added ones.
+    const uint32_t appended = std::min(capacity + 1 - count, 4u);
+    CHECK(grass.sent_patches == count + appended);
+    CHECK(grass.uploaded_count == count + appended);
+}
@@ -0,0 +1,167 @@
+#include "resolution_controller.hpp"
+#include "test.hpp"
+
+namespace
+{
+    // Stands in for the GPU: a fixed cost plus a cost per pixel, so frame time grows with the rendered area, with
+    // optional noise on top.
+    struct SimulatedGpu
+    {
+        float fixed_ms;
+        float full_resolution_ms;
+        float noise_ms = 0.f;
+        std::mt19937 rng{ 17 };
+
+        float FrameMs(const float scale)
+        {
+            std::normal_distribution<float> noise(0.f, noise_ms);
+            const float frame_ms = fixed_ms + full_resolution_ms * scale * scale;
+            return noise_ms > 0.f ? std::max(frame_ms + noise(rng), 0.1f) : frame_ms;
+        }
+
+        // The scale that exactly meets the target.
+        [[nodiscard]] float GetIdealScale(const float target_ms) const
+        {
+            return std::clamp(std::sqrt((target_ms - fixed_ms) / full_resolution_ms),
+                              ResolutionController::MIN_SCALE,
+                              ResolutionController::MAX_SCALE);
+        }
+    };
+
+    struct Run
+    {
+        std::vector<float> scales;
+        std::vector<float> frame_ms;
+    };
+
+    Run Simulate(ResolutionController& controller, SimulatedGpu& gpu, const uint32_t frames, float scale = 1.f)
+    {
+        Run run;
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            const float frame_ms = gpu.FrameMs(scale);
+            scale = controller.Update(frame_ms);
+            run.scales.push_back(scale);
+            run.frame_ms.push_back(frame_ms);
+        }
+        return run;
+    }
+
+    // Within the dead band of the target, give or take what the smoothing still lags behind.
+    bool IsSettled(const ResolutionController& controller, const Run& run)
+    {
+        const float error = std::abs(run.frame_ms.back() - controller.GetTargetMs()) / controller.GetTargetMs();
+        return error < ResolutionController::DEAD_BAND + 0.01f;
+    }
+
+    // Smallest and largest scale over the last count frames.
+    std::pair<float, float> GetTailRange(const Run& run, const uint32_t count)
+    {
+        const auto tail = std::span(run.scales).last(count);
+        const auto [min, max] = std::ranges::minmax(tail);
+        return { min, max };
+    }
+} // namespace
+
+TEST(ResolutionController, ConvergesToTheTarget)
+{
+    // 24 ms at full resolution against a 16.7 ms target, the ideal scale is about 0.8.
+    ResolutionController controller;
+    SimulatedGpu gpu{ .fixed_ms = 4.f, .full_resolution_ms = 20.f };
+    const Run run = Simulate(controller, gpu, 600);
+    const float ideal = gpu.GetIdealScale(controller.GetTargetMs());
+
+    // Settled within the dead band of the target, and still.
+    CHECK(IsSettled(controller, run));
+    CHECK_NEAR(run.scales.back(), ideal, 0.03f);
+    const auto [min, max] = GetTailRange(run, 200);
+    CHECK(max - min < 1e-4f);
+
+    // Never dips far below the ideal scale on the way down.
+    CHECK(std::ranges::min(run.scales) > ideal - 0.08f);
+}
+
+TEST(ResolutionController, HeadroomKeepsFullResolution)
+{
+    ResolutionController controller;
+    SimulatedGpu gpu{ .fixed_ms = 2.f, .full_resolution_ms = 8.f };
+    const Run run = Simulate(controller, gpu, 300);
+    CHECK(std::ranges::all_of(run.scales, [](const float scale) { return scale == ResolutionController::MAX_SCALE; }));
+}
+
+TEST(ResolutionController, SaturationDoesNotWindUp)
+{
+    // Far too slow even at the minimum scale for a long time, then the load drops. The velocity form must come back to
+    // full resolution quickly instead of unwinding a huge integral first.
+    ResolutionController controller;
+    SimulatedGpu gpu{ .fixed_ms = 10.f, .full_resolution_ms = 90.f };
+    const Run slow = Simulate(controller, gpu, 600);
+    CHECK(slow.scales.back() == ResolutionController::MIN_SCALE);
+
+    gpu = { .fixed_ms = 2.f, .full_resolution_ms = 8.f };
+    const Run fast = Simulate(controller, gpu, 120, slow.scales.back());
+    const auto recovered = std::ranges::find(fast.scales, ResolutionController::MAX_SCALE);
+    CHECK(recovered != fast.scales.end());
+    CHECK(recovered - fast.scales.begin() < 60);
+}
+
+TEST(ResolutionController, StepChangesReconverge)
+{
+    // The scene gets twice as expensive per pixel, then cheaper again, and the scale follows both ways. Coming from
+    // either side it stops at the near edge of the dead band, so the two light scales differ by a few percent.
+    ResolutionController controller;
+    SimulatedGpu gpu{ .fixed_ms = 4.f, .full_resolution_ms = 14.f };
+    const Run light = Simulate(controller, gpu, 400);
+    CHECK(IsSettled(controller, light));
+
+    gpu.full_resolution_ms = 28.f;
+    const Run heavy = Simulate(controller, gpu, 400, light.scales.back());
+    const float heavy_ideal = gpu.GetIdealScale(controller.GetTargetMs());
+    CHECK(IsSettled(controller, heavy));
+    CHECK_NEAR(heavy.scales.back(), heavy_ideal, 0.03f);
+    // Most of the way there within two seconds at 60 Hz.
+    CHECK(std::abs(heavy.scales[120] - heavy_ideal) < 0.05f);
+
+    gpu.full_resolution_ms = 14.f;
+    const Run light_again = Simulate(controller, gpu, 400, heavy.scales.back());
+    CHECK(IsSettled(controller, light_again));
+    CHECK(light_again.scales.back() > heavy.scales.back());
+}
+
+TEST(ResolutionController, NoiseDoesNotMakeItHunt)
+{
+    // Frame times jitter by a millisecond around a load with an ideal scale well inside the range. Once settled the
+    // smoothing and dead band keep the scale within a narrow band rather than following every frame.
+    ResolutionController controller;
+    SimulatedGpu gpu{ .fixed_ms = 4.f, .full_resolution_ms = 20.f, .noise_ms = 1.f };
+    const Run run = Simulate(controller, gpu, 1200);
+    const auto [min, max] = GetTailRange(run, 600);
+    CHECK(max - min < 0.1f);
+    CHECK_NEAR(run.scales.back(), gpu.GetIdealScale(controller.GetTargetMs()), 0.05f);
+
+    uint32_t changes = 0;
+    const auto tail = std::span(run.scales).last(600);
+    for (uint32_t i = 1; i < tail.size(); ++i)
+    {
+        changes += tail[i] != tail[i - 1];
+    }
+    CHECK(changes < 300);
+}
+
+TEST(ResolutionController, OnlyTheInputsDecideTheOutput)
+{
+    ResolutionController first;
+    ResolutionController second;
+    SimulatedGpu first_gpu{ .fixed_ms = 4.f, .full_resolution_ms = 20.f, .noise_ms = 0.5f };
+    SimulatedGpu second_gpu{ .fixed_ms = 4.f, .full_resolution_ms = 20.f, .noise_ms = 0.5f };
+    const Run a = Simulate(first, first_gpu, 300);
+    const Run b = Simulate(second, second_gpu, 300);
+    CHECK(a.scales == b.scales);
+
+    // Reset starts over from full resolution as if new.
+    first.Reset();
+    CHECK(first.GetScale() == ResolutionController::MAX_SCALE);
+    SimulatedGpu replay_gpu{ .fixed_ms = 4.f, .full_resolution_ms = 20.f, .noise_ms = 0.5f };
+    const Run replay = Simulate(first, replay_gpu, 300);
+    CHECK(replay.scales == a.scales);
+}
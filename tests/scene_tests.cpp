@@ -0,0 +1,202 @@
+#include "scene.hpp"
+#include "test.hpp"
+
+// Actors without renderables never reach the renderer, so the scene runs here without an engine.
+namespace
+{
+    bool Near(const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b) < 1e-4f; }
+
+    glm::vec3 GetWorldPosition(const Scene& scene, const ActorHandle handle)
+    {
+        return glm::vec3(scene.GetWorldMatrix(handle)[3]);
+    }
+} // namespace
+
+TEST(Scene, DestroyedHandlesGoStale)
+{
+    Scene scene(nullptr);
+    const auto first = scene.CreateActor("First");
+    const auto second = scene.CreateActor("Second");
+    CHECK(scene.IsValid(first));
+    CHECK(!scene.IsValid(ActorHandle{}));
+
+    scene.DestroyActor(first);
+    CHECK(!scene.IsValid(first));
+    CHECK(scene.IsValid(second));
+
+    // The slot is reused under a new generation, the old handle must not resolve to the new actor.
+    const auto third = scene.CreateActor("Third");
+    CHECK(third.index == first.index);
+    CHECK(third.generation != first.generation);
+    CHECK(!scene.IsValid(first));
+    CHECK(scene.GetName(third) == "Third");
+
+    // Destroying twice is harmless.
+    scene.DestroyActor(first);
+    CHECK(scene.GetActorCount() == 2);
+}
+
+TEST(Scene, DenseArraysStayPacked)
+{
+    Scene scene(nullptr);
+    std::vector<ActorHandle> handles;
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        handles.push_back(scene.CreateActor(std::format("Actor {}", i)));
+        scene.SetTransform(handles.back(), { .position = glm::vec3(static_cast<float>(i), 0.f, 0.f) });
+    }
+    scene.DestroyActor(handles[1]);
+    scene.DestroyActor(handles[4]);
+    CHECK(scene.GetActorCount() == 4);
+    CHECK(scene.GetNames().size() == 4);
+    CHECK(scene.GetTransforms().size() == 4);
+
+    // The last actors were moved into the holes, their handles must follow them.
+    for (const uint32_t i : { 0u, 2u, 3u, 5u })
+    {
+        CHECK(scene.GetName(handles[i]) == std::format("Actor {}", i));
+        CHECK(scene.GetTransform(handles[i]).position.x == static_cast<float>(i));
+    }
+    for (uint32_t i = 0; i < scene.GetActorCount(); ++i)
+    {
+        const auto handle = scene.GetHandle(i);
+        CHECK(scene.IsValid(handle));
+        CHECK(scene.GetNames()[i] == scene.GetName(handle));
+    }
+}
+
+TEST(Scene, WorldMatricesFollowParents)
+{
+    Scene scene(nullptr);
+    const auto root = scene.CreateActor();
+    const auto child = scene.CreateActor();
+    const auto grandchild = scene.CreateActor();
+    CHECK(scene.SetParent(child, root));
+    CHECK(scene.SetParent(grandchild, child));
+    scene.SetTransform(root, { .position = glm::vec3(1.f, 0.f, 0.f) });
+    scene.SetTransform(child, { .position = glm::vec3(0.f, 2.f, 0.f), .scale = glm::vec3(2.f) });
+    scene.SetTransform(grandchild, { .position = glm::vec3(0.f, 0.f, 1.f) });
+    scene.Update();
+    CHECK(Near(GetWorldPosition(scene, child), glm::vec3(1.f, 2.f, 0.f)));
+    // The child's scale applies to the grandchild's offset.
+    CHECK(Near(GetWorldPosition(scene, grandchild), glm::vec3(1.f, 2.f, 2.f)));
+
+    // Only the root moved, the whole subtree follows.
+    scene.SetTransform(root, { .position = glm::vec3(-1.f, 0.f, 0.f), .rotation = glm::vec3(0.f, glm::pi<float>(), 0.f) });
+    scene.Update();
+    CHECK(Near(GetWorldPosition(scene, child), glm::vec3(-1.f, 2.f, 0.f)));
+    CHECK(Near(GetWorldPosition(scene, grandchild), glm::vec3(-1.f, 2.f, -2.f)));
+
+    // Detached children keep their local transform as their world transform.
+    scene.DestroyActor(child);
+    CHECK(!scene.IsValid(child));
+    CHECK(!scene.IsValid(scene.GetParent(grandchild)));
+    scene.Update();
+    CHECK(Near(GetWorldPosition(scene, grandchild), glm::vec3(0.f, 0.f, 1.f)));
+    CHECK(scene.GetChildren(root).empty());
+}
+
+TEST(Scene, SetParentRejectsCycles)
+{
+    Scene scene(nullptr);
+    const auto a = scene.CreateActor();
+    const auto b = scene.CreateActor();
+    const auto c = scene.CreateActor();
+    CHECK(scene.SetParent(b, a));
+    CHECK(scene.SetParent(c, b));
+    CHECK(!scene.SetParent(a, c));
+    CHECK(!scene.SetParent(a, a));
+    CHECK(!scene.IsValid(scene.GetParent(a)));
+
+    // Reparenting moves the child between the two lists.
+    CHECK(scene.SetParent(c, a));
+    CHECK(scene.GetChildren(b).empty());
+    CHECK(scene.GetChildren(a).size() == 2);
+    CHECK(scene.SetParent(c, {}));
+    CHECK(scene.GetChildren(a).size() == 1);
+}
+
+TEST(Scene, StaleHandlesAreIgnored)
+{
+    Scene scene(nullptr);
+    const auto parent = scene.CreateActor();
+    const auto stale = scene.CreateActor();
+    scene.DestroyActor(stale);
+    const auto reused = scene.CreateActor();
+    CHECK(reused.index == stale.index);
+
+    // Writes through the stale handle must not land on the actor that now owns the slot.
+    scene.SetTransform(stale, { .position = glm::vec3(5.f) });
+    CHECK(!scene.SetParent(stale, parent));
+    CHECK(scene.GetTransform(reused).position == glm::vec3(0.f));
+    CHECK(!scene.IsValid(scene.GetParent(reused)));
+    CHECK(scene.GetChildren(parent).empty());
+}
+
+TEST(Scene, BatchedMatricesMatchTransforms)
+{
+    // Enough roots for several full batches plus a scalar tail, with angles well outside [-pi, pi].
+    Scene scene(nullptr);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> angle(-20.f, 20.f);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    std::vector<ActorHandle> actors;
+    for (uint32_t i = 0; i < 103; ++i)
+    {
+        actors.push_back(scene.CreateActor());
+        scene.SetTransform(actors.back(),
+                           { .position = glm::vec3(unit(rng), unit(rng), unit(rng)) * 100.f,
+                             .rotation = glm::vec3(angle(rng), angle(rng), angle(rng)),
+                             .scale = glm::vec3(1.5f + unit(rng), 1.5f + unit(rng), 1.5f + unit(rng)) });
+    }
+    // A child per root checks the products against glm's.
+    std::vector<ActorHandle> children;
+    for (const auto actor : actors)
+    {
+        children.push_back(scene.CreateActor());
+        scene.SetTransform(children.back(), { .position = glm::vec3(1.f, 2.f, 3.f), .rotation = glm::vec3(0.3f, -0.2f, 1.f) });
+        CHECK(scene.SetParent(children.back(), actor));
+    }
+    scene.Update();
+
+    float max_error = 0.f;
+    for (size_t i = 0; i < actors.size(); ++i)
+    {
+        const glm::mat4 local = scene.GetTransform(actors[i]).ToMatrix();
+        const glm::mat4 child = local * scene.GetTransform(children[i]).ToMatrix();
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                const float local_error = std::abs(scene.GetWorldMatrix(actors[i])[column][row] - local[column][row]);
+                const float child_error = std::abs(scene.GetWorldMatrix(children[i])[column][row] - child[column][row]);
+                max_error = std::max({ max_error, local_error, child_error });
+            }
+        }
+    }
+    CHECK(max_error < 1e-3f);
+}
+
+TEST(Scene, InterpolationKeepsScaleWhileRotating)
+{
+    const glm::mat4 from = Transform{ .position = glm::vec3(0.f), .scale = glm::vec3(2.f) }.ToMatrix();
+    const glm::mat4 to = Transform{ .position = glm::vec3(4.f, 0.f, 0.f),
+                                    .rotation = glm::vec3(0.f, glm::half_pi<float>(), 0.f),
+                                    .scale = glm::vec3(2.f) }
+                             .ToMatrix();
+    const Pose from_pose = Pose::FromMatrix(from);
+    const Pose to_pose = Pose::FromMatrix(to);
+    const glm::mat4 start = Pose::Blend(from_pose, to_pose, 0.f);
+    const glm::mat4 end = Pose::Blend(from_pose, to_pose, 1.f);
+    const glm::mat4 middle = Pose::Blend(from_pose, to_pose, 0.5f);
+    for (int column = 0; column < 4; ++column)
+    {
+        CHECK(Near(glm::vec3(start[column]), glm::vec3(from[column])));
+        CHECK(Near(glm::vec3(end[column]), glm::vec3(to[column])));
+    }
+    // Halfway through a quarter turn, a plain lerp would have shrunk the axes to about 1.41.
+    CHECK_NEAR(glm::length(glm::vec3(middle[0])), 2.f, 1e-4f);
+    CHECK_NEAR(glm::length(glm::vec3(middle[2])), 2.f, 1e-4f);
+    CHECK(Near(glm::vec3(middle[0]) / 2.f, glm::vec3(std::cos(glm::quarter_pi<float>()), 0.f, -std::sin(glm::quarter_pi<float>()))));
+    CHECK(Near(glm::vec3(middle[3]), glm::vec3(2.f, 0.f, 0.f)));
+}
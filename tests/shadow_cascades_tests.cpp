@@ -0,0 +1,202 @@
+#include "shadow_cascades.hpp"
+#include "test.hpp"
+
+namespace
+{
+    const glm::vec3 SUN_DIRECTION = glm::normalize(glm::vec3(0.3f, -1.f, 0.2f));
+
+    Camera CreateCamera(const glm::vec3& position, const glm::vec3& target)
+    {
+        Camera camera(nullptr);
+        camera.m_near_plane = 0.1f;
+        camera.m_far_plane = 500.f;
+        camera.m_view_matrix = glm::lookAtRH(position, target, glm::vec3(0.f, 1.f, 0.f));
+        return camera;
+    }
+
+    // World space corners of the camera slice between two view depths.
+    std::array<glm::vec3, 8> GetSliceCorners(const Camera& camera, const float near_depth, const float far_depth)
+    {
+        const glm::mat4 inv_view = glm::inverse(camera.m_view_matrix);
+        const float tan_y = std::tan(camera.m_fov * 0.5f);
+        const float tan_x = tan_y * camera.m_aspect_ratio;
+        std::array<glm::vec3, 8> corners;
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            const float depth = i & 4 ? far_depth : near_depth;
+            const glm::vec4 point((i & 1 ? 1.f : -1.f) * depth * tan_x, (i & 2 ? 1.f : -1.f) * depth * tan_y, -depth, 1.f);
+            corners[i] = glm::vec3(inv_view * point);
+        }
+        return corners;
+    }
+
+    bool IsInsideClip(const glm::mat4& view_proj, const glm::vec3& point)
+    {
+        const glm::vec4 clip = view_proj * glm::vec4(point, 1.f);
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        constexpr float epsilon = 1e-4f;
+        return std::abs(ndc.x) <= 1.f + epsilon && std::abs(ndc.y) <= 1.f + epsilon && ndc.z >= -epsilon &&
+               ndc.z <= 1.f + epsilon;
+    }
+} // namespace
+
+TEST(ShadowCascades, SplitsBlendUniformAndLogarithmic)
+{
+    std::array<float, 4> uniform{};
+    std::array<float, 4> logarithmic{};
+    std::array<float, 4> practical{};
+    ShadowCascades::ComputeSplits(1.f, 1000.f, 0.f, uniform);
+    ShadowCascades::ComputeSplits(1.f, 1000.f, 1.f, logarithmic);
+    ShadowCascades::ComputeSplits(1.f, 1000.f, 0.5f, practical);
+    CHECK_NEAR(uniform[0], 250.75f, 1e-3f);
+    CHECK_NEAR(uniform[1], 500.5f, 1e-3f);
+    CHECK_NEAR(logarithmic[0], std::pow(1000.f, 0.25f), 1e-3f);
+    CHECK_NEAR(logarithmic[2], std::pow(1000.f, 0.75f), 1e-2f);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        CHECK_NEAR(practical[i], (uniform[i] + logarithmic[i]) * 0.5f, 1e-2f);
+        if (i > 0)
+        {
+            CHECK(practical[i] > practical[i - 1]);
+        }
+    }
+    // The last split is exactly the far plane whatever the blend.
+    CHECK(uniform[3] == 1000.f);
+    CHECK(logarithmic[3] == 1000.f);
+    CHECK(practical[3] == 1000.f);
+}
+
+TEST(ShadowCascades, SettingsAreClamped)
+{
+    ShadowCascades cascades;
+    cascades.SetSettings({ .count = 0, .lambda = 2.f, .resolution = 1 });
+    CHECK(cascades.GetSettings().count == 1);
+    CHECK(cascades.GetSettings().lambda == 1.f);
+    CHECK(cascades.GetSettings().resolution == 16);
+    cascades.SetSettings({ .count = 9, .lambda = -1.f });
+    CHECK(cascades.GetSettings().count == ShadowCascades::MAX_CASCADES);
+    CHECK(cascades.GetSettings().lambda == 0.f);
+
+    // Shadows stop at the maximum distance rather than the far plane.
+    cascades.SetSettings({ .count = 3, .max_distance = 120.f });
+    cascades.Fit(CreateCamera(glm::vec3(0.f, 2.f, 0.f), glm::vec3(0.f, 2.f, -1.f)), SUN_DIRECTION, BoundingBox{});
+    const auto fitted = cascades.GetCascades();
+    CHECK(fitted.size() == 3);
+    CHECK(fitted.back().split_depth == 120.f);
+    CHECK(fitted.front().near_depth == 0.1f);
+    for (uint32_t i = 1; i < fitted.size(); ++i)
+    {
+        CHECK(fitted[i].near_depth == fitted[i - 1].split_depth);
+    }
+
+    cascades.Reset();
+    CHECK(cascades.GetCascades().empty());
+}
+
+TEST(ShadowCascades, CascadesCoverTheirSlices)
+{
+    // Cameras looking every which way, every corner of each slice must land inside its cascade's projection and sphere.
+    ShadowCascades cascades;
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    bool covered = true;
+    for (uint32_t i = 0; i < 50; ++i)
+    {
+        const glm::vec3 position(unit(rng) * 100.f, 2.f + unit(rng), unit(rng) * 100.f);
+        const glm::vec3 forward(unit(rng), unit(rng) * 0.5f, unit(rng));
+        if (glm::length(forward) < 0.1f) continue;
+        const Camera camera = CreateCamera(position, position + forward);
+        cascades.Fit(camera, SUN_DIRECTION, BoundingBox{});
+        for (const auto& cascade : cascades.GetCascades())
+        {
+            for (const auto& corner : GetSliceCorners(camera, cascade.near_depth, cascade.split_depth))
+            {
+                covered &= IsInsideClip(cascade.view_proj, corner);
+                covered &= glm::length(corner - cascade.bounds.center) <= cascade.bounds.radius * (1.f + 1e-4f);
+            }
+        }
+    }
+    CHECK(covered);
+}
+
+TEST(ShadowCascades, RotatingKeepsTheSize)
+{
+    // The spheres only depend on the projection, so turning the camera in place never changes a radius.
+    ShadowCascades cascades;
+    const glm::vec3 position(5.f, 2.f, -3.f);
+    cascades.Fit(CreateCamera(position, position + glm::vec3(0.f, 0.f, -1.f)), SUN_DIRECTION, BoundingBox{});
+    const auto first = cascades.GetCascades();
+    std::array<float, ShadowCascades::MAX_CASCADES> radii{};
+    for (uint32_t i = 0; i < first.size(); ++i)
+    {
+        radii[i] = first[i].bounds.radius;
+    }
+
+    bool same = true;
+    for (const float angle : { 0.3f, 1.f, 2.5f, 4.f })
+    {
+        const glm::vec3 forward(std::sin(angle), 0.2f, -std::cos(angle));
+        cascades.Fit(CreateCamera(position, position + forward), SUN_DIRECTION, BoundingBox{});
+        const auto rotated = cascades.GetCascades();
+        for (uint32_t i = 0; i < rotated.size(); ++i)
+        {
+            same &= rotated[i].bounds.radius == radii[i];
+        }
+    }
+    CHECK(same);
+}
+
+TEST(ShadowCascades, MovingShiftsByWholeTexels)
+{
+    // The map spans resolution texels over NDC [-1, 1], so a fixed world point must move by whole texels.
+    ShadowCascades cascades;
+    const auto resolution = static_cast<float>(cascades.GetSettings().resolution);
+    const glm::vec3 probe(1.f, 0.f, -7.f);
+    const glm::vec3 forward(0.f, -0.2f, -1.f);
+    const glm::vec3 start(0.f, 2.f, 0.f);
+    cascades.Fit(CreateCamera(start, start + forward), SUN_DIRECTION, BoundingBox{});
+    std::array<glm::vec2, ShadowCascades::MAX_CASCADES> previous{};
+    for (uint32_t i = 0; i < cascades.GetCascades().size(); ++i)
+    {
+        previous[i] = glm::vec2(cascades.GetCascades()[i].view_proj * glm::vec4(probe, 1.f));
+    }
+
+    float worst = 0.f;
+    for (uint32_t step = 1; step <= 20; ++step)
+    {
+        const glm::vec3 position = start + glm::vec3(0.037f, 0.f, -0.051f) * static_cast<float>(step);
+        cascades.Fit(CreateCamera(position, position + forward), SUN_DIRECTION, BoundingBox{});
+        for (uint32_t i = 0; i < cascades.GetCascades().size(); ++i)
+        {
+            const glm::vec2 ndc = glm::vec2(cascades.GetCascades()[i].view_proj * glm::vec4(probe, 1.f));
+            const glm::vec2 texels = (ndc - previous[i]) * resolution * 0.5f;
+            worst = std::max({ worst,
+                               std::abs(texels.x - std::round(texels.x)),
+                               std::abs(texels.y - std::round(texels.y)) });
+        }
+    }
+    CHECK(worst < 0.01f);
+}
+
+TEST(ShadowCascades, CastersTowardTheSunStayInDepthRange)
+{
+    // A tall caster well outside the camera's slices, between them and the sun. Its shadow can still fall into view, so
+    // every cascade's depth range has to reach back to it.
+    ShadowCascades cascades;
+    const Camera camera = CreateCamera(glm::vec3(0.f, 2.f, 0.f), glm::vec3(0.f, 2.f, -1.f));
+    const glm::vec3 caster_center = glm::vec3(0.f, 0.f, -20.f) - SUN_DIRECTION * 150.f;
+    const BoundingBox casters{ .min = caster_center - glm::vec3(2.f), .max = caster_center + glm::vec3(2.f) };
+    cascades.Fit(camera, SUN_DIRECTION, casters);
+    bool in_range = true;
+    for (const auto& cascade : cascades.GetCascades())
+    {
+        const glm::vec4 clip = cascade.view_proj * glm::vec4(caster_center, 1.f);
+        in_range &= clip.z >= 0.f && clip.z <= 1.f;
+    }
+    CHECK(in_range);
+
+    // Without the casters the nearest cascade starts at its own sphere and would have clipped the caster.
+    cascades.Fit(camera, SUN_DIRECTION, BoundingBox{});
+    const glm::vec4 clip = cascades.GetCascades().front().view_proj * glm::vec4(caster_center, 1.f);
+    CHECK(clip.z < 0.f);
+}
@@ -0,0 +1,241 @@
+#include "shadow_tile_cache.hpp"
+#include "test.hpp"
+
+namespace
+{
+    constexpr uint32_t RESOLUTION = 2048;
+    const BoundingBox CASTERS{ .min = glm::vec3(-100.f), .max = glm::vec3(100.f) };
+
+    // Cascades doubling in size around one point. The light looks down -z so light space is world xy, and at this
+    // resolution a tile is half a radius wide, 4 m for the first cascade.
+    std::vector<ShadowCascade> CreateCascades(const glm::vec2 center)
+    {
+        std::vector<ShadowCascade> cascades;
+        for (uint32_t i = 0; i < ShadowCascades::MAX_CASCADES; ++i)
+        {
+            const float radius = 8.f * static_cast<float>(1 << i);
+            cascades.push_back({ .bounds = { .center = glm::vec3(center.x, center.y, 0.f), .radius = radius } });
+        }
+        return cascades;
+    }
+
+    uint32_t GetSlot(const ShadowTileCache& cache, const uint32_t level, const glm::ivec2 coord)
+    {
+        const glm::ivec2 offset = coord - cache.GetLevels()[level].origin;
+        return level * ShadowTileCache::WINDOW_TILES + offset.y * ShadowTileCache::WINDOW + offset.x;
+    }
+
+    // Frames of full budget until every tile the cascades need is resident, returns how many it took.
+    uint32_t Fill(ShadowTileCache& cache, const glm::mat4& light_view, const std::vector<ShadowCascade>& cascades)
+    {
+        for (uint32_t frame = 1; frame <= 20; ++frame)
+        {
+            cache.BeginFrame(light_view, cascades, RESOLUTION, CASTERS);
+            cache.Schedule(ShadowTileCache::MAX_RENDERS);
+            if (cache.GetStats().missing == 0) return frame;
+        }
+        return 0;
+    }
+
+    struct ResidentTile
+    {
+        uint32_t level;
+        glm::ivec2 coord;
+        uint32_t page;
+    };
+
+    std::vector<ResidentTile> GetResidentTiles(const ShadowTileCache& cache)
+    {
+        std::vector<ResidentTile> tiles;
+        const auto levels = cache.GetLevels();
+        const auto page_table = cache.GetPageTable();
+        for (uint32_t level = 0; level < levels.size(); ++level)
+        {
+            for (uint32_t slot = 0; slot < ShadowTileCache::WINDOW_TILES; ++slot)
+            {
+                const uint32_t page = page_table[level * ShadowTileCache::WINDOW_TILES + slot];
+                if (page == ShadowTileCache::NO_PAGE) continue;
+                const glm::ivec2 offset(slot % ShadowTileCache::WINDOW, slot / ShadowTileCache::WINDOW);
+                tiles.push_back({ .level = level, .coord = levels[level].origin + offset, .page = page });
+            }
+        }
+        return tiles;
+    }
+} // namespace
+
+TEST(ShadowTileCache, SchedulesNearestCascadeFirst)
+{
+    ShadowTileCache cache;
+    const glm::mat4 light_view(1.f);
+    const auto cascades = CreateCascades(glm::vec2(2.f));
+    cache.BeginFrame(light_view, cascades, RESOLUTION, CASTERS);
+    cache.Schedule(ShadowTileCache::MAX_RENDERS);
+
+    // Every cascade needs a full 5x5 window, the first frame only gets to the nearest one.
+    const ShadowTileStats stats = cache.GetStats();
+    CHECK(stats.requested == ShadowCascades::MAX_CASCADES * ShadowTileCache::WINDOW_TILES);
+    CHECK(stats.redrawn == ShadowTileCache::MAX_RENDERS);
+    CHECK(stats.missing == stats.requested - stats.redrawn);
+    CHECK(std::ranges::all_of(cache.GetRenders(), [](const ShadowTileRender& render) { return render.level == 0; }));
+
+    // The page table points every drawn tile's slot at the page it was drawn into.
+    bool mapped = true;
+    for (const auto& render : cache.GetRenders())
+    {
+        mapped &= cache.GetPageTable()[GetSlot(cache, render.level, render.coord)] == render.page;
+    }
+    CHECK(mapped);
+
+    // The rest arrives a budget at a time, after which nothing is drawn again.
+    const uint32_t frames = Fill(cache, light_view, cascades);
+    CHECK(frames == (stats.missing + ShadowTileCache::MAX_RENDERS - 1) / ShadowTileCache::MAX_RENDERS);
+    cache.BeginFrame(light_view, cascades, RESOLUTION, CASTERS);
+    cache.Schedule(ShadowTileCache::MAX_RENDERS);
+    CHECK(cache.GetRenders().empty());
+    CHECK(cache.GetStats().resident == ShadowCascades::MAX_CASCADES * ShadowTileCache::WINDOW_TILES);
+}
+
+TEST(ShadowTileCache, PagesHaveTheirOwnAtlasRect)
+{
+    ShadowTileCache cache;
+    CHECK(Fill(cache, glm::mat4(1.f), CreateCascades(glm::vec2(2.f))) > 0);
+    const auto tiles = GetResidentTiles(cache);
+    CHECK(tiles.size() == ShadowCascades::MAX_CASCADES * ShadowTileCache::WINDOW_TILES);
+
+    // No page backs two slots, and no two pages overlap in the atlas.
+    std::vector<glm::uvec2> origins;
+    bool inside = true;
+    for (const auto& tile : tiles)
+    {
+        const glm::uvec2 origin = ShadowTileCache::GetPageOrigin(tile.page);
+        inside &= origin.x % ShadowTileCache::TILE_RESOLUTION == 0 && origin.y % ShadowTileCache::TILE_RESOLUTION == 0;
+        inside &= origin.x + ShadowTileCache::TILE_RESOLUTION <= ShadowTileCache::ATLAS_WIDTH;
+        inside &= origin.y + ShadowTileCache::TILE_RESOLUTION <= ShadowTileCache::ATLAS_HEIGHT;
+        origins.push_back(origin);
+    }
+    CHECK(inside);
+    std::ranges::sort(origins,
+                      [](const glm::uvec2 a, const glm::uvec2 b) { return std::tie(a.y, a.x) < std::tie(b.y, b.x); });
+    CHECK(std::ranges::adjacent_find(origins) == origins.end());
+
+    // The last page still fits.
+    const glm::uvec2 last = ShadowTileCache::GetPageOrigin(ShadowTileCache::PAGE_COUNT - 1);
+    CHECK(last.y + ShadowTileCache::TILE_RESOLUTION <= ShadowTileCache::ATLAS_HEIGHT);
+}
+
+TEST(ShadowTileCache, MovingKeepsResidentTiles)
+{
+    // Moving one first cascade tile along x slides the windows. Tiles still inside one keep their page under a new slot
+    // and only the tiles entering are drawn.
+    ShadowTileCache cache;
+    const glm::mat4 light_view(1.f);
+    CHECK(Fill(cache, light_view, CreateCascades(glm::vec2(2.f))) > 0);
+    const auto before = GetResidentTiles(cache);
+
+    cache.BeginFrame(light_view, CreateCascades(glm::vec2(6.f, 2.f)), RESOLUTION, CASTERS);
+    cache.Schedule(ShadowTileCache::MAX_RENDERS);
+    const auto levels = cache.GetLevels();
+    bool kept = true;
+    uint32_t still_needed = 0;
+    for (const auto& tile : before)
+    {
+        const glm::ivec2 offset = tile.coord - levels[tile.level].origin;
+        const glm::ivec2 count = levels[tile.level].count;
+        if (offset.x < 0 || offset.y < 0 || offset.x >= count.x || offset.y >= count.y) continue;
+        ++still_needed;
+        kept &= cache.GetPageTable()[GetSlot(cache, tile.level, tile.coord)] == tile.page;
+    }
+    CHECK(kept);
+
+    bool only_new = true;
+    for (const auto& render : cache.GetRenders())
+    {
+        only_new &= std::ranges::none_of(before,
+                                         [&](const ResidentTile& tile)
+                                         { return tile.level == render.level && tile.coord == render.coord; });
+    }
+    CHECK(only_new);
+    // The first cascade gains a column of five.
+    CHECK(cache.GetRenders().size() >= ShadowTileCache::WINDOW);
+    CHECK(cache.GetStats().requested + still_needed == ShadowCascades::MAX_CASCADES * ShadowTileCache::WINDOW_TILES);
+}
+
+TEST(ShadowTileCache, InvalidateRedrawsInPlace)
+{
+    ShadowTileCache cache;
+    const glm::mat4 light_view(1.f);
+    const auto cascades = CreateCascades(glm::vec2(2.f));
+    CHECK(Fill(cache, light_view, cascades) > 0);
+    const std::vector<uint32_t> page_table(cache.GetPageTable().begin(), cache.GetPageTable().end());
+
+    // A small caster inside one tile of every cascade.
+    cache.Invalidate({ .min = glm::vec3(0.5f, 0.5f, -1.f), .max = glm::vec3(1.5f, 1.5f, 1.f) });
+    cache.BeginFrame(light_view, cascades, RESOLUTION, CASTERS);
+    CHECK(cache.GetStats().invalidated == ShadowCascades::MAX_CASCADES);
+    cache.Schedule(ShadowTileCache::MAX_RENDERS);
+
+    // The dirty tiles are drawn again into the pages they already had.
+    CHECK(cache.GetRenders().size() == ShadowCascades::MAX_CASCADES);
+    bool in_place = true;
+    for (const auto& render : cache.GetRenders())
+    {
+        in_place &= render.coord == glm::ivec2(0);
+        in_place &= page_table[GetSlot(cache, render.level, render.coord)] == render.page;
+    }
+    CHECK(in_place);
+    CHECK(std::ranges::equal(cache.GetPageTable(), page_table));
+
+    // Boxes outside every resident tile and invalid boxes change nothing.
+    cache.Invalidate({ .min = glm::vec3(900.f), .max = glm::vec3(901.f) });
+    cache.Invalidate(BoundingBox{});
+    cache.BeginFrame(light_view, cascades, RESOLUTION, CASTERS);
+    cache.Schedule(ShadowTileCache::MAX_RENDERS);
+    CHECK(cache.GetStats().invalidated == 0);
+    CHECK(cache.GetRenders().empty());
+}
+
+TEST(ShadowTileCache, LightOrDepthRangeChangesDropEverything)
+{
+    ShadowTileCache cache;
+    const auto cascades = CreateCascades(glm::vec2(2.f));
+    CHECK(Fill(cache, glm::mat4(1.f), cascades) > 0);
+    const glm::mat4 turned = glm::rotate(glm::mat4(1.f), 0.1f, glm::vec3(1.f, 0.f, 0.f));
+    cache.BeginFrame(turned, cascades, RESOLUTION, CASTERS);
+    CHECK(GetResidentTiles(cache).empty());
+
+    // A caster moving inside the snapped depth range keeps the tiles, one leaving it drops them.
+    CHECK(Fill(cache, turned, cascades) > 0);
+    const BoundingBox nudged{ .min = CASTERS.min + 1.f, .max = CASTERS.max + 1.f };
+    cache.BeginFrame(turned, cascades, RESOLUTION, nudged);
+    CHECK(GetResidentTiles(cache).size() == ShadowCascades::MAX_CASCADES * ShadowTileCache::WINDOW_TILES);
+    const BoundingBox taller{ .min = CASTERS.min, .max = CASTERS.max + glm::vec3(0.f, 0.f, 50.f) };
+    cache.BeginFrame(turned, cascades, RESOLUTION, taller);
+    CHECK(GetResidentTiles(cache).empty());
+}
+
+TEST(ShadowTileCache, EvictsTilesNoLongerNeeded)
+{
+    // Jumping to places far apart needs new tiles every time, the pool never grows and old tiles make room.
+    ShadowTileCache cache;
+    const glm::mat4 light_view(1.f);
+    uint32_t evicted = 0;
+    bool filled = true;
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        const auto cascades = CreateCascades(glm::vec2(1000.f * static_cast<float>(i), 2.f));
+        for (uint32_t frame = 0; frame < 10; ++frame)
+        {
+            cache.BeginFrame(light_view, cascades, RESOLUTION, CASTERS);
+            cache.Schedule(ShadowTileCache::MAX_RENDERS);
+            evicted += cache.GetStats().evicted;
+            if (cache.GetStats().missing == 0) break;
+        }
+        filled &= cache.GetStats().missing == 0;
+        filled &= cache.GetStats().resident <= ShadowTileCache::PAGE_COUNT;
+    }
+    CHECK(filled);
+    CHECK(evicted > 0);
+
+    // Only the current place's tiles are in the page table.
+    CHECK(GetResidentTiles(cache).size() == ShadowCascades::MAX_CASCADES * ShadowTileCache::WINDOW_TILES);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Tests register themselves under a suite, EngineTests runs every suite or only the one named by its first argument.
+struct TestCase
+{
+    std::string_view suite;
+    std::string_view name;
+    void (*function)();
+};
+
+std::vector<TestCase>& GetTestCases();
+void ReportFailure(std::string_view expression, std::string_view file, int line);
+
+struct TestRegistrar
+{
+    explicit TestRegistrar(const TestCase& test_case) { GetTestCases().push_back(test_case); }
+};
+
+#define TEST(suite, name)                                                                                              \
+    static void suite##name##Test();                                                                                   \
+    static const TestRegistrar suite##name##Registrar({ #suite, #name, &suite##name##Test });                          \
+    static void suite##name##Test()
+
+// Failing checks are reported and the test carries on, so one run shows every broken expectation.
+#define CHECK(expression)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(expression)) ReportFailure(#expression, __FILE__, __LINE__);                                             \
+    } while (false)
+
+#define CHECK_NEAR(a, b, epsilon) CHECK(std::abs((a) - (b)) <= (epsilon))
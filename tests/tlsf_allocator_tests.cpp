@@ -0,0 +1,117 @@
+#include "test.hpp"
+#include "tlsf_allocator.hpp"
+
+TEST(Tlsf, AllocationsFitAndAreTracked)
+{
+    TlsfAllocator allocator(1000);
+    const auto a = allocator.Allocate(100);
+    const auto b = allocator.Allocate(250);
+    const auto c = allocator.Allocate(1);
+    CHECK(a && b && c);
+    CHECK(a->offset + a->size <= b->offset || b->offset + b->size <= a->offset);
+    CHECK(allocator.GetFreeSize() == 649);
+    CHECK(allocator.GetAllocationCount() == 3);
+
+    CHECK(!allocator.Allocate(0));
+    CHECK(!allocator.Allocate(650));
+    // Whatever is left is one block, so all of it can still be taken at once.
+    CHECK(allocator.GetLargestFreeBlock() == 649);
+    CHECK(allocator.Allocate(649));
+    CHECK(allocator.GetFreeSize() == 0);
+    CHECK(!allocator.Allocate(1));
+}
+
+TEST(Tlsf, FreeMergesNeighbours)
+{
+    TlsfAllocator allocator(300);
+    const auto a = allocator.Allocate(100);
+    const auto b = allocator.Allocate(100);
+    const auto c = allocator.Allocate(100);
+    CHECK(a && b && c);
+
+    // Freeing the outer blocks leaves two holes that can't hold 200 together.
+    allocator.Free(*a);
+    allocator.Free(*c);
+    CHECK(allocator.GetFreeSize() == 200);
+    CHECK(allocator.GetLargestFreeBlock() == 100);
+    CHECK(!allocator.Allocate(200));
+
+    // The middle one joins both of them back into the whole range.
+    allocator.Free(*b);
+    CHECK(allocator.GetAllocationCount() == 0);
+    CHECK(allocator.GetLargestFreeBlock() == 300);
+    const auto whole = allocator.Allocate(300);
+    CHECK(whole && whole->offset == 0);
+}
+
+TEST(Tlsf, BlocksInTheirOwnBinAreFound)
+{
+    // 100 falls between the bin edges, so the rounded up search skips its bin and only the walk of that bin finds it.
+    TlsfAllocator allocator(100);
+    CHECK(allocator.Allocate(100));
+
+    TlsfAllocator smaller(100);
+    const auto block = smaller.Allocate(99);
+    CHECK(block && block->offset == 0);
+    CHECK(smaller.GetLargestFreeBlock() == 1);
+}
+
+TEST(Tlsf, RandomChurnNeverOverlaps)
+{
+    // Random sizes spanning small and large bins, allocated and freed in random order. Every element is owned by at
+    // most one allocation and the free size always matches what isn't owned.
+    constexpr uint32_t size = 1 << 16;
+    TlsfAllocator allocator(size);
+    std::vector<uint8_t> owned(size, 0);
+    std::vector<TlsfAllocation> live;
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<uint32_t> small(1, 64);
+    std::uniform_int_distribution<uint32_t> large(65, 4096);
+    uint32_t owned_size = 0;
+    bool overlap = false;
+    uint32_t failures = 0;
+    for (uint32_t i = 0; i < 20'000; ++i)
+    {
+        if (!live.empty() && rng() % 5 < 2)
+        {
+            const uint32_t index = rng() % live.size();
+            const auto allocation = live[index];
+            std::fill_n(owned.begin() + allocation.offset, allocation.size, uint8_t(0));
+            owned_size -= allocation.size;
+            allocator.Free(allocation);
+            live[index] = live.back();
+            live.pop_back();
+            continue;
+        }
+
+        const uint32_t request = rng() % 4 == 0 ? large(rng) : small(rng);
+        const auto allocation = allocator.Allocate(request);
+        if (!allocation)
+        {
+            ++failures;
+            // Only refused when no single free block is big enough.
+            overlap |= allocator.GetLargestFreeBlock() >= request;
+            continue;
+        }
+        overlap |= allocation->size != request || allocation->offset + allocation->size > size;
+        for (uint32_t element = allocation->offset; element < allocation->offset + allocation->size; ++element)
+        {
+            overlap |= owned[element] != 0;
+            owned[element] = 1;
+        }
+        owned_size += allocation->size;
+        live.push_back(*allocation);
+    }
+    CHECK(!overlap);
+    CHECK(failures > 0);
+    CHECK(allocator.GetFreeSize() == size - owned_size);
+    CHECK(allocator.GetAllocationCount() == live.size());
+
+    // With everything freed the neighbours have merged back into one block.
+    for (const auto& allocation : live)
+    {
+        allocator.Free(allocation);
+    }
+    CHECK(allocator.GetFreeSize() == size);
+    CHECK(allocator.GetLargestFreeBlock() == size);
+}
@@ -0,0 +1,170 @@
+#include "test.hpp"
+#include "transient_planner.hpp"
+
+namespace
+{
+    bool Overlaps(const TransientTexture& a, const TransientTexture& b)
+    {
+        return a.first_pass <= b.last_pass && b.first_pass <= a.last_pass;
+    }
+
+    // Textures in one block never live at the same time and every block holds its largest texture.
+    bool IsValidPlan(const TransientPlanner& planner)
+    {
+        const auto textures = planner.GetTextures();
+        const auto blocks = planner.GetBlockSizes();
+        for (uint32_t i = 0; i < textures.size(); ++i)
+        {
+            const auto& texture = textures[i];
+            if (texture.first_pass == TransientPlanner::NONE)
+            {
+                if (texture.block != TransientPlanner::NONE) return false;
+                continue;
+            }
+            if (texture.block >= blocks.size() || blocks[texture.block] < texture.size) return false;
+            for (uint32_t j = i + 1; j < textures.size(); ++j)
+            {
+                if (textures[j].block == texture.block && Overlaps(texture, textures[j])) return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+TEST(TransientPlanner, DisjointLifetimesShareBlocks)
+{
+    // A chain of passes each reading what the one before wrote, like a post process chain.
+    TransientPlanner planner;
+    const uint32_t a = planner.AddTexture("A", 4 * TransientPlanner::ALIGNMENT);
+    const uint32_t b = planner.AddTexture("B", 2 * TransientPlanner::ALIGNMENT);
+    const uint32_t c = planner.AddTexture("C", 3 * TransientPlanner::ALIGNMENT);
+    planner.AddPass("Write A").Write(a);
+    planner.AddPass("A to B").Read(a).Write(b);
+    planner.AddPass("B to C").Read(b).Write(c);
+    planner.AddPass("Read C").Read(c);
+    planner.Plan();
+    CHECK(IsValidPlan(planner));
+
+    // A dies before C is written, so they alias and the block is as big as A.
+    const auto textures = planner.GetTextures();
+    CHECK(textures[a].block == textures[c].block);
+    CHECK(textures[a].block != textures[b].block);
+    const auto& report = planner.GetReport();
+    CHECK(report.block_count == 2);
+    CHECK(report.unaliased_bytes == 9 * TransientPlanner::ALIGNMENT);
+    CHECK(report.aliased_bytes == 6 * TransientPlanner::ALIGNMENT);
+    CHECK(report.GetSavedBytes() == 3 * TransientPlanner::ALIGNMENT);
+}
+
+TEST(TransientPlanner, SizesAreAligned)
+{
+    TransientPlanner planner;
+    const uint32_t small = planner.AddTexture("Small", 1);
+    const uint32_t exact = planner.AddTexture("Exact", TransientPlanner::ALIGNMENT);
+    const uint32_t over = planner.AddTexture("Over", TransientPlanner::ALIGNMENT + 1);
+    CHECK(planner.GetTextures()[small].size == TransientPlanner::ALIGNMENT);
+    CHECK(planner.GetTextures()[exact].size == TransientPlanner::ALIGNMENT);
+    CHECK(planner.GetTextures()[over].size == 2 * TransientPlanner::ALIGNMENT);
+}
+
+TEST(TransientPlanner, ReadBeforeWriteLivesAllFrame)
+{
+    // History is read by the first pass and written by the middle one, so last frame's contents must survive until
+    // then and this frame's until the next, nothing may alias it.
+    TransientPlanner planner;
+    const uint32_t history = planner.AddTexture("History", TransientPlanner::ALIGNMENT);
+    const uint32_t early = planner.AddTexture("Early", TransientPlanner::ALIGNMENT);
+    const uint32_t late = planner.AddTexture("Late", TransientPlanner::ALIGNMENT);
+    const uint32_t unused = planner.AddTexture("Unused", TransientPlanner::ALIGNMENT);
+    planner.AddPass("First").Read(history).Write(early);
+    planner.AddPass("Second").Read(early).Write(history);
+    planner.AddPass("Third").Write(late);
+    planner.AddPass("Fourth").Read(late);
+    planner.Plan();
+    CHECK(IsValidPlan(planner));
+
+    const auto textures = planner.GetTextures();
+    CHECK(textures[history].persistent);
+    CHECK(textures[history].first_pass == 0);
+    CHECK(textures[history].last_pass == 3);
+    CHECK(!textures[early].persistent);
+    CHECK(textures[early].block == textures[late].block);
+    CHECK(textures[history].block != textures[late].block);
+
+    // Textures no pass touches take no block but still count towards what the frame would need without aliasing.
+    CHECK(textures[unused].block == TransientPlanner::NONE);
+    CHECK(planner.GetReport().unused_textures == 1);
+    CHECK(planner.GetReport().block_count == 2);
+    CHECK(planner.GetReport().unaliased_bytes == 4 * TransientPlanner::ALIGNMENT);
+}
+
+TEST(TransientPlanner, BiggerTexturesOpenBlocks)
+{
+    // Both start together, the bigger one opens the first block. The late texture then reuses the big block rather
+    // than growing the small one.
+    TransientPlanner planner;
+    const uint32_t small = planner.AddTexture("Small", TransientPlanner::ALIGNMENT);
+    const uint32_t big = planner.AddTexture("Big", 8 * TransientPlanner::ALIGNMENT);
+    const uint32_t late = planner.AddTexture("Late", 4 * TransientPlanner::ALIGNMENT);
+    planner.AddPass("Both").Write(small).Write(big);
+    planner.AddPass("Late").Write(late);
+    planner.Plan();
+    CHECK(IsValidPlan(planner));
+    CHECK(planner.GetTextures()[big].block == 0);
+    CHECK(planner.GetTextures()[late].block == planner.GetTextures()[big].block);
+    CHECK(planner.GetReport().aliased_bytes == 9 * TransientPlanner::ALIGNMENT);
+}
+
+TEST(TransientPlanner, RandomPassListsUseFewestBlocks)
+{
+    // Random frames of passes touching random textures. Colouring intervals by start is optimal, so the block count
+    // must equal the most textures alive in any one pass.
+    std::mt19937 rng(13);
+    TransientPlanner planner;
+    bool valid = true;
+    bool fewest = true;
+    for (uint32_t frame = 0; frame < 200; ++frame)
+    {
+        planner.Reset();
+        const uint32_t texture_count = 1 + rng() % 24;
+        const uint32_t pass_count = 1 + rng() % 16;
+        for (uint32_t i = 0; i < texture_count; ++i)
+        {
+            planner.AddTexture("Texture", (1 + rng() % 64) * 1024 * 16);
+        }
+        for (uint32_t pass = 0; pass < pass_count; ++pass)
+        {
+            planner.AddPass("Pass");
+            for (uint32_t i = rng() % 4; i > 0; --i)
+            {
+                // Mostly writes, so some textures are read first and become persistent.
+                const uint32_t texture = rng() % texture_count;
+                if (rng() % 4 == 0)
+                {
+                    planner.Read(texture);
+                }
+                else
+                {
+                    planner.Write(texture);
+                }
+            }
+        }
+        planner.Plan();
+        valid &= IsValidPlan(planner);
+
+        uint32_t most_alive = 0;
+        for (uint32_t pass = 0; pass < pass_count; ++pass)
+        {
+            const auto alive = std::ranges::count_if(planner.GetTextures(),
+                                                     [&](const TransientTexture& texture)
+                                                     {
+                                                         return texture.first_pass != TransientPlanner::NONE &&
+                                                                texture.first_pass <= pass && pass <= texture.last_pass;
+                                                     });
+            most_alive = std::max(most_alive, static_cast<uint32_t>(alive));
+        }
+        fewest &= planner.GetReport().block_count == most_alive;
+    }
+    CHECK(valid);
+    CHECK(fewest);
+}
@@ -0,0 +1,151 @@
+#include "test.hpp"
+#include "upload_ring.hpp"
+
+namespace
+{
+    // Stands in for the graphics queue: frames are submitted under increasing fence values and the GPU finishes
+    // them some frames later, in order.
+    struct MockQueue
+    {
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+
+        uint64_t Submit() { return ++submitted; }
+        void Complete(const uint64_t count) { completed = std::min(completed + count, submitted); }
+    };
+
+    struct Range
+    {
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    bool Overlaps(const Range& a, const Range& b) { return a.begin < b.end && b.begin < a.end; }
+} // namespace
+
+TEST(UploadRing, AllocationsAreAligned)
+{
+    UploadRing ring(1024);
+    CHECK(ring.Allocate(3, 1) == 0);
+    CHECK(ring.Allocate(16, 16) == 16);
+    CHECK(ring.Allocate(1, 256) == 256);
+    CHECK(ring.Allocate(8, 4) == 260);
+    // The padding counts as used until the frame is recycled.
+    CHECK(ring.GetUsedBytes() == 268);
+    CHECK(ring.Allocate(2048, 1) == UploadRing::NONE);
+}
+
+TEST(UploadRing, WrapsPastTheTail)
+{
+    MockQueue queue;
+    UploadRing ring(100);
+    CHECK(ring.Allocate(60, 4) == 0);
+    ring.EndFrame(queue.Submit());
+    CHECK(ring.Allocate(30, 4) == 60);
+    ring.EndFrame(queue.Submit());
+
+    // 10 bytes are left at the end, too few, and the start still belongs to the first frame.
+    CHECK(ring.Allocate(20, 4) == UploadRing::NONE);
+    queue.Complete(1);
+    ring.Recycle(queue.completed);
+    CHECK(ring.GetFramesInFlight() == 1);
+
+    // The allocation skips the tail rather than straddling the end of the ring.
+    CHECK(ring.Allocate(20, 4) == 0);
+    CHECK(ring.GetUsedBytes() == 60);
+}
+
+TEST(UploadRing, FramesInFlightBlockReuse)
+{
+    MockQueue queue;
+    UploadRing ring(256);
+    for (uint32_t frame = 0; frame < 4; ++frame)
+    {
+        CHECK(ring.Allocate(64, 16) != UploadRing::NONE);
+        ring.EndFrame(queue.Submit());
+    }
+    CHECK(ring.Allocate(1, 1) == UploadRing::NONE);
+
+    // Nothing is released before the GPU passes a frame's fence value, and frames are released in order.
+    ring.Recycle(0);
+    CHECK(ring.GetFramesInFlight() == 4);
+    queue.Complete(2);
+    ring.Recycle(queue.completed);
+    CHECK(ring.GetFramesInFlight() == 2);
+    CHECK(ring.GetUsedBytes() == 128);
+    CHECK(ring.Allocate(128, 16) == 0);
+    CHECK(ring.Allocate(1, 1) == UploadRing::NONE);
+}
+
+TEST(UploadRing, EmptyRingStartsOver)
+{
+    MockQueue queue;
+    UploadRing ring(100);
+    CHECK(ring.Allocate(70, 1) == 0);
+    ring.EndFrame(queue.Submit());
+    queue.Complete(1);
+    ring.Recycle(queue.completed);
+
+    // With nothing in flight the whole ring is free, even though the head sits in the middle of it.
+    CHECK(ring.GetUsedBytes() == 0);
+    CHECK(ring.Allocate(90, 1) == 0);
+    ring.EndFrame(queue.Submit());
+    queue.Complete(1);
+    ring.Recycle(queue.completed);
+    CHECK(ring.GetUsedBytes() == 0);
+}
+
+TEST(UploadRing, LiveAllocationsNeverOverlap)
+{
+    // Random frames against a GPU that lags a random number of frames behind. Every allocation made while its frame
+    // is still in flight must be disjoint from every other one that is.
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<uint64_t> size(1, 300);
+    std::uniform_int_distribution<uint32_t> allocations(0, 6);
+    std::uniform_int_distribution<uint32_t> alignment_shift(0, 8);
+    std::uniform_int_distribution<uint64_t> completed(0, 2);
+
+    MockQueue queue;
+    UploadRing ring(4096);
+    std::deque<std::pair<uint64_t, std::vector<Range>>> in_flight;
+    std::vector<Range> open;
+    uint32_t failures = 0;
+    bool overlap = false;
+    for (uint32_t frame = 0; frame < 5'000; ++frame)
+    {
+        queue.Complete(completed(rng));
+        ring.Recycle(queue.completed);
+        while (!in_flight.empty() && in_flight.front().first <= queue.completed)
+        {
+            in_flight.pop_front();
+        }
+
+        for (uint32_t i = allocations(rng); i > 0; --i)
+        {
+            const uint64_t alignment = uint64_t(1) << alignment_shift(rng);
+            const uint64_t bytes = size(rng);
+            const uint64_t offset = ring.Allocate(bytes, alignment);
+            if (offset == UploadRing::NONE)
+            {
+                ++failures;
+                continue;
+            }
+            const Range range{ .begin = offset, .end = offset + bytes };
+            overlap |= offset % alignment != 0 || range.end > ring.GetCapacity();
+            for (const auto& [fence_value, ranges] : in_flight)
+            {
+                overlap |= std::ranges::any_of(ranges, [&](const Range& other) { return Overlaps(range, other); });
+            }
+            overlap |= std::ranges::any_of(open, [&](const Range& other) { return Overlaps(range, other); });
+            open.push_back(range);
+        }
+        const uint64_t fence_value = queue.Submit();
+        ring.EndFrame(fence_value);
+        in_flight.emplace_back(fence_value, std::move(open));
+        open.clear();
+    }
+    CHECK(!overlap);
+    // The lagging GPU should have filled the ring now and then, or the test didn't exercise anything.
+    CHECK(failures > 0);
+    CHECK(ring.GetFramesInFlight() == in_flight.size());
+}